@@ -0,0 +1,101 @@
+#ifndef CBL_ALLOCATOR_BENCH_H
+#define CBL_ALLOCATOR_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/mem/fba.h"
+#include "cbl/mem/layout.h"
+#include "cbl/mem/pool.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+
+namespace cbl_bench {
+
+/// Allocates a block for every pointer in `ptrs` and then frees them in
+/// reverse order.
+inline static void allocateFree(mem::Allocator& allocator, mem::Layout layout,
+                                Slice<u8*> ptrs) {
+  for (u8*& ptr : ptrs) {
+    ptr = allocator.allocate(layout).ptr();
+  }
+  clobberMemory();
+  for (usize i = ptrs.len(); i > 0; i--) {
+    allocator.deallocate(ptrs[i - 1], layout);
+  }
+}
+
+/// Allocates a block for every pointer in `ptrs` with batches of `batch`
+/// blocks, and then frees them with batches as well.
+inline static void allocateFreeBatch(mem::Allocator& allocator,
+                                     mem::Layout layout, Slice<u8*> ptrs,
+                                     usize batch) {
+  for (usize i = 0; i < ptrs.len(); i += batch) {
+    const bool ok =
+        allocator.allocateBatch(layout, ptrs.subslice(i, i + batch));
+    doNotOptimize(ok);
+  }
+  clobberMemory();
+  for (usize i = 0; i < ptrs.len(); i += batch) {
+    allocator.deallocateBatch(ptrs.subslice(i, i + batch), layout);
+  }
+}
+
+inline static void allocatorBench(Harness& h) {
+  mem::CAllocator   allocator{};
+  const usize       count  = 10000;
+  const mem::Layout layout = mem::Layout{64, 16};
+  Slice<u8*>        ptrs   = allocator.createArray<u8*>(count);
+
+  h.run({"allocator", "c_allocator_64b", 2 * count},
+        [&]() { allocateFree(allocator, layout, ptrs); });
+
+  // The fixed buffer allocator is reset instead of freeing blocks one by one
+  Slice<u8> buf = allocator.createArray<u8>(count * 128);
+  {
+    mem::FixedBufferAllocator fba{buf};
+    h.run({"allocator", "fba_64b", count}, [&]() { fba.reset(); },
+          [&]() {
+            for (u8*& ptr : ptrs) {
+              ptr = fba.allocate(layout).ptr();
+            }
+            clobberMemory();
+          });
+  }
+
+  {
+    mem::PoolAllocator pool{allocator, layout};
+    h.run({"allocator", "pool_64b", 2 * count},
+          [&]() { allocateFree(pool, layout, ptrs); });
+    pool.deinit();
+  }
+
+  // Graph builders allocate many nodes of one layout at once
+  h.run({"allocator", "c_allocator_64b_batch_100", 2 * count},
+        [&]() { allocateFreeBatch(allocator, layout, ptrs, 100); });
+  {
+    mem::PoolAllocator pool{allocator, layout};
+    h.run({"allocator", "pool_64b_batch_100", 2 * count},
+          [&]() { allocateFreeBatch(pool, layout, ptrs, 100); });
+    pool.deinit();
+  }
+  {
+    mem::FixedBufferAllocator fba{buf};
+    h.run({"allocator", "fba_64b_batch_100", count}, [&]() { fba.reset(); },
+          [&]() {
+            for (usize i = 0; i < count; i += 100) {
+              const bool ok =
+                  fba.allocateBatch(layout, ptrs.subslice(i, i + 100));
+              doNotOptimize(ok);
+            }
+            clobberMemory();
+          });
+  }
+
+  allocator.destroyArray(buf);
+  allocator.destroyArray(ptrs);
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_ALLOCATOR_BENCH_H
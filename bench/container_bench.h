@@ -0,0 +1,202 @@
+#ifndef CBL_CONTAINER_BENCH_H
+#define CBL_CONTAINER_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/btree.h"
+#include "cbl/cache.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/priority_queue.h"
+#include "cbl/slice.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace cbl_bench {
+
+/// Fills `out` with keys in [0, n) drawn from a Zipfian distribution with
+/// exponent `s`, so that key 0 is the most popular.
+inline static void fillZipf(mem::Allocator& allocator, Slice<u64> out,
+                            usize n, f64 s, Rng& rng) {
+  Slice<f64> cdf   = allocator.createArray<f64>(n);
+  f64        total = 0.0;
+  for (usize i = 0; i < n; i++) {
+    total  += 1.0 / std::pow(static_cast<f64>(i + 1), s);
+    cdf[i]  = total;
+  }
+  for (u64& key : out) {
+    const f64 x = rng.nextF64() * total;
+    key = static_cast<u64>(std::upper_bound(cdf.begin(), cdf.end(), x) -
+                           cdf.begin());
+    key = (key < n) ? key : n - 1;
+  }
+  allocator.destroyArray(cdf);
+}
+
+inline static void btreeBench(Harness& h) {
+  mem::CAllocator allocator{};
+  const usize     len  = 1000000;
+  Slice<u64>      keys = allocator.createArray<u64>(len);
+  Rng             rng{3};
+  for (u64& key : keys) {
+    key = rng.next();
+  }
+
+  h.run({"btree", "insert_random_u64", len}, [&]() {
+    BTreeMap<u64, u64> map{allocator};
+    for (const u64 key : keys) {
+      map.insert(key, key);
+    }
+    doNotOptimize(map.len());
+    map.deinit();
+  });
+  h.run({"btree", "std_map_insert_random_u64", len}, [&]() {
+    std::map<u64, u64> map;
+    for (const u64 key : keys) {
+      map.emplace(key, key);
+    }
+    doNotOptimize(map.size());
+  });
+
+  BTreeMap<u64, u64> map{allocator};
+  std::map<u64, u64> std_map;
+  for (const u64 key : keys) {
+    map.insert(key, key);
+    std_map.emplace(key, key);
+  }
+  h.run({"btree", "lookup_random_u64", len}, [&]() {
+    for (const u64 key : keys) {
+      doNotOptimize(map.getPtr(key));
+    }
+  });
+  h.run({"btree", "std_map_lookup_random_u64", len}, [&]() {
+    for (const u64 key : keys) {
+      doNotOptimize(std_map.find(key));
+    }
+  });
+  h.run({"btree", "scan_u64", len}, [&]() {
+    BTreeMap<u64, u64>::Range range = map.iterator();
+    BTreeMap<u64, u64>::Entry entry = {};
+    u64                       sum   = 0;
+    while (range.next(&entry)) {
+      sum += *entry.value;
+    }
+    doNotOptimize(sum);
+  });
+  h.run({"btree", "std_map_scan_u64", len}, [&]() {
+    u64 sum = 0;
+    for (const auto& [key, value] : std_map) {
+      sum += value;
+    }
+    doNotOptimize(sum);
+  });
+
+  map.deinit();
+  allocator.destroyArray(keys);
+}
+
+inline static void priorityQueueBench(Harness& h) {
+  mem::CAllocator allocator{};
+  const usize     len    = 1000000;
+  Slice<u64>      values = allocator.createArray<u64>(len);
+  Rng             rng{4};
+  for (u64& value : values) {
+    value = rng.next();
+  }
+
+  h.run({"priority_queue", "push_pop_u64", 2 * len}, [&]() {
+    PriorityQueue<u64> queue{allocator};
+    for (const u64 value : values) {
+      queue.push(value);
+    }
+    u64 top = 0;
+    while (queue.pop(&top)) {
+      doNotOptimize(top);
+    }
+    queue.deinit();
+  });
+  h.run({"priority_queue", "std_push_pop_u64", 2 * len}, [&]() {
+    std::priority_queue<u64, std::vector<u64>, std::greater<u64>> queue;
+    for (const u64 value : values) {
+      queue.push(value);
+    }
+    while (!queue.empty()) {
+      doNotOptimize(queue.top());
+      queue.pop();
+    }
+  });
+
+  allocator.destroyArray(values);
+}
+
+inline static void cacheBench(Harness& h) {
+  mem::CAllocator allocator{};
+  const usize     universe = 1000000;
+  const usize     capacity = universe / 10;
+  const usize     ops      = 2000000;
+  const usize     budget   = capacity * Cache<u64, u64>::charge(0);
+  Slice<u64>      keys     = allocator.createArray<u64>(ops);
+  Rng             rng{5};
+  fillZipf(allocator, keys, universe, 0.99, rng);
+
+  // Every miss is filled, as a read-through cache would
+  const CachePolicy policies[2] = {CachePolicy::Lru, CachePolicy::Clock};
+  const const_cstr  names[2]    = {"lru_zipf_get_put", "clock_zipf_get_put"};
+  const const_cstr  rates[2]    = {"lru_zipf_hit_rate", "clock_zipf_hit_rate"};
+  for (usize p = 0; p < 2; p++) {
+    Cache<u64, u64> cache{allocator, budget, policies[p]};
+    usize           hits = 0;
+    h.run({"cache", names[p], ops}, [&]() {
+      hits = 0;
+      for (const u64 key : keys) {
+        u64 value = 0;
+        if (cache.get(key, &value)) {
+          hits += 1;
+        } else {
+          cache.put(key, key);
+        }
+      }
+    });
+    h.metric({"cache", rates[p], ops}, "hits/op",
+             static_cast<f64>(hits) / static_cast<f64>(ops));
+    cache.deinit();
+  }
+
+  // Threads replay parts of the same stream against a sharded cache
+  const usize threads = 4;
+  for (usize p = 0; p < 2; p++) {
+    ShardedCache<u64, u64> cache{allocator, budget, 0, policies[p]};
+    const const_cstr       name = (policies[p] == CachePolicy::Lru)
+                                      ? "sharded_lru_zipf_4_threads"
+                                      : "sharded_clock_zipf_4_threads";
+    h.run({"cache", name, ops}, [&]() {
+      std::thread workers[threads];
+      for (usize t = 0; t < threads; t++) {
+        workers[t] = std::thread{[&, t]() {
+          const usize part = ops / threads;
+          for (usize i = t * part; i < (t + 1) * part; i++) {
+            u64 value = 0;
+            if (!cache.get(keys[i], &value)) {
+              cache.put(keys[i], keys[i]);
+            }
+          }
+        }};
+      }
+      for (std::thread& worker : workers) {
+        worker.join();
+      }
+    });
+    cache.deinit();
+  }
+
+  allocator.destroyArray(keys);
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_CONTAINER_BENCH_H
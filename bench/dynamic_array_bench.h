@@ -0,0 +1,112 @@
+#ifndef CBL_DYNAMIC_ARRAY_BENCH_H
+#define CBL_DYNAMIC_ARRAY_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/dynamic_array.h"
+#include "cbl/mem/allocator.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/mem/fba.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+
+namespace cbl_bench {
+
+inline static void dynamicArrayBench(Harness& h) {
+  mem::CAllocator allocator{};
+
+  // Appending includes the cost of growing from empty
+  {
+    const usize len = 1000000;
+    h.run({"dynamic_array", "append_u64", len}, [&]() {
+      UnmanagedDynamicArray<u64> array;
+      for (usize i = 0; i < len; i++) {
+        array.append(allocator, i);
+      }
+      doNotOptimize(array.elems().ptr());
+      array.deinit(allocator);
+    });
+  }
+
+  // The same appends into a fixed buffer, with the allocator's concrete type
+  // (inlined bump allocation) and through `mem::Allocator&` (virtual calls)
+  {
+    const usize               len    = 1000000;
+    Slice<u8>                 buf    = allocator.createArray<u8>(64 * len);
+    mem::FixedBufferAllocator fba{buf};
+    mem::Allocator*           erased = opaque<mem::Allocator*>(&fba);
+    h.run({"dynamic_array", "append_u64_fba_static", len}, [&]() {
+      fba.reset();
+      UnmanagedDynamicArray<u64> array;
+      for (usize i = 0; i < len; i++) {
+        array.append(fba, i);
+      }
+      doNotOptimize(array.elems().ptr());
+    });
+    h.run({"dynamic_array", "append_u64_fba_virtual", len}, [&]() {
+      fba.reset();
+      UnmanagedDynamicArray<u64> array;
+      for (usize i = 0; i < len; i++) {
+        array.append(*erased, i);
+      }
+      doNotOptimize(array.elems().ptr());
+    });
+
+    // Appending into reserved capacity leaves only the bump allocations of
+    // many small arrays
+    const usize small = 4;
+    h.run({"dynamic_array", "small_arrays_fba_static", len / small}, [&]() {
+      fba.reset();
+      for (usize i = 0; i < len / small; i++) {
+        UnmanagedDynamicArray<u64> array =
+            UnmanagedDynamicArray<u64>::initWithCapacity(fba, small);
+        for (usize j = 0; j < small; j++) {
+          array.append(fba, j);
+        }
+        doNotOptimize(array.elems().ptr());
+      }
+    });
+    h.run({"dynamic_array", "small_arrays_fba_virtual", len / small}, [&]() {
+      fba.reset();
+      for (usize i = 0; i < len / small; i++) {
+        UnmanagedDynamicArray<u64> array =
+            UnmanagedDynamicArray<u64>::initWithCapacity(*erased, small);
+        for (usize j = 0; j < small; j++) {
+          array.append(*erased, j);
+        }
+        doNotOptimize(array.elems().ptr());
+      }
+    });
+    allocator.destroyArray(buf);
+  }
+
+  {
+    const usize len = 20000;
+    h.run({"dynamic_array", "insert_front_u64", len}, [&]() {
+      UnmanagedDynamicArray<u64> array =
+          UnmanagedDynamicArray<u64>::initWithCapacity(allocator, len);
+      for (usize i = 0; i < len; i++) {
+        array.insert(allocator, i, 0);
+      }
+      doNotOptimize(array.elems().ptr());
+      array.deinit(allocator);
+    });
+  }
+
+  {
+    const usize len = 20000;
+    h.run({"dynamic_array", "insert_middle_u64", len}, [&]() {
+      UnmanagedDynamicArray<u64> array =
+          UnmanagedDynamicArray<u64>::initWithCapacity(allocator, len);
+      for (usize i = 0; i < len; i++) {
+        array.insert(allocator, i, array.len() / 2);
+      }
+      doNotOptimize(array.elems().ptr());
+      array.deinit(allocator);
+    });
+  }
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_DYNAMIC_ARRAY_BENCH_H
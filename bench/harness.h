@@ -0,0 +1,341 @@
+#ifndef CBL_BENCH_HARNESS_H
+#define CBL_BENCH_HARNESS_H
+
+#include "cbl/primitives.h" // u64, usize, f64, const_cstr
+#include <algorithm>        // sort
+#include <chrono>           // steady_clock
+#include <cstdio>           // printf
+#include <cstdlib>          // strtoull
+#include <cstring>          // strcmp, strncmp, strstr
+
+#if defined(__linux__)
+#include <linux/perf_event.h> // perf_event_attr
+#include <sys/ioctl.h>        // ioctl
+#include <sys/syscall.h>      // SYS_perf_event_open
+#include <unistd.h>           // syscall, read, close
+#endif
+
+namespace cbl_bench {
+using namespace cbl;
+
+/// Keeps the compiler from optimizing away the computation of `value`.
+///
+/// # Note
+///
+/// The asm takes the address of `value` rather than `value` itself, since
+/// `_BitInt` types cannot be asm operands; the memory clobber makes the
+/// compiler store `value` before the asm.
+template <class T> inline auto doNotOptimize(const T& value) noexcept -> void {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+/// Keeps the compiler from optimizing away writes to memory.
+inline auto clobberMemory() noexcept -> void {
+  asm volatile("" : : : "memory");
+}
+
+/// Returns `value` in a way the compiler cannot see through, e.g. to keep it
+/// from devirtualizing calls through a base class pointer.
+template <class T> inline auto opaque(T value) noexcept -> T {
+  asm volatile("" : "+r"(value));
+  return value;
+}
+
+/// Counts CPU cycles and cache misses of the calling thread with
+/// `perf_event_open`.
+///
+/// # Note
+///
+/// The counters are unavailable outside Linux, or when the kernel does not
+/// allow unprivileged access (see `/proc/sys/kernel/perf_event_paranoid`).
+struct PerfCounters {
+  explicit PerfCounters() noexcept                      = default;
+  PerfCounters(PerfCounters&&) noexcept                 = delete;
+  PerfCounters(const PerfCounters&) noexcept            = delete;
+  PerfCounters& operator=(PerfCounters&&) noexcept      = delete;
+  PerfCounters& operator=(const PerfCounters&) noexcept = delete;
+
+public:
+  ~PerfCounters() noexcept {
+#if defined(__linux__)
+    if (this->_cycles >= 0) {
+      close(this->_cycles);
+    }
+    if (this->_misses >= 0) {
+      close(this->_misses);
+    }
+#endif
+  }
+
+  /// Opens the counters, returning `false` if they are unavailable.
+  auto open() noexcept -> bool {
+#if defined(__linux__)
+    this->_cycles = openCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (this->_cycles < 0) {
+      return false;
+    }
+    this->_misses = openCounter(PERF_COUNT_HW_CACHE_MISSES, this->_cycles);
+    return this->_misses >= 0;
+#else
+    return false;
+#endif
+  }
+
+  /// Resets and starts the counters.
+  auto start() noexcept -> void {
+#if defined(__linux__)
+    ioctl(this->_cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(this->_cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  /// Stops the counters and reads them.
+  auto stop(u64* cycles, u64* misses) noexcept -> void {
+    *cycles = 0;
+    *misses = 0;
+#if defined(__linux__)
+    ioctl(this->_cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    unsigned long long value = 0;
+    if (read(this->_cycles, &value, sizeof(value)) == sizeof(value)) {
+      *cycles = value;
+    }
+    if (read(this->_misses, &value, sizeof(value)) == sizeof(value)) {
+      *misses = value;
+    }
+#endif
+  }
+
+private:
+  int _cycles = -1;
+  int _misses = -1;
+
+#if defined(__linux__)
+  static auto openCounter(unsigned long long config, int group) noexcept
+      -> int {
+    perf_event_attr attr = {};
+    attr.type            = PERF_TYPE_HARDWARE;
+    attr.size            = sizeof(attr);
+    attr.config          = config;
+    attr.disabled        = (group < 0) ? 1 : 0;
+    attr.exclude_kernel  = 1;
+    attr.exclude_hv      = 1;
+    return static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+  }
+#endif
+};
+
+/// Describes a benchmark.
+struct Bench {
+  /// The group and name identify the benchmark across runs, so they should
+  /// not change.
+  const_cstr group;
+  const_cstr name;
+
+  /// The number of operations done by each repetition.
+  usize      ops;
+
+  /// The number of bytes processed by each operation, or 0 if throughput is
+  /// not meaningful.
+  usize      bytes_per_op = 0;
+};
+
+/// Runs benchmarks and reports their results.
+///
+/// Every benchmark is run for a few warmup repetitions, and then timed for a
+/// number of repetitions. The minimum, median and 99th percentile time per
+/// operation over the timed repetitions are reported, either as a table or as
+/// one JSON object per line (`--json`) for tracking regressions.
+///
+/// The command line accepts:
+///
+/// * `--json`: Print JSON lines instead of a table.
+/// * `--counters`: Also report cycles and cache misses per operation.
+/// * `--warmup=N`, `--reps=N`: Set the number of repetitions.
+/// * `--label=STR`: Add a label, such as the version, to every JSON object.
+/// * Any other argument only runs benchmarks whose `group/name` contains it.
+struct Harness {
+  explicit Harness() noexcept                 = delete;
+  Harness(Harness&&) noexcept                 = delete;
+  Harness(const Harness&) noexcept            = delete;
+  Harness& operator=(Harness&&) noexcept      = delete;
+  Harness& operator=(const Harness&) noexcept = delete;
+  ~Harness() noexcept                         = default;
+
+public:
+  /// The most timed repetitions per benchmark.
+  static constexpr usize MAX_REPS = 1000;
+
+  /// Creates a harness configured by the command line.
+  explicit Harness(int argc, char** argv) noexcept {
+    for (int i = 1; i < argc; i++) {
+      const_cstr arg = argv[i];
+      if (std::strcmp(arg, "--json") == 0) {
+        this->_json = true;
+      } else if (std::strcmp(arg, "--counters") == 0) {
+        this->_counters = true;
+      } else if (std::strncmp(arg, "--warmup=", 9) == 0) {
+        this->_warmup = std::strtoull(arg + 9, nullptr, 10);
+      } else if (std::strncmp(arg, "--reps=", 7) == 0) {
+        this->_reps = std::strtoull(arg + 7, nullptr, 10);
+      } else if (std::strncmp(arg, "--label=", 8) == 0) {
+        this->_label = arg + 8;
+      } else {
+        this->_filter = arg;
+      }
+    }
+    if (this->_reps == 0) {
+      this->_reps = 1;
+    } else if (this->_reps > MAX_REPS) {
+      this->_reps = MAX_REPS;
+    }
+    if (this->_counters && !this->_perf.open()) {
+      std::fprintf(stderr, "Performance counters are unavailable\n");
+      this->_counters = false;
+    }
+    if (!this->_json) {
+      std::printf("%-44s %12s %12s %12s %10s\n", "benchmark", "min ns/op",
+                  "median ns/op", "p99 ns/op", "MB/s");
+    }
+  }
+
+  /// Runs `body`, which must do `bench.ops` operations, after calling `setup`
+  /// untimed before every repetition.
+  template <class Setup, class Body>
+  auto run(const Bench& bench, Setup&& setup, Body&& body) noexcept -> void {
+    if (!this->selected(bench)) {
+      return;
+    }
+    for (usize i = 0; i < this->_warmup; i++) {
+      setup();
+      body();
+    }
+
+    f64 ns[MAX_REPS];
+    f64 cycles[MAX_REPS];
+    f64 misses[MAX_REPS];
+    for (usize i = 0; i < this->_reps; i++) {
+      setup();
+      if (this->_counters) {
+        this->_perf.start();
+      }
+      const auto start = std::chrono::steady_clock::now();
+      body();
+      const auto end   = std::chrono::steady_clock::now();
+      if (this->_counters) {
+        u64 c = 0;
+        u64 m = 0;
+        this->_perf.stop(&c, &m);
+        cycles[i] = static_cast<f64>(c) / static_cast<f64>(bench.ops);
+        misses[i] = static_cast<f64>(m) / static_cast<f64>(bench.ops);
+      }
+      ns[i] = static_cast<f64>(
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+                                                                       start)
+                      .count()) /
+              static_cast<f64>(bench.ops);
+    }
+
+    std::sort(ns, ns + this->_reps);
+    std::sort(cycles, cycles + (this->_counters ? this->_reps : 0));
+    std::sort(misses, misses + (this->_counters ? this->_reps : 0));
+    const usize median = this->_reps / 2;
+    const usize p99    = (this->_reps * 99 + 99) / 100 - 1;
+    const f64   mb_s   = (bench.bytes_per_op == 0)
+                             ? 0.0
+                             : static_cast<f64>(bench.bytes_per_op) * 1000.0 /
+                                 ns[median];
+
+    if (this->_json) {
+      std::printf("{\"group\":\"%s\",\"name\":\"%s\",\"label\":\"%s\","
+                  "\"ops\":%llu,\"reps\":%llu,\"min_ns\":%.3f,"
+                  "\"median_ns\":%.3f,\"p99_ns\":%.3f,\"bytes_per_op\":%llu,"
+                  "\"mb_per_s\":%.3f",
+                  bench.group, bench.name, this->_label,
+                  static_cast<unsigned long long>(bench.ops),
+                  static_cast<unsigned long long>(this->_reps), ns[0],
+                  ns[median], ns[p99],
+                  static_cast<unsigned long long>(bench.bytes_per_op), mb_s);
+      if (this->_counters) {
+        std::printf(",\"cycles_per_op\":%.3f,\"cache_misses_per_op\":%.3f",
+                    cycles[median], misses[median]);
+      }
+      std::printf("}\n");
+    } else {
+      char id[128];
+      std::snprintf(id, sizeof(id), "%s/%s", bench.group, bench.name);
+      std::printf("%-44s %12.2f %12.2f %12.2f %10.1f", id, ns[0], ns[median],
+                  ns[p99], mb_s);
+      if (this->_counters) {
+        std::printf("  %.1f cycles/op %.3f misses/op", cycles[median],
+                    misses[median]);
+      }
+      std::printf("\n");
+    }
+    std::fflush(stdout);
+  }
+
+  /// Runs `body`, which must do `bench.ops` operations.
+  template <class Body>
+  auto run(const Bench& bench, Body&& body) noexcept -> void {
+    this->run(bench, []() {}, body);
+  }
+
+  /// Reports a value that is not a time, such as a hit rate.
+  auto metric(const Bench& bench, const_cstr unit, f64 value) noexcept
+      -> void {
+    if (!this->selected(bench)) {
+      return;
+    }
+    if (this->_json) {
+      std::printf("{\"group\":\"%s\",\"name\":\"%s\",\"label\":\"%s\","
+                  "\"unit\":\"%s\",\"value\":%.6f}\n",
+                  bench.group, bench.name, this->_label, unit, value);
+    } else {
+      char id[128];
+      std::snprintf(id, sizeof(id), "%s/%s", bench.group, bench.name);
+      std::printf("%-44s %12.4f %s\n", id, value, unit);
+    }
+    std::fflush(stdout);
+  }
+
+private:
+  PerfCounters _perf;
+  const_cstr   _filter   = nullptr;
+  const_cstr   _label    = "";
+  usize        _warmup   = 2;
+  usize        _reps     = 11;
+  bool         _json     = false;
+  bool         _counters = false;
+
+  auto selected(const Bench& bench) const noexcept -> bool {
+    if (this->_filter == nullptr) {
+      return true;
+    }
+    char id[128];
+    std::snprintf(id, sizeof(id), "%s/%s", bench.group, bench.name);
+    return std::strstr(id, this->_filter) != nullptr;
+  }
+};
+
+/// A small, fast generator for benchmark inputs.
+struct Rng {
+  u64 state;
+
+  auto next() noexcept -> u64 {
+    this->state += 0x9E3779B97F4A7C15ULL;
+    u64 z        = this->state;
+    z            = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z            = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  /// Returns a uniform value in [0, 1).
+  auto nextF64() noexcept -> f64 {
+    return static_cast<f64>(this->next() >> 11) * 0x1.0p-53;
+  }
+};
+
+} // namespace cbl_bench
+
+#endif // !CBL_BENCH_HARNESS_H
@@ -0,0 +1,200 @@
+#ifndef CBL_IO_BENCH_H
+#define CBL_IO_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/io/binary.h"
+#include "cbl/io/buffer_writer.h"
+#include "cbl/io/event_loop.h"
+#include "cbl/io/file.h"
+#include "cbl/io/format.h"
+#include "cbl/io/task.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cstdio>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace cbl_bench {
+
+/// Sends `rounds` one-byte messages to `echoRounds` and waits for each reply.
+inline static auto pingRounds(io::EventLoop& loop, int fd,
+                              usize rounds) noexcept -> io::Task<void> {
+  u8 byte = 0;
+  for (usize i = 0; i < rounds; i++) {
+    (void)co_await loop.write(fd, Slice<u8>{&byte, 1});
+    (void)co_await loop.read(fd, Slice<u8>{&byte, 1});
+  }
+}
+
+inline static auto echoRounds(io::EventLoop& loop, int fd,
+                              usize rounds) noexcept -> io::Task<void> {
+  u8 byte = 0;
+  for (usize i = 0; i < rounds; i++) {
+    (void)co_await loop.read(fd, Slice<u8>{&byte, 1});
+    (void)co_await loop.write(fd, Slice<u8>{&byte, 1});
+  }
+}
+
+inline static auto yieldRounds(io::EventLoop& loop, usize rounds) noexcept
+    -> io::Task<void> {
+  for (usize i = 0; i < rounds; i++) {
+    co_await loop.yield();
+  }
+}
+
+inline static void ioBench(Harness& h) {
+  mem::CAllocator allocator{};
+
+  // Writes go through stdio to /dev/null, so the kernel does little work
+  {
+    io::File    file{"/dev/null", io::File::Mode::Write};
+    const usize count = 100000;
+    u8          chunk[64];
+    for (u8& byte : chunk) {
+      byte = 'a';
+    }
+    h.run({"io", "file_write_64b", count, sizeof(chunk)}, [&]() {
+      for (usize i = 0; i < count; i++) {
+        doNotOptimize(file.write(Slice<u8>{chunk, sizeof(chunk)}));
+      }
+    });
+    h.run({"io", "fwrite_64b", count, sizeof(chunk)}, [&]() {
+      for (usize i = 0; i < count; i++) {
+        doNotOptimize(std::fwrite(chunk, 1, sizeof(chunk), file.file()));
+      }
+    });
+
+    h.run({"format", "file_format", count}, [&]() {
+      for (usize i = 0; i < count; i++) {
+        file.format("id={} name={} ratio={}\n", i, "bench", 0.25);
+      }
+    });
+    h.run({"format", "fprintf", count}, [&]() {
+      for (usize i = 0; i < count; i++) {
+        std::fprintf(file.file(), "id=%llu name=%s ratio=%g\n",
+                     static_cast<unsigned long long>(i), "bench", 0.25);
+      }
+    });
+  }
+
+  // Formatting into memory isolates the formatting from stdio
+  {
+    const usize count = 100000;
+    u8          buf[128];
+    h.run({"format", "buffer_format", count}, [&]() {
+      for (usize i = 0; i < count; i++) {
+        io::BufferWriter writer{Slice<u8>{buf, sizeof(buf)}};
+        writer.format("id={} hex={x} name={}", i, i, "bench");
+        doNotOptimize(buf[0]);
+      }
+    });
+    h.run({"format", "snprintf", count}, [&]() {
+      for (usize i = 0; i < count; i++) {
+        std::snprintf(reinterpret_cast<char*>(buf), sizeof(buf),
+                      "id=%llu hex=%llx name=%s",
+                      static_cast<unsigned long long>(i),
+                      static_cast<unsigned long long>(i), "bench");
+        doNotOptimize(buf[0]);
+      }
+    });
+  }
+
+  // Binary encoding of varints and bulk slices
+  {
+    const usize count = 100000;
+    Slice<u8>   buf   = allocator.createArray<u8>(count * 16);
+    h.run({"binary", "write_varint", count}, [&]() {
+      io::BufferWriter writer{buf};
+      io::BinaryWriter encoder{writer};
+      for (usize i = 0; i < count; i++) {
+        encoder.writeVarint(static_cast<u64>(i) * 977);
+      }
+      doNotOptimize(encoder.written());
+    });
+    h.run({"binary", "read_varint", count}, [&]() {
+      io::BinaryReader decoder{buf};
+      u64              value = 0;
+      for (usize i = 0; i < count; i++) {
+        decoder.readVarint(&value);
+        doNotOptimize(value);
+      }
+    });
+
+    Slice<u64> values = allocator.createArray<u64>(count);
+    h.run({"binary", "write_slice_u64", 1, count * sizeof(u64)}, [&]() {
+      io::BufferWriter writer{buf};
+      io::BinaryWriter encoder{writer};
+      encoder.writeSlice(values);
+      doNotOptimize(encoder.written());
+    });
+    h.run({"binary", "read_slice_u64", 1, count * sizeof(u64)}, [&]() {
+      io::BinaryReader decoder{buf};
+      Slice<u64>       view;
+      doNotOptimize(decoder.readSlice(&view));
+      doNotOptimize(view.ptr());
+    });
+    allocator.destroyArray(values);
+    allocator.destroyArray(buf);
+  }
+
+  // Copying a file through the kernel, against `fread`/`fwrite` through a
+  // buffer in userspace
+  {
+    const usize len = usize{16} << 20;
+    io::File    src{std::tmpfile()};
+    io::File    dst{std::tmpfile()};
+    Slice<u8>   buf = allocator.createArray<u8>(usize{64} << 10);
+    for (usize done = 0; done < len; done += buf.len()) {
+      (void)src.write(buf);
+    }
+    std::fflush(src.file());
+
+    h.run({"io", "copy_range_16mb", 1, len}, [&]() {
+      (void)ftruncate(dst.fd(), 0);
+      (void)lseek(dst.fd(), 0, SEEK_SET);
+      doNotOptimize(io::copyRange(src, dst, 0, len, buf));
+    });
+    h.run({"io", "fread_fwrite_16mb", 1, len}, [&]() {
+      (void)ftruncate(dst.fd(), 0);
+      std::rewind(dst.file());
+      std::rewind(src.file());
+      usize n = 0;
+      while ((n = std::fread(buf.ptr(), 1, buf.len(), src.file())) != 0) {
+        doNotOptimize(std::fwrite(buf.ptr(), 1, n, dst.file()));
+      }
+      std::fflush(dst.file());
+    });
+    allocator.destroyArray(buf);
+  }
+
+  // Round trips between two tasks over a socket pair, where every read
+  // suspends until the other task has written
+  {
+    io::EventLoop loop{allocator};
+    const usize   rounds = 10000;
+    int           fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0) {
+      h.run({"event_loop", "socketpair_round_trip", rounds}, [&]() {
+        loop.spawn(echoRounds(loop, fds[1], rounds));
+        loop.spawn(pingRounds(loop, fds[0], rounds));
+        loop.run();
+      });
+      close(fds[0]);
+      close(fds[1]);
+    }
+
+    // Ready tasks run in rounds, with a non-blocking poll between rounds
+    const usize switches = 100000;
+    h.run({"event_loop", "yield_2_tasks", 2 * switches}, [&]() {
+      loop.spawn(yieldRounds(loop, switches));
+      loop.spawn(yieldRounds(loop, switches));
+      loop.run();
+    });
+  }
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_IO_BENCH_H
@@ -0,0 +1,54 @@
+#include "allocator_bench.h"
+#include "container_bench.h"
+#include "dynamic_array_bench.h"
+#include "harness.h"
+#include "io_bench.h"
+#include "slice_bench.h"
+#include "sort_bench.h"
+#include "sync_bench.h"
+#include "trace_bench.h"
+
+int main(int argc, char** argv) {
+  using namespace cbl_bench;
+  Harness h{argc, argv};
+
+  // Allocator benchmarks
+  {
+    allocatorBench(h);
+  }
+
+  // Slice benchmarks
+  {
+    sliceBench(h);
+    dynamicArrayBench(h);
+  }
+
+  // Container benchmarks
+  {
+    btreeBench(h);
+    priorityQueueBench(h);
+    cacheBench(h);
+  }
+
+  // Sorting benchmarks
+  {
+    sortBench(h);
+  }
+
+  // I/O benchmarks
+  {
+    ioBench(h);
+  }
+
+  // Synchronization benchmarks
+  {
+    syncBench(h);
+  }
+
+  // Tracing benchmarks
+  {
+    traceBench(h);
+  }
+
+  return 0;
+}
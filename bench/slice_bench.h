@@ -0,0 +1,94 @@
+#ifndef CBL_SLICE_BENCH_H
+#define CBL_SLICE_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/assert.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slice_ops.h"
+#include <algorithm>
+
+namespace cbl_bench {
+
+inline static void sliceBench(Harness& h) {
+  mem::CAllocator allocator{};
+  const usize     len    = 1 << 20;
+  Slice<u32>      values = allocator.createArray<u32>(len);
+  Rng             rng{1};
+  for (u32& value : values) {
+    value = static_cast<u32>(rng.next() % 1000);
+  }
+
+  // Element access: bounds-checked, unchecked, with an always-on check of
+  // every value, and through iterators
+  h.run({"slice", "index_checked_u32", len, sizeof(u32)}, [&]() {
+    u64 sum = 0;
+    for (usize i = 0; i < values.len(); i++) {
+      sum += values[i];
+    }
+    doNotOptimize(sum);
+  });
+  h.run({"slice", "index_unchecked_u32", len, sizeof(u32)}, [&]() {
+    u64 sum = 0;
+    for (usize i = 0; i < values.len(); i++) {
+      sum += values.getUnchecked(i);
+    }
+    doNotOptimize(sum);
+  });
+  h.run({"slice", "index_verified_u32", len, sizeof(u32)}, [&]() {
+    u64 sum = 0;
+    for (usize i = 0; i < values.len(); i++) {
+      CBL_VERIFY(values[i] < 1000, "The value is out of range");
+      sum += values[i];
+    }
+    doNotOptimize(sum);
+  });
+  h.run({"slice", "iterate_u32", len, sizeof(u32)}, [&]() {
+    u64 sum = 0;
+    for (const u32 value : values) {
+      sum += value;
+    }
+    doNotOptimize(sum);
+  });
+
+  // Bulk kernels against the standard algorithms
+  const u32 missing = 5000;
+  h.run({"slice_ops", "index_of_u32", len, sizeof(u32)},
+        [&]() { doNotOptimize(slice::indexOf(values, missing)); });
+  h.run({"slice_ops", "std_find_u32", len, sizeof(u32)}, [&]() {
+    doNotOptimize(std::find(values.begin(), values.end(), missing));
+  });
+  h.run({"slice_ops", "count_u32", len, sizeof(u32)},
+        [&]() { doNotOptimize(slice::count(values, 7U)); });
+  h.run({"slice_ops", "std_count_u32", len, sizeof(u32)}, [&]() {
+    doNotOptimize(std::count(values.begin(), values.end(), 7U));
+  });
+  h.run({"slice_ops", "count_less_u32", len, sizeof(u32)},
+        [&]() { doNotOptimize(slice::countLess(values, 500U)); });
+  h.run({"slice_ops", "min_u32", len, sizeof(u32)},
+        [&]() { doNotOptimize(slice::min(values)); });
+  h.run({"slice_ops", "std_min_element_u32", len, sizeof(u32)}, [&]() {
+    doNotOptimize(*std::min_element(values.begin(), values.end()));
+  });
+  h.run({"slice_ops", "sum_u32", len, sizeof(u32)},
+        [&]() { doNotOptimize(slice::sum(values)); });
+
+  Slice<u32> dst = allocator.createArray<u32>(len);
+  h.run({"slice_ops", "copy_u32", len, sizeof(u32)}, [&]() {
+    slice::copy(dst, values);
+    clobberMemory();
+  });
+  h.run({"slice_ops", "fill_u32", len, sizeof(u32)}, [&]() {
+    slice::fill(dst, u32{3});
+    clobberMemory();
+  });
+
+  allocator.destroyArray(dst);
+  allocator.destroyArray(values);
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_SLICE_BENCH_H
@@ -0,0 +1,51 @@
+#ifndef CBL_SORT_BENCH_H
+#define CBL_SORT_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slice_ops.h"
+#include "cbl/sort.h"
+#include <algorithm>
+
+namespace cbl_bench {
+
+inline static void sortBench(Harness& h) {
+  mem::CAllocator allocator{};
+  const usize     len    = 1 << 20;
+  Slice<u64>      input  = allocator.createArray<u64>(len);
+  Slice<u64>      values = allocator.createArray<u64>(len);
+  Rng             rng{2};
+  for (u64& value : input) {
+    value = rng.next();
+  }
+  auto reset = [&]() { slice::copy(values, input); };
+
+  h.run({"sort", "pdq_random_u64", len}, reset,
+        [&]() { sort::pdq(values); });
+  h.run({"sort", "std_sort_random_u64", len}, reset,
+        [&]() { std::sort(values.begin(), values.end()); });
+  h.run({"sort", "radix_random_u64", len}, reset,
+        [&]() { sort::radix(allocator, values); });
+  h.run({"sort", "parallel_random_u64", len}, reset,
+        [&]() { sort::parallel(allocator, values); });
+
+  // Presorted runs are where pattern detection pays off
+  std::sort(input.begin(), input.end());
+  for (usize i = 0; i < len; i += 1000) {
+    input[i] = rng.next();
+  }
+  h.run({"sort", "pdq_nearly_sorted_u64", len}, reset,
+        [&]() { sort::pdq(values); });
+  h.run({"sort", "std_sort_nearly_sorted_u64", len}, reset,
+        [&]() { std::sort(values.begin(), values.end()); });
+
+  allocator.destroyArray(values);
+  allocator.destroyArray(input);
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_SORT_BENCH_H
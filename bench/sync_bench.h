@@ -0,0 +1,159 @@
+#ifndef CBL_SYNC_BENCH_H
+#define CBL_SYNC_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/sync/channel.h"
+#include "cbl/sync/mutex.h"
+#include "cbl/sync/rw_lock.h"
+#include "cbl/sync/spin_lock.h"
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+namespace cbl_bench {
+
+/// Runs `body(t)` on `threads` threads and waits for them.
+template <class F> inline static void onThreads(usize threads, F&& body) {
+  std::thread workers[16];
+  for (usize t = 0; t < threads; t++) {
+    workers[t] = std::thread{[&body, t]() { body(t); }};
+  }
+  for (usize t = 0; t < threads; t++) {
+    workers[t].join();
+  }
+}
+
+/// Increments a counter `iters` times under `lock` on every thread.
+template <class L>
+inline static void contend(L& lock, usize threads, usize iters) {
+  usize counter = 0;
+  onThreads(threads, [&](usize) {
+    for (usize i = 0; i < iters; i++) {
+      lock.lock();
+      counter += 1;
+      lock.unlock();
+    }
+  });
+  doNotOptimize(counter);
+}
+
+/// Reads a shared value under `lock`, writing it every 16th time.
+template <class L, class LockShared, class UnlockShared>
+inline static void readMostly(L& lock, usize threads, usize iters,
+                              LockShared lock_shared,
+                              UnlockShared unlock_shared) {
+  usize value = 0;
+  onThreads(threads, [&](usize t) {
+    usize sum = 0;
+    for (usize i = 0; i < iters; i++) {
+      if (((i + t) & 15) == 0) {
+        lock.lock();
+        value += 1;
+        lock.unlock();
+      } else {
+        lock_shared(lock);
+        sum += value;
+        unlock_shared(lock);
+      }
+    }
+    doNotOptimize(sum);
+  });
+}
+
+/// Sends `count` messages from `senders` threads and receives them in
+/// batches of `batch` on the calling thread.
+inline static void pipe(sync::Channel<u64>& channel, usize senders,
+                        usize count, usize batch) {
+  std::thread threads[16];
+  for (usize t = 0; t < senders; t++) {
+    threads[t] = std::thread{[&channel, senders, count]() {
+      for (usize i = 0; i < count / senders; i++) {
+        channel.send(i);
+      }
+    }};
+  }
+  u64   buf[256];
+  u64   sum      = 0;
+  usize received = 0;
+  while (received < count) {
+    const usize n = channel.recvMany(Slice<u64>{buf, batch});
+    for (usize i = 0; i < n; i++) {
+      sum += buf[i];
+    }
+    received += n;
+  }
+  for (usize t = 0; t < senders; t++) {
+    threads[t].join();
+  }
+  doNotOptimize(sum);
+}
+
+inline static void syncBench(Harness& h) {
+  const usize iters = 100000;
+
+  // A single thread only pays for the atomic instructions
+  {
+    sync::Mutex mutex;
+    h.run({"sync", "mutex_uncontended", iters},
+          [&]() { contend(mutex, 1, iters); });
+    std::mutex std_mutex;
+    h.run({"sync", "std_mutex_uncontended", iters},
+          [&]() { contend(std_mutex, 1, iters); });
+    sync::SpinLock spin;
+    h.run({"sync", "spin_lock_uncontended", iters},
+          [&]() { contend(spin, 1, iters); });
+  }
+
+  // Every thread hammers the same lock
+  const usize threads = 4;
+  {
+    sync::Mutex mutex;
+    h.run({"sync", "mutex_4_threads", threads * iters},
+          [&]() { contend(mutex, threads, iters); });
+    std::mutex std_mutex;
+    h.run({"sync", "std_mutex_4_threads", threads * iters},
+          [&]() { contend(std_mutex, threads, iters); });
+    sync::SpinLock spin;
+    h.run({"sync", "spin_lock_4_threads", threads * iters},
+          [&]() { contend(spin, threads, iters); });
+  }
+
+  {
+    sync::RwLock lock;
+    h.run({"sync", "rw_lock_read_mostly_4_threads", threads * iters}, [&]() {
+      readMostly(
+          lock, threads, iters, [](sync::RwLock& l) { l.lockShared(); },
+          [](sync::RwLock& l) { l.unlockShared(); });
+    });
+    std::shared_mutex std_lock;
+    h.run({"sync", "std_shared_mutex_read_mostly_4_threads", threads * iters},
+          [&]() {
+            readMostly(
+                std_lock, threads, iters,
+                [](std::shared_mutex& l) { l.lock_shared(); },
+                [](std::shared_mutex& l) { l.unlock_shared(); });
+          });
+  }
+
+  // Messages through a channel, one by one and in batches
+  {
+    mem::CAllocator    allocator{};
+    sync::Channel<u64> channel{allocator, 1024};
+    const usize        count = 1 << 20;
+    h.run({"channel", "spsc_u64", count, sizeof(u64)},
+          [&]() { pipe(channel, 1, count, 1); });
+    h.run({"channel", "spsc_u64_batch_64", count, sizeof(u64)},
+          [&]() { pipe(channel, 1, count, 64); });
+    h.run({"channel", "mpsc_4_u64_batch_64", count, sizeof(u64)},
+          [&]() { pipe(channel, 4, count, 64); });
+    channel.deinit();
+  }
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_SYNC_BENCH_H
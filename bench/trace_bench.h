@@ -0,0 +1,62 @@
+#ifndef CBL_TRACE_BENCH_H
+#define CBL_TRACE_BENCH_H
+
+#include "harness.h"
+
+#include "cbl/io/buffer_writer.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/trace.h"
+
+namespace cbl_bench {
+
+inline static void traceBench(Harness& h) {
+  mem::CAllocator allocator{};
+  Slice<u8>       buf = allocator.createArray<u8>(16 << 20);
+  io::BufferWriter out{buf};
+
+  static constexpr trace::Site zone{"bench_zone"};
+  static constexpr trace::Site value{"bench_counter"};
+
+  // Buffers are drained between repetitions so that nothing is dropped
+  const usize count = trace::BUFFER_EVENTS / 4;
+  auto        drain = [&]() {
+    out.reset();
+    (void)trace::exportBinary(allocator, out);
+  };
+
+  h.run({"trace", "zone", count}, drain, [&]() {
+    for (usize i = 0; i < count; i++) {
+      trace::Zone z{zone};
+      clobberMemory();
+    }
+  });
+
+  h.run({"trace", "counter", count}, drain, [&]() {
+    for (usize i = 0; i < count; i++) {
+      trace::counter(value, static_cast<i64>(i));
+    }
+  });
+
+  // Exporting a full buffer of zones
+  auto fill = [&]() {
+    drain();
+    for (usize i = 0; i < count; i++) {
+      trace::Zone z{zone};
+    }
+    out.reset();
+  };
+  h.run({"trace", "export_binary", 2 * count}, fill, [&]() {
+    (void)trace::exportBinary(allocator, out);
+  });
+  h.run({"trace", "export_chrome_json", 2 * count}, fill, [&]() {
+    (void)trace::exportChromeJson(out);
+  });
+
+  allocator.destroyArray(buf);
+}
+
+} // namespace cbl_bench
+
+#endif // !CBL_TRACE_BENCH_H
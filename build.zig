@@ -3,15 +3,34 @@ const genCompileCommands = @import("build/gen_compile_commands.zig").genCompileC
 
 pub const source_files = [_][]const u8{
     "src/assert.cpp",
+    "src/bit_set.cpp",
+    "src/cpu.cpp",
+    "src/io/binary.cpp",
+    "src/io/buffer_writer.cpp",
+    "src/io/event_loop.cpp",
+    "src/io/file.cpp",
+    "src/io/format.cpp",
+    "src/io/ring.cpp",
+    "src/io/task.cpp",
     "src/io/writer.cpp",
+    "src/log.cpp",
     "src/mem/allocator.cpp",
     "src/mem/c_allocator.cpp",
     "src/mem/fba.cpp",
-    "src/mem/layout.cpp",
+    "src/mem/pool.cpp",
+    "src/slice_ops.cpp",
+    "src/string.cpp",
+    "src/string_pool.cpp",
+    "src/sync/channel.cpp",
+    "src/sync/condition.cpp",
+    "src/sync/futex.cpp",
+    "src/sync/mutex.cpp",
+    "src/sync/once.cpp",
+    "src/sync/reset_event.cpp",
+    "src/sync/rw_lock.cpp",
+    "src/trace.cpp",
 };
 
-// TODO: Add flags for release and switch based on that!
-
 fn debugFlags(allocator: std.mem.Allocator, extra_opts: ?[]const []const u8) !std.ArrayList([]const u8) {
     var flags = std.ArrayList([]const u8).initCapacity(allocator, 10) catch unreachable;
     try flags.append("-std=c++20");
@@ -33,6 +52,32 @@ fn debugFlags(allocator: std.mem.Allocator, extra_opts: ?[]const []const u8) !st
     return flags;
 }
 
+fn releaseFlags(allocator: std.mem.Allocator, extra_opts: ?[]const []const u8) !std.ArrayList([]const u8) {
+    var flags = std.ArrayList([]const u8).initCapacity(allocator, 10) catch unreachable;
+    try flags.append("-std=c++20");
+    try flags.append("-W");
+    try flags.append("-Wall");
+    try flags.append("-Werror");
+    try flags.append("-Wpedantic");
+    try flags.append("-Wstrict-prototypes");
+    try flags.append("-Wwrite-strings");
+    try flags.append("-Wno-missing-field-initializers");
+    try flags.append("-Wno-bit-int-extension");
+    if (extra_opts != null) {
+        for (extra_opts.?) |opt| {
+            try flags.append(opt);
+        }
+    }
+    return flags;
+}
+
+fn optimizeFlags(allocator: std.mem.Allocator, optimize: std.builtin.OptimizeMode, extra_opts: ?[]const []const u8) !std.ArrayList([]const u8) {
+    return switch (optimize) {
+        .Debug => debugFlags(allocator, extra_opts),
+        else => releaseFlags(allocator, extra_opts),
+    };
+}
+
 pub fn getSourceFileNames(allocator: std.mem.Allocator, files: []const []const u8) !std.ArrayList([]const u8) {
     var filenames = std.ArrayList([]const u8).init(allocator);
     for (files) |file| {
@@ -64,6 +109,12 @@ pub fn build(b: *std.Build) !void {
         lib.root_module.addCMacro("CBL_ASSERT_ON", "");
     }
 
+    // Compile in the tracing zones with `-Dtrace=true`
+    const trace = b.option(bool, "trace", "Record CBL_TRACE_ZONE events") orelse false;
+    if (trace) {
+        lib.root_module.addCMacro("CBL_TRACE_ON", "");
+    }
+
     const filenames = try getSourceFileNames(b.allocator, &source_files);
     for (source_files, 0..) |file, i| {
         const buf = try b.allocator.alloc(u8, file.len + 12);
@@ -75,7 +126,7 @@ pub fn build(b: *std.Build) !void {
         try writer.print("build/{s}.json", .{filenames.items[i]});
         const out = stream.getWritten();
 
-        const flags = try debugFlags(b.allocator, &.{ "-MJ", out });
+        const flags = try optimizeFlags(b.allocator, optimize, &.{ "-MJ", out });
         lib.addCSourceFile(.{
             .file = b.path(file),
             .flags = flags.items,
@@ -97,6 +148,9 @@ pub fn build(b: *std.Build) !void {
     });
     lib_tests.addIncludePath(b.path("include"));
     lib_tests.root_module.addCMacro("CBL_ASSERT_ON", "");
+    if (trace) {
+        lib_tests.root_module.addCMacro("CBL_TRACE_ON", "");
+    }
     const flags = try debugFlags(b.allocator, null);
     lib_tests.addCSourceFile(.{
         .file = b.path("tests/runner.cpp"),
@@ -109,4 +163,40 @@ pub fn build(b: *std.Build) !void {
     test_step.dependOn(b.getInstallStep());
     test_step.dependOn(&run_lib_unit_tests.step);
     b.installArtifact(lib_tests);
+
+    // Benchmarks
+    // ==================================
+    // Benchmarks build their own optimized copy of the library, so they
+    // measure release code whatever the `-Doptimize` option is
+    const bench_flags = try releaseFlags(b.allocator, null);
+    const bench_lib = b.addStaticLibrary(.{
+        .name = "cbl_bench_lib",
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    bench_lib.addIncludePath(b.path("include"));
+    bench_lib.addCSourceFiles(.{
+        .files = &source_files,
+        .flags = bench_flags.items,
+    });
+    bench_lib.linkLibCpp();
+
+    const lib_bench = b.addExecutable(.{
+        .name = "cbl_bench",
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    lib_bench.addIncludePath(b.path("include"));
+    lib_bench.addCSourceFile(.{
+        .file = b.path("bench/runner.cpp"),
+        .flags = bench_flags.items,
+    });
+    lib_bench.linkLibCpp();
+    lib_bench.linkLibrary(bench_lib);
+    const run_lib_bench = b.addRunArtifact(lib_bench);
+    if (b.args) |args| {
+        run_lib_bench.addArgs(args);
+    }
+    const bench_step = b.step("bench", "Run benchmarks (`zig build bench -- --json` for JSON lines)");
+    bench_step.dependOn(&run_lib_bench.step);
 }
@@ -6,16 +6,69 @@
 
 namespace cbl {
 
-auto cbl_assert(bool expr, const_cstr msg,
-                std::source_location loc = std::source_location::current())
+namespace detail {
+
+/// Reports a failed check at `loc` and aborts.
+///
+/// The function is cold and never inlined, so a check only costs its
+/// condition and a branch; the message and location are only materialized
+/// on the failure path.
+[[noreturn, gnu::cold, gnu::noinline]] auto
+assertFail(const_cstr           msg,
+           std::source_location loc = std::source_location::current()) noexcept
     -> void;
 
+} // namespace detail
+
+/// Aborts with `msg` if `expr` is `false`.
+inline auto cbl_assert(bool expr, const_cstr msg,
+                       std::source_location loc =
+                           std::source_location::current()) noexcept -> void {
+  if (!expr) [[unlikely]] {
+    detail::assertFail(msg, loc);
+  }
+}
+
 // clang-format off
+
+/// Aborts with `msg` if `expr` is `false`, in every build.
+///
+/// Use this for cheap invariants that must hold in production, e.g. on data
+/// read from outside the program.
+#define CBL_VERIFY(expr, msg)                                                  \
+  (__builtin_expect(static_cast<bool>(expr), 1)                                \
+       ? (void)0                                                               \
+       : ::cbl::detail::assertFail(msg))
+
+/// Aborts with `msg` if `expr` is `false`, when `CBL_ASSERT_ON` is defined.
+///
+/// Assertions may be used in `constexpr` functions, since the failure path is
+/// only taken if they fail.
 #ifdef CBL_ASSERT_ON
-  #define CBL_ASSERT(expr, msg) ::cbl::cbl_assert(expr, msg)
+  #define CBL_ASSERT(expr, msg) CBL_VERIFY(expr, msg)
 #else
-  #define CBL_ASSERT(expr, msg)
+  // Keeps variables that are only used by assertions from being unused
+  #define CBL_ASSERT(expr, msg) ((void)sizeof(expr))
 #endif // CBL_ASSERT_ON
+
+/// Checks `expr` like `CBL_ASSERT` when `CBL_ASSERT_ON` is defined, and
+/// otherwise tells the optimizer that `expr` is `true`.
+///
+/// # Safety
+///
+/// Without `CBL_ASSERT_ON`, `expr` being `false` is Undefined Behavior.
+/// `expr` must be cheap and free of side effects, since it may or may not be
+/// evaluated. Clang counts any function call as a side effect, so values
+/// returned by calls should be read into locals first.
+#ifdef CBL_ASSERT_ON
+  #define CBL_ASSUME(expr, msg) CBL_VERIFY(expr, msg)
+#elif defined(__clang__)
+  #define CBL_ASSUME(expr, msg) __builtin_assume(expr)
+#else
+  #define CBL_ASSUME(expr, msg)                                                \
+    (static_cast<bool>(expr) ? (void)0 : __builtin_unreachable())
+#endif // CBL_ASSERT_ON
+
 // clang-format on
 
 } // namespace cbl
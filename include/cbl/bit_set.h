@@ -0,0 +1,395 @@
+#ifndef CBL_BIT_SET_H
+#define CBL_BIT_SET_H
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u64, usize
+#include "cbl/slice.h"         // Slice
+
+namespace cbl {
+
+namespace detail {
+
+/// Returns the number of words needed to store `bits` bits.
+constexpr auto bitSetWords(usize bits) noexcept -> usize {
+  return (bits + 63) / 64;
+}
+
+/// Returns the mask of the bits in use in the last word of a set of `bits`
+/// bits.
+constexpr auto bitSetLastMask(usize bits) noexcept -> u64 {
+  return ((bits % 64) == 0) ? ~u64(0) : (u64(1) << (bits % 64)) - 1;
+}
+
+/// Returns the number of set bits in `words`, using the `popcnt` instruction
+/// when the CPU supports it.
+auto popcountWords(const u64* words, usize len) noexcept -> usize;
+
+} // namespace detail
+
+/// Iterates over the indices of the set bits in a sequence of words, in
+/// ascending order.
+struct SetBitIterator {
+  explicit SetBitIterator() noexcept                        = delete;
+  SetBitIterator(SetBitIterator&&) noexcept                 = default;
+  SetBitIterator(const SetBitIterator&) noexcept            = default;
+  SetBitIterator& operator=(SetBitIterator&&) noexcept      = default;
+  SetBitIterator& operator=(const SetBitIterator&) noexcept = default;
+  ~SetBitIterator() noexcept                                = default;
+
+public:
+  explicit SetBitIterator(Slice<const u64> words) noexcept
+      : _words{words}, _word{words.len() == 0 ? u64(0) : words[0]} {}
+
+  /// Stores the index of the next set bit in `out`, returning `false` if
+  /// there are no set bits left.
+  auto next(usize* out) noexcept -> bool {
+    while (this->_word == 0) {
+      this->_idx += 1;
+      if (this->_idx >= this->_words.len()) {
+        return false;
+      }
+      this->_word = this->_words.getUnchecked(this->_idx);
+    }
+    *out = this->_idx * 64 +
+           static_cast<usize>(
+               __builtin_ctzll(static_cast<unsigned long long>(this->_word)));
+
+    // Clear the lowest set bit
+    this->_word &= this->_word - 1;
+    return true;
+  }
+
+private:
+  Slice<const u64> _words;
+  u64              _word;
+  usize            _idx = 0;
+};
+
+/// A set of `N` bits stored inline.
+///
+/// Bits past `N` in the last word are always zero, so the words can be
+/// serialized and compared directly.
+template <usize N> struct BitSet {
+  static_assert(N > 0, "A BitSet must hold at least one bit");
+
+  /// Creates a set with every bit unset.
+  explicit BitSet() noexcept                = default;
+  BitSet(BitSet&&) noexcept                 = default;
+  BitSet(const BitSet&) noexcept            = default;
+  BitSet& operator=(BitSet&&) noexcept      = default;
+  BitSet& operator=(const BitSet&) noexcept = default;
+  ~BitSet() noexcept                        = default;
+
+public:
+  static constexpr usize WORDS = detail::bitSetWords(N);
+
+  /// Returns the number of bits in the set.
+  static constexpr auto len() noexcept -> usize { return N; }
+
+  /// Returns `true` if bit `idx` is set.
+  auto isSet(usize idx) const noexcept -> bool {
+    CBL_ASSERT(idx < N, "The index is outside the set's bounds");
+    return ((this->_words[idx / 64] >> (idx % 64)) & 1) != 0;
+  }
+
+  /// Sets bit `idx`.
+  auto set(usize idx) noexcept -> void {
+    CBL_ASSERT(idx < N, "The index is outside the set's bounds");
+    this->_words[idx / 64] |= u64(1) << (idx % 64);
+  }
+
+  /// Unsets bit `idx`.
+  auto unset(usize idx) noexcept -> void {
+    CBL_ASSERT(idx < N, "The index is outside the set's bounds");
+    this->_words[idx / 64] &= ~(u64(1) << (idx % 64));
+  }
+
+  /// Flips bit `idx`.
+  auto toggle(usize idx) noexcept -> void {
+    CBL_ASSERT(idx < N, "The index is outside the set's bounds");
+    this->_words[idx / 64] ^= u64(1) << (idx % 64);
+  }
+
+  /// Sets every bit.
+  auto setAll() noexcept -> void {
+    for (u64& word : this->_words) {
+      word = ~u64(0);
+    }
+    this->maskLast();
+  }
+
+  /// Unsets every bit.
+  auto unsetAll() noexcept -> void {
+    for (u64& word : this->_words) {
+      word = 0;
+    }
+  }
+
+  /// Flips every bit.
+  auto toggleAll() noexcept -> void {
+    for (u64& word : this->_words) {
+      word = ~word;
+    }
+    this->maskLast();
+  }
+
+  /// Sets the bits that are set in `other` (`this | other`).
+  auto setUnion(const BitSet& other) noexcept -> void {
+    for (usize i = 0; i < WORDS; i++) {
+      this->_words[i] |= other._words[i];
+    }
+  }
+
+  /// Unsets the bits that are unset in `other` (`this & other`).
+  auto setIntersection(const BitSet& other) noexcept -> void {
+    for (usize i = 0; i < WORDS; i++) {
+      this->_words[i] &= other._words[i];
+    }
+  }
+
+  /// Unsets the bits that are set in `other` (`this & ~other`).
+  auto setDifference(const BitSet& other) noexcept -> void {
+    for (usize i = 0; i < WORDS; i++) {
+      this->_words[i] &= ~other._words[i];
+    }
+  }
+
+  /// Flips the bits that are set in `other` (`this ^ other`).
+  auto toggleSet(const BitSet& other) noexcept -> void {
+    for (usize i = 0; i < WORDS; i++) {
+      this->_words[i] ^= other._words[i];
+    }
+  }
+
+  /// Returns the number of set bits.
+  auto count() const noexcept -> usize {
+    return detail::popcountWords(this->_words, WORDS);
+  }
+
+  /// Returns `true` if both sets have the same bits set.
+  auto eql(const BitSet& other) const noexcept -> bool {
+    for (usize i = 0; i < WORDS; i++) {
+      if (this->_words[i] != other._words[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Returns an iterator over the indices of the set bits.
+  auto iterator() const noexcept -> SetBitIterator {
+    return SetBitIterator{Slice<const u64>{this->_words, WORDS}};
+  }
+
+  /// Returns the underlying words, with bit `i` stored in bit `i % 64` of
+  /// word `i / 64`.
+  ///
+  /// # Safety
+  ///
+  /// Bits past `N` in the last word must be left unset.
+  auto words() noexcept -> Slice<u64> {
+    return Slice<u64>{this->_words, WORDS};
+  }
+
+private:
+  u64 _words[WORDS] = {};
+
+  auto maskLast() noexcept -> void {
+    this->_words[WORDS - 1] &= detail::bitSetLastMask(N);
+  }
+};
+
+/// A growable set of bits.
+///
+/// Bits past `len()` in the last word are always zero, so the words can be
+/// serialized and compared directly.
+struct DynamicBitSet {
+  explicit DynamicBitSet() noexcept                       = delete;
+  DynamicBitSet(DynamicBitSet&&) noexcept                 = default;
+  DynamicBitSet(const DynamicBitSet&) noexcept            = delete;
+  DynamicBitSet& operator=(DynamicBitSet&&) noexcept      = default;
+  DynamicBitSet& operator=(const DynamicBitSet&) noexcept = delete;
+  ~DynamicBitSet() noexcept                               = default;
+
+public:
+  /// Creates an empty set that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the set.
+  explicit DynamicBitSet(mem::Allocator& allocator) noexcept;
+
+  /// Creates a set of `len` unset bits.
+  static auto initEmpty(mem::Allocator& allocator,
+                        usize           len) noexcept -> DynamicBitSet;
+
+  /// Creates a set of `len` bits from `words`, taking ownership of them.
+  ///
+  /// # Safety
+  ///
+  /// * `words` must have been allocated with `allocator`.
+  /// * `words` must hold at least `len` bits.
+  static auto initFromOwnedWords(mem::Allocator& allocator, Slice<u64> words,
+                                 usize len) noexcept -> DynamicBitSet;
+
+  /// Frees all memory allocated by the set.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void;
+
+  /// Returns the number of bits in the set.
+  auto len() const noexcept -> usize { return this->_len; }
+
+  /// Changes the number of bits to `len`; new bits are unset.
+  auto resize(usize len) noexcept -> void;
+
+  /// Returns `true` if bit `idx` is set.
+  auto isSet(usize idx) const noexcept -> bool {
+    CBL_ASSERT(idx < this->_len, "The index is outside the set's bounds");
+    return ((this->_words.getUnchecked(idx / 64) >> (idx % 64)) & 1) != 0;
+  }
+
+  /// Sets bit `idx`.
+  auto set(usize idx) noexcept -> void {
+    CBL_ASSERT(idx < this->_len, "The index is outside the set's bounds");
+    this->_words.getUnchecked(idx / 64) |= u64(1) << (idx % 64);
+  }
+
+  /// Unsets bit `idx`.
+  auto unset(usize idx) noexcept -> void {
+    CBL_ASSERT(idx < this->_len, "The index is outside the set's bounds");
+    this->_words.getUnchecked(idx / 64) &= ~(u64(1) << (idx % 64));
+  }
+
+  /// Flips bit `idx`.
+  auto toggle(usize idx) noexcept -> void {
+    CBL_ASSERT(idx < this->_len, "The index is outside the set's bounds");
+    this->_words.getUnchecked(idx / 64) ^= u64(1) << (idx % 64);
+  }
+
+  /// Sets every bit.
+  auto setAll() noexcept -> void;
+
+  /// Unsets every bit.
+  auto unsetAll() noexcept -> void;
+
+  /// Flips every bit.
+  auto toggleAll() noexcept -> void;
+
+  /// Sets the bits that are set in `other` (`this | other`).
+  ///
+  /// # Note
+  ///
+  /// Both sets must have the same length; this also applies to the other set
+  /// operations.
+  auto setUnion(const DynamicBitSet& other) noexcept -> void;
+
+  /// Unsets the bits that are unset in `other` (`this & other`).
+  auto setIntersection(const DynamicBitSet& other) noexcept -> void;
+
+  /// Unsets the bits that are set in `other` (`this & ~other`).
+  auto setDifference(const DynamicBitSet& other) noexcept -> void;
+
+  /// Flips the bits that are set in `other` (`this ^ other`).
+  auto toggleSet(const DynamicBitSet& other) noexcept -> void;
+
+  /// Returns the number of set bits.
+  auto count() const noexcept -> usize;
+
+  /// Returns `true` if both sets have the same length and bits set.
+  auto eql(const DynamicBitSet& other) const noexcept -> bool;
+
+  /// Returns an iterator over the indices of the set bits.
+  auto iterator() const noexcept -> SetBitIterator;
+
+  /// Returns the underlying words, with bit `i` stored in bit `i % 64` of
+  /// word `i / 64`.
+  ///
+  /// # Safety
+  ///
+  /// * Bits past `len()` in the last word must be left unset.
+  /// * The returned slice will be invalid after the set is resized.
+  auto words() const noexcept -> Slice<u64> { return this->_words; }
+
+private:
+  mem::Allocator* _allocator;
+  Slice<u64>      _words;
+  usize           _len = 0;
+
+  auto maskLast() noexcept -> void;
+};
+
+/// An index over a bit sequence that answers rank and select queries.
+///
+/// The index stores the number of set bits before every 512-bit block,
+/// which costs 12.5% of the size of the bits.
+///
+/// # Note
+///
+/// The bits are not copied, so the index can be built over a slice decoded
+/// in place by `io::BinaryReader`. They must outlive the index and must not
+/// change while it is in use.
+struct RankSelect {
+  explicit RankSelect() noexcept                    = delete;
+  RankSelect(RankSelect&&) noexcept                 = default;
+  RankSelect(const RankSelect&) noexcept            = delete;
+  RankSelect& operator=(RankSelect&&) noexcept      = default;
+  RankSelect& operator=(const RankSelect&) noexcept = delete;
+  ~RankSelect() noexcept                            = default;
+
+public:
+  /// Builds an index over the first `len` bits of `words`.
+  ///
+  /// # Note
+  ///
+  /// Bits past `len` in the last word must be unset.
+  explicit RankSelect(mem::Allocator& allocator, Slice<const u64> words,
+                      usize len) noexcept;
+
+  /// Frees all memory allocated by the index.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void;
+
+  /// Returns `true` if bit `idx` is set.
+  auto isSet(usize idx) const noexcept -> bool;
+
+  /// Returns the number of set bits before bit `idx`.
+  ///
+  /// # Note
+  ///
+  /// `idx` may equal the number of bits, which returns `count()`.
+  auto rank(usize idx) const noexcept -> usize;
+
+  /// Returns the index of the set bit with rank `k` (i.e. the `k + 1`th set
+  /// bit).
+  ///
+  /// # Note
+  ///
+  /// `k` must be less than `count()`.
+  auto select(usize k) const noexcept -> usize;
+
+  /// Returns the number of set bits.
+  auto count() const noexcept -> usize;
+
+private:
+  static constexpr usize BLOCK_WORDS = 8;
+
+  mem::Allocator*        _allocator;
+  Slice<const u64>       _words;
+  usize                  _len;
+
+  /// The number of set bits before each block, plus the total.
+  Slice<u64>             _ranks;
+};
+
+} // namespace cbl
+
+#endif // !CBL_BIT_SET_H
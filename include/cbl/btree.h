@@ -0,0 +1,608 @@
+#ifndef CBL_BTREE_H
+#define CBL_BTREE_H
+
+#include "cbl/assert.h"        // CBL_ASSERT, CBL_VERIFY
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/mem/layout.h"    // Layout
+#include "cbl/mem/pool.h"      // PoolAllocator
+#include "cbl/primitives.h"    // u8, u32, usize
+#include "cbl/slice.h"         // Slice
+#include "cbl/slice_ops.h"     // countLess, move, copy
+#include <functional>          // less
+#include <type_traits>         // is_same_v, is_trivially_copyable_v
+
+namespace cbl {
+
+namespace detail {
+
+/// The target size of B+-tree nodes: 8 cache lines, so a node search touches
+/// few lines and adjacent lines are brought in by the hardware prefetcher.
+inline constexpr usize BTREE_NODE_SIZE  = 512;
+
+/// The size of the fields shared by every node, plus the extra child pointer
+/// of inner nodes.
+inline constexpr usize BTREE_NODE_EXTRA = 16;
+
+constexpr auto btreeCapacity(usize entry_size) noexcept -> usize {
+  const usize cap = (BTREE_NODE_SIZE - BTREE_NODE_EXTRA) / entry_size;
+  return (cap < 4) ? 4 : cap;
+}
+
+struct BTreeNode {
+  u32  len;
+  bool is_leaf;
+};
+
+template <class K, class V, usize CAP>
+struct alignas(64) BTreeLeaf : public BTreeNode {
+  K          keys[CAP];
+  V          values[CAP];
+  BTreeLeaf* next;
+};
+
+template <class K, usize CAP> struct alignas(64) BTreeInner : public BTreeNode {
+  K          keys[CAP];
+  BTreeNode* children[CAP + 1];
+};
+
+/// Inserts `value` at `idx` in an array of `len` elements with room for one
+/// more.
+template <class T>
+auto btreeInsertAt(T* arr, usize len, usize idx, const T& value) noexcept
+    -> void {
+  slice::move(Slice<T>{arr + idx + 1, len - idx},
+              Slice<const T>{arr + idx, len - idx});
+  arr[idx] = value;
+}
+
+/// Removes the element at `idx` from an array of `len` elements.
+template <class T>
+auto btreeRemoveAt(T* arr, usize len, usize idx) noexcept -> void {
+  slice::move(Slice<T>{arr + idx, len - idx - 1},
+              Slice<const T>{arr + idx + 1, len - idx - 1});
+}
+
+} // namespace detail
+
+/// An ordered map implemented as a B+-tree.
+///
+/// Entries are stored in leaves of about 512 bytes that are linked together,
+/// so lookups touch a few nodes per level and range scans read memory
+/// sequentially. Keys and values are stored in separate arrays; when `K` is a
+/// primitive number ordered by `std::less`, nodes are searched with SIMD
+/// comparisons (see `slice::countLess`), otherwise with a binary search.
+///
+/// Nodes are allocated from pools backed by the map's allocator.
+///
+/// # Note
+///
+/// * `K` and `V` must be trivially copyable, since entries are moved between
+///   nodes with `memmove`.
+/// * Pointers to values are invalidated by inserting or removing entries.
+template <class K, class V, class Less = std::less<K>>
+  requires(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>)
+struct BTreeMap {
+  explicit BTreeMap() noexcept                  = delete;
+  BTreeMap(BTreeMap&&) noexcept                 = default;
+  BTreeMap(const BTreeMap&) noexcept            = delete;
+  BTreeMap& operator=(BTreeMap&&) noexcept      = default;
+  BTreeMap& operator=(const BTreeMap&) noexcept = delete;
+  ~BTreeMap() noexcept                          = default;
+
+private:
+  static constexpr usize LEAF_CAP =
+      detail::btreeCapacity(sizeof(K) + sizeof(V));
+  static constexpr usize INNER_CAP =
+      detail::btreeCapacity(sizeof(K) + sizeof(detail::BTreeNode*));
+
+  // Every node except the root holds at least this many keys
+  static constexpr usize LEAF_MIN  = LEAF_CAP / 2;
+  static constexpr usize INNER_MIN = (INNER_CAP - 1) / 2;
+
+  using Node                       = detail::BTreeNode;
+  using Leaf                       = detail::BTreeLeaf<K, V, LEAF_CAP>;
+  using Inner                      = detail::BTreeInner<K, INNER_CAP>;
+
+  static constexpr bool SIMD_SEARCH =
+      (slice::detail::IntElement<K> || slice::detail::FloatElement<K>) &&
+      (std::is_same_v<Less, std::less<K>> || std::is_same_v<Less, std::less<>>);
+
+public:
+  /// A key and a pointer to its value, yielded by `Range`.
+  struct Entry {
+    const K* key;
+    V*       value;
+  };
+
+  /// Iterates over entries in ascending key order; see `BTreeMap::range`.
+  struct Range {
+    explicit Range() noexcept               = delete;
+    Range(Range&&) noexcept                 = default;
+    Range(const Range&) noexcept            = default;
+    Range& operator=(Range&&) noexcept      = default;
+    Range& operator=(const Range&) noexcept = default;
+    ~Range() noexcept                       = default;
+
+  public:
+    explicit Range(Leaf* leaf, usize idx, const K& end, bool bounded,
+                   Less less) noexcept
+        : _leaf{leaf}, _idx{idx}, _end{end}, _bounded{bounded}, _less{less} {}
+
+    /// Stores the next entry in `out`, returning `false` if there are no
+    /// entries left.
+    auto next(Entry* out) noexcept -> bool {
+      while ((this->_leaf != nullptr) && (this->_idx >= this->_leaf->len)) {
+        this->_leaf = this->_leaf->next;
+        this->_idx  = 0;
+      }
+      if (this->_leaf == nullptr) {
+        return false;
+      }
+
+      const K& key = this->_leaf->keys[this->_idx];
+      if (this->_bounded && !this->_less(key, this->_end)) {
+        this->_leaf = nullptr;
+        return false;
+      }
+      *out        = Entry{&key, &this->_leaf->values[this->_idx]};
+      this->_idx += 1;
+      return true;
+    }
+
+  private:
+    Leaf* _leaf;
+    usize _idx;
+    K     _end;
+    bool  _bounded;
+    Less  _less;
+  };
+
+  /// Creates an empty map that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the map.
+  explicit BTreeMap(mem::Allocator& allocator, Less less = Less{}) noexcept
+      : _leaves{allocator, mem::Layout::init<Leaf>()},
+        _inners{allocator, mem::Layout::init<Inner>()}, _less{less} {}
+
+  /// Creates a map from `keys` and their corresponding `values`.
+  ///
+  /// This is much faster than inserting the entries one by one: leaves are
+  /// filled completely and each level is built in a single pass.
+  ///
+  /// # Note
+  ///
+  /// * `keys` must be sorted and must not contain duplicates.
+  /// * `keys` and `values` must have the same length.
+  static auto initFromSorted(mem::Allocator& allocator, Slice<const K> keys,
+                             Slice<const V> values,
+                             Less less = Less{}) noexcept -> BTreeMap {
+    CBL_ASSERT(keys.len() == values.len(),
+               "There must be a value for every key");
+    BTreeMap self{allocator, less};
+    if (keys.len() == 0) {
+      return self;
+    }
+    for (usize i = 1; i < keys.len(); i++) {
+      CBL_ASSERT(less(keys.getUnchecked(i - 1), keys.getUnchecked(i)),
+                 "The keys must be sorted and unique");
+    }
+
+    // Each level is built from the nodes of the level below and their
+    // largest keys, overwriting them in place
+    const usize num_leaves = (keys.len() + LEAF_CAP - 1) / LEAF_CAP;
+
+    // The nodes and their largest keys share a single allocation
+    const mem::Layout::Extended scratch =
+        mem::Layout::array<Node*>(num_leaves).extend(
+            mem::Layout::array<K>(num_leaves));
+    Slice<u8>                   block   = allocator.allocate(scratch.layout);
+    CBL_VERIFY(!block.isEmpty(), "Allocation failed");
+    Slice<Node*> nodes{block.as<Node*>(), num_leaves};
+    Slice<K>     maxes{reinterpret_cast<K*>(block.ptr() + scratch.offset),
+                   num_leaves};
+
+    Leaf* prev  = nullptr;
+    usize start = 0;
+    for (usize i = 0; i < num_leaves; i++) {
+      // Spread the entries evenly so every leaf is at least half full
+      const usize end  = keys.len() * (i + 1) / num_leaves;
+      Leaf*       leaf = self.newLeaf();
+      leaf->len        = static_cast<u32>(end - start);
+      slice::copy(Slice<K>{leaf->keys, LEAF_CAP}, keys.subslice(start, end));
+      slice::copy(Slice<V>{leaf->values, LEAF_CAP},
+                  values.subslice(start, end));
+      if (prev != nullptr) {
+        prev->next = leaf;
+      }
+      nodes.getUnchecked(i) = leaf;
+      maxes.getUnchecked(i) = keys.getUnchecked(end - 1);
+      prev                  = leaf;
+      start                 = end;
+    }
+
+    usize level_len = num_leaves;
+    while (level_len > 1) {
+      const usize num_inners = (level_len + INNER_CAP) / (INNER_CAP + 1);
+      usize       first      = 0;
+      for (usize i = 0; i < num_inners; i++) {
+        const usize last  = level_len * (i + 1) / num_inners;
+        Inner*      inner = self.newInner();
+        inner->len        = static_cast<u32>(last - first - 1);
+        for (usize c = first; c < last; c++) {
+          inner->children[c - first] = nodes.getUnchecked(c);
+          if (c + 1 < last) {
+            inner->keys[c - first] = maxes.getUnchecked(c);
+          }
+        }
+        nodes.getUnchecked(i) = inner;
+        maxes.getUnchecked(i) = maxes.getUnchecked(last - 1);
+        first                 = last;
+      }
+      level_len = num_inners;
+    }
+
+    self._root = nodes.getUnchecked(0);
+    self._len  = keys.len();
+    allocator.deallocate(block.ptr(), scratch.layout);
+    return self;
+  }
+
+  /// Frees all memory allocated by the map.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void {
+    this->_leaves.deinit();
+    this->_inners.deinit();
+    this->_root = nullptr;
+    this->_len  = 0;
+  }
+
+  /// Returns the number of entries in the map.
+  auto len() const noexcept -> usize { return this->_len; }
+
+  /// Returns `true` if the map has no entries.
+  auto isEmpty() const noexcept -> bool { return this->_len == 0; }
+
+  /// Returns a pointer to the value of `key`, or `nullptr` if the map does not
+  /// contain `key`.
+  auto getPtr(const K& key) const noexcept -> V* {
+    if (this->_root == nullptr) {
+      return nullptr;
+    }
+    Node* node = this->_root;
+    while (!node->is_leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      node = inner->children[this->lowerBound(inner->keys, inner->len, key)];
+    }
+    Leaf*       leaf = static_cast<Leaf*>(node);
+    const usize pos  = this->lowerBound(leaf->keys, leaf->len, key);
+    if ((pos < leaf->len) && !this->_less(key, leaf->keys[pos])) {
+      return &leaf->values[pos];
+    }
+    return nullptr;
+  }
+
+  /// Returns `true` if the map contains `key`.
+  auto contains(const K& key) const noexcept -> bool {
+    return this->getPtr(key) != nullptr;
+  }
+
+  /// Sets the value of `key`, returning `true` if the key was not in the map
+  /// before.
+  auto insert(const K& key, const V& value) noexcept -> bool {
+    if (this->_root == nullptr) {
+      this->_root = this->newLeaf();
+    }
+
+    // Full nodes are split on the way down, so there is always room to
+    // insert into the leaf or to add a split child to its parent
+    if (this->isFull(this->_root)) {
+      Inner* root       = this->newInner();
+      root->len         = 0;
+      root->children[0] = this->_root;
+      this->splitChild(root, 0);
+      this->_root = root;
+    }
+
+    Node* node = this->_root;
+    while (!node->is_leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      usize  i     = this->lowerBound(inner->keys, inner->len, key);
+      if (this->isFull(inner->children[i])) {
+        this->splitChild(inner, i);
+        if (this->_less(inner->keys[i], key)) {
+          i += 1;
+        }
+      }
+      node = inner->children[i];
+    }
+
+    Leaf*       leaf = static_cast<Leaf*>(node);
+    const usize pos  = this->lowerBound(leaf->keys, leaf->len, key);
+    if ((pos < leaf->len) && !this->_less(key, leaf->keys[pos])) {
+      leaf->values[pos] = value;
+      return false;
+    }
+    detail::btreeInsertAt(leaf->keys, leaf->len, pos, key);
+    detail::btreeInsertAt(leaf->values, leaf->len, pos, value);
+    leaf->len  += 1;
+    this->_len += 1;
+    return true;
+  }
+
+  /// Removes `key` from the map, returning `true` if it was in the map.
+  auto remove(const K& key) noexcept -> bool {
+    if (this->_root == nullptr) {
+      return false;
+    }
+
+    // Nodes at their minimum size are refilled on the way down, so removing
+    // from a child never leaves its parent below the minimum
+    Node* node = this->_root;
+    while (!node->is_leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      usize  i     = this->lowerBound(inner->keys, inner->len, key);
+      if (this->isMinimal(inner->children[i])) {
+        i = this->refillChild(inner, i);
+      }
+      node = inner->children[i];
+    }
+
+    Leaf*       leaf  = static_cast<Leaf*>(node);
+    const usize pos   = this->lowerBound(leaf->keys, leaf->len, key);
+    const bool  found = (pos < leaf->len) && !this->_less(key, leaf->keys[pos]);
+    if (found) {
+      detail::btreeRemoveAt(leaf->keys, leaf->len, pos);
+      detail::btreeRemoveAt(leaf->values, leaf->len, pos);
+      leaf->len  -= 1;
+      this->_len -= 1;
+    }
+
+    // Merging the root's only two children leaves it with a single child
+    if (!this->_root->is_leaf && (this->_root->len == 0)) {
+      Inner* root = static_cast<Inner*>(this->_root);
+      this->_root = root->children[0];
+      this->freeInner(root);
+    } else if (this->_root->is_leaf && (this->_root->len == 0)) {
+      this->freeLeaf(static_cast<Leaf*>(this->_root));
+      this->_root = nullptr;
+    }
+    return found;
+  }
+
+  /// Returns an iterator over every entry in ascending key order.
+  auto iterator() const noexcept -> Range {
+    Node* node = this->_root;
+    while ((node != nullptr) && !node->is_leaf) {
+      node = static_cast<Inner*>(node)->children[0];
+    }
+    return Range{static_cast<Leaf*>(node), 0, K{}, false, this->_less};
+  }
+
+  /// Returns an iterator over the entries with keys in `[start, end)`, in
+  /// ascending key order.
+  auto range(const K& start, const K& end) const noexcept -> Range {
+    if (this->_root == nullptr) {
+      return Range{nullptr, 0, end, true, this->_less};
+    }
+    Node* node = this->_root;
+    while (!node->is_leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      node = inner->children[this->lowerBound(inner->keys, inner->len, start)];
+    }
+    Leaf* leaf = static_cast<Leaf*>(node);
+    return Range{leaf, this->lowerBound(leaf->keys, leaf->len, start), end,
+                 true, this->_less};
+  }
+
+private:
+  mem::PoolAllocator _leaves;
+  mem::PoolAllocator _inners;
+  Less               _less;
+  Node*              _root = nullptr;
+  usize              _len  = 0;
+
+  /// Returns the index of the first key that is not less than `key`.
+  ///
+  /// Inner nodes store the largest key of each child but the last, so this
+  /// is also the index of the child that may contain `key`.
+  auto lowerBound(const K* keys, usize len, const K& key) const noexcept
+      -> usize {
+    if constexpr (SIMD_SEARCH) {
+      return slice::countLess(Slice<const K>{keys, len}, key);
+    } else {
+      usize lo = 0;
+      while (len > 0) {
+        const usize half = len / 2;
+        if (this->_less(keys[lo + half], key)) {
+          lo  += half + 1;
+          len -= half + 1;
+        } else {
+          len = half;
+        }
+      }
+      return lo;
+    }
+  }
+
+  auto newLeaf() noexcept -> Leaf* {
+    Slice<u8> block = this->_leaves.allocate(mem::Layout::init<Leaf>());
+    Leaf*     leaf  = block.as<Leaf>();
+    CBL_VERIFY(leaf != nullptr, "Allocation failed");
+    leaf->len     = 0;
+    leaf->is_leaf = true;
+    leaf->next    = nullptr;
+    return leaf;
+  }
+
+  auto newInner() noexcept -> Inner* {
+    Slice<u8> block = this->_inners.allocate(mem::Layout::init<Inner>());
+    Inner*    inner = block.as<Inner>();
+    CBL_VERIFY(inner != nullptr, "Allocation failed");
+    inner->len     = 0;
+    inner->is_leaf = false;
+    return inner;
+  }
+
+  auto freeLeaf(Leaf* leaf) noexcept -> void {
+    this->_leaves.deallocate(reinterpret_cast<u8*>(leaf),
+                             mem::Layout::init<Leaf>());
+  }
+
+  auto freeInner(Inner* inner) noexcept -> void {
+    this->_inners.deallocate(reinterpret_cast<u8*>(inner),
+                             mem::Layout::init<Inner>());
+  }
+
+  static auto isFull(const Node* node) noexcept -> bool {
+    return node->len == (node->is_leaf ? LEAF_CAP : INNER_CAP);
+  }
+
+  static auto isMinimal(const Node* node) noexcept -> bool {
+    return node->len <= (node->is_leaf ? LEAF_MIN : INNER_MIN);
+  }
+
+  /// Splits the full child `i` of `parent` in two.
+  auto splitChild(Inner* parent, usize i) noexcept -> void {
+    Node* child = parent->children[i];
+    Node* right;
+    K     separator;
+    if (child->is_leaf) {
+      Leaf*       left   = static_cast<Leaf*>(child);
+      Leaf*       r      = this->newLeaf();
+      const usize keep   = LEAF_CAP / 2;
+      r->len             = static_cast<u32>(LEAF_CAP - keep);
+      slice::copy(Slice<K>{r->keys, LEAF_CAP},
+                  Slice<const K>{left->keys + keep, r->len});
+      slice::copy(Slice<V>{r->values, LEAF_CAP},
+                  Slice<const V>{left->values + keep, r->len});
+      left->len          = static_cast<u32>(keep);
+      r->next            = left->next;
+      left->next         = r;
+      separator          = left->keys[keep - 1];
+      right              = r;
+    } else {
+      // The middle key moves up to the parent
+      Inner*      left   = static_cast<Inner*>(child);
+      Inner*      r      = this->newInner();
+      const usize keep   = INNER_CAP / 2;
+      r->len             = static_cast<u32>(INNER_CAP - keep - 1);
+      slice::copy(Slice<K>{r->keys, INNER_CAP},
+                  Slice<const K>{left->keys + keep + 1, r->len});
+      slice::copy(Slice<Node*>{r->children, INNER_CAP + 1},
+                  Slice<Node* const>{left->children + keep + 1, r->len + 1});
+      left->len          = static_cast<u32>(keep);
+      separator          = left->keys[keep];
+      right              = r;
+    }
+    detail::btreeInsertAt(parent->keys, parent->len, i, separator);
+    detail::btreeInsertAt(parent->children, parent->len + 1, i + 1, right);
+    parent->len += 1;
+  }
+
+  /// Gives the minimal child `i` of `parent` an extra key by borrowing from
+  /// or merging with a sibling, returning the child's new index.
+  auto refillChild(Inner* parent, usize i) noexcept -> usize {
+    if ((i > 0) && !isMinimal(parent->children[i - 1])) {
+      this->borrowFromLeft(parent, i);
+      return i;
+    }
+    if ((i < parent->len) && !isMinimal(parent->children[i + 1])) {
+      this->borrowFromRight(parent, i);
+      return i;
+    }
+    if (i < parent->len) {
+      this->mergeWithRight(parent, i);
+      return i;
+    }
+    this->mergeWithRight(parent, i - 1);
+    return i - 1;
+  }
+
+  auto borrowFromLeft(Inner* parent, usize i) noexcept -> void {
+    Node* child = parent->children[i];
+    if (child->is_leaf) {
+      Leaf*       c    = static_cast<Leaf*>(child);
+      Leaf*       l    = static_cast<Leaf*>(parent->children[i - 1]);
+      const usize last = l->len - 1;
+      detail::btreeInsertAt(c->keys, c->len, 0, l->keys[last]);
+      detail::btreeInsertAt(c->values, c->len, 0, l->values[last]);
+      l->len                -= 1;
+      c->len                += 1;
+      parent->keys[i - 1]    = l->keys[last - 1];
+    } else {
+      Inner*      c    = static_cast<Inner*>(child);
+      Inner*      l    = static_cast<Inner*>(parent->children[i - 1]);
+      const usize last = l->len - 1;
+      detail::btreeInsertAt(c->keys, c->len, 0, parent->keys[i - 1]);
+      detail::btreeInsertAt(c->children, c->len + 1, 0, l->children[l->len]);
+      parent->keys[i - 1]  = l->keys[last];
+      l->len              -= 1;
+      c->len              += 1;
+    }
+  }
+
+  auto borrowFromRight(Inner* parent, usize i) noexcept -> void {
+    Node* child = parent->children[i];
+    if (child->is_leaf) {
+      Leaf* c           = static_cast<Leaf*>(child);
+      Leaf* r           = static_cast<Leaf*>(parent->children[i + 1]);
+      c->keys[c->len]   = r->keys[0];
+      c->values[c->len] = r->values[0];
+      parent->keys[i]   = r->keys[0];
+      detail::btreeRemoveAt(r->keys, r->len, 0);
+      detail::btreeRemoveAt(r->values, r->len, 0);
+      r->len -= 1;
+      c->len += 1;
+    } else {
+      Inner* c                 = static_cast<Inner*>(child);
+      Inner* r                 = static_cast<Inner*>(parent->children[i + 1]);
+      c->keys[c->len]          = parent->keys[i];
+      c->children[c->len + 1]  = r->children[0];
+      parent->keys[i]          = r->keys[0];
+      detail::btreeRemoveAt(r->keys, r->len, 0);
+      detail::btreeRemoveAt(r->children, r->len + 1, 0);
+      r->len -= 1;
+      c->len += 1;
+    }
+  }
+
+  /// Moves child `i + 1` of `parent` into child `i` and frees it.
+  auto mergeWithRight(Inner* parent, usize i) noexcept -> void {
+    Node* child = parent->children[i];
+    if (child->is_leaf) {
+      Leaf* c = static_cast<Leaf*>(child);
+      Leaf* r = static_cast<Leaf*>(parent->children[i + 1]);
+      slice::copy(Slice<K>{c->keys + c->len, LEAF_CAP - c->len},
+                  Slice<const K>{r->keys, r->len});
+      slice::copy(Slice<V>{c->values + c->len, LEAF_CAP - c->len},
+                  Slice<const V>{r->values, r->len});
+      c->len  += r->len;
+      c->next  = r->next;
+      this->freeLeaf(r);
+    } else {
+      // The separator between the children moves down between their keys
+      Inner* c        = static_cast<Inner*>(child);
+      Inner* r        = static_cast<Inner*>(parent->children[i + 1]);
+      c->keys[c->len] = parent->keys[i];
+      slice::copy(Slice<K>{c->keys + c->len + 1, INNER_CAP - c->len - 1},
+                  Slice<const K>{r->keys, r->len});
+      slice::copy(Slice<Node*>{c->children + c->len + 1, INNER_CAP - c->len},
+                  Slice<Node* const>{r->children, r->len + 1});
+      c->len += r->len + 1;
+      this->freeInner(r);
+    }
+    detail::btreeRemoveAt(parent->keys, parent->len, i);
+    detail::btreeRemoveAt(parent->children, parent->len + 1, i + 1);
+    parent->len -= 1;
+  }
+};
+
+} // namespace cbl
+
+#endif // !CBL_BTREE_H
@@ -0,0 +1,574 @@
+#ifndef CBL_CACHE_H
+#define CBL_CACHE_H
+
+#include "cbl/assert.h"         // CBL_VERIFY
+#include "cbl/hash.h"           // Hasher, hashMix
+#include "cbl/intrusive_list.h" // DList, DListLink
+#include "cbl/mem/allocator.h"  // Allocator
+#include "cbl/mem/layout.h"     // Layout
+#include "cbl/mem/pool.h"       // PoolAllocator
+#include "cbl/primitives.h"     // u8, u64, usize
+#include "cbl/slice.h"          // Slice
+#include <bit>                  // bit_ceil, bit_floor
+#include <functional>           // equal_to
+#include <mutex>                // mutex, lock_guard
+#include <new>                  // operator new
+#include <thread>               // thread
+#include <type_traits>          // is_same_v, is_trivially_copyable_v
+
+namespace cbl {
+
+/// How a `Cache` picks the entry to evict.
+enum class CachePolicy {
+  /// Evicts the least recently used entry.
+  ///
+  /// Every hit moves the entry to the front of a list.
+  Lru,
+
+  /// Evicts an entry that has not been used since the clock hand last passed
+  /// over it.
+  ///
+  /// Hits only set a bit, so they are cheaper than with `Lru` at the cost of a
+  /// coarser notion of recency.
+  Clock,
+};
+
+/// Does nothing with evicted entries; the default for `Cache`.
+struct IgnoreEvict {
+  template <class K, class V>
+  auto operator()(const K&, const V&) const noexcept -> void {}
+};
+
+namespace detail {
+
+/// Hashes `key` with `hash`, mixing the result unless `Hash` already does,
+/// since caches index their tables with both the low and the high bits.
+template <class K, class Hash>
+auto cacheHash(const Hash& hash, const K& key) noexcept -> u64 {
+  if constexpr (std::is_same_v<Hash, Hasher<K>>) {
+    return hash(key);
+  } else {
+    return hashMix(static_cast<u64>(hash(key)));
+  }
+}
+
+} // namespace detail
+
+template <class K, class V, class Hash, class Eql, class OnEvict>
+struct ShardedCache;
+
+/// A cache that holds entries up to a budget of bytes.
+///
+/// Keys are found through an open-addressing hash table, and entries are
+/// ordered by recency in an intrusive list (see `CachePolicy`). Once the
+/// entries are charged more bytes than the budget, the least recently used
+/// ones are evicted and passed to `OnEvict`, which can release anything the
+/// values own.
+///
+/// Each entry is charged the size of its node, as given by `mem::Layout`, plus
+/// the extra bytes passed to `put`, such as the size of the memory that the
+/// value points to. The hash table is not charged.
+///
+/// Looking up, inserting and removing entries are O(1).
+///
+/// # Note
+///
+/// * Entries are allocated from a pool backed by the cache's allocator.
+/// * `K` and `V` must be trivially copyable.
+/// * The cache is not thread-safe; see `ShardedCache`.
+template <class K, class V, class Hash = Hasher<K>,
+          class Eql = std::equal_to<K>, class OnEvict = IgnoreEvict>
+  requires(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>)
+struct Cache {
+  explicit Cache() noexcept               = delete;
+  Cache(Cache&&) noexcept                 = default;
+  Cache(const Cache&) noexcept            = delete;
+  Cache& operator=(Cache&&) noexcept      = default;
+  Cache& operator=(const Cache&) noexcept = delete;
+  ~Cache() noexcept                       = default;
+
+private:
+  struct Entry {
+    DListLink link;
+    K         key;
+    V         value;
+    usize     charge;
+    u64       hash;
+    /// Set by hits and cleared by the clock hand (`CachePolicy::Clock`).
+    bool      referenced;
+  };
+
+public:
+  /// Creates an empty cache that allocates with `allocator` and holds entries
+  /// worth up to `budget` bytes.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the cache.
+  explicit Cache(mem::Allocator& allocator, usize budget,
+                 CachePolicy policy = CachePolicy::Lru,
+                 OnEvict     on_evict = OnEvict{}) noexcept
+      : _allocator{&allocator},
+        _entries{allocator, mem::Layout::init<Entry>()}, _budget{budget},
+        _policy{policy}, _on_evict{on_evict} {}
+
+  /// Returns the number of bytes an entry is charged when `extra` bytes are
+  /// passed to `put`.
+  static auto charge(usize extra) noexcept -> usize {
+    return mem::Layout::init<Entry>().size() + extra;
+  }
+
+  /// Evicts every entry and frees all memory allocated by the cache.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void {
+    this->clear();
+    this->_entries.deinit();
+    this->_allocator->destroyArray(this->_table);
+    this->_table = Slice<Entry*>{};
+  }
+
+  /// Returns the number of entries in the cache.
+  auto len() const noexcept -> usize { return this->_list.len(); }
+
+  /// Returns `true` if the cache has no entries.
+  auto isEmpty() const noexcept -> bool { return this->_list.isEmpty(); }
+
+  /// Returns the number of bytes charged for the entries in the cache.
+  auto bytes() const noexcept -> usize { return this->_bytes; }
+
+  /// Returns the most bytes the entries can be charged.
+  auto budget() const noexcept -> usize { return this->_budget; }
+
+  /// Returns a pointer to the value of `key` and marks it as used, or
+  /// `nullptr` if `key` is not cached.
+  ///
+  /// # Safety
+  ///
+  /// The returned pointer is invalidated by `put`, `remove` and `clear`, which
+  /// may evict the entry.
+  auto getPtr(const K& key) noexcept -> V* {
+    return this->getPtrHashed(key, this->hashOf(key));
+  }
+
+  /// Copies the value of `key` into `out` and marks it as used.
+  ///
+  /// Returns `false` if `key` is not cached.
+  auto get(const K& key, V* out) noexcept -> bool {
+    const V* value = this->getPtr(key);
+    if (value == nullptr) {
+      return false;
+    }
+    *out = *value;
+    return true;
+  }
+
+  /// Returns `true` if `key` is cached, without marking it as used.
+  auto contains(const K& key) const noexcept -> bool {
+    return this->find(key, this->hashOf(key)) != nullptr;
+  }
+
+  /// Caches `value` for `key`, charging `charge(extra)` bytes and evicting
+  /// entries until the cache fits its budget.
+  ///
+  /// A previous value of `key` is replaced and passed to `OnEvict`.
+  ///
+  /// Returns `false`, leaving the cache unchanged (including any previous
+  /// value of `key`), if the entry alone would be over the budget.
+  auto put(const K& key, const V& value, usize extra = 0) noexcept -> bool {
+    return this->putHashed(key, this->hashOf(key), value, extra);
+  }
+
+  /// Removes `key`, storing its value in `out` if it is not `nullptr`.
+  ///
+  /// Returns `false` if `key` is not cached. Removed values are not passed to
+  /// `OnEvict`.
+  auto remove(const K& key, V* out = nullptr) noexcept -> bool {
+    return this->removeHashed(key, this->hashOf(key), out);
+  }
+
+  /// Evicts every entry, keeping the hash table.
+  auto clear() noexcept -> void {
+    while (Entry* entry = this->_list.popFront()) {
+      this->_on_evict(entry->key, entry->value);
+      this->_entries.deallocate(reinterpret_cast<u8*>(entry),
+                                mem::Layout::init<Entry>());
+    }
+    for (Entry*& slot : this->_table) {
+      slot = nullptr;
+    }
+    this->_hand  = nullptr;
+    this->_bytes = 0;
+  }
+
+private:
+  template <class, class, class, class, class> friend struct ShardedCache;
+
+  /// The length of the hash table when the first entry is added.
+  static constexpr usize MIN_TABLE_LEN = 16;
+
+  mem::Allocator*            _allocator;
+  mem::PoolAllocator         _entries;
+  /// An open-addressing table with linear probing, at most half full.
+  Slice<Entry*>              _table;
+  /// Entries from the most recently used (`CachePolicy::Lru`), or in the
+  /// order the clock hand visits them (`CachePolicy::Clock`).
+  DList<Entry, &Entry::link> _list;
+  /// The next entry the clock hand visits, or `nullptr` for the first.
+  Entry*                     _hand  = nullptr;
+  usize                      _budget;
+  usize                      _bytes = 0;
+  CachePolicy                _policy;
+  Hash                       _hash;
+  Eql                        _eql;
+  OnEvict                    _on_evict;
+
+  auto hashOf(const K& key) const noexcept -> u64 {
+    return detail::cacheHash(this->_hash, key);
+  }
+
+  /// Returns the table slot that holds `key`, or the empty slot where it
+  /// would be inserted.
+  auto probe(const K& key, u64 hash) const noexcept -> usize {
+    Entry* const* table = this->_table.ptr();
+    const usize   mask  = this->_table.len() - 1;
+    usize         idx   = static_cast<usize>(hash) & mask;
+    while ((table[idx] != nullptr) &&
+           ((table[idx]->hash != hash) || !this->_eql(table[idx]->key, key))) {
+      idx = (idx + 1) & mask;
+    }
+    return idx;
+  }
+
+  auto find(const K& key, u64 hash) const noexcept -> Entry* {
+    if (this->_table.isEmpty()) {
+      return nullptr;
+    }
+    return this->_table.ptr()[this->probe(key, hash)];
+  }
+
+  auto getPtrHashed(const K& key, u64 hash) noexcept -> V* {
+    Entry* entry = this->find(key, hash);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    this->markUsed(entry);
+    return &entry->value;
+  }
+
+  auto markUsed(Entry* entry) noexcept -> void {
+    if (this->_policy == CachePolicy::Clock) {
+      entry->referenced = true;
+    } else if (this->_list.front() != entry) {
+      this->_list.remove(entry);
+      this->_list.pushFront(entry);
+    }
+  }
+
+  auto putHashed(const K& key, u64 hash, const V& value, usize extra) noexcept
+      -> bool {
+    const usize cost = charge(extra);
+    if (cost > this->_budget) {
+      return false;
+    }
+
+    Entry* old = this->find(key, hash);
+    if (old != nullptr) {
+      this->_on_evict(old->key, old->value);
+      this->release(old);
+    }
+    while (this->_bytes + cost > this->_budget) {
+      this->evictOne();
+    }
+    if ((this->len() + 1) * 2 > this->_table.len()) {
+      this->grow();
+    }
+
+    Slice<u8> block = this->_entries.allocate(mem::Layout::init<Entry>());
+    CBL_VERIFY(!block.isEmpty(), "Allocation failed");
+    Entry* entry = new (block.ptr()) Entry{DListLink{}, key, value, cost, hash,
+                                           false};
+    this->_table.ptr()[this->probe(key, hash)] = entry;
+    this->_bytes                              += cost;
+
+    // New entries are visited last by the clock hand
+    if (this->_policy == CachePolicy::Lru) {
+      this->_list.pushFront(entry);
+    } else if (this->_hand != nullptr) {
+      this->_list.insertBefore(this->_hand, entry);
+    } else {
+      this->_list.pushBack(entry);
+    }
+    return true;
+  }
+
+  auto removeHashed(const K& key, u64 hash, V* out) noexcept -> bool {
+    Entry* entry = this->find(key, hash);
+    if (entry == nullptr) {
+      return false;
+    }
+    if (out != nullptr) {
+      *out = entry->value;
+    }
+    this->release(entry);
+    return true;
+  }
+
+  /// Evicts the entry chosen by the policy.
+  auto evictOne() noexcept -> void {
+    Entry* victim = nullptr;
+    if (this->_policy == CachePolicy::Lru) {
+      victim = this->_list.back();
+    } else {
+      // Give every referenced entry a second chance
+      victim = (this->_hand != nullptr) ? this->_hand : this->_list.front();
+      while (victim->referenced) {
+        victim->referenced = false;
+        victim             = this->_list.next(victim);
+        if (victim == nullptr) {
+          victim = this->_list.front();
+        }
+      }
+
+      // The hand moves past the victim as it is released
+      this->_hand = victim;
+    }
+    this->_on_evict(victim->key, victim->value);
+    this->release(victim);
+  }
+
+  /// Unlinks `entry` from the table and the list and frees it.
+  auto release(Entry* entry) noexcept -> void {
+    if (this->_hand == entry) {
+      this->_hand = this->_list.next(entry);
+    }
+    this->_list.remove(entry);
+    this->_bytes -= entry->charge;
+
+    // Shift later entries of the probe sequence back, so lookups never need
+    // tombstones
+    Entry**     table = this->_table.ptr();
+    const usize mask  = this->_table.len() - 1;
+    usize       hole  = static_cast<usize>(entry->hash) & mask;
+    while (table[hole] != entry) {
+      hole = (hole + 1) & mask;
+    }
+    usize idx = hole;
+    while (true) {
+      idx = (idx + 1) & mask;
+      if (table[idx] == nullptr) {
+        break;
+      }
+      const usize home = static_cast<usize>(table[idx]->hash) & mask;
+      if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+        table[hole] = table[idx];
+        hole        = idx;
+      }
+    }
+    table[hole] = nullptr;
+
+    this->_entries.deallocate(reinterpret_cast<u8*>(entry),
+                              mem::Layout::init<Entry>());
+  }
+
+  /// Doubles the length of the table.
+  auto grow() noexcept -> void {
+    const usize   new_len = this->_table.isEmpty() ? MIN_TABLE_LEN
+                                                   : 2 * this->_table.len();
+    Slice<Entry*> table   =
+        this->_allocator->template createArray<Entry*>(new_len);
+    CBL_VERIFY(!table.isEmpty(), "Allocation failed");
+
+    const usize mask = new_len - 1;
+    for (Entry* entry : this->_table) {
+      if (entry == nullptr) {
+        continue;
+      }
+      usize idx = static_cast<usize>(entry->hash) & mask;
+      while (table.ptr()[idx] != nullptr) {
+        idx = (idx + 1) & mask;
+      }
+      table.ptr()[idx] = entry;
+    }
+
+    this->_allocator->destroyArray(this->_table);
+    this->_table = table;
+  }
+};
+
+/// A thread-safe cache made of independently locked `Cache` shards.
+///
+/// Keys are spread over the shards by hash, so threads working on different
+/// keys rarely wait on the same lock. Each shard holds an equal part of the
+/// budget and evicts on its own.
+///
+/// # Note
+///
+/// * Values are copied out, since a pointer into a shard could be evicted as
+///   soon as its lock is released.
+/// * `OnEvict` is called with the shard's lock held.
+template <class K, class V, class Hash = Hasher<K>,
+          class Eql = std::equal_to<K>, class OnEvict = IgnoreEvict>
+struct ShardedCache {
+  explicit ShardedCache() noexcept                      = delete;
+  ShardedCache(ShardedCache&&) noexcept                 = default;
+  ShardedCache(const ShardedCache&) noexcept            = delete;
+  ShardedCache& operator=(ShardedCache&&) noexcept      = default;
+  ShardedCache& operator=(const ShardedCache&) noexcept = delete;
+  ~ShardedCache() noexcept                              = default;
+
+private:
+  using Shard = Cache<K, V, Hash, Eql, OnEvict>;
+
+public:
+  /// The number of `Cache::charge(0)` entries that a shard's budget holds at
+  /// least when the number of shards is picked by the cache.
+  static constexpr usize MIN_SHARD_ENTRIES = 64;
+
+  /// Creates an empty cache that allocates with `allocator` and holds entries
+  /// worth up to `budget` bytes, split over `shards` shards.
+  ///
+  /// If `shards` is 0, there are four per hardware thread, but only as many
+  /// as leave each shard a budget worth `MIN_SHARD_ENTRIES` entries of
+  /// `Cache::charge(0)` bytes.
+  ///
+  /// # Note
+  ///
+  /// * `allocator` must be thread-safe and outlive the cache.
+  /// * The number of shards is rounded up to a power of 2.
+  /// * Each shard holds `budget / shards` bytes, so `put` fails for an entry
+  ///   whose `Cache::charge(extra)` is over that, even if it fits `budget`.
+  explicit ShardedCache(mem::Allocator& allocator, usize budget,
+                        usize       shards   = 0,
+                        CachePolicy policy   = CachePolicy::Lru,
+                        OnEvict     on_evict = OnEvict{}) noexcept
+      : _allocator{&allocator} {
+    if (shards == 0) {
+      const usize threads = std::thread::hardware_concurrency();
+      const usize wanted  = 4 * ((threads == 0) ? 1 : threads);
+      const usize most    = std::bit_floor(
+          budget / (MIN_SHARD_ENTRIES * Shard::charge(0)));
+      shards              = (most == 0) ? 1 : ((most < wanted) ? most : wanted);
+    }
+    shards = std::bit_ceil(shards);
+
+    this->_shards = allocator.createArray<Locked>(shards);
+    CBL_VERIFY(!this->_shards.isEmpty(), "Allocation failed");
+    for (Locked& locked : this->_shards) {
+      new (&locked) Locked{{}, Shard{allocator, budget / shards, policy,
+                                     on_evict}};
+    }
+  }
+
+  /// Evicts every entry and frees all memory allocated by the cache.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void {
+    for (Locked& locked : this->_shards) {
+      locked.cache.deinit();
+      locked.~Locked();
+    }
+    this->_allocator->destroyArray(this->_shards);
+    this->_shards = Slice<Locked>{};
+  }
+
+  /// Returns the number of entries in the cache.
+  auto len() const noexcept -> usize {
+    usize len = 0;
+    for (Locked& locked : this->_shards) {
+      std::lock_guard lock{locked.mutex};
+      len += locked.cache.len();
+    }
+    return len;
+  }
+
+  /// Returns the number of bytes charged for the entries in the cache.
+  auto bytes() const noexcept -> usize {
+    usize bytes = 0;
+    for (Locked& locked : this->_shards) {
+      std::lock_guard lock{locked.mutex};
+      bytes += locked.cache.bytes();
+    }
+    return bytes;
+  }
+
+  /// Copies the value of `key` into `out` and marks it as used.
+  ///
+  /// Returns `false` if `key` is not cached.
+  auto get(const K& key, V* out) noexcept -> bool {
+    const u64       hash   = this->hashOf(key);
+    Locked&         locked = this->shardOf(hash);
+    std::lock_guard lock{locked.mutex};
+    const V*        value  = locked.cache.getPtrHashed(key, hash);
+    if (value == nullptr) {
+      return false;
+    }
+    *out = *value;
+    return true;
+  }
+
+  /// Returns `true` if `key` is cached, without marking it as used.
+  auto contains(const K& key) const noexcept -> bool {
+    const u64       hash   = this->hashOf(key);
+    Locked&         locked = this->shardOf(hash);
+    std::lock_guard lock{locked.mutex};
+    return locked.cache.find(key, hash) != nullptr;
+  }
+
+  /// Caches `value` for `key`; see `Cache::put`.
+  auto put(const K& key, const V& value, usize extra = 0) noexcept -> bool {
+    const u64       hash   = this->hashOf(key);
+    Locked&         locked = this->shardOf(hash);
+    std::lock_guard lock{locked.mutex};
+    return locked.cache.putHashed(key, hash, value, extra);
+  }
+
+  /// Removes `key`; see `Cache::remove`.
+  auto remove(const K& key, V* out = nullptr) noexcept -> bool {
+    const u64       hash   = this->hashOf(key);
+    Locked&         locked = this->shardOf(hash);
+    std::lock_guard lock{locked.mutex};
+    return locked.cache.removeHashed(key, hash, out);
+  }
+
+  /// Evicts every entry.
+  auto clear() noexcept -> void {
+    for (Locked& locked : this->_shards) {
+      std::lock_guard lock{locked.mutex};
+      locked.cache.clear();
+    }
+  }
+
+private:
+  /// Shards are on separate cache lines, so locking one does not slow down
+  /// threads using its neighbours.
+  struct alignas(64) Locked {
+    std::mutex mutex;
+    Shard      cache;
+  };
+
+  mem::Allocator* _allocator;
+  Slice<Locked>   _shards;
+  Hash            _hash;
+
+  auto hashOf(const K& key) const noexcept -> u64 {
+    return detail::cacheHash(this->_hash, key);
+  }
+
+  /// Picks a shard with the high bits of `hash`, since shards index their
+  /// tables with the low bits.
+  auto shardOf(u64 hash) const noexcept -> Locked& {
+    const usize mask = this->_shards.len() - 1;
+    return this->_shards.getUnchecked(static_cast<usize>(hash >> 32) & mask);
+  }
+};
+
+} // namespace cbl
+
+#endif // !CBL_CACHE_H
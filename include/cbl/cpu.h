@@ -0,0 +1,26 @@
+#ifndef CBL_CPU_H
+#define CBL_CPU_H
+
+namespace cbl::cpu {
+
+/// Instruction set extensions that are usable on the running CPU.
+///
+/// Features that need OS support for their registers (AVX, AVX-512) are only
+/// reported if the OS saves that state.
+struct Features {
+  bool sse42    = false;
+  bool popcnt   = false;
+  bool avx2     = false;
+  bool bmi2     = false;
+  bool avx512f  = false;
+  bool avx512bw = false;
+};
+
+/// Returns the features of the running CPU.
+///
+/// The CPU is only queried on the first call.
+auto features() noexcept -> const Features&;
+
+} // namespace cbl::cpu
+
+#endif // !CBL_CPU_H
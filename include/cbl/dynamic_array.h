@@ -2,13 +2,19 @@
 #define CBL_DYNAMIC_ARRAY_H
 
 #include "cbl/assert.h"
-#include "cbl/mem/allocator.h"
+#include "cbl/mem/allocator.h" // AllocatorLike, allocateArray
 #include "cbl/primitives.h" // usize
 #include "cbl/slice.h"
-#include <cstring>
+#include "cbl/slice_ops.h" // copy, move
 
 namespace cbl {
 
+/// A growable array that is passed its allocator by every call that may
+/// allocate or free memory.
+///
+/// Those calls are templated on `mem::AllocatorLike`: passing a concrete
+/// allocator such as `mem::FixedBufferAllocator` lets its allocations inline,
+/// while passing a `mem::Allocator&` dispatches them virtually.
 template <class T> struct UnmanagedDynamicArray {
   /// Creates an empty array.
   explicit UnmanagedDynamicArray() noexcept                          = default;
@@ -21,14 +27,14 @@ template <class T> struct UnmanagedDynamicArray {
 
 public:
   /// Creates an array with memory reserved for `capacity` elements.
-  static auto
-  initWithCapacity(mem::Allocator& allocator,
-                   usize           capacity) noexcept -> UnmanagedDynamicArray {
-    T* elems = allocator.createArray<T>(capacity);
-    CBL_ASSERT(elems != nullptr, "Allocation failed");
+  template <mem::AllocatorLike A>
+  static auto initWithCapacity(A& allocator, usize capacity) noexcept
+      -> UnmanagedDynamicArray {
+    Slice<T> elems = mem::allocateArray<T>(allocator, capacity);
+    CBL_VERIFY((capacity == 0) || !elems.isEmpty(), "Allocation failed");
 
     UnmanagedDynamicArray self;
-    self._elems = elems;
+    self._elems = elems.ptr();
     self._len   = 0;
     self._cap   = capacity;
 
@@ -58,8 +64,8 @@ public:
   ///
   /// Calling just the destructor will result in a memory leak; `deinit` must be
   /// called to free allocated memory.
-  auto deinit(mem::Allocator& allocator) noexcept -> void {
-    allocator.deallocate(this->_elems);
+  template <mem::AllocatorLike A> auto deinit(A& allocator) noexcept -> void {
+    mem::deallocateArray(allocator, Slice<T>{this->_elems, this->_cap});
     this->_elems = nullptr;
     this->_len   = 0;
     this->_cap   = 0;
@@ -70,15 +76,14 @@ public:
   /// # Note
   ///
   /// This will empty the array and clear its capacity.
-  auto toOwnedSlice(mem::Allocator& allocator) noexcept -> Slice<T> {
-    const usize len     = this->len;
-    T*          new_mem = allocator.createArray<T>(len);
-    void*       copied =
-        std::memcpy(new_mem, this->_elems,
-                    sizeof(T) * len); // TODO: Replace with loop instead?
-    CBL_ASSERT(copied != nullptr, "`memcpy` failed");
+  template <mem::AllocatorLike A>
+  auto toOwnedSlice(A& allocator) noexcept -> Slice<T> {
+    const usize len     = this->_len;
+    Slice<T>    new_mem = mem::allocateArray<T>(allocator, len);
+    CBL_VERIFY((len == 0) || !new_mem.isEmpty(), "Allocation failed");
+    slice::copy(new_mem, Slice<T>{this->_elems, len});
     this->deinit(allocator);
-    return Slice<T>{new_mem, len};
+    return new_mem;
   }
 
   /// Returns the array's elements.
@@ -102,8 +107,8 @@ public:
   auto cap() const noexcept -> usize { return this->_cap; }
 
   /// Creates a copy of the array.
-  auto
-  clone(mem::Allocator& allocator) const noexcept -> UnmanagedDynamicArray {
+  template <mem::AllocatorLike A>
+  auto clone(A& allocator) const noexcept -> UnmanagedDynamicArray {
     UnmanagedDynamicArray cloned =
         UnmanagedDynamicArray::initWithCapacity(allocator, this->_cap);
     cloned.appendSlice(allocator, this->elems());
@@ -122,7 +127,8 @@ public:
   /// # Safety
   ///
   /// Invalidates element pointers if additional memory is needed.
-  auto insert(mem::Allocator& allocator, T value, usize idx) noexcept -> void {
+  template <mem::AllocatorLike A>
+  auto insert(A& allocator, T value, usize idx) noexcept -> void {
     if (idx == this->_len) {
       this->append(allocator, value);
       return;
@@ -134,9 +140,8 @@ public:
     }
 
     // Shift all elements from the idx to the right
-    for (usize i = this->_len; i > idx; i--) {
-      this->_elems[i] = this->_elems[i - 1];
-    }
+    slice::move(Slice<T>{this->_elems + idx + 1, this->_len - idx},
+                Slice<T>{this->_elems + idx, this->_len - idx});
 
     // Insert value at `idx`
     this->_elems[idx]  = value;
@@ -157,8 +162,8 @@ public:
   /// * Invalidates pre-existing pointers to elements at and after `index`.
   /// * Invalidates all pre-existing element pointers if capacity must be
   ///   increased to accommodate the new elements.
-  auto insertSlice(mem::Allocator& allocator, Slice<T> slice,
-                   usize idx) noexcept -> void {
+  template <mem::AllocatorLike A>
+  auto insertSlice(A& allocator, Slice<T> slice, usize idx) noexcept -> void {
     if (idx == this->_len) {
       this->appendSlice(allocator, slice);
       return;
@@ -171,14 +176,11 @@ public:
 
     // Shift all elements from the idx to the right, leaving enough space for
     // the slice elements
-    for (usize i = this->_len + slice.len() - 1; i > idx; i--) {
-      this->_elems[i] = this->_elems[i - slice.len()];
-    }
+    slice::move(Slice<T>{this->_elems + idx + slice.len(), this->_len - idx},
+                Slice<T>{this->_elems + idx, this->_len - idx});
 
     // Insert slice at `idx`
-    for (usize i = idx; i < slice.len(); i++) {
-      this->_elems[i] = slice[i - idx];
-    }
+    slice::copy(Slice<T>{this->_elems + idx, slice.len()}, slice);
     this->_len += slice.len();
   }
 
@@ -189,7 +191,8 @@ public:
   /// # Safety
   ///
   /// Invalidates element pointers if additional memory is needed.
-  auto append(mem::Allocator& allocator, T value) noexcept -> void {
+  template <mem::AllocatorLike A>
+  auto append(A& allocator, T value) noexcept -> void {
     // Resize original buffer if necessary
     if (this->_len + 1 > this->_cap) {
       resize(allocator);
@@ -206,18 +209,20 @@ public:
   /// # Safety
   ///
   /// Invalidates element pointers if additional memory is needed.
-  auto appendSlice(mem::Allocator& allocator, Slice<T> slice) noexcept -> void {
+  template <mem::AllocatorLike A>
+  auto appendSlice(A& allocator, Slice<T> slice) noexcept -> void {
     // Resize original buffer if necessary
     while (this->_len + slice.len() > this->_cap) {
       resize(allocator);
     }
 
-    for (usize i = 0; i < slice.len(); i++) {
-      this->_elems[this->_len + i] = slice[i];
-    }
+    slice::copy(Slice<T>{this->_elems + this->_len, slice.len()}, slice);
     this->_len += slice.len();
   }
 
+  /// Removes all elements, keeping the reserved memory.
+  auto clear() noexcept -> void { this->_len = 0; }
+
   /// Removes and returns the element at `idx`.
   ///
   /// Shifts all elements from `idx` to the left.
@@ -231,7 +236,16 @@ public:
   /// # Safety
   ///
   /// Invalidates pointers to the last element.
-  auto remove(usize idx) -> T;
+  auto remove(usize idx) noexcept -> T {
+    CBL_ASSERT(idx < this->_len, "The index is outside the array's bounds");
+    T removed = this->_elems[idx];
+
+    // Shift all elements after `idx` to the left
+    slice::move(Slice<T>{this->_elems + idx, this->_len - idx - 1},
+                Slice<T>{this->_elems + idx + 1, this->_len - idx - 1});
+    this->_len -= 1;
+    return removed;
+  }
 
   /// Removes and returns the element at `idx`.
   ///
@@ -242,7 +256,13 @@ public:
   /// # Safety
   ///
   /// Invalidates pointers to last element.
-  auto swapRemove(usize idx) -> T;
+  auto swapRemove(usize idx) noexcept -> T {
+    CBL_ASSERT(idx < this->_len, "The index is outside the array's bounds");
+    T removed          = this->_elems[idx];
+    this->_elems[idx]  = this->_elems[this->_len - 1];
+    this->_len        -= 1;
+    return removed;
+  }
 
 private:
   T*    _elems = nullptr;
@@ -254,7 +274,8 @@ private:
   /// # Safety
   ///
   /// This will invalidate all pointers to elements.
-  auto  resize(mem::Allocator& allocator) -> void {
+  template <mem::AllocatorLike A>
+  auto resize(A& allocator) noexcept -> void {
     usize cap = this->_cap;
     if (this->_cap == 0) {
       cap = 1;
@@ -262,16 +283,15 @@ private:
       cap *= 2;
     }
 
-    T* resized = allocator.createArray<T>(cap);
-    CBL_ASSERT(resized != nullptr, "Resize failed (out of memory)");
+    Slice<T> resized = mem::allocateArray<T>(allocator, cap);
+    CBL_VERIFY((cap == 0) || !resized.isEmpty(), "Allocation failed");
 
     // Copy and delete old data
-    const usize len    = this->_len;
-    void*       copied = std::memcpy(resized, this->_elems, sizeof(T) * len);
-    CBL_ASSERT(copied != nullptr, "`memcpy` failed");
+    const usize len = this->_len;
+    slice::copy(resized, Slice<T>{this->_elems, len});
     this->deinit(allocator);
 
-    this->_elems = resized;
+    this->_elems = resized.ptr();
     this->_len   = len;
     this->_cap   = cap;
   }
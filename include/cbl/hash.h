@@ -0,0 +1,41 @@
+#ifndef CBL_HASH_H
+#define CBL_HASH_H
+
+#include "cbl/primitives.h" // Integer, u64
+#include <functional>       // hash
+
+namespace cbl {
+
+/// Mixes the bits of `x`, so that every bit of the result depends on every
+/// bit of `x` (the finalizer of MurmurHash3).
+inline constexpr auto hashMix(u64 x) noexcept -> u64 {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+/// Hashes values of type `T` to 64 well-mixed bits; the default hash of the
+/// hash-based containers.
+///
+/// # Note
+///
+/// * Integers, including the `_BitInt` aliases that `std::hash` does not
+///   support, are widened and passed through `hashMix`.
+/// * Other types go through `std::hash`, whose result is mixed too, since it
+///   is the identity for pointers and the builtin integers.
+template <class T> struct Hasher {
+  auto operator()(const T& value) const noexcept -> u64 {
+    if constexpr (Integer<T>) {
+      return hashMix(static_cast<u64>(static_cast<unsigned long long>(value)));
+    } else {
+      return hashMix(static_cast<u64>(std::hash<T>{}(value)));
+    }
+  }
+};
+
+} // namespace cbl
+
+#endif // !CBL_HASH_H
@@ -0,0 +1,396 @@
+#ifndef CBL_INTRUSIVE_LIST_H
+#define CBL_INTRUSIVE_LIST_H
+
+#include "cbl/assert.h"     // CBL_ASSERT
+#include "cbl/primitives.h" // u8, usize
+
+/// Linked lists whose links are fields of the elements.
+///
+/// The lists never allocate: an element is linked by pointing its link field
+/// at its neighbours, so it can be moved between lists in O(1) and belong to
+/// several lists at once through different link fields. The lists do not own
+/// their elements, which must stay alive and in place while they are linked.
+///
+/// ```
+/// struct Connection {
+///   DListLink link;
+///   int       fd;
+/// };
+///
+/// DList<Connection, &Connection::link> idle;
+/// ```
+namespace cbl {
+
+namespace detail {
+
+/// Returns the element that contains `link` as its `LINK` field.
+template <class T, class Link, Link T::*LINK>
+auto linkOwner(Link* link) noexcept -> T* {
+  // Compilers fold this to a constant offset
+  alignas(T) u8 storage[sizeof(T)];
+  const T*      probe  = reinterpret_cast<const T*>(storage);
+  const usize   offset = static_cast<usize>(
+      reinterpret_cast<const u8*>(&(probe->*LINK)) - storage);
+  return reinterpret_cast<T*>(reinterpret_cast<u8*>(link) - offset);
+}
+
+} // namespace detail
+
+/// The link field of an element of an `SList`.
+struct SListLink {
+  SListLink* next = nullptr;
+};
+
+/// An intrusive singly linked list.
+///
+/// Pushing and popping at the front are O(1).
+template <class T, SListLink T::*LINK> struct SList {
+  explicit SList() noexcept               = default;
+  SList(SList&&) noexcept                 = default;
+  SList(const SList&) noexcept            = delete;
+  SList& operator=(SList&&) noexcept      = default;
+  SList& operator=(const SList&) noexcept = delete;
+  ~SList() noexcept                       = default;
+
+public:
+  /// Iterates over the elements from the front; see `SList::iterator`.
+  struct Iterator {
+    explicit Iterator() noexcept                  = delete;
+    Iterator(Iterator&&) noexcept                 = default;
+    Iterator(const Iterator&) noexcept            = default;
+    Iterator& operator=(Iterator&&) noexcept      = default;
+    Iterator& operator=(const Iterator&) noexcept = default;
+    ~Iterator() noexcept                          = default;
+
+  public:
+    explicit Iterator(SListLink* link) noexcept : _link{link} {}
+
+    /// Stores the next element in `out`, returning `false` if there are no
+    /// elements left.
+    ///
+    /// # Note
+    ///
+    /// The element stored in `out` may be removed before the next call.
+    auto next(T** out) noexcept -> bool {
+      if (this->_link == nullptr) {
+        return false;
+      }
+      *out        = detail::linkOwner<T, SListLink, LINK>(this->_link);
+      this->_link = this->_link->next;
+      return true;
+    }
+
+  private:
+    SListLink* _link;
+  };
+
+  /// Returns the number of elements in the list.
+  auto len() const noexcept -> usize { return this->_len; }
+
+  /// Returns `true` if the list has no elements.
+  auto isEmpty() const noexcept -> bool { return this->_head == nullptr; }
+
+  /// Returns the first element, or `nullptr` if the list is empty.
+  auto front() const noexcept -> T* {
+    return (this->_head == nullptr)
+               ? nullptr
+               : detail::linkOwner<T, SListLink, LINK>(this->_head);
+  }
+
+  /// Adds `elem` to the front of the list.
+  auto pushFront(T* elem) noexcept -> void {
+    SListLink* link  = &(elem->*LINK);
+    link->next       = this->_head;
+    this->_head      = link;
+    this->_len      += 1;
+  }
+
+  /// Removes and returns the first element, or `nullptr` if the list is
+  /// empty.
+  auto popFront() noexcept -> T* {
+    SListLink* link = this->_head;
+    if (link == nullptr) {
+      return nullptr;
+    }
+    this->_head  = link->next;
+    this->_len  -= 1;
+    link->next   = nullptr;
+    return detail::linkOwner<T, SListLink, LINK>(link);
+  }
+
+  /// Inserts `elem` after `pos`, which must be in the list.
+  auto insertAfter(T* pos, T* elem) noexcept -> void {
+    SListLink* prev  = &(pos->*LINK);
+    SListLink* link  = &(elem->*LINK);
+    link->next       = prev->next;
+    prev->next       = link;
+    this->_len      += 1;
+  }
+
+  /// Removes `elem` from the list, returning `false` if it is not in the
+  /// list.
+  ///
+  /// This operation is O(N); use a `DList` if elements are often removed
+  /// from the middle.
+  auto remove(T* elem) noexcept -> bool {
+    SListLink*  link = &(elem->*LINK);
+    SListLink** prev = &this->_head;
+    while ((*prev != nullptr) && (*prev != link)) {
+      prev = &(*prev)->next;
+    }
+    if (*prev == nullptr) {
+      return false;
+    }
+    *prev       = link->next;
+    link->next  = nullptr;
+    this->_len -= 1;
+    return true;
+  }
+
+  /// Forgets every element, leaving their link fields as they are.
+  auto clear() noexcept -> void {
+    this->_head = nullptr;
+    this->_len  = 0;
+  }
+
+  /// Returns an iterator over the elements, from the front.
+  auto iterator() const noexcept -> Iterator { return Iterator{this->_head}; }
+
+private:
+  SListLink* _head = nullptr;
+  usize      _len  = 0;
+};
+
+/// The link field of an element of a `DList`.
+struct DListLink {
+  DListLink* prev = nullptr;
+  DListLink* next = nullptr;
+};
+
+/// An intrusive doubly linked list.
+///
+/// Inserting, removing and splicing are O(1).
+template <class T, DListLink T::*LINK> struct DList {
+  explicit DList() noexcept               = default;
+  DList(DList&&) noexcept                 = default;
+  DList(const DList&) noexcept            = delete;
+  DList& operator=(DList&&) noexcept      = default;
+  DList& operator=(const DList&) noexcept = delete;
+  ~DList() noexcept                       = default;
+
+public:
+  /// Iterates over the elements from the front; see `DList::iterator`.
+  struct Iterator {
+    explicit Iterator() noexcept                  = delete;
+    Iterator(Iterator&&) noexcept                 = default;
+    Iterator(const Iterator&) noexcept            = default;
+    Iterator& operator=(Iterator&&) noexcept      = default;
+    Iterator& operator=(const Iterator&) noexcept = default;
+    ~Iterator() noexcept                          = default;
+
+  public:
+    explicit Iterator(DListLink* link) noexcept : _link{link} {}
+
+    /// Stores the next element in `out`, returning `false` if there are no
+    /// elements left.
+    ///
+    /// # Note
+    ///
+    /// The element stored in `out` may be removed before the next call.
+    auto next(T** out) noexcept -> bool {
+      if (this->_link == nullptr) {
+        return false;
+      }
+      *out        = detail::linkOwner<T, DListLink, LINK>(this->_link);
+      this->_link = this->_link->next;
+      return true;
+    }
+
+  private:
+    DListLink* _link;
+  };
+
+  /// Returns the number of elements in the list.
+  auto len() const noexcept -> usize { return this->_len; }
+
+  /// Returns `true` if the list has no elements.
+  auto isEmpty() const noexcept -> bool { return this->_head == nullptr; }
+
+  /// Returns the first element, or `nullptr` if the list is empty.
+  auto front() const noexcept -> T* { return owner(this->_head); }
+
+  /// Returns the last element, or `nullptr` if the list is empty.
+  auto back() const noexcept -> T* { return owner(this->_tail); }
+
+  /// Returns the element after `elem`, or `nullptr` if `elem` is the last.
+  auto next(T* elem) const noexcept -> T* { return owner((elem->*LINK).next); }
+
+  /// Returns the element before `elem`, or `nullptr` if `elem` is the first.
+  auto prev(T* elem) const noexcept -> T* { return owner((elem->*LINK).prev); }
+
+  /// Adds `elem` to the front of the list.
+  auto pushFront(T* elem) noexcept -> void {
+    this->link(&(elem->*LINK), nullptr, this->_head);
+  }
+
+  /// Adds `elem` to the back of the list.
+  auto pushBack(T* elem) noexcept -> void {
+    this->link(&(elem->*LINK), this->_tail, nullptr);
+  }
+
+  /// Inserts `elem` after `pos`, which must be in the list.
+  auto insertAfter(T* pos, T* elem) noexcept -> void {
+    DListLink* prev = &(pos->*LINK);
+    this->link(&(elem->*LINK), prev, prev->next);
+  }
+
+  /// Inserts `elem` before `pos`, which must be in the list.
+  auto insertBefore(T* pos, T* elem) noexcept -> void {
+    DListLink* next = &(pos->*LINK);
+    this->link(&(elem->*LINK), next->prev, next);
+  }
+
+  /// Removes `elem`, which must be in the list.
+  auto remove(T* elem) noexcept -> void {
+    DListLink* link = &(elem->*LINK);
+    if (link->prev != nullptr) {
+      link->prev->next = link->next;
+    } else {
+      CBL_ASSERT(this->_head == link, "The element is not in the list");
+      this->_head = link->next;
+    }
+    if (link->next != nullptr) {
+      link->next->prev = link->prev;
+    } else {
+      CBL_ASSERT(this->_tail == link, "The element is not in the list");
+      this->_tail = link->prev;
+    }
+    link->prev  = nullptr;
+    link->next  = nullptr;
+    this->_len -= 1;
+  }
+
+  /// Removes and returns the first element, or `nullptr` if the list is
+  /// empty.
+  auto popFront() noexcept -> T* {
+    T* elem = this->front();
+    if (elem != nullptr) {
+      this->remove(elem);
+    }
+    return elem;
+  }
+
+  /// Removes and returns the last element, or `nullptr` if the list is empty.
+  auto popBack() noexcept -> T* {
+    T* elem = this->back();
+    if (elem != nullptr) {
+      this->remove(elem);
+    }
+    return elem;
+  }
+
+  /// Moves every element of `other` to the back of this list, leaving `other`
+  /// empty.
+  auto splice(DList& other) noexcept -> void {
+    if (other._head == nullptr) {
+      return;
+    }
+    if (this->_tail == nullptr) {
+      this->_head = other._head;
+    } else {
+      this->_tail->next = other._head;
+      other._head->prev = this->_tail;
+    }
+    this->_tail  = other._tail;
+    this->_len  += other._len;
+    other._head  = nullptr;
+    other._tail  = nullptr;
+    other._len   = 0;
+  }
+
+  /// Returns an iterator over the elements, from the front.
+  auto iterator() const noexcept -> Iterator { return Iterator{this->_head}; }
+
+private:
+  DListLink* _head = nullptr;
+  DListLink* _tail = nullptr;
+  usize      _len  = 0;
+
+  static auto owner(DListLink* link) noexcept -> T* {
+    return (link == nullptr) ? nullptr
+                             : detail::linkOwner<T, DListLink, LINK>(link);
+  }
+
+  /// Links `link` between `prev` and `next`, either of which may be the end
+  /// of the list.
+  auto link(DListLink* link, DListLink* prev, DListLink* next) noexcept
+      -> void {
+    link->prev = prev;
+    link->next = next;
+    if (prev != nullptr) {
+      prev->next = link;
+    } else {
+      this->_head = link;
+    }
+    if (next != nullptr) {
+      next->prev = link;
+    } else {
+      this->_tail = link;
+    }
+    this->_len += 1;
+  }
+};
+
+/// An intrusive list that orders elements by how recently they were used.
+///
+/// Caches use this to find the element to evict in O(1).
+template <class T, DListLink T::*LINK> struct LruList {
+  explicit LruList() noexcept                 = default;
+  LruList(LruList&&) noexcept                 = default;
+  LruList(const LruList&) noexcept            = delete;
+  LruList& operator=(LruList&&) noexcept      = default;
+  LruList& operator=(const LruList&) noexcept = delete;
+  ~LruList() noexcept                         = default;
+
+public:
+  using Iterator = typename DList<T, LINK>::Iterator;
+
+  /// Returns the number of elements in the list.
+  auto len() const noexcept -> usize { return this->_list.len(); }
+
+  /// Returns `true` if the list has no elements.
+  auto isEmpty() const noexcept -> bool { return this->_list.isEmpty(); }
+
+  /// Adds `elem` as the most recently used element.
+  auto insert(T* elem) noexcept -> void { this->_list.pushFront(elem); }
+
+  /// Marks `elem`, which must be in the list, as the most recently used
+  /// element.
+  auto touch(T* elem) noexcept -> void {
+    if (this->_list.front() != elem) {
+      this->_list.remove(elem);
+      this->_list.pushFront(elem);
+    }
+  }
+
+  /// Removes `elem`, which must be in the list.
+  auto remove(T* elem) noexcept -> void { this->_list.remove(elem); }
+
+  /// Returns the least recently used element, or `nullptr` if the list is
+  /// empty.
+  auto leastRecent() const noexcept -> T* { return this->_list.back(); }
+
+  /// Removes and returns the least recently used element, or `nullptr` if the
+  /// list is empty.
+  auto evict() noexcept -> T* { return this->_list.popBack(); }
+
+  /// Returns an iterator over the elements, from the most recently used.
+  auto iterator() const noexcept -> Iterator { return this->_list.iterator(); }
+
+private:
+  DList<T, LINK> _list;
+};
+
+} // namespace cbl
+
+#endif // !CBL_INTRUSIVE_LIST_H
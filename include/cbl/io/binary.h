@@ -0,0 +1,205 @@
+#ifndef CBL_IO_BINARY_H
+#define CBL_IO_BINARY_H
+
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/io/writer.h"     // Writer
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u64, usize, f32, f64, Integer
+#include "cbl/slice.h"         // Slice
+#include <bit>                 // endian
+#include <cstdint>             // uintptr_t
+#include <cstring>             // memcpy
+#include <type_traits>         // is_same_v, is_trivially_copyable_v
+#include <utility>             // move
+
+namespace cbl::io {
+
+/// Types that are encoded as a single fixed-width little-endian value.
+template <class T>
+concept BinaryPrimitive = Integer<T> || std::is_same_v<T, f32> ||
+                          std::is_same_v<T, f64> || std::is_same_v<T, bool>;
+
+/// Types whose slices can be encoded as raw bytes and viewed in place.
+template <class T>
+concept BinaryElement = std::is_trivially_copyable_v<T> &&
+                        ((sizeof(T) == 1) ||
+                         (std::endian::native == std::endian::little));
+
+/// Encodes values into a compact binary format.
+///
+/// The format is:
+///
+/// * Primitives are stored little-endian at their natural width.
+/// * Lengths are stored as unsigned LEB128 varints.
+/// * Slices are stored as a varint length, padding up to the element alignment
+///   (relative to the start of the stream), and then the raw elements. The
+///   padding lets `BinaryReader` return views into the buffer without copying.
+///
+/// # Errors
+///
+/// Every `write*` method returns `false` if the underlying writer accepted
+/// fewer bytes than requested (a short write). `written` still counts only
+/// the bytes that were accepted, and the stream is truncated from there.
+struct BinaryWriter {
+  explicit BinaryWriter() noexcept                      = delete;
+  BinaryWriter(BinaryWriter&&) noexcept                 = default;
+  BinaryWriter(const BinaryWriter&) noexcept            = delete;
+  BinaryWriter& operator=(BinaryWriter&&) noexcept      = default;
+  BinaryWriter& operator=(const BinaryWriter&) noexcept = delete;
+  ~BinaryWriter() noexcept                              = default;
+
+public:
+  /// Creates an encoder that writes into `writer`.
+  explicit BinaryWriter(Writer& writer) noexcept;
+
+  /// Encodes a primitive value.
+  template <BinaryPrimitive T> auto write(T value) noexcept -> bool {
+    u8 bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+      for (usize i = 0; i < sizeof(T) / 2; i++) {
+        u8 tmp                   = bytes[i];
+        bytes[i]                 = bytes[sizeof(T) - 1 - i];
+        bytes[sizeof(T) - 1 - i] = tmp;
+      }
+    }
+    return this->writeBytes(bytes, sizeof(T));
+  }
+
+  /// Encodes an unsigned LEB128 varint.
+  auto writeVarint(u64 value) noexcept -> bool;
+
+  /// Encodes a slice as its length followed by its elements.
+  template <BinaryElement T> auto writeSlice(Slice<T> slice) noexcept -> bool {
+    return this->writeVarint(static_cast<u64>(slice.len())) &&
+           this->pad(alignof(T)) &&
+           this->writeBytes(slice.ptr(), slice.len() * sizeof(T));
+  }
+
+  /// Encodes the elements of `array` like `writeSlice`.
+  template <BinaryElement T>
+  auto writeArray(const UnmanagedDynamicArray<T>& array) noexcept -> bool {
+    return this->writeSlice(array.elems());
+  }
+
+  /// Returns the number of bytes written so far.
+  auto written() const noexcept -> usize;
+
+private:
+  Writer* _writer;
+  usize   _pos = 0;
+
+  /// Writes raw bytes, returning `false` on a short write.
+  auto    writeBytes(const void* bytes, usize len) noexcept -> bool;
+
+  /// Writes zeroes until the stream position is a multiple of `alignment`.
+  auto    pad(usize alignment) noexcept -> bool;
+};
+
+/// Decodes values encoded by `BinaryWriter` from a buffer.
+///
+/// # Errors
+///
+/// Every `read*` method returns `false`, leaving the output unchanged, if the
+/// buffer does not contain a valid encoding of the requested value.
+struct BinaryReader {
+  explicit BinaryReader() noexcept                      = delete;
+  BinaryReader(BinaryReader&&) noexcept                 = default;
+  BinaryReader(const BinaryReader&) noexcept            = default;
+  BinaryReader& operator=(BinaryReader&&) noexcept      = default;
+  BinaryReader& operator=(const BinaryReader&) noexcept = default;
+  ~BinaryReader() noexcept                              = default;
+
+public:
+  /// Creates a decoder over `buf`.
+  ///
+  /// # Note
+  ///
+  /// For `readSlice` to return views, `buf` must be aligned to the largest
+  /// element alignment in the stream (e.g. memory from `malloc` or `mmap`).
+  explicit BinaryReader(Slice<u8> buf) noexcept;
+
+  /// Decodes a primitive value.
+  template <BinaryPrimitive T> auto read(T* out) noexcept -> bool {
+    if (this->remaining() < sizeof(T)) {
+      return false;
+    }
+    u8 bytes[sizeof(T)];
+    std::memcpy(bytes, this->_buf.ptr() + this->_pos, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+      for (usize i = 0; i < sizeof(T) / 2; i++) {
+        u8 tmp                   = bytes[i];
+        bytes[i]                 = bytes[sizeof(T) - 1 - i];
+        bytes[sizeof(T) - 1 - i] = tmp;
+      }
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+      *out = bytes[0] != 0;
+    } else {
+      std::memcpy(out, bytes, sizeof(T));
+    }
+    this->_pos += sizeof(T);
+    return true;
+  }
+
+  /// Decodes an unsigned LEB128 varint.
+  auto readVarint(u64* out) noexcept -> bool;
+
+  /// Decodes a slice as a view into the buffer, without copying.
+  ///
+  /// # Safety
+  ///
+  /// The returned slice is only valid as long as the buffer is.
+  template <BinaryElement T> auto readSlice(Slice<T>* out) noexcept -> bool {
+    const usize start = this->_pos;
+    u64         len;
+    if (!this->readVarint(&len) || !this->skipPadding(alignof(T))) {
+      this->_pos = start;
+      return false;
+    }
+
+    // Check the length without overflowing
+    u8* data = this->_buf.ptr() + this->_pos;
+    if ((len > this->remaining() / sizeof(T)) ||
+        ((reinterpret_cast<uintptr_t>(data) % alignof(T)) != 0)) {
+      this->_pos = start;
+      return false;
+    }
+    *out = Slice<T>{reinterpret_cast<T*>(data), static_cast<usize>(len)};
+    this->_pos += static_cast<usize>(len) * sizeof(T);
+    return true;
+  }
+
+  /// Decodes a slice into a newly allocated array.
+  ///
+  /// # Note
+  ///
+  /// The caller owns the array and must `deinit` it with `allocator`.
+  template <BinaryElement T>
+  auto readArray(mem::Allocator&           allocator,
+                 UnmanagedDynamicArray<T>* out) noexcept -> bool {
+    Slice<T> view;
+    if (!this->readSlice(&view)) {
+      return false;
+    }
+    UnmanagedDynamicArray<T> array =
+        UnmanagedDynamicArray<T>::initWithCapacity(allocator, view.len());
+    array.appendSlice(allocator, view);
+    *out = std::move(array);
+    return true;
+  }
+
+  /// Returns the number of bytes left to decode.
+  auto remaining() const noexcept -> usize;
+
+private:
+  Slice<u8> _buf;
+  usize     _pos = 0;
+
+  /// Skips the padding written by `BinaryWriter::pad`.
+  auto      skipPadding(usize alignment) noexcept -> bool;
+};
+
+} // namespace cbl::io
+
+#endif // !CBL_IO_BINARY_H
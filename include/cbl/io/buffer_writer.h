@@ -0,0 +1,44 @@
+#ifndef CBL_IO_BUFFER_WRITER_H
+#define CBL_IO_BUFFER_WRITER_H
+
+#include "cbl/io/writer.h"  // Writer
+#include "cbl/primitives.h" // u8, usize
+#include "cbl/slice.h"      // Slice
+
+namespace cbl::io {
+
+/// A writer that writes into a fixed buffer.
+///
+/// Writes that do not fit in the remaining space are truncated.
+struct BufferWriter : public Writer {
+  explicit BufferWriter() noexcept                      = delete;
+  BufferWriter(BufferWriter&&) noexcept                 = default;
+  BufferWriter(const BufferWriter&) noexcept            = delete;
+  BufferWriter& operator=(BufferWriter&&) noexcept      = default;
+  BufferWriter& operator=(const BufferWriter&) noexcept = delete;
+  ~BufferWriter() noexcept                              = default;
+
+public:
+  /// Creates a writer that writes into `buf`.
+  explicit BufferWriter(Slice<u8> buf) noexcept;
+
+  /// Copies as much of `buf` as fits, returning the number of bytes written.
+  [[nodiscard]] auto write(Slice<u8> buf) noexcept -> usize override;
+
+  /// Returns the bytes written so far.
+  auto written() const noexcept -> Slice<u8>;
+
+  /// Returns the number of bytes that can still be written.
+  auto remaining() const noexcept -> usize;
+
+  /// Discards everything written so far.
+  auto reset() noexcept -> void;
+
+private:
+  Slice<u8> _buf;
+  usize     _pos = 0;
+};
+
+} // namespace cbl::io
+
+#endif // !CBL_IO_BUFFER_WRITER_H
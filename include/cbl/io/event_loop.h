@@ -0,0 +1,234 @@
+#ifndef CBL_IO_EVENT_LOOP_H
+#define CBL_IO_EVENT_LOOP_H
+
+#include "cbl/dynamic_array.h"  // UnmanagedDynamicArray
+#include "cbl/io/file.h"        // File
+#include "cbl/io/task.h"        // Task
+#include "cbl/mem/allocator.h"  // Allocator
+#include "cbl/primitives.h"     // u8, u64, usize, isize
+#include "cbl/priority_queue.h" // PriorityQueue
+#include "cbl/slice.h"          // Slice
+#include <atomic>               // atomic
+#include <coroutine>            // coroutine_handle
+
+namespace cbl::io {
+
+/// A single-threaded loop that runs many `Task`s concurrently, suspending
+/// them while they wait for I/O or timers.
+///
+/// Waiting is built on `epoll`: file descriptors are registered
+/// edge-triggered the first time a task waits on them, a `timerfd` fires for
+/// the earliest timer, and an `eventfd` lets other threads interrupt the
+/// loop. I/O is attempted right away, and a task is only suspended if the
+/// descriptor is not ready, so reads and writes that would not block cost a
+/// single syscall.
+///
+/// # Note
+///
+/// * File descriptors used with the loop must be non-blocking (see
+///   `setNonBlocking`).
+/// * At most one task may read from, and one task write to, a descriptor at
+///   a time.
+struct EventLoop {
+  explicit EventLoop() noexcept                   = delete;
+  EventLoop(EventLoop&&) noexcept                 = delete;
+  EventLoop(const EventLoop&) noexcept            = delete;
+  EventLoop& operator=(EventLoop&&) noexcept      = delete;
+  EventLoop& operator=(const EventLoop&) noexcept = delete;
+
+public:
+  /// Waits until a descriptor is ready, then reads or writes it.
+  struct IoAwaiter {
+    EventLoop*              loop;
+    int                     fd;
+    Slice<u8>               buf;
+    bool                    is_write;
+
+    /// The number of bytes transferred, or a negated `errno` value.
+    isize                   result = 0;
+
+    /// The suspended task.
+    std::coroutine_handle<> handle;
+
+    /// Tries the I/O right away.
+    auto await_ready() noexcept -> bool;
+
+    /// Waits for the descriptor, returning `false` if it could not be
+    /// watched.
+    auto await_suspend(std::coroutine_handle<> handle) noexcept -> bool;
+
+    /// Returns the number of bytes transferred, or a negated `errno` value
+    /// on failure. Reads return 0 at the end of the stream.
+    auto await_resume() const noexcept -> isize { return this->result; }
+  };
+
+  /// Suspends a task until a deadline.
+  struct SleepAwaiter {
+    EventLoop* loop;
+
+    /// In nanoseconds of `CLOCK_MONOTONIC`.
+    u64        deadline;
+
+    auto await_ready() const noexcept -> bool;
+    auto await_suspend(std::coroutine_handle<> handle) noexcept -> void;
+    auto await_resume() const noexcept -> void {}
+  };
+
+  /// Lets the other ready tasks run before resuming a task.
+  struct YieldAwaiter {
+    EventLoop* loop;
+
+    auto await_ready() const noexcept -> bool { return false; }
+    auto await_suspend(std::coroutine_handle<> handle) noexcept -> void;
+    auto await_resume() const noexcept -> void {}
+  };
+
+  /// Creates a loop that allocates its bookkeeping, and the frames of the
+  /// coroutines that take the loop as an argument, with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the loop.
+  ///
+  /// # Errors
+  ///
+  /// Check `isValid` after construction; the loop is invalid if the `epoll`,
+  /// `eventfd` or `timerfd` descriptors could not be created.
+  explicit EventLoop(mem::Allocator& allocator) noexcept;
+
+  /// Closes the loop's descriptors and frees its memory.
+  ///
+  /// # Note
+  ///
+  /// Every spawned task must have finished, i.e. `run` must have returned
+  /// without being stopped; the frames of unfinished tasks are leaked.
+  ~EventLoop() noexcept;
+
+  /// Returns `true` if the loop was successfully initialized.
+  auto isValid() const noexcept -> bool;
+
+  /// Returns the allocator of the loop.
+  auto allocator() noexcept -> mem::Allocator&;
+
+  /// Hands `task` to the loop, which starts it on the next iteration of
+  /// `run` and destroys it when it finishes.
+  auto spawn(Task<void>&& task) noexcept -> void;
+
+  /// Runs tasks until every spawned task has finished or `stop` is called.
+  auto run() noexcept -> void;
+
+  /// Makes `run` return at its next iteration, or, if the loop is not
+  /// running, the next call to `run` return right away.
+  ///
+  /// This may be called from any thread.
+  auto stop() noexcept -> void;
+
+  /// Reads up to `buf.len()` bytes from `fd` once it is readable.
+  auto read(int fd, Slice<u8> buf) noexcept -> IoAwaiter {
+    return IoAwaiter{this, fd, buf, false, 0, {}};
+  }
+
+  /// Writes up to `buf.len()` bytes into `fd` once it is writable.
+  auto write(int fd, Slice<u8> buf) noexcept -> IoAwaiter {
+    return IoAwaiter{this, fd, buf, true, 0, {}};
+  }
+
+  /// Reads from the descriptor of `file`.
+  ///
+  /// # Note
+  ///
+  /// This bypasses the `FILE*` buffer of `file`.
+  auto read(const File& file, Slice<u8> buf) noexcept -> IoAwaiter {
+    return this->read(file.fd(), buf);
+  }
+
+  /// Writes into the descriptor of `file`.
+  ///
+  /// # Note
+  ///
+  /// This bypasses the `FILE*` buffer of `file`, so pending writes through
+  /// `file` should be flushed first.
+  auto write(const File& file, Slice<u8> buf) noexcept -> IoAwaiter {
+    return this->write(file.fd(), buf);
+  }
+
+  /// Suspends the task for `ns` nanoseconds.
+  auto sleep(u64 ns) noexcept -> SleepAwaiter;
+
+  /// Lets the other ready tasks run.
+  auto yield() noexcept -> YieldAwaiter { return YieldAwaiter{this}; }
+
+  /// Reads exactly `buf.len()` bytes from `fd`, returning `buf.len()`, the
+  /// number of bytes read before the end of the stream, or a negated `errno`
+  /// value.
+  auto readAll(int fd, Slice<u8> buf) noexcept -> Task<isize>;
+
+  /// Writes all of `buf` into `fd`, returning `buf.len()` or a negated
+  /// `errno` value.
+  auto writeAll(int fd, Slice<u8> buf) noexcept -> Task<isize>;
+
+  /// Makes `fd` non-blocking, returning `false` on failure.
+  static auto setNonBlocking(int fd) noexcept -> bool;
+
+private:
+  /// The tasks waiting on a descriptor.
+  struct Watch {
+    IoAwaiter* reader;
+    IoAwaiter* writer;
+  };
+
+  struct Timer {
+    u64                     deadline;
+    /// Orders timers with the same deadline by creation.
+    u64                     seq;
+    std::coroutine_handle<> handle;
+
+    auto operator<(const Timer& other) const noexcept -> bool {
+      return (this->deadline < other.deadline) ||
+             ((this->deadline == other.deadline) && (this->seq < other.seq));
+    }
+  };
+
+  mem::Allocator*                                _allocator;
+  int                                            _epoll_fd = -1;
+  int                                            _event_fd = -1;
+  int                                            _timer_fd = -1;
+  bool                                           _valid    = false;
+  std::atomic<bool>                              _stopped{false};
+
+  /// The number of spawned tasks that have not finished.
+  usize                                          _live = 0;
+
+  /// Tasks to resume on the next iteration.
+  UnmanagedDynamicArray<std::coroutine_handle<>> _ready;
+  UnmanagedDynamicArray<std::coroutine_handle<>> _running;
+
+  /// Indexed by descriptor.
+  Slice<Watch>                                   _watches;
+
+  PriorityQueue<Timer>                           _timers;
+  u64                                            _timer_seq   = 0;
+  /// The deadline the `timerfd` is armed for, or 0.
+  u64                                            _timer_armed = 0;
+
+  /// Schedules `handle` to be resumed.
+  auto schedule(std::coroutine_handle<> handle) noexcept -> void;
+
+  /// Suspends `awaiter` until its descriptor is ready, returning `false` if
+  /// the descriptor could not be watched.
+  auto watch(IoAwaiter* awaiter) noexcept -> bool;
+
+  /// Retries the I/O of the tasks waiting on `fd`, resuming the ones that
+  /// are done.
+  auto dispatch(int fd, unsigned events) noexcept -> void;
+
+  /// Schedules expired timers and arms the `timerfd` for the next one.
+  auto fireTimers() noexcept -> void;
+
+  /// Arms the `timerfd` for the earliest timer.
+  auto armTimer() noexcept -> void;
+};
+
+} // namespace cbl::io
+
+#endif // !CBL_IO_EVENT_LOOP_H
@@ -2,8 +2,8 @@
 #define CBL_IO_FILE_H
 
 #include "cbl/io/writer.h"  // Writer
-#include "cbl/primitives.h" // const_cstr
-#include <cstdarg>          // va_list
+#include "cbl/primitives.h" // u8, u64, usize, isize, const_cstr
+#include "cbl/slice.h"      // Slice
 #include <cstdio>           // FILE
 
 namespace cbl::io {
@@ -37,12 +37,12 @@ public:
   /// Writes the buffer into the file, returning the number of bytes written.
   [[nodiscard]] auto write(Slice<u8> buf) noexcept -> usize override;
 
-  /// Writes a formatted string into the file.
-  auto formatV(const_cstr fmt, std::va_list args) noexcept -> void override;
-
   /// Returns the raw `FILE*`.
   auto file() const noexcept -> std::FILE*;
 
+  /// Returns the underlying file descriptor.
+  auto fd() const noexcept -> int;
+
   /// Clones the file.
   auto clone() const noexcept -> File;
 
@@ -54,6 +54,46 @@ private:
   static auto getFileMode(Mode mode) -> const_cstr;
 };
 
+/// How `copyRange` moved the bytes.
+enum class CopyMethod {
+  /// `copy_file_range`, which may share extents or copy inside the kernel.
+  CopyFileRange,
+  /// `sendfile`, from a regular file into any file.
+  SendFile,
+  /// `splice`, to or from a pipe.
+  Splice,
+  /// `read`/`write` through the caller's buffer.
+  Buffered,
+};
+
+/// Copies up to `len` bytes of `src`, starting at `offset`, into `dst` at its
+/// current position, returning the number of bytes copied.
+///
+/// The bytes move inside the kernel when both ends allow it: between regular
+/// files with `copy_file_range`, from a regular file with `sendfile`, and to
+/// or from a pipe with `splice`. Otherwise they go through `buf`, which
+/// costs two copies per byte.
+///
+/// The position of `src` does not change, and `offset` is ignored if `src` is
+/// not seekable (e.g. a pipe or a socket). If `method` is not null, it
+/// receives the method that moved the last bytes.
+///
+/// # Note
+///
+/// * The `FILE*` buffers of both files are flushed first, since the copy goes
+///   through their descriptors.
+/// * The descriptors should be blocking: bytes read into `buf` that `dst`
+///   does not accept are lost.
+///
+/// # Errors
+///
+/// Fewer than `len` bytes are copied at the end of `src`, or if an error
+/// stops the copy after some bytes. If the copy fails before any byte, a
+/// negated `errno` value is returned; `-EINVAL` if it needs `buf` but `buf`
+/// is empty.
+auto copyRange(File& src, File& dst, u64 offset, usize len, Slice<u8> buf,
+               CopyMethod* method = nullptr) noexcept -> isize;
+
 /// Safe representation of `stdout`.
 struct Stdout : public Writer {
   explicit Stdout() noexcept                = default;
@@ -65,9 +105,6 @@ struct Stdout : public Writer {
 public:
   /// Writes the buffer to `stdout`, returning the number of bytes written.
   [[nodiscard]] auto write(Slice<u8> buf) noexcept -> usize override;
-
-  /// Writes a formatted string into `stdout`.
-  auto formatV(const_cstr fmt, std::va_list args) noexcept -> void override;
 };
 
 /// Safe representation of `stderr`.
@@ -81,9 +118,6 @@ struct Stderr : public Writer {
 public:
   /// Writes the buffer to `stderr`, returning the number of bytes written.
   [[nodiscard]] auto write(Slice<u8> buf) noexcept -> usize override;
-
-  /// Writes a formatted string into `stderr`.
-  auto formatV(const_cstr fmt, std::va_list args) noexcept -> void override;
 };
 
 // TODO: Add Stdin that implements Reader
@@ -0,0 +1,279 @@
+#ifndef CBL_IO_FORMAT_H
+#define CBL_IO_FORMAT_H
+
+#include "cbl/io/writer.h"  // Writer
+#include "cbl/primitives.h" // u8, usize, f32, f64, Integer, const_cstr
+#include "cbl/slice.h"      // Slice
+#include <type_traits>      // decay_t, remove_cv_t, is_same_v
+
+namespace cbl::io {
+
+/// Formats values of type `T` for `Writer::format`.
+///
+/// Specializations must provide:
+///
+/// * `static constexpr auto supports(char spec) noexcept -> bool`, which
+///   returns `true` if `spec` is a valid specifier for `T` (`'\0'` is the
+///   empty specifier). It is evaluated when the format string is parsed.
+/// * `static auto format(Writer& writer, const T& value, char spec) noexcept
+///   -> void`, which writes `value` into `writer`.
+template <class T> struct Formatter;
+
+namespace detail {
+
+/// Reports an invalid format string.
+///
+/// This is intentionally not `constexpr`, so calling it while parsing a
+/// format string is a compile error.
+inline auto formatError(const_cstr msg) noexcept -> void { (void)msg; }
+
+template <class T>
+using FormatterFor = Formatter<std::remove_cv_t<std::decay_t<T>>>;
+
+/// Writes `value` (negated if `negative`) in the base selected by `spec`.
+auto formatInteger(Writer& writer, unsigned long long value, bool negative,
+                   char spec) noexcept -> void;
+
+/// Writes the shortest representation of `value` that round-trips.
+auto formatFloat(Writer& writer, f32 value, char spec) noexcept -> void;
+
+/// Writes the shortest representation of `value` that round-trips.
+auto formatFloat(Writer& writer, f64 value, char spec) noexcept -> void;
+
+/// Writes `str`, collapsing `{{` and `}}` if `escaped` is `true`.
+auto formatLiteral(Writer& writer, const_cstr str, usize len,
+                   bool escaped) noexcept -> void;
+
+} // namespace detail
+
+/// A format string that is parsed and checked against `Args` at compile time.
+template <class... Args> struct FormatString {
+  /// A run of literal text between placeholders.
+  struct Literal {
+    usize start   = 0;
+    usize len     = 0;
+    bool  escaped = false;
+  };
+
+  /// Parses `str`.
+  ///
+  /// # Note
+  ///
+  /// This is `consteval`, so an invalid format string fails to compile.
+  template <usize N>
+  consteval FormatString(const char (&str)[N]) noexcept // NOLINT
+      : _str{str} {
+    this->parse(N - 1);
+  }
+
+  /// Returns the format string.
+  constexpr auto str() const noexcept -> const_cstr { return this->_str; }
+
+  /// Returns the literal text preceding placeholder `idx`, or the trailing
+  /// text if `idx` is the number of arguments.
+  constexpr auto literal(usize idx) const noexcept -> Literal {
+    return this->_literals[idx];
+  }
+
+  /// Returns the specifier of placeholder `idx`.
+  constexpr auto spec(usize idx) const noexcept -> char {
+    return this->_specs[idx];
+  }
+
+private:
+  const_cstr _str                           = nullptr;
+  Literal    _literals[sizeof...(Args) + 1] = {};
+  char       _specs[sizeof...(Args) + 1]    = {};
+
+  consteval auto parse(usize len) noexcept -> void {
+    usize arg     = 0;
+    usize start   = 0;
+    bool  escaped = false;
+    for (usize i = 0; i < len; i++) {
+      const char c = this->_str[i];
+      if ((c == '{') || (c == '}')) {
+        if ((i + 1 < len) && (this->_str[i + 1] == c)) {
+          escaped  = true;
+          i       += 1;
+          continue;
+        }
+        if (c == '}') {
+          detail::formatError("Unmatched `}` in format string");
+        }
+
+        // Placeholder with an optional single-character specifier
+        usize end  = i + 1;
+        char  spec = '\0';
+        if ((end < len) && (this->_str[end] != '}')) {
+          spec  = this->_str[end];
+          end  += 1;
+        }
+        if ((end >= len) || (this->_str[end] != '}')) {
+          detail::formatError("Unterminated placeholder in format string");
+        }
+        if (arg >= sizeof...(Args)) {
+          detail::formatError("More placeholders than arguments");
+        }
+        this->_literals[arg]  = Literal{start, i - start, escaped};
+        this->_specs[arg]     = spec;
+        arg                  += 1;
+        start                 = end + 1;
+        escaped               = false;
+        i                     = end;
+      }
+    }
+    if (arg != sizeof...(Args)) {
+      detail::formatError("Fewer placeholders than arguments");
+    }
+    this->_literals[arg] = Literal{start, len - start, escaped};
+
+    usize idx = 0;
+    ((detail::FormatterFor<Args>::supports(this->_specs[idx++])
+          ? void()
+          : detail::formatError("Unsupported format specifier")),
+     ...);
+  }
+};
+
+template <class... Args>
+auto Writer::format(FormatString<std::type_identity_t<Args>...> fmt,
+                    const Args&... args) noexcept -> void {
+  usize idx     = 0;
+  auto  literal = [&]() {
+    auto lit = fmt.literal(idx);
+    detail::formatLiteral(*this, fmt.str() + lit.start, lit.len, lit.escaped);
+  };
+  [[maybe_unused]] auto arg = [&](const auto& value) {
+    literal();
+    detail::FormatterFor<decltype(value)>::format(*this, value,
+                                                  fmt.spec(idx));
+    idx += 1;
+  };
+  (arg(args), ...);
+  literal();
+}
+
+/// Formats integers, including the `_BitInt` aliases.
+///
+/// Specifiers: none (decimal), `x` (hexadecimal), `b` (binary).
+template <Integer T> struct Formatter<T> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    return (spec == '\0') || (spec == 'x') || (spec == 'b');
+  }
+
+  static auto format(Writer& writer, const T& value,
+                     char spec) noexcept -> void {
+    if constexpr (isSigned<T>()) {
+      const long long v = static_cast<long long>(value);
+      const unsigned long long magnitude =
+          (v < 0) ? 0ULL - static_cast<unsigned long long>(v)
+                  : static_cast<unsigned long long>(v);
+      detail::formatInteger(writer, magnitude, v < 0, spec);
+    } else {
+      detail::formatInteger(writer, static_cast<unsigned long long>(value),
+                            false, spec);
+    }
+  }
+};
+
+/// Formats floating point numbers using their shortest round-trip
+/// representation.
+///
+/// Specifiers: none (shortest), `e` (scientific).
+template <class T>
+  requires std::is_same_v<T, f32> || std::is_same_v<T, f64>
+struct Formatter<T> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    return (spec == '\0') || (spec == 'e');
+  }
+
+  static auto format(Writer& writer, const T& value,
+                     char spec) noexcept -> void {
+    detail::formatFloat(writer, value, spec);
+  }
+};
+
+/// Formats `bool` as `true` or `false`.
+template <> struct Formatter<bool> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    return spec == '\0';
+  }
+
+  static auto format(Writer& writer, const bool& value,
+                     char spec) noexcept -> void;
+};
+
+/// Formats a single character.
+template <> struct Formatter<char> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    return spec == '\0';
+  }
+
+  static auto format(Writer& writer, const char& value,
+                     char spec) noexcept -> void;
+};
+
+/// Formats a null-terminated string.
+template <> struct Formatter<const_cstr> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    return spec == '\0';
+  }
+
+  static auto format(Writer& writer, const const_cstr& value,
+                     char spec) noexcept -> void;
+};
+
+/// Formats a null-terminated string.
+template <> struct Formatter<cstr> : Formatter<const_cstr> {};
+
+/// Formats a pointer as a hexadecimal address.
+template <class T> struct Formatter<T*> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    return spec == '\0';
+  }
+
+  static auto format(Writer& writer, T* const& value,
+                     char spec) noexcept -> void {
+    (void)spec;
+    writer.format("0x");
+    detail::formatInteger(
+        writer, reinterpret_cast<unsigned long long>(value), false, 'x');
+  }
+};
+
+/// Formats a slice as `[a, b, c]`, applying the specifier to each element.
+///
+/// A `Slice<u8>` or `Slice<const u8>` also accepts `s`, which writes its bytes
+/// as a string.
+template <class T> struct Formatter<Slice<T>> {
+  static constexpr auto supports(char spec) noexcept -> bool {
+    if constexpr (std::is_same_v<std::remove_cv_t<T>, u8>) {
+      if (spec == 's') {
+        return true;
+      }
+    }
+    return detail::FormatterFor<T>::supports(spec);
+  }
+
+  static auto format(Writer& writer, const Slice<T>& value,
+                     char spec) noexcept -> void {
+    if constexpr (std::is_same_v<std::remove_cv_t<T>, u8>) {
+      if (spec == 's') {
+        writer.writeAll(Slice<u8>{const_cast<u8*>(value.ptr()), value.len()});
+        return;
+      }
+    }
+    writer.format("[");
+    for (usize i = 0; i < value.len(); i++) {
+      if (i != 0) {
+        writer.format(", ");
+      }
+      detail::FormatterFor<T>::format(writer, value[i], spec);
+    }
+    writer.format("]");
+  }
+};
+
+} // namespace cbl::io
+
+#endif // !CBL_IO_FORMAT_H
@@ -0,0 +1,233 @@
+#ifndef CBL_IO_RING_H
+#define CBL_IO_RING_H
+
+#include "cbl/io/file.h"       // File
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u32, u64, usize, isize, any
+#include "cbl/slice.h"         // Slice
+
+struct io_uring_sqe; // NOLINT
+struct io_uring_cqe; // NOLINT
+
+namespace cbl::io {
+
+/// An asynchronous file I/O engine.
+///
+/// Reads and writes are queued into a submission queue, handed to the kernel
+/// in batches by `submit`, and their results are collected with `poll` or
+/// `wait`.
+///
+/// The ring is backed by `io_uring` when the kernel supports it. Otherwise it
+/// falls back to a blocking backend that executes each queued request with
+/// `preadv`/`pwritev` when it is submitted, so callers can use the same API
+/// everywhere.
+///
+/// # Note
+///
+/// Buffers passed to `read`/`write` must stay valid until the request's
+/// completion has been reaped.
+struct Ring {
+  enum class Backend {
+    /// Use `io_uring` if it is available, otherwise use `Blocking`.
+    Auto,
+    /// Use `io_uring`; initialization fails if it is unavailable.
+    Uring,
+    /// Execute requests synchronously at submission time.
+    Blocking,
+  };
+
+  enum class Op {
+    Read,
+    Write,
+  };
+
+  /// Describes a single read or write.
+  struct Request {
+    Op        op;
+
+    /// The file descriptor, or an index into the registered files if
+    /// `fixed_file` is `true`.
+    int       fd;
+
+    /// The buffer to read into or write from.
+    Slice<u8> buf;
+
+    /// The file offset to start at.
+    u64       offset;
+
+    /// A value that is passed back unmodified in the request's completion.
+    u64       user_data;
+
+    /// Index of the registered buffer that `buf` lies in, or `-1` if `buf` is
+    /// not part of a registered buffer.
+    int       buf_index  = -1;
+
+    /// `true` if `fd` is an index into the registered files.
+    bool      fixed_file = false;
+  };
+
+  /// The result of a completed request.
+  struct Completion {
+    /// The `user_data` of the request that completed.
+    u64   user_data;
+
+    /// The number of bytes transferred, or a negated `errno` value on
+    /// failure.
+    isize result;
+  };
+
+  /// Function called for each completion by `poll`.
+  typedef void (*Callback)(Completion completion, any ctx);
+
+  explicit Ring() noexcept              = delete;
+  Ring(Ring&&) noexcept                 = delete;
+  Ring(const Ring&) noexcept            = delete;
+  Ring& operator=(Ring&&) noexcept      = delete;
+  Ring& operator=(const Ring&) noexcept = delete;
+
+public:
+  /// Creates a ring with room for `entries` in-flight requests.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the ring.
+  ///
+  /// # Errors
+  ///
+  /// Check `isValid` after construction; the ring is invalid if the requested
+  /// backend could not be initialized or memory could not be allocated.
+  explicit Ring(mem::Allocator& allocator, u32 entries,
+                Backend backend = Backend::Auto) noexcept;
+
+  /// Cleanup resources used by the `Ring`.
+  ///
+  /// # Note
+  ///
+  /// In-flight requests are not cancelled, so all of them should be reaped
+  /// before the ring is destroyed.
+  ~Ring() noexcept;
+
+  /// Returns `true` if the ring was successfully initialized.
+  auto isValid() const noexcept -> bool;
+
+  /// Returns the backend in use (either `Uring` or `Blocking`).
+  auto backend() const noexcept -> Backend;
+
+  /// Registers `bufs` with the kernel so that requests on them skip the
+  /// per-request page pinning.
+  ///
+  /// Requests using a registered buffer must set `Request::buf_index`.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false` if the buffers could not be registered.
+  auto registerBuffers(Slice<Slice<u8>> bufs) noexcept -> bool;
+
+  /// Registers `fds` so that requests can refer to them by index, skipping
+  /// the per-request file table lookup.
+  ///
+  /// Requests using a registered file must set `Request::fixed_file`.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false` if the files could not be registered.
+  auto registerFiles(Slice<int> fds) noexcept -> bool;
+
+  /// Unregisters all buffers and files registered with the ring.
+  auto unregisterAll() noexcept -> void;
+
+  /// Adds `request` to the submission queue.
+  ///
+  /// The request is not started until `submit` is called.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false` if the submission queue is full.
+  auto queue(Request request) noexcept -> bool;
+
+  /// Queues a read of `buf.len()` bytes from `file` at `offset`.
+  ///
+  /// # Note
+  ///
+  /// This bypasses the `FILE*` buffer of `file`, so pending writes through
+  /// `file` should be flushed first.
+  auto read(const File& file, Slice<u8> buf, u64 offset,
+            u64 user_data) noexcept -> bool;
+
+  /// Queues a write of `buf` into `file` at `offset`.
+  ///
+  /// # Note
+  ///
+  /// This bypasses the `FILE*` buffer of `file`, so pending writes through
+  /// `file` should be flushed first.
+  auto write(const File& file, Slice<u8> buf, u64 offset,
+             u64 user_data) noexcept -> bool;
+
+  /// Submits all queued requests, returning the number submitted.
+  auto submit() noexcept -> usize;
+
+  /// Submits all queued requests and blocks until at least `min_complete`
+  /// completions are available, returning the number submitted.
+  auto submitAndWait(u32 min_complete) noexcept -> usize;
+
+  /// Copies available completions into `out` without blocking, returning the
+  /// number of completions copied.
+  auto poll(Slice<Completion> out) noexcept -> usize;
+
+  /// Calls `callback` for each available completion without blocking,
+  /// returning the number of completions handled.
+  auto poll(Callback callback, any ctx) noexcept -> usize;
+
+  /// Returns the number of requests that have been queued or submitted but
+  /// whose completions have not been reaped yet.
+  auto inFlight() const noexcept -> usize;
+
+private:
+  mem::Allocator*   _allocator;
+  Backend           _backend   = Backend::Blocking;
+  u32               _entries   = 0;
+  usize             _in_flight = 0;
+  bool              _valid     = false;
+
+  // `io_uring` state
+  int               _ring_fd   = -1;
+  u8*               _sq_ptr    = nullptr;
+  usize             _sq_size   = 0;
+  u8*               _cq_ptr    = nullptr;
+  usize             _cq_size   = 0;
+  io_uring_sqe*     _sqes      = nullptr;
+  usize             _sqes_size = 0;
+  unsigned*         _sq_head   = nullptr;
+  unsigned*         _sq_tail   = nullptr;
+  unsigned*         _sq_mask   = nullptr;
+  unsigned*         _sq_array  = nullptr;
+  unsigned*         _cq_head   = nullptr;
+  unsigned*         _cq_tail   = nullptr;
+  unsigned*         _cq_mask   = nullptr;
+  io_uring_cqe*     _cqes      = nullptr;
+  u32               _to_submit = 0;
+
+  // Blocking backend state
+  Slice<Request>    _pending;
+  usize             _pending_len = 0;
+  Slice<Completion> _completed;
+  usize             _completed_head = 0;
+  usize             _completed_len  = 0;
+  Slice<int>        _files;
+
+  /// Sets up the `io_uring` instance.
+  auto              initUring() noexcept -> bool;
+
+  /// Sets up the blocking backend.
+  auto              initBlocking() noexcept -> bool;
+
+  /// Executes a request synchronously, returning its result.
+  auto              execute(const Request& request) const noexcept -> isize;
+
+  /// Returns the next completion, or `false` if none are available.
+  auto              nextCompletion(Completion* out) noexcept -> bool;
+};
+
+} // namespace cbl::io
+
+#endif // !CBL_IO_RING_H
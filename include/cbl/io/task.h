@@ -0,0 +1,230 @@
+#ifndef CBL_IO_TASK_H
+#define CBL_IO_TASK_H
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, usize
+#include <concepts>            // derived_from, same_as
+#include <coroutine>           // coroutine_handle, suspend_always
+#include <cstdlib>             // abort
+#include <memory>              // construct_at, destroy_at
+#include <type_traits>         // remove_cvref_t
+#include <utility>             // exchange, move
+
+namespace cbl::io {
+
+namespace detail {
+
+/// A coroutine argument that provides the allocator for the coroutine's
+/// frame: an allocator, or an object with an `allocator` method such as
+/// `EventLoop`.
+template <class T>
+concept FrameAllocatorSource =
+    std::derived_from<std::remove_cvref_t<T>, mem::Allocator> ||
+    requires(T& source) {
+      { source.allocator() } -> std::same_as<mem::Allocator&>;
+    };
+
+/// Returns the allocator of the first argument that provides one.
+template <class First, class... Rest>
+auto frameAllocator(First& first, Rest&... rest) noexcept -> mem::Allocator& {
+  if constexpr (std::derived_from<std::remove_cvref_t<First>,
+                                  mem::Allocator>) {
+    return first;
+  } else if constexpr (FrameAllocatorSource<First>) {
+    return first.allocator();
+  } else {
+    static_assert(sizeof...(Rest) > 0,
+                  "A coroutine returning `Task` must take an allocator, or "
+                  "an object with an `allocator` method, as an argument");
+    return frameAllocator(rest...);
+  }
+}
+
+/// The state shared by the promises of every `Task`.
+struct PromiseBase {
+  /// Resumed when the coroutine finishes.
+  std::coroutine_handle<> continuation;
+
+  /// For tasks owned by an event loop, which counts the tasks that are not
+  /// finished, and destroys a task's frame when it finishes.
+  usize*                  detached = nullptr;
+
+  /// Hands control to the awaiting coroutine when the task finishes.
+  struct FinalAwaiter {
+    auto await_ready() const noexcept -> bool { return false; }
+
+    template <class P>
+    auto await_suspend(std::coroutine_handle<P> handle) noexcept
+        -> std::coroutine_handle<> {
+      PromiseBase& promise = handle.promise();
+      if (promise.continuation) {
+        return promise.continuation;
+      }
+      if (promise.detached != nullptr) {
+        *promise.detached -= 1;
+        handle.destroy();
+      }
+      return std::noop_coroutine();
+    }
+
+    auto await_resume() const noexcept -> void {}
+  };
+
+  /// Tasks are lazy: they start when they are awaited or spawned.
+  auto initial_suspend() const noexcept -> std::suspend_always { return {}; }
+
+  auto final_suspend() const noexcept -> FinalAwaiter { return {}; }
+
+  /// The library is built without exceptions.
+  auto unhandled_exception() const noexcept -> void { std::abort(); }
+
+  /// Allocates the frame with the allocator of the coroutine's arguments
+  /// (see `FrameAllocatorSource`).
+  ///
+  /// # Note
+  ///
+  /// This is not `noexcept`, which would make the compiler handle a null
+  /// frame; a failed allocation aborts instead.
+  template <class... Args>
+  static auto operator new(usize size, Args&... args) -> void* {
+    static_assert(sizeof...(Args) > 0,
+                  "A coroutine returning `Task` must take an allocator, or "
+                  "an object with an `allocator` method, as an argument");
+    return allocateFrame(frameAllocator(args...), size);
+  }
+
+  static auto operator delete(void* frame, usize size) noexcept -> void {
+    deallocateFrame(frame, size);
+  }
+
+private:
+  /// Allocates `size` bytes, storing `allocator` in front of them.
+  static auto allocateFrame(mem::Allocator& allocator, usize size) noexcept
+      -> void*;
+
+  /// Frees a frame with the allocator stored in front of it.
+  static auto deallocateFrame(void* frame, usize size) noexcept -> void;
+};
+
+template <class T> struct Promise : public PromiseBase {
+  Promise() noexcept = default;
+
+  ~Promise() noexcept {
+    if (this->_has_value) {
+      std::destroy_at(reinterpret_cast<T*>(this->_storage));
+    }
+  }
+
+  auto return_value(T value) noexcept -> void {
+    CBL_ASSERT(!this->_has_value, "The task returned twice");
+    std::construct_at(reinterpret_cast<T*>(this->_storage), std::move(value));
+    this->_has_value = true;
+  }
+
+  /// Moves out the value returned by the coroutine.
+  auto result() noexcept -> T {
+    CBL_ASSERT(this->_has_value, "The task has not returned");
+    return std::move(*reinterpret_cast<T*>(this->_storage));
+  }
+
+private:
+  alignas(T) u8 _storage[sizeof(T)];
+  bool          _has_value = false;
+};
+
+template <> struct Promise<void> : public PromiseBase {
+  auto return_void() const noexcept -> void {}
+
+  auto result() const noexcept -> void {}
+};
+
+} // namespace detail
+
+/// A coroutine that computes a `T`, e.g. from asynchronous I/O on an
+/// `EventLoop`.
+///
+/// Tasks are lazy: a task starts running when it is awaited with
+/// `co_await std::move(task)`, which resumes the awaiting coroutine with the
+/// task's result once it finishes, or when it is handed to
+/// `EventLoop::spawn`. Awaiting a task transfers control to it directly, so
+/// chains of tasks do not grow the stack.
+///
+/// The frame of a coroutine is allocated with the allocator of its first
+/// argument that is a `mem::Allocator`, or that has an `allocator` method
+/// (such as `EventLoop`), instead of the global `new`, so frames can come
+/// from an arena.
+///
+/// # Note
+///
+/// * The arguments of the coroutine are copied into its frame, but
+///   references are not: referenced objects must outlive the task.
+/// * Destroying a task that has started but not finished is Undefined
+///   Behavior.
+template <class T = void> struct [[nodiscard]] Task {
+  struct promise_type : public detail::Promise<T> {
+    auto get_return_object() noexcept -> Task {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+  };
+
+  explicit Task() noexcept              = delete;
+  Task(const Task&) noexcept            = delete;
+  Task& operator=(Task&&) noexcept      = delete;
+  Task& operator=(const Task&) noexcept = delete;
+
+  /// Takes the coroutine of `other`.
+  Task(Task&& other) noexcept
+      : _handle{std::exchange(other._handle, nullptr)} {}
+
+  /// Destroys the coroutine's frame.
+  ~Task() noexcept {
+    if (this->_handle) {
+      this->_handle.destroy();
+    }
+  }
+
+public:
+  /// Resumes the awaiting coroutine with the result of the task.
+  struct Awaiter {
+    std::coroutine_handle<promise_type> handle;
+
+    auto await_ready() const noexcept -> bool { return this->handle.done(); }
+
+    auto await_suspend(std::coroutine_handle<> awaiting) noexcept
+        -> std::coroutine_handle<> {
+      this->handle.promise().continuation = awaiting;
+      return this->handle;
+    }
+
+    auto await_resume() noexcept -> T {
+      return this->handle.promise().result();
+    }
+  };
+
+  /// Starts the task, resuming the awaiting coroutine when it finishes.
+  auto operator co_await() && noexcept -> Awaiter {
+    CBL_ASSERT(this->_handle, "The task was released");
+    return Awaiter{this->_handle};
+  }
+
+  /// Returns `true` if the task has finished.
+  auto isDone() const noexcept -> bool {
+    return this->_handle && this->_handle.done();
+  }
+
+  /// Gives up ownership of the coroutine, returning its handle.
+  auto release() noexcept -> std::coroutine_handle<promise_type> {
+    return std::exchange(this->_handle, nullptr);
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+      : _handle{handle} {}
+
+  std::coroutine_handle<promise_type> _handle;
+};
+
+} // namespace cbl::io
+
+#endif // !CBL_IO_TASK_H
@@ -1,12 +1,14 @@
 #ifndef CBL_IO_WRITER_H
 #define CBL_IO_WRITER_H
 
-#include "cbl/primitives.h" // u8, const_cstr
+#include "cbl/primitives.h" // u8, usize
 #include "cbl/slice.h"      // Slice
-#include <cstdarg>          // va_list
+#include <type_traits>      // type_identity_t
 
 namespace cbl::io {
 
+template <class... Args> struct FormatString;
+
 struct Writer {
   explicit Writer() noexcept                = default;
   Writer(Writer&&) noexcept                 = default;
@@ -18,18 +20,33 @@ struct Writer {
 public:
   /// Writes the buffer into the writer, returning the number of bytes
   /// written.
-  [[nodiscard]] virtual auto write(Slice<u8> buf) noexcept -> usize        = 0;
-
-  /// Writes a formatted string into the writer.
-  virtual auto formatV(const_cstr fmt, std::va_list args) noexcept -> void = 0;
+  [[nodiscard]] virtual auto write(Slice<u8> buf) noexcept -> usize = 0;
 
   /// Writes a formatted string into the writer.
-  auto         format(const_cstr fmt, ...) noexcept -> void;
-
-  /// Attempts to write the entire buffer into the writer.
-  auto         writeAll(Slice<u8> buf) noexcept -> void;
+  ///
+  /// Each `{}` in `fmt` is replaced by the next argument, formatted by its
+  /// `Formatter`. A single-character specifier may be given between the
+  /// braces (e.g. `{x}`), and `{{`/`}}` write literal braces.
+  ///
+  /// # Note
+  ///
+  /// The format string is parsed at compile time; a mismatched number of
+  /// arguments or an unsupported specifier is a compile error.
+  template <class... Args>
+  auto format(FormatString<std::type_identity_t<Args>...> fmt,
+              const Args&... args) noexcept -> void;
+
+  /// Attempts to write the entire buffer into the writer, returning the
+  /// number of bytes written.
+  ///
+  /// # Errors
+  ///
+  /// Returns less than `buf.len()` if the writer stops accepting bytes.
+  auto writeAll(Slice<u8> buf) noexcept -> usize;
 };
 
 } // namespace cbl::io
 
+#include "cbl/io/format.h" // FormatString, Writer::format
+
 #endif // !CBL_IO_WRITER_H
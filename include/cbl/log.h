@@ -0,0 +1,193 @@
+#ifndef CBL_LOG_H
+#define CBL_LOG_H
+
+#include "cbl/io/buffer_writer.h" // BufferWriter
+#include "cbl/io/format.h"        // FormatString
+#include "cbl/io/writer.h"        // Writer
+#include "cbl/mem/allocator.h"    // Allocator
+#include "cbl/primitives.h"       // u8, u32, usize, const_cstr
+#include "cbl/slice.h"            // Slice
+#include <atomic>                 // atomic
+#include <thread>                 // thread
+#include <type_traits>            // type_identity_t
+
+/// The lowest level that is compiled into the program.
+///
+/// Log calls below this level are removed at compile time; e.g. building with
+/// `-DCBL_LOG_LEVEL=2` removes all `trace` and `debug` calls.
+// clang-format off
+#ifndef CBL_LOG_LEVEL
+  #define CBL_LOG_LEVEL 0
+#endif // !CBL_LOG_LEVEL
+// clang-format on
+
+namespace cbl::log {
+
+enum class Level {
+  Trace = 0,
+  Debug = 1,
+  Info  = 2,
+  Warn  = 3,
+  Error = 4,
+};
+
+/// Returns the name of `level`.
+auto levelName(Level level) noexcept -> const_cstr;
+
+/// The longest message that can be logged; longer messages are truncated.
+inline constexpr usize MAX_MESSAGE_LEN = 240;
+
+namespace detail {
+
+/// Returns the calling thread's formatting buffer.
+auto threadBuffer() noexcept -> io::BufferWriter&;
+
+} // namespace detail
+
+/// An asynchronous logger.
+///
+/// Log calls format the message into a per-thread buffer and push it onto a
+/// bounded lock-free queue. A background thread drains the queue into the
+/// sink, so producers never block on I/O.
+///
+/// # Note
+///
+/// * Messages from a single thread are written in order.
+/// * The sink is only written to from the background thread.
+struct Logger {
+  /// What a producer does when the queue is full.
+  enum class Policy {
+    /// Discard the message (counted by `dropped`).
+    Drop,
+    /// Wait until the background thread frees a slot.
+    Block,
+  };
+
+  struct Options {
+    /// Number of messages the queue can hold; must be a power of 2.
+    usize  capacity = 1024;
+
+    /// Messages below this level are discarded at runtime.
+    Level  level    = Level::Trace;
+
+    Policy policy   = Policy::Drop;
+  };
+
+  explicit Logger() noexcept                = delete;
+  Logger(Logger&&) noexcept                 = delete;
+  Logger(const Logger&) noexcept            = delete;
+  Logger& operator=(Logger&&) noexcept      = delete;
+  Logger& operator=(const Logger&) noexcept = delete;
+
+public:
+  /// Creates a logger that writes into `sink`, starting its background
+  /// thread.
+  ///
+  /// # Note
+  ///
+  /// `allocator` and `sink` must outlive the logger.
+  explicit Logger(mem::Allocator& allocator, io::Writer& sink,
+                  Options options) noexcept;
+
+  /// Writes all queued messages and stops the background thread.
+  ~Logger() noexcept;
+
+  /// Logs a formatted message at level `L`.
+  ///
+  /// Returns `false` if the message was filtered out or dropped.
+  template <Level L, class... Args>
+  auto log(io::FormatString<std::type_identity_t<Args>...> fmt,
+           const Args&... args) noexcept -> bool {
+    if constexpr (static_cast<int>(L) < CBL_LOG_LEVEL) {
+      return false;
+    } else {
+      if (L < this->_level.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      io::BufferWriter& buf = detail::threadBuffer();
+      buf.reset();
+      buf.format(fmt, args...);
+      return this->push(L, buf.written());
+    }
+  }
+
+  template <class... Args>
+  auto trace(io::FormatString<std::type_identity_t<Args>...> fmt,
+             const Args&... args) noexcept -> bool {
+    return this->log<Level::Trace, Args...>(fmt, args...);
+  }
+
+  template <class... Args>
+  auto debug(io::FormatString<std::type_identity_t<Args>...> fmt,
+             const Args&... args) noexcept -> bool {
+    return this->log<Level::Debug, Args...>(fmt, args...);
+  }
+
+  template <class... Args>
+  auto info(io::FormatString<std::type_identity_t<Args>...> fmt,
+            const Args&... args) noexcept -> bool {
+    return this->log<Level::Info, Args...>(fmt, args...);
+  }
+
+  template <class... Args>
+  auto warn(io::FormatString<std::type_identity_t<Args>...> fmt,
+            const Args&... args) noexcept -> bool {
+    return this->log<Level::Warn, Args...>(fmt, args...);
+  }
+
+  template <class... Args>
+  auto error(io::FormatString<std::type_identity_t<Args>...> fmt,
+             const Args&... args) noexcept -> bool {
+    return this->log<Level::Error, Args...>(fmt, args...);
+  }
+
+  /// Pushes an already formatted message.
+  ///
+  /// Returns `false` if the message was dropped.
+  auto push(Level level, Slice<u8> msg) noexcept -> bool;
+
+  /// Blocks until every message pushed before the call has been written.
+  auto flush() noexcept -> void;
+
+  /// Sets the runtime level filter.
+  auto setLevel(Level level) noexcept -> void;
+
+  /// Returns the number of messages dropped because the queue was full.
+  auto dropped() const noexcept -> usize;
+
+private:
+  struct alignas(64) Slot {
+    std::atomic<usize> seq;
+    Level              level;
+    u32                len;
+    u8                 msg[MAX_MESSAGE_LEN];
+  };
+
+  mem::Allocator*    _allocator;
+  io::Writer*        _sink;
+  Slice<Slot>        _slots;
+  usize              _mask;
+  Policy             _policy;
+  std::atomic<Level> _level;
+  std::atomic<bool>  _running{true};
+  std::atomic<bool>  _sleeping{false};
+  std::atomic<usize> _dropped{0};
+  std::thread        _thread;
+
+  alignas(64) std::atomic<usize> _tail{0};
+  alignas(64) std::atomic<usize> _head{0};
+
+  /// Attempts to claim a slot and copy the message into it.
+  auto tryPush(Level level, Slice<u8> msg) noexcept -> bool;
+
+  /// Writes the next message into the sink, returning `false` if the queue
+  /// is empty.
+  auto drainOne() noexcept -> bool;
+
+  /// The background thread's loop.
+  auto run() noexcept -> void;
+};
+
+} // namespace cbl::log
+
+#endif // !CBL_LOG_H
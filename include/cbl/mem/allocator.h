@@ -4,6 +4,8 @@
 #include "cbl/mem/layout.h" // Layout
 #include "cbl/primitives.h" // u8, usize
 #include "cbl/slice.h"      // Slice
+#include <concepts>         // same_as
+#include <cstring>          // memset
 
 namespace cbl::mem {
 
@@ -147,6 +149,30 @@ public:
   auto         shrink(u8* ptr, Layout old_layout,
                       Layout new_layout) noexcept -> Slice<u8>;
 
+  /// Allocates a block of memory described by `layout` for every element of
+  /// `out`, storing the pointers to the blocks in `out`.
+  ///
+  /// Either all blocks are allocated or none are. The default implementation
+  /// calls `allocate` for every block; allocators override it when they can
+  /// hand out many blocks for the cost of one allocation.
+  ///
+  /// The allocated blocks of memory may or may not be initialized.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false`, leaving `out` unspecified, if either memory is exhausted
+  /// or `layout` does not meet the allocator's size or alignment constraints.
+  virtual auto allocateBatch(Layout layout, Slice<u8*> out) noexcept -> bool;
+
+  /// Deallocates every block of memory in `ptrs`, in reverse order.
+  ///
+  /// # Safety
+  ///
+  /// Every pointer in `ptrs` must abide by the safety considerations of
+  /// `deallocate`.
+  virtual auto deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+      -> void;
+
   /// Allocates memory for a single object of type `T`.
   ///
   /// The memory must be freed by calling `destroy`.
@@ -172,6 +198,55 @@ public:
     }
   }
 
+  /// Allocates memory for a single object of type `T` for every element of
+  /// `out`, storing the pointers to the objects in `out`.
+  ///
+  /// The objects are zero-initialized and must be freed by calling
+  /// `destroyMany` or `destroy`.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false`, leaving `out` unspecified, if the allocation fails.
+  template <class T> auto createMany(Slice<T*> out) noexcept -> bool {
+    const Layout layout = Layout::init<T>();
+
+    // Pointers are allocated through a buffer of `u8*`, since `T*` and `u8*`
+    // must not alias
+    u8* buf[BATCH_CHUNK];
+    for (usize done = 0; done < out.len(); done += BATCH_CHUNK) {
+      const usize rest = out.len() - done;
+      const usize n    = (rest < BATCH_CHUNK) ? rest : BATCH_CHUNK;
+      if (!this->allocateBatch(layout, Slice<u8*>{buf, n})) {
+        this->destroyMany(out.first(done));
+        return false;
+      }
+      for (usize i = 0; i < n; i++) {
+        std::memset(buf[i], 0, layout.size());
+        out[done + i] = reinterpret_cast<T*>(buf[i]);
+      }
+    }
+    return true;
+  }
+
+  /// Deallocates objects allocated by `createMany` or `create`.
+  ///
+  /// # Safety
+  ///
+  /// Calls function `deallocateBatch`, so it must abide by its safety
+  /// considerations.
+  template <class T> auto destroyMany(Slice<T*> ptrs) noexcept -> void {
+    const Layout layout = Layout::init<T>();
+    u8*          buf[BATCH_CHUNK];
+    for (usize end = ptrs.len(); end > 0;) {
+      const usize n = (end < BATCH_CHUNK) ? end : BATCH_CHUNK;
+      for (usize i = 0; i < n; i++) {
+        buf[i] = reinterpret_cast<u8*>(ptrs[end - n + i]);
+      }
+      this->deallocateBatch(Slice<u8*>{buf, n}, layout);
+      end -= n;
+    }
+  }
+
   /// Allocates memory for an array with `len` elements of type `T`.
   ///
   /// The returned reference must be freed by calling
@@ -201,8 +276,54 @@ public:
     Layout layout = Layout::array<T>(slice.len());
     this->deallocate(ptr, layout);
   }
+
+private:
+  /// The most pointers `createMany` and `destroyMany` pass to a batch call.
+  static constexpr usize BATCH_CHUNK = 64;
+};
+
+/// A type that can be used as an allocator.
+///
+/// Containers that take their allocator as a template parameter constrained
+/// by this concept call `allocate` and `deallocate` directly. When the
+/// allocator is a concrete `final` type like `FixedBufferAllocator`, the calls
+/// are resolved at compile time and can be inlined into the container's
+/// loops; passing an `Allocator&` instead keeps the type-erased, virtual
+/// dispatch.
+template <class A>
+concept AllocatorLike = requires(A& allocator, Layout layout, u8* ptr) {
+  { allocator.allocate(layout) } -> std::same_as<Slice<u8>>;
+  { allocator.deallocate(ptr, layout) } -> std::same_as<void>;
 };
 
+/// Allocates uninitialized memory for an array with `len` elements of type
+/// `T`.
+///
+/// The returned slice must be freed by calling `deallocateArray`.
+///
+/// # Errors
+///
+/// Returns an empty slice if the allocation fails.
+template <class T, AllocatorLike A>
+auto allocateArray(A& allocator, usize len) noexcept -> Slice<T> {
+  Slice<u8> mem = allocator.allocate(Layout::array<T>(len));
+  return Slice<T>{mem.as<T>(), mem.isEmpty() ? 0 : len};
+}
+
+/// Deallocates memory allocated by `allocateArray`.
+///
+/// # Safety
+///
+/// Calls the allocator's `deallocate` function, so it must abide by its
+/// safety considerations.
+template <class T, AllocatorLike A>
+auto deallocateArray(A& allocator, Slice<T> slice) noexcept -> void {
+  if (!slice.isEmpty()) {
+    allocator.deallocate(reinterpret_cast<u8*>(slice.ptr()),
+                         Layout::array<T>(slice.len()));
+  }
+}
+
 } // namespace cbl::mem
 
 #endif // !CBL_MEM_ALLOCATOR_H
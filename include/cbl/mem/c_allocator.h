@@ -8,7 +8,12 @@
 namespace cbl::mem {
 
 /// An allocator backed by the `malloc` and `free` functions.
-struct CAllocator : public Allocator {
+///
+/// # Note
+///
+/// A batch is carved out of a single `malloc` call, which is only given back
+/// to `free` once every block of the batch has been deallocated.
+struct CAllocator final : public Allocator {
   explicit CAllocator() noexcept                    = default;
   CAllocator(CAllocator&&) noexcept                 = default;
   CAllocator(const CAllocator&) noexcept            = default;
@@ -22,6 +27,16 @@ public:
 
   /// Deallocates memory using `free`.
   auto deallocate(u8* ptr, Layout layout) noexcept -> void override;
+
+  /// Allocates every block of the batch with a single call to `malloc`.
+  ///
+  /// The blocks can be deallocated one by one, from any thread.
+  auto allocateBatch(Layout layout, Slice<u8*> out) noexcept -> bool override;
+
+  /// Deallocates a batch of blocks, calling `free` for each batch that has no
+  /// blocks left.
+  auto deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+      -> void override;
 };
 
 } // namespace cbl::mem
@@ -1,13 +1,25 @@
 #ifndef CBL_MEM_FBA_H
 #define CBL_MEM_FBA_H
 
+#include "cbl/assert.h"        // CBL_ASSERT, CBL_ASSUME
 #include "cbl/mem/allocator.h" // Allocator
-#include "cbl/primitives.h"    // usize
+#include "cbl/mem/layout.h"    // Layout
+#include "cbl/primitives.h"    // u8, usize
 #include "cbl/slice.h"         // Slice
+#include <cstdint>             // uintptr_t
 
 namespace cbl::mem {
 
-struct FixedBufferAllocator : public Allocator {
+/// An allocator that hands out consecutive parts of a fixed buffer.
+///
+/// Allocating is a pointer increment, and is inlined when the allocator is
+/// used through its concrete type (see `AllocatorLike`).
+///
+/// # Note
+///
+/// Only the most recent allocation can be freed; freeing any other
+/// allocation does nothing. Call `reset` to free everything at once.
+struct FixedBufferAllocator final : public Allocator {
   explicit FixedBufferAllocator() noexcept                         = delete;
   FixedBufferAllocator(FixedBufferAllocator&&) noexcept            = default;
   FixedBufferAllocator(const FixedBufferAllocator&) noexcept       = delete;
@@ -21,10 +33,47 @@ public:
   explicit FixedBufferAllocator(Slice<u8> buf) noexcept;
 
   /// Allocates memory in the buffer.
-  auto allocate(Layout layout) noexcept -> Slice<u8> override;
+  ///
+  /// # Errors
+  ///
+  /// Returns an empty slice if the rest of the buffer is too small.
+  auto allocate(Layout layout) noexcept -> Slice<u8> override {
+    const usize len = this->_buf.len();
+    CBL_ASSUME(this->_pos <= len, "The position is outside the buffer");
+    const uintptr_t start     = reinterpret_cast<uintptr_t>(this->_buf.ptr());
+    const uintptr_t addr      = start + this->_pos;
+    const uintptr_t align     = layout.alignment();
+    const usize     padding   = static_cast<usize>((~addr + 1) & (align - 1));
+    const usize     remaining = len - this->_pos;
+    if ((padding > remaining) || (layout.size() > remaining - padding)) {
+      return Slice<u8>{};
+    }
+    u8* ptr     = this->_buf.ptr() + this->_pos + padding;
+    this->_pos += padding + layout.size();
+    return Slice<u8>{ptr, layout.size()};
+  }
 
-  /// Allocates memory from the buffer.
-  auto deallocate(u8* ptr, Layout layout) noexcept -> void override;
+  /// Frees the most recent allocation, and does nothing for any other.
+  auto deallocate(u8* ptr, Layout layout) noexcept -> void override {
+    CBL_ASSERT((ptr == nullptr) || this->ownsPtr(ptr),
+               "`ptr` was not allocated by this allocator");
+    if ((ptr != nullptr) &&
+        (ptr + layout.size() == this->_buf.ptr() + this->_pos)) {
+      this->_pos = static_cast<usize>(ptr - this->_buf.ptr());
+    }
+  }
+
+  /// Allocates every block of the batch with a single bump of the buffer.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false` if the rest of the buffer is too small for the batch.
+  auto allocateBatch(Layout layout, Slice<u8*> out) noexcept -> bool override;
+
+  /// Frees the blocks of the most recent batch, and does nothing for any
+  /// other blocks.
+  auto deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+      -> void override;
 
   /// Resets the allocator.
   auto reset() noexcept -> void;
@@ -1,14 +1,25 @@
 #ifndef CBL_MEM_LAYOUT_H
 #define CBL_MEM_LAYOUT_H
 
-#include "cbl/assert.h"     // CBL_ASSERT
+#include "cbl/assert.h"     // CBL_ASSERT, CBL_ASSUME
 #include "cbl/primitives.h" // usize, u16
-#include <stdckdint.h>      // ckd_mul
+#include <stdckdint.h>      // ckd_add, ckd_mul
 
 namespace cbl::mem {
 
 /// Describes a particular layout of memory.
 ///
+/// Every function is `constexpr`, so the layout of a type, or of a header
+/// followed by trailing arrays, can be computed at compile time:
+///
+/// ```
+/// // A header followed by `n` keys and `n` values, in one allocation
+/// const Layout::Extended keys   = Layout::init<Header>().extend(
+///     Layout::array<K>(n));
+/// const Layout::Extended values = keys.layout.extend(Layout::array<V>(n));
+/// const Layout           layout = values.layout.padToAlign();
+/// ```
+///
 /// # Note
 ///
 /// * This requires an alignment that is a power of 2.
@@ -22,22 +33,28 @@ struct Layout {
   ~Layout() noexcept                        = default;
 
 public:
+  struct Extended;
+
   /// Creates a new memory layout with the given size and alignment.
-  explicit Layout(usize size, u16 alignment) noexcept;
+  constexpr explicit Layout(usize size, u16 alignment) noexcept
+      : _size{size}, _alignment{alignment} {
+    CBL_ASSERT(isPowerOf2(alignment),
+               "Type `T` must have an alignment that is a power of 2");
+  }
 
   /// Creates a memory layout suitable for holding a value of type `T`.
-  template <class T> static auto init() noexcept -> Layout {
+  template <class T> static constexpr auto init() noexcept -> Layout {
     CBL_ASSERT(isPowerOf2(alignof(T)),
                "Type `T` must have an alignment that is a power of 2");
     return Layout{sizeof(T), alignof(T)};
   }
 
   /// Creates a memory layout for an array with `len` elements of type `T`.
-  template <class T> static auto array(usize len) noexcept -> Layout {
+  template <class T> static constexpr auto array(usize len) noexcept -> Layout {
     CBL_ASSERT(isPowerOf2(alignof(T)),
                "Type `T` must have an alignment that is a power of 2");
-    usize final_size;
-    bool  invalid = ckd_mul(&final_size, sizeof(T), len);
+    usize final_size = 0;
+    bool  invalid    = ckd_mul(&final_size, sizeof(T), len);
     CBL_ASSERT(invalid == false, "Multiplication overflowed");
     return Layout{final_size, alignof(T)};
   }
@@ -47,7 +64,8 @@ public:
   /// # Note
   ///
   /// `value` must be a single item pointer and must not be `nullptr`.
-  template <class T> static auto fromValue(T* value) noexcept -> Layout {
+  template <class T>
+  static constexpr auto fromValue(T* value) noexcept -> Layout {
     CBL_ASSERT(value != nullptr, "`value` must not be null");
     CBL_ASSERT(isPowerOf2(alignof(T)),
                "Type `T` must have an alignment that is a power of 2");
@@ -60,30 +78,103 @@ public:
   ///
   /// `arr` must be a multi-item pointer and must not be `nullptr`.
   template <class T>
-  static auto fromArray(T* arr, usize len) noexcept -> Layout {
+  static constexpr auto fromArray(T* arr, usize len) noexcept -> Layout {
     CBL_ASSERT(arr != nullptr, "`arr` must not be null");
     CBL_ASSERT(isPowerOf2(alignof(T)),
                "Type `T` must have an alignment that is a power of 2");
-    usize final_size;
-    bool  invalid = ckd_mul(&final_size, sizeof(T), len);
+    usize final_size = 0;
+    bool  invalid    = ckd_mul(&final_size, sizeof(T), len);
     CBL_ASSERT(invalid == false, "Multiplication overflowed");
     return Layout{final_size, alignof(T)};
   }
 
   /// Gets the size in bytes.
-  auto size() const noexcept -> usize;
+  constexpr auto size() const noexcept -> usize { return this->_size; }
 
   /// Gets the alignment in bytes.
-  auto alignment() const noexcept -> u16;
+  constexpr auto alignment() const noexcept -> u16 {
+    CBL_ASSUME((this->_alignment != 0) &&
+                   ((this->_alignment & (this->_alignment - 1)) == 0),
+               "The alignment must be a power of 2");
+    return this->_alignment;
+  }
+
+  /// Creates a layout with the same size, and an alignment of at least
+  /// `alignment`.
+  constexpr auto alignTo(u16 alignment) const noexcept -> Layout {
+    return Layout{this->_size,
+                  (alignment > this->_alignment) ? alignment
+                                                 : this->_alignment};
+  }
+
+  /// Creates a layout with the size rounded up to a multiple of the
+  /// alignment, which is the stride of the layout in an array.
+  constexpr auto padToAlign() const noexcept -> Layout {
+    return Layout{alignUp(this->_size, this->_alignment), this->_alignment};
+  }
+
+  /// Creates a layout for `n` consecutive instances of this layout, each
+  /// padded to its alignment.
+  constexpr auto repeat(usize n) const noexcept -> Layout {
+    usize final_size = 0;
+    bool  invalid    = ckd_mul(&final_size, this->padToAlign().size(), n);
+    CBL_ASSERT(invalid == false, "Multiplication overflowed");
+    return Layout{final_size, this->_alignment};
+  }
+
+  /// Creates a layout for this layout followed by `next`, placed at the next
+  /// offset aligned for it, and returns the offset of `next` along with it.
+  ///
+  /// # Note
+  ///
+  /// The size of the combined layout is not padded, so call `padToAlign`
+  /// once every field has been added.
+  constexpr auto extend(Layout next) const noexcept -> Extended;
+
+  constexpr auto operator==(const Layout& other) const noexcept -> bool {
+    return (this->_size == other._size) &&
+           (this->_alignment == other._alignment);
+  }
 
 private:
   usize       _size;
   u16         _alignment;
 
   /// Checks if an alignment is a power of 2.
-  static auto isPowerOf2(u16 alignment) -> bool;
+  static constexpr auto isPowerOf2(u16 alignment) noexcept -> bool {
+    return (alignment != 0) && ((alignment & (alignment - 1)) == 0);
+  }
+
+  /// Rounds `value` up to a multiple of `alignment`.
+  static constexpr auto alignUp(usize value, u16 alignment) noexcept
+      -> usize {
+    usize padded  = 0;
+    bool  invalid = ckd_add(&padded, value, alignment - 1);
+    CBL_ASSERT(invalid == false, "Addition overflowed");
+    return padded & ~static_cast<usize>(alignment - 1);
+  }
 };
 
+/// A layout made by `Layout::extend`, and the offset of the added layout in
+/// it.
+struct Layout::Extended {
+  Layout layout;
+  usize  offset;
+};
+
+constexpr auto Layout::extend(Layout next) const noexcept -> Extended {
+  const usize offset     = alignUp(this->_size, next._alignment);
+  usize       final_size = 0;
+  bool        invalid    = ckd_add(&final_size, offset, next._size);
+  CBL_ASSERT(invalid == false, "Addition overflowed");
+  return Extended{
+      Layout{final_size, (next._alignment > this->_alignment)
+                             ? next._alignment
+                             : this->_alignment},
+      offset,
+  };
+}
+
 } // namespace cbl::mem
 
 #endif // !CBL_MEM_LAYOUT_H
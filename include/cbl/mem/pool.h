@@ -0,0 +1,102 @@
+#ifndef CBL_MEM_POOL_H
+#define CBL_MEM_POOL_H
+
+#include "cbl/intrusive_list.h" // SList, SListLink
+#include "cbl/mem/allocator.h"  // Allocator
+#include "cbl/mem/layout.h"     // Layout
+#include "cbl/primitives.h"     // u8, u16, usize
+#include "cbl/slice.h"          // Slice
+
+namespace cbl::mem {
+
+/// An allocator for blocks of a single size.
+///
+/// Blocks are carved out of large slabs allocated by a backing allocator, and
+/// freed blocks are kept in a free list for reuse, so allocating and freeing
+/// are a few instructions and blocks allocated together are close together in
+/// memory.
+struct PoolAllocator final : public Allocator {
+  explicit PoolAllocator() noexcept                       = delete;
+  PoolAllocator(PoolAllocator&&) noexcept                 = default;
+  PoolAllocator(const PoolAllocator&) noexcept            = delete;
+  PoolAllocator& operator=(PoolAllocator&&) noexcept      = default;
+  PoolAllocator& operator=(const PoolAllocator&) noexcept = delete;
+  ~PoolAllocator() noexcept                               = default;
+
+public:
+  /// The default size of the slabs requested from the backing allocator.
+  static constexpr usize SLAB_SIZE = 64 * 1024;
+
+  /// Creates a pool of blocks that fit `block`, allocating slabs of at least
+  /// `slab_size` bytes from `backing`.
+  ///
+  /// # Note
+  ///
+  /// `backing` must outlive the pool.
+  explicit PoolAllocator(Allocator& backing, Layout block,
+                         usize slab_size = SLAB_SIZE) noexcept;
+
+  /// Frees every slab, including blocks that are still allocated.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void;
+
+  /// Allocates a block.
+  ///
+  /// # Errors
+  ///
+  /// Returns an empty slice if `layout` does not fit in a block or the backing
+  /// allocator fails.
+  auto allocate(Layout layout) noexcept -> Slice<u8> override;
+
+  /// Returns a block to the pool.
+  auto deallocate(u8* ptr, Layout layout) noexcept -> void override;
+
+  /// Allocates a batch of blocks, taking freed blocks first and carving the
+  /// rest out of the current slab.
+  ///
+  /// # Errors
+  ///
+  /// Returns `false` if `layout` does not fit in a block or the backing
+  /// allocator fails.
+  auto allocateBatch(Layout layout, Slice<u8*> out) noexcept -> bool override;
+
+  /// Returns a batch of blocks to the pool.
+  auto deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+      -> void override;
+
+  /// Returns the size of the blocks.
+  auto blockSize() const noexcept -> usize { return this->_block_size; }
+
+private:
+  /// Stored in each freed block.
+  struct FreeBlock {
+    SListLink link;
+  };
+
+  /// Stored at the start of each slab.
+  struct SlabHeader {
+    SListLink link;
+  };
+
+  Allocator*                           _backing;
+  usize                                _block_size;
+  usize                                _block_align;
+  usize                                _slab_size;
+  u16                                  _slab_align;
+  SList<FreeBlock, &FreeBlock::link>   _free;
+  SList<SlabHeader, &SlabHeader::link> _slabs;
+
+  /// The unused part of the newest slab.
+  u8* _bump     = nullptr;
+  u8* _bump_end = nullptr;
+
+  auto allocateSlab() noexcept -> bool;
+};
+
+} // namespace cbl::mem
+
+#endif // !CBL_MEM_POOL_H
@@ -1,14 +1,15 @@
 #ifndef CBL_PRIMITIVES_H
 #define CBL_PRIMITIVES_H
 
-#include <cstddef> // size_t
+#include <cstddef>     // size_t
+#include <type_traits> // is_integral_v, is_same_v
 
 namespace cbl {
 
-typedef _BitInt(8) u8;
-typedef _BitInt(16) u16;
-typedef _BitInt(32) u32;
-typedef _BitInt(64) u64;
+typedef unsigned _BitInt(8) u8;
+typedef unsigned _BitInt(16) u16;
+typedef unsigned _BitInt(32) u32;
+typedef unsigned _BitInt(64) u64;
 typedef std::size_t usize;
 
 typedef signed _BitInt(8) i8;
@@ -26,6 +27,26 @@ typedef const char* const_cstr;
 typedef void*       any;
 typedef const void* const_any;
 
+/// Satisfied by the builtin integer types (except `bool`) and the
+/// fixed-width aliases above.
+///
+/// # Note
+///
+/// `std::is_integral` does not recognize `_BitInt` types, so generic code
+/// should use this instead.
+template <class T>
+concept Integer =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    std::is_same_v<T, u8> || std::is_same_v<T, u16> ||
+    std::is_same_v<T, u32> || std::is_same_v<T, u64> ||
+    std::is_same_v<T, i8> || std::is_same_v<T, i16> ||
+    std::is_same_v<T, i32> || std::is_same_v<T, i64>;
+
+/// Returns `true` if the integer type `T` is signed.
+template <Integer T> constexpr auto isSigned() noexcept -> bool {
+  return T(-1) < T(0);
+}
+
 } // namespace cbl
 
 #endif // !CBL_PRIMITIVES_H
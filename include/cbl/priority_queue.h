@@ -0,0 +1,368 @@
+#ifndef CBL_PRIORITY_QUEUE_H
+#define CBL_PRIORITY_QUEUE_H
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u32, usize
+#include "cbl/slice.h"         // Slice
+#include "cbl/slot_map.h"      // SlotMap
+#include <functional>          // less
+
+namespace cbl {
+
+namespace detail {
+
+/// The number of children of each heap node.
+///
+/// The children of a node share a cache line for most element sizes, and the
+/// heap is half as deep as a binary heap, so sifting down touches fewer lines
+/// at the cost of more comparisons per level.
+inline constexpr usize HEAP_ARITY = 4;
+
+/// Moves `heap[idx]` towards the root until its parent is not greater.
+///
+/// `on_move(elem, pos)` is called for every element placed at a new position.
+template <class T, class Less, class OnMove>
+auto heapSiftUp(T* heap, usize idx, Less& less, OnMove& on_move) noexcept
+    -> void {
+  T value = heap[idx];
+  while (idx > 0) {
+    const usize parent = (idx - 1) / HEAP_ARITY;
+    if (!less(value, heap[parent])) {
+      break;
+    }
+    heap[idx] = heap[parent];
+    on_move(heap[idx], idx);
+    idx = parent;
+  }
+  heap[idx] = value;
+  on_move(heap[idx], idx);
+}
+
+/// Moves `heap[idx]` towards the leaves until none of its children are less.
+///
+/// `on_move(elem, pos)` is called for every element placed at a new position.
+template <class T, class Less, class OnMove>
+auto heapSiftDown(T* heap, usize len, usize idx, Less& less,
+                  OnMove& on_move) noexcept -> void {
+  T value = heap[idx];
+  while (true) {
+    const usize first = idx * HEAP_ARITY + 1;
+    if (first >= len) {
+      break;
+    }
+    const usize end  = (first + HEAP_ARITY < len) ? first + HEAP_ARITY : len;
+    usize       best = first;
+    for (usize c = first + 1; c < end; c++) {
+      if (less(heap[c], heap[best])) {
+        best = c;
+      }
+    }
+    if (!less(heap[best], value)) {
+      break;
+    }
+    heap[idx] = heap[best];
+    on_move(heap[idx], idx);
+    idx = best;
+  }
+  heap[idx] = value;
+  on_move(heap[idx], idx);
+}
+
+} // namespace detail
+
+/// A priority queue implemented as a 4-ary heap.
+///
+/// The top of the queue is the *smallest* element according to `Less`; use
+/// `std::greater` for a max-queue.
+template <class T, class Less = std::less<T>> struct PriorityQueue {
+  explicit PriorityQueue() noexcept                       = delete;
+  PriorityQueue(PriorityQueue&&) noexcept                 = default;
+  PriorityQueue(const PriorityQueue&) noexcept            = delete;
+  PriorityQueue& operator=(PriorityQueue&&) noexcept      = default;
+  PriorityQueue& operator=(const PriorityQueue&) noexcept = delete;
+  ~PriorityQueue() noexcept                               = default;
+
+public:
+  /// Creates an empty queue that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the queue.
+  explicit PriorityQueue(mem::Allocator& allocator, Less less = Less{}) noexcept
+      : _allocator{&allocator}, _less{less} {}
+
+  /// Creates a queue from the elements of `slice`.
+  ///
+  /// This is O(N), unlike pushing the elements one by one which is
+  /// O(N log N).
+  static auto fromSlice(mem::Allocator& allocator, Slice<const T> slice,
+                        Less less = Less{}) noexcept -> PriorityQueue {
+    PriorityQueue self{allocator, less};
+    self._heap = UnmanagedDynamicArray<T>::initWithCapacity(allocator,
+                                                            slice.len());
+    for (const T& value : slice) {
+      self._heap.append(allocator, value);
+    }
+
+    // Sift down every node that has children, starting from the last one
+    const usize len = self._heap.len();
+    if (len > 1) {
+      for (usize i = (len - 2) / detail::HEAP_ARITY + 1; i > 0; i--) {
+        detail::heapSiftDown(self._heap.elems().ptr(), len, i - 1, self._less,
+                             IGNORE_MOVE);
+      }
+    }
+    return self;
+  }
+
+  /// Frees all memory allocated by the queue.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void { this->_heap.deinit(*this->_allocator); }
+
+  /// Returns the number of elements in the queue.
+  auto len() const noexcept -> usize { return this->_heap.len(); }
+
+  /// Returns `true` if the queue has no elements.
+  auto isEmpty() const noexcept -> bool { return this->_heap.len() == 0; }
+
+  /// Adds `value` to the queue.
+  auto push(T value) noexcept -> void {
+    this->_heap.append(*this->_allocator, value);
+    detail::heapSiftUp(this->_heap.elems().ptr(), this->_heap.len() - 1,
+                       this->_less, IGNORE_MOVE);
+  }
+
+  /// Returns a pointer to the top element, or `nullptr` if the queue is
+  /// empty.
+  auto peek() const noexcept -> const T* {
+    return this->isEmpty() ? nullptr : this->_heap.elems().ptr();
+  }
+
+  /// Removes the top element and stores it in `out`, returning `false` if the
+  /// queue is empty.
+  auto pop(T* out) noexcept -> bool {
+    if (this->isEmpty()) {
+      return false;
+    }
+    *out = this->_heap.swapRemove(0);
+    if (!this->isEmpty()) {
+      detail::heapSiftDown(this->_heap.elems().ptr(), this->_heap.len(), 0,
+                           this->_less, IGNORE_MOVE);
+    }
+    return true;
+  }
+
+  /// Removes every element, keeping the reserved memory.
+  auto clear() noexcept -> void { this->_heap.clear(); }
+
+private:
+  struct IgnoreMove {
+    auto operator()(const T&, usize) const noexcept -> void {}
+  };
+  static constexpr IgnoreMove IGNORE_MOVE = {};
+
+  mem::Allocator*          _allocator;
+  UnmanagedDynamicArray<T> _heap;
+  Less                     _less;
+};
+
+/// A priority queue whose elements can be updated or removed through handles.
+///
+/// The top of the queue is the *smallest* element according to `Less`.
+template <class T, class Less = std::less<T>> struct IndexedPriorityQueue {
+  explicit IndexedPriorityQueue() noexcept                         = delete;
+  IndexedPriorityQueue(IndexedPriorityQueue&&) noexcept            = default;
+  IndexedPriorityQueue(const IndexedPriorityQueue&) noexcept       = delete;
+  IndexedPriorityQueue& operator=(IndexedPriorityQueue&&) noexcept = default;
+  IndexedPriorityQueue&
+  operator=(const IndexedPriorityQueue&) noexcept = delete;
+  ~IndexedPriorityQueue() noexcept                = default;
+
+public:
+  /// Refers to an element in the queue.
+  ///
+  /// Handles of removed elements are detected as stale.
+  using Handle = typename SlotMap<u32>::Handle;
+
+  /// Creates an empty queue that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the queue.
+  explicit IndexedPriorityQueue(mem::Allocator& allocator,
+                                Less            less = Less{}) noexcept
+      : _allocator{&allocator}, _positions{allocator}, _less{less} {}
+
+  /// Frees all memory allocated by the queue.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void {
+    this->_heap.deinit(*this->_allocator);
+    this->_positions.deinit();
+  }
+
+  /// Returns the number of elements in the queue.
+  auto len() const noexcept -> usize { return this->_heap.len(); }
+
+  /// Returns `true` if the queue has no elements.
+  auto isEmpty() const noexcept -> bool { return this->_heap.len() == 0; }
+
+  /// Adds `value` to the queue, returning its handle.
+  auto push(T value) noexcept -> Handle {
+    const usize  pos    = this->_heap.len();
+    const Handle handle = this->_positions.insert(static_cast<u32>(pos));
+    this->_heap.append(*this->_allocator, Entry{value, handle});
+    this->siftUp(pos);
+    return handle;
+  }
+
+  /// Returns a pointer to the top element, or `nullptr` if the queue is
+  /// empty.
+  auto peek() const noexcept -> const T* {
+    return this->isEmpty() ? nullptr : &this->_heap.elems().ptr()->value;
+  }
+
+  /// Removes the top element and stores it in `out`, returning `false` if the
+  /// queue is empty.
+  auto pop(T* out) noexcept -> bool {
+    if (this->isEmpty()) {
+      return false;
+    }
+    const Handle top = this->_heap.elems().ptr()->handle;
+    return this->remove(top, out);
+  }
+
+  /// Returns `true` if `handle` refers to an element in the queue.
+  auto contains(Handle handle) const noexcept -> bool {
+    return this->_positions.contains(handle);
+  }
+
+  /// Returns a pointer to the element of `handle`, or `nullptr` if the handle
+  /// is stale.
+  ///
+  /// # Safety
+  ///
+  /// The element must not be modified through the pointer; use `update`.
+  auto get(Handle handle) const noexcept -> const T* {
+    const u32* pos = this->_positions.getPtr(handle);
+    return (pos == nullptr) ? nullptr
+                            : &this->_heap.elems().ptr()[*pos].value;
+  }
+
+  /// Moves the element of `handle` towards the top by replacing it with
+  /// `value`, returning `false` if the handle is stale.
+  ///
+  /// # Note
+  ///
+  /// `value` must not be greater than the current value.
+  auto decreaseKey(Handle handle, T value) noexcept -> bool {
+    const u32* pos = this->_positions.getPtr(handle);
+    if (pos == nullptr) {
+      return false;
+    }
+    Entry& entry = this->_heap.elems().ptr()[*pos];
+    CBL_ASSERT(!this->_less(entry.value, value),
+               "The new value must not be greater than the current one");
+    entry.value = value;
+    this->siftUp(*pos);
+    return true;
+  }
+
+  /// Replaces the element of `handle` with `value`, returning `false` if the
+  /// handle is stale.
+  auto update(Handle handle, T value) noexcept -> bool {
+    const u32* pos = this->_positions.getPtr(handle);
+    if (pos == nullptr) {
+      return false;
+    }
+    this->_heap.elems().ptr()[*pos].value = value;
+    this->restore(*pos);
+    return true;
+  }
+
+  /// Removes the element of `handle` and stores it in `out`, returning `false`
+  /// if the handle is stale.
+  auto remove(Handle handle, T* out) noexcept -> bool {
+    const u32* ptr = this->_positions.getPtr(handle);
+    if (ptr == nullptr) {
+      return false;
+    }
+    const usize pos = *ptr;
+    *out            = this->_heap.swapRemove(pos).value;
+    this->_positions.remove(handle);
+
+    // The last element was moved into the hole
+    if (pos < this->_heap.len()) {
+      this->restore(pos);
+    }
+    return true;
+  }
+
+private:
+  struct Entry {
+    T      value;
+    Handle handle;
+  };
+
+  /// Orders entries by their values.
+  struct EntryLess {
+    Less* less;
+
+    auto operator()(const Entry& a, const Entry& b) const noexcept -> bool {
+      return (*this->less)(a.value, b.value);
+    }
+  };
+
+  /// Records the new position of moved entries.
+  struct TrackMove {
+    SlotMap<u32>* positions;
+
+    auto operator()(const Entry& entry, usize pos) const noexcept -> void {
+      *this->positions->getPtr(entry.handle) = static_cast<u32>(pos);
+    }
+  };
+
+  mem::Allocator*              _allocator;
+  UnmanagedDynamicArray<Entry> _heap;
+  /// The position of each element in `_heap`.
+  SlotMap<u32>                 _positions;
+  Less                         _less;
+
+  auto siftUp(usize pos) noexcept -> void {
+    EntryLess less{&this->_less};
+    TrackMove on_move{&this->_positions};
+    detail::heapSiftUp(this->_heap.elems().ptr(), pos, less, on_move);
+  }
+
+  auto siftDown(usize pos) noexcept -> void {
+    EntryLess less{&this->_less};
+    TrackMove on_move{&this->_positions};
+    detail::heapSiftDown(this->_heap.elems().ptr(), this->_heap.len(), pos,
+                         less, on_move);
+  }
+
+  /// Restores the heap order after the element at `pos` changed.
+  auto restore(usize pos) noexcept -> void {
+    const Entry* heap = this->_heap.elems().ptr();
+    if ((pos > 0) &&
+        this->_less(heap[pos].value,
+                    heap[(pos - 1) / detail::HEAP_ARITY].value)) {
+      this->siftUp(pos);
+    } else {
+      this->siftDown(pos);
+    }
+  }
+};
+
+} // namespace cbl
+
+#endif // !CBL_PRIORITY_QUEUE_H
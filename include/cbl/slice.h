@@ -1,8 +1,9 @@
 #ifndef CBL_SLICE_H
 #define CBL_SLICE_H
 
-#include "cbl/assert.h"     // CBL_ASSERT
+#include "cbl/assert.h"     // CBL_ASSERT, CBL_ASSUME
 #include "cbl/primitives.h" // usize
+#include <type_traits>      // is_const_v
 
 namespace cbl {
 
@@ -20,9 +21,79 @@ template <class T> struct Slice {
   ~Slice() noexcept                       = default;
 
 public:
+  /// Iterates over non-overlapping sub-slices; see `Slice::chunks`.
+  struct Chunks {
+    explicit Chunks() noexcept                = delete;
+    Chunks(Chunks&&) noexcept                 = default;
+    Chunks(const Chunks&) noexcept            = default;
+    Chunks& operator=(Chunks&&) noexcept      = default;
+    Chunks& operator=(const Chunks&) noexcept = default;
+    ~Chunks() noexcept                        = default;
+
+  public:
+    explicit Chunks(T* ptr, usize len, usize size) noexcept
+        : _ptr{ptr}, _len{len}, _size{size} {}
+
+    /// Stores the next chunk in `out`, returning `false` if there are no
+    /// chunks left.
+    auto next(Slice* out) noexcept -> bool {
+      if (this->_len == 0) {
+        return false;
+      }
+      const usize len  = (this->_len < this->_size) ? this->_len : this->_size;
+      *out             = Slice{this->_ptr, len};
+      this->_ptr      += len;
+      this->_len      -= len;
+      return true;
+    }
+
+  private:
+    T*    _ptr;
+    usize _len;
+    usize _size;
+  };
+
+  /// Iterates over overlapping sub-slices; see `Slice::windows`.
+  struct Windows {
+    explicit Windows() noexcept                 = delete;
+    Windows(Windows&&) noexcept                 = default;
+    Windows(const Windows&) noexcept            = default;
+    Windows& operator=(Windows&&) noexcept      = default;
+    Windows& operator=(const Windows&) noexcept = default;
+    ~Windows() noexcept                         = default;
+
+  public:
+    explicit Windows(T* ptr, usize len, usize size) noexcept
+        : _ptr{ptr}, _len{len}, _size{size} {}
+
+    /// Stores the next window in `out`, returning `false` if there are no
+    /// windows left.
+    auto next(Slice* out) noexcept -> bool {
+      if (this->_size > this->_len) {
+        return false;
+      }
+      *out        = Slice{this->_ptr, this->_size};
+      this->_ptr += 1;
+      this->_len -= 1;
+      return true;
+    }
+
+  private:
+    T*    _ptr;
+    usize _len;
+    usize _size;
+  };
+
   /// Creates a slice from a raw pointer and length.
   explicit Slice(T* ptr, usize len) noexcept : _ptr{ptr}, _len{len} {}
 
+  /// Converts the slice into a read-only slice.
+  template <class U = T>
+    requires(!std::is_const_v<U>)
+  operator Slice<const U>() const noexcept { // NOLINT
+    return Slice<const U>{this->_ptr, this->_len};
+  }
+
   /// Returns `true` if the slice is empty.
   auto isEmpty() const noexcept {
     return (this->_ptr == nullptr) || (this->_len == 0);
@@ -40,9 +111,8 @@ public:
   ///
   /// The `idx` must be less than the slice's length.
   auto getPtr(usize idx) const noexcept -> const T* {
-    CBL_ASSERT(idx < this->_len, "The index is outside the slice's bounds");
-    return reinterpret_cast<T*>(reinterpret_cast<u8*>(this->_ptr) +
-                                (idx * sizeof(T)));
+    CBL_ASSUME(idx < this->_len, "The index is outside the slice's bounds");
+    return this->_ptr + idx;
   }
 
   /// Gets a mutable pointer to the value of the slice at `idx`.
@@ -51,9 +121,8 @@ public:
   ///
   /// The `idx` must be less than the slice's length.
   auto getPtrMut(usize idx) noexcept -> T* {
-    CBL_ASSERT(idx < this->_len, "The index is outside the slice's bounds");
-    return reinterpret_cast<T*>(reinterpret_cast<u8*>(this->_ptr) +
-                                (idx * sizeof(T)));
+    CBL_ASSUME(idx < this->_len, "The index is outside the slice's bounds");
+    return this->_ptr + idx;
   }
 
   /// Returns a const reference to the value at `idx`.
@@ -62,11 +131,79 @@ public:
   /// Returns a reference to the value at `idx`.
   auto operator[](usize idx) noexcept -> T& { return *getPtrMut(idx); }
 
+  /// Returns a reference to the value at `idx` without checking the bounds.
+  ///
+  /// # Safety
+  ///
+  /// The `idx` must be less than the slice's length.
+  auto getUnchecked(usize idx) const noexcept -> T& { return this->_ptr[idx]; }
+
   /// Returns the slice as a `U*`.
   template <class U> auto as() noexcept -> U* {
     return reinterpret_cast<U*>(this->_ptr);
   }
 
+  /// Returns a pointer to the first element, for range-based `for` loops.
+  auto begin() const noexcept -> T* { return this->_ptr; }
+
+  /// Returns a pointer one past the last element, for range-based `for`
+  /// loops.
+  auto end() const noexcept -> T* { return this->_ptr + this->_len; }
+
+  /// Returns the elements in the range `[start, end)`.
+  ///
+  /// # Note
+  ///
+  /// `start` must not be greater than `end`, and `end` must not be greater
+  /// than the slice's length.
+  auto subslice(usize start, usize end) const noexcept -> Slice {
+    CBL_ASSUME(start <= end, "The start of the range is after its end");
+    CBL_ASSUME(end <= this->_len, "The range is outside the slice's bounds");
+    return Slice{this->_ptr + start, end - start};
+  }
+
+  /// Returns the first `n` elements.
+  ///
+  /// # Note
+  ///
+  /// `n` must not be greater than the slice's length.
+  auto first(usize n) const noexcept -> Slice { return this->subslice(0, n); }
+
+  /// Returns the last `n` elements.
+  ///
+  /// # Note
+  ///
+  /// `n` must not be greater than the slice's length.
+  auto last(usize n) const noexcept -> Slice {
+    CBL_ASSUME(n <= this->_len, "The range is outside the slice's bounds");
+    return Slice{this->_ptr + (this->_len - n), n};
+  }
+
+  /// Returns an iterator over consecutive sub-slices of `size` elements.
+  ///
+  /// The last chunk is shorter if the length is not a multiple of `size`.
+  ///
+  /// # Note
+  ///
+  /// `size` must not be zero.
+  auto chunks(usize size) const noexcept -> Chunks {
+    CBL_ASSERT(size != 0, "The chunk size must not be zero");
+    return Chunks{this->_ptr, this->_len, size};
+  }
+
+  /// Returns an iterator over every sub-slice of `size` consecutive
+  /// elements, in order of their start index.
+  ///
+  /// There are no windows if `size` is greater than the slice's length.
+  ///
+  /// # Note
+  ///
+  /// `size` must not be zero.
+  auto windows(usize size) const noexcept -> Windows {
+    CBL_ASSERT(size != 0, "The window size must not be zero");
+    return Windows{this->_ptr, this->_len, size};
+  }
+
 private:
   T*    _ptr = 0;
   usize _len = 0;
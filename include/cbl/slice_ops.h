@@ -0,0 +1,305 @@
+#ifndef CBL_SLICE_OPS_H
+#define CBL_SLICE_OPS_H
+
+#include "cbl/assert.h"     // CBL_ASSERT
+#include "cbl/primitives.h" // usize, f32, f64, Integer, isSigned
+#include "cbl/slice.h"      // Slice
+#include <bit>              // bit_cast
+#include <cstdint>          // int8_t, uint8_t, ..., int64_t, uint64_t
+#include <cstring>          // memcpy, memmove, memset, memcmp
+#include <type_traits>      // is_same_v, remove_const_t, type_identity_t
+
+/// Bulk operations on slices.
+///
+/// Operations on integer and floating point elements run vectorized kernels
+/// that use SSE2, AVX2 or AVX-512 depending on what the CPU supports; other
+/// element types fall back to scalar loops.
+namespace cbl::slice {
+
+/// Returned by searches when nothing was found.
+inline constexpr usize NOT_FOUND = static_cast<usize>(-1);
+
+namespace detail {
+
+// Kernels are explicitly instantiated in `slice_ops.cpp` for the standard
+// fixed-width integers, `float` and `double`.
+
+template <class K>
+auto indexOfKernel(const K* ptr, usize len, K value) noexcept -> usize;
+
+template <class K>
+auto countKernel(const K* ptr, usize len, K value) noexcept -> usize;
+
+template <class K>
+auto countLessKernel(const K* ptr, usize len, K value) noexcept -> usize;
+
+template <class K> auto fillKernel(K* ptr, usize len, K value) noexcept -> void;
+
+template <class K> auto minKernel(const K* ptr, usize len) noexcept -> K;
+
+template <class K> auto maxKernel(const K* ptr, usize len) noexcept -> K;
+
+template <class K> auto sumKernel(const K* ptr, usize len) noexcept -> K;
+
+template <usize SIZE, bool SIGNED> struct IntLane;
+template <> struct IntLane<1, true> { using Type = std::int8_t; };
+template <> struct IntLane<1, false> { using Type = std::uint8_t; };
+template <> struct IntLane<2, true> { using Type = std::int16_t; };
+template <> struct IntLane<2, false> { using Type = std::uint16_t; };
+template <> struct IntLane<4, true> { using Type = std::int32_t; };
+template <> struct IntLane<4, false> { using Type = std::uint32_t; };
+template <> struct IntLane<8, true> { using Type = std::int64_t; };
+template <> struct IntLane<8, false> { using Type = std::uint64_t; };
+
+/// Integers that have a kernel.
+template <class T>
+concept IntElement = Integer<T> && ((sizeof(T) == 1) || (sizeof(T) == 2) ||
+                                    (sizeof(T) == 4) || (sizeof(T) == 8));
+
+/// Floating point numbers that have a kernel.
+template <class T>
+concept FloatElement = std::is_same_v<T, f32> || std::is_same_v<T, f64>;
+
+/// The kernel type used for ordering and arithmetic on `T`.
+template <class T> struct Lane;
+template <IntElement T> struct Lane<T> {
+  using Type = typename IntLane<sizeof(T), isSigned<T>()>::Type;
+};
+template <FloatElement T> struct Lane<T> { using Type = T; };
+
+/// The kernel type used for equality on `T`.
+///
+/// Integers of the same width are equal exactly when their bits are, so
+/// signedness does not matter.
+template <IntElement T>
+using BitsLane = typename IntLane<sizeof(T), false>::Type;
+
+template <class K, class T> auto lanePtr(T* ptr) noexcept -> K* {
+  return reinterpret_cast<K*>(ptr);
+}
+
+/// The element type of a `Slice<T>` or `Slice<const T>`.
+template <class T> using Elem = std::remove_const_t<T>;
+
+} // namespace detail
+
+/// Copies `src` into the start of `dst`.
+///
+/// # Note
+///
+/// `dst` must be at least as long as `src`, and the slices must not overlap
+/// (use `move` for overlapping slices).
+template <class T>
+auto copy(Slice<T> dst, std::type_identity_t<Slice<const T>> src) noexcept
+    -> void {
+  CBL_ASSERT(dst.len() >= src.len(), "The destination is too short");
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    if (src.len() != 0) {
+      std::memcpy(dst.ptr(), src.ptr(), src.len() * sizeof(T));
+    }
+  } else {
+    for (usize i = 0; i < src.len(); i++) {
+      dst.ptr()[i] = src.ptr()[i];
+    }
+  }
+}
+
+/// Copies `src` into the start of `dst`, which may overlap `src`.
+///
+/// # Note
+///
+/// `dst` must be at least as long as `src`.
+template <class T>
+auto move(Slice<T> dst, std::type_identity_t<Slice<const T>> src) noexcept
+    -> void {
+  CBL_ASSERT(dst.len() >= src.len(), "The destination is too short");
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    if (src.len() != 0) {
+      std::memmove(dst.ptr(), src.ptr(), src.len() * sizeof(T));
+    }
+  } else if (dst.ptr() < src.ptr()) {
+    for (usize i = 0; i < src.len(); i++) {
+      dst.ptr()[i] = src.ptr()[i];
+    }
+  } else {
+    for (usize i = src.len(); i > 0; i--) {
+      dst.ptr()[i - 1] = src.ptr()[i - 1];
+    }
+  }
+}
+
+/// Sets every element of `dst` to `value`.
+template <class T>
+auto fill(Slice<T> dst, const std::type_identity_t<T>& value) noexcept -> void {
+  if constexpr (detail::IntElement<T> && (sizeof(T) == 1)) {
+    std::memset(dst.ptr(), static_cast<int>(std::bit_cast<std::uint8_t>(value)),
+                dst.len());
+  } else if constexpr (detail::IntElement<T>) {
+    using K = detail::BitsLane<T>;
+    detail::fillKernel(detail::lanePtr<K>(dst.ptr()), dst.len(),
+                       std::bit_cast<K>(value));
+  } else {
+    for (usize i = 0; i < dst.len(); i++) {
+      dst.ptr()[i] = value;
+    }
+  }
+}
+
+/// Returns `true` if `a` and `b` have the same length and equal elements.
+template <class T>
+auto equal(Slice<T> a, std::type_identity_t<Slice<const T>> b) noexcept
+    -> bool {
+  using E = detail::Elem<T>;
+  if (a.len() != b.len()) {
+    return false;
+  }
+  if constexpr (detail::IntElement<E> || std::is_same_v<E, bool>) {
+    // `memcmp` is already vectorized by the C library
+    return (a.len() == 0) ||
+           (std::memcmp(a.ptr(), b.ptr(), a.len() * sizeof(T)) == 0);
+  } else {
+    for (usize i = 0; i < a.len(); i++) {
+      if (!(a.ptr()[i] == b.ptr()[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+/// Returns the index of the first element equal to `value`, or `NOT_FOUND`.
+template <class T>
+auto indexOf(Slice<T> slice, const detail::Elem<T>& value) noexcept -> usize {
+  using E = detail::Elem<T>;
+  if constexpr (detail::IntElement<E>) {
+    using K = detail::BitsLane<E>;
+    return detail::indexOfKernel(detail::lanePtr<const K>(slice.ptr()),
+                                 slice.len(), std::bit_cast<K>(value));
+  } else {
+    for (usize i = 0; i < slice.len(); i++) {
+      if (slice.ptr()[i] == value) {
+        return i;
+      }
+    }
+    return NOT_FOUND;
+  }
+}
+
+/// Returns the number of elements equal to `value`.
+template <class T>
+auto count(Slice<T> slice, const detail::Elem<T>& value) noexcept -> usize {
+  using E = detail::Elem<T>;
+  if constexpr (detail::IntElement<E>) {
+    using K = detail::BitsLane<E>;
+    return detail::countKernel(detail::lanePtr<const K>(slice.ptr()),
+                               slice.len(), std::bit_cast<K>(value));
+  } else {
+    usize n = 0;
+    for (usize i = 0; i < slice.len(); i++) {
+      n += (slice.ptr()[i] == value) ? 1 : 0;
+    }
+    return n;
+  }
+}
+
+/// Returns the number of elements less than `value`.
+///
+/// For a sorted slice this is the index of the first element that is not less
+/// than `value`; scanning a short slice this way is faster than a binary
+/// search since it has no unpredictable branches.
+///
+/// # Note
+///
+/// The result is unspecified if a floating point slice contains NaN.
+template <class T>
+auto countLess(Slice<T> slice, const detail::Elem<T>& value) noexcept -> usize {
+  using E = detail::Elem<T>;
+  if constexpr (detail::IntElement<E> || detail::FloatElement<E>) {
+    using K = typename detail::Lane<E>::Type;
+    return detail::countLessKernel(detail::lanePtr<const K>(slice.ptr()),
+                                   slice.len(), std::bit_cast<K>(value));
+  } else {
+    usize n = 0;
+    for (usize i = 0; i < slice.len(); i++) {
+      n += (slice.ptr()[i] < value) ? 1 : 0;
+    }
+    return n;
+  }
+}
+
+/// Returns the smallest element.
+///
+/// # Note
+///
+/// * `slice` must not be empty.
+/// * The result is unspecified if a floating point slice contains NaN.
+template <class T> auto min(Slice<T> slice) noexcept -> detail::Elem<T> {
+  using E = detail::Elem<T>;
+  CBL_ASSERT(slice.len() != 0, "The slice must not be empty");
+  if constexpr (detail::IntElement<E> || detail::FloatElement<E>) {
+    using K = typename detail::Lane<E>::Type;
+    return std::bit_cast<E>(
+        detail::minKernel(detail::lanePtr<const K>(slice.ptr()), slice.len()));
+  } else {
+    E result = slice.ptr()[0];
+    for (usize i = 1; i < slice.len(); i++) {
+      if (slice.ptr()[i] < result) {
+        result = slice.ptr()[i];
+      }
+    }
+    return result;
+  }
+}
+
+/// Returns the largest element.
+///
+/// # Note
+///
+/// * `slice` must not be empty.
+/// * The result is unspecified if a floating point slice contains NaN.
+template <class T> auto max(Slice<T> slice) noexcept -> detail::Elem<T> {
+  using E = detail::Elem<T>;
+  CBL_ASSERT(slice.len() != 0, "The slice must not be empty");
+  if constexpr (detail::IntElement<E> || detail::FloatElement<E>) {
+    using K = typename detail::Lane<E>::Type;
+    return std::bit_cast<E>(
+        detail::maxKernel(detail::lanePtr<const K>(slice.ptr()), slice.len()));
+  } else {
+    E result = slice.ptr()[0];
+    for (usize i = 1; i < slice.len(); i++) {
+      if (result < slice.ptr()[i]) {
+        result = slice.ptr()[i];
+      }
+    }
+    return result;
+  }
+}
+
+/// Returns the sum of the elements, or `T{}` if `slice` is empty.
+///
+/// # Note
+///
+/// * Integer sums wrap around on overflow.
+/// * Floating point sums are accumulated in several lanes and then combined,
+///   so rounding may differ from a sequential loop.
+template <class T> auto sum(Slice<T> slice) noexcept -> detail::Elem<T> {
+  using E = detail::Elem<T>;
+  if constexpr (detail::IntElement<E>) {
+    // Wrapping addition does not depend on signedness
+    using K = detail::BitsLane<E>;
+    return std::bit_cast<E>(
+        detail::sumKernel(detail::lanePtr<const K>(slice.ptr()), slice.len()));
+  } else if constexpr (detail::FloatElement<E>) {
+    return detail::sumKernel<E>(slice.ptr(), slice.len());
+  } else {
+    E result{};
+    for (usize i = 0; i < slice.len(); i++) {
+      result = result + slice.ptr()[i];
+    }
+    return result;
+  }
+}
+
+} // namespace cbl::slice
+
+#endif // !CBL_SLICE_OPS_H
@@ -0,0 +1,186 @@
+#ifndef CBL_SLOT_MAP_H
+#define CBL_SLOT_MAP_H
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u32, usize
+#include "cbl/slice.h"         // Slice
+
+namespace cbl {
+
+/// A container that hands out stable handles to its values.
+///
+/// Values are stored contiguously, so iterating over them is as fast as
+/// iterating over an array. A handle stays valid as the map grows and is
+/// detected as stale once its value is removed, even if the slot is reused.
+///
+/// Inserting, removing and looking up values are O(1).
+template <class T> struct SlotMap {
+  explicit SlotMap() noexcept                 = delete;
+  SlotMap(SlotMap&&) noexcept                 = default;
+  SlotMap(const SlotMap&) noexcept            = delete;
+  SlotMap& operator=(SlotMap&&) noexcept      = default;
+  SlotMap& operator=(const SlotMap&) noexcept = delete;
+  ~SlotMap() noexcept                         = default;
+
+public:
+  /// Refers to a value in the map.
+  ///
+  /// Live values always have an odd generation, so a zero-initialized handle
+  /// never refers to a value.
+  struct Handle {
+    u32 index;
+    u32 generation;
+
+    auto operator==(const Handle& other) const noexcept -> bool {
+      return (this->index == other.index) &&
+             (this->generation == other.generation);
+    }
+  };
+
+  /// Creates an empty map that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the map.
+  explicit SlotMap(mem::Allocator& allocator) noexcept
+      : _allocator{&allocator} {}
+
+  /// Frees all memory allocated by the map.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void {
+    this->_values.deinit(*this->_allocator);
+    this->_owners.deinit(*this->_allocator);
+    this->_slots.deinit(*this->_allocator);
+    this->_free_head = NONE;
+  }
+
+  /// Returns the number of values in the map.
+  auto len() const noexcept -> usize { return this->_values.len(); }
+
+  /// Returns `true` if the map has no values.
+  auto isEmpty() const noexcept -> bool { return this->_values.len() == 0; }
+
+  /// Adds `value` to the map, returning its handle.
+  auto insert(T value) noexcept -> Handle {
+    u32 index;
+    if (this->_free_head != NONE) {
+      index            = this->_free_head;
+      this->_free_head = this->slot(index).dense;
+    } else {
+      CBL_ASSERT(this->_slots.len() < NONE, "SlotMap is full");
+      index = static_cast<u32>(this->_slots.len());
+      this->_slots.append(*this->_allocator, Slot{0, 0});
+    }
+
+    // Occupied slots have odd generations
+    Slot& s       = this->slot(index);
+    s.dense       = static_cast<u32>(this->_values.len());
+    s.generation += 1;
+    this->_values.append(*this->_allocator, value);
+    this->_owners.append(*this->_allocator, index);
+    return Handle{index, s.generation};
+  }
+
+  /// Removes the value of `handle`, returning `false` if the handle is stale.
+  ///
+  /// # Safety
+  ///
+  /// The last value is moved into the removed value's place, which
+  /// invalidates pointers to it.
+  auto remove(Handle handle) noexcept -> bool {
+    if (!this->contains(handle)) {
+      return false;
+    }
+    Slot&       s     = this->slot(handle.index);
+    const usize dense = s.dense;
+
+    // Move the last value into the hole and point its slot at the new place
+    const u32 last = this->_owners.elems()[this->_owners.len() - 1];
+    this->_values.swapRemove(dense);
+    this->_owners.swapRemove(dense);
+    if (last != handle.index) {
+      this->slot(last).dense = static_cast<u32>(dense);
+    }
+
+    s.generation     += 1;
+    s.dense           = this->_free_head;
+    this->_free_head  = handle.index;
+    return true;
+  }
+
+  /// Returns `true` if `handle` refers to a value in the map.
+  auto contains(Handle handle) const noexcept -> bool {
+    return (handle.index < this->_slots.len()) &&
+           ((handle.generation & 1) == 1) &&
+           (this->slot(handle.index).generation == handle.generation);
+  }
+
+  /// Returns a pointer to the value of `handle`, or `nullptr` if the handle is
+  /// stale.
+  ///
+  /// # Safety
+  ///
+  /// The returned pointer is invalidated by inserting or removing values.
+  auto getPtr(Handle handle) const noexcept -> T* {
+    if (!this->contains(handle)) {
+      return nullptr;
+    }
+    return this->_values.elems().ptr() + this->slot(handle.index).dense;
+  }
+
+  /// Returns the values in the map, in no particular order.
+  ///
+  /// # Safety
+  ///
+  /// The returned slice is invalidated by inserting or removing values.
+  auto values() const noexcept -> Slice<T> { return this->_values.elems(); }
+
+  /// Returns the handle of the value at `idx` in `values()`.
+  auto handleAt(usize idx) const noexcept -> Handle {
+    const u32 index = this->_owners.elems()[idx];
+    return Handle{index, this->slot(index).generation};
+  }
+
+  /// Removes every value, invalidating all handles.
+  auto clear() noexcept -> void {
+    for (const u32 index : this->_owners.elems()) {
+      Slot& s          = this->slot(index);
+      s.generation    += 1;
+      s.dense          = this->_free_head;
+      this->_free_head = index;
+    }
+    this->_values.clear();
+    this->_owners.clear();
+  }
+
+private:
+  static constexpr u32 NONE = static_cast<u32>(-1);
+
+  struct Slot {
+    /// The index of the value in `_values`, or the next free slot if the slot
+    /// is free.
+    u32 dense;
+    u32 generation;
+  };
+
+  mem::Allocator*             _allocator;
+  UnmanagedDynamicArray<T>    _values;
+  /// The slot of each value in `_values`.
+  UnmanagedDynamicArray<u32>  _owners;
+  UnmanagedDynamicArray<Slot> _slots;
+  u32                         _free_head = NONE;
+
+  auto slot(u32 index) const noexcept -> Slot& {
+    return this->_slots.elems().getUnchecked(index);
+  }
+};
+
+} // namespace cbl
+
+#endif // !CBL_SLOT_MAP_H
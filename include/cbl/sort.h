@@ -0,0 +1,568 @@
+#ifndef CBL_SORT_H
+#define CBL_SORT_H
+
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // usize, f32, f64, Integer, isSigned
+#include "cbl/slice.h"         // Slice
+#include "cbl/slice_ops.h"     // copy
+#include <bit>                 // bit_cast, bit_width
+#include <cstdint>             // uint8_t, ..., uint64_t
+#include <functional>          // less
+#include <thread>              // thread
+#include <type_traits>         // conditional_t, invoke_result_t, is_same_v
+#include <utility>             // move, swap
+
+/// Sorting algorithms for slices.
+///
+/// * `pdq` is an in-place, unstable comparison sort.
+/// * `radix` is a stable LSD radix sort for integer and floating point keys.
+/// * `parallel` sorts chunks on several threads and merges them.
+namespace cbl::sort {
+
+namespace detail {
+
+inline constexpr usize INSERTION_SORT_THRESHOLD     = 24;
+inline constexpr usize NINTHER_THRESHOLD            = 128;
+inline constexpr usize PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+/// Sorts `[begin, end)` by insertion.
+///
+/// If `GUARDED` is `false`, the element before `begin` must not be greater
+/// than any element in the range.
+template <bool GUARDED, class T, class Less>
+auto insertionSort(T* begin, T* end, Less& less) noexcept -> void {
+  if (begin == end) {
+    return;
+  }
+  for (T* cur = begin + 1; cur != end; cur++) {
+    T* sift = cur;
+    if (less(*sift, *(sift - 1))) {
+      T tmp = std::move(*sift);
+      do {
+        *sift = std::move(*(sift - 1));
+        sift -= 1;
+      } while ((!GUARDED || (sift != begin)) && less(tmp, *(sift - 1)));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+/// Attempts to insertion sort `[begin, end)`, giving up if more than
+/// `PARTIAL_INSERTION_SORT_LIMIT` elements would be moved.
+///
+/// Returns `true` if the range was sorted.
+template <class T, class Less>
+auto partialInsertionSort(T* begin, T* end, Less& less) noexcept -> bool {
+  if (begin == end) {
+    return true;
+  }
+  usize moved = 0;
+  for (T* cur = begin + 1; cur != end; cur++) {
+    T* sift = cur;
+    if (less(*sift, *(sift - 1))) {
+      T tmp = std::move(*sift);
+      do {
+        *sift = std::move(*(sift - 1));
+        sift -= 1;
+      } while ((sift != begin) && less(tmp, *(sift - 1)));
+      *sift  = std::move(tmp);
+      moved += static_cast<usize>(cur - sift);
+    }
+    if (moved > PARTIAL_INSERTION_SORT_LIMIT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T, class Less>
+auto sort2(T* a, T* b, Less& less) noexcept -> void {
+  if (less(*b, *a)) {
+    std::swap(*a, *b);
+  }
+}
+
+template <class T, class Less>
+auto sort3(T* a, T* b, T* c, Less& less) noexcept -> void {
+  sort2(a, b, less);
+  sort2(b, c, less);
+  sort2(a, b, less);
+}
+
+template <class T, class Less>
+auto siftDown(T* heap, usize len, usize idx, Less& less) noexcept -> void {
+  while (true) {
+    usize child = 2 * idx + 1;
+    if (child >= len) {
+      return;
+    }
+    if ((child + 1 < len) && less(heap[child], heap[child + 1])) {
+      child += 1;
+    }
+    if (!less(heap[idx], heap[child])) {
+      return;
+    }
+    std::swap(heap[idx], heap[child]);
+    idx = child;
+  }
+}
+
+/// Sorts `[begin, end)` in O(n log n) regardless of the input.
+template <class T, class Less>
+auto heapSort(T* begin, T* end, Less& less) noexcept -> void {
+  const usize len = static_cast<usize>(end - begin);
+  for (usize i = len / 2; i > 0; i--) {
+    siftDown(begin, len, i - 1, less);
+  }
+  for (usize i = len; i > 1; i--) {
+    std::swap(begin[0], begin[i - 1]);
+    siftDown(begin, i - 1, 0, less);
+  }
+}
+
+/// Partitions `[begin, end)` around `*begin`, placing elements equal to the
+/// pivot on the right.
+///
+/// Returns the position of the pivot and whether the range was already
+/// partitioned.
+template <class T, class Less>
+auto partitionRight(T* begin, T* end, Less& less,
+                    bool* already_partitioned) noexcept -> T* {
+  T  pivot = std::move(*begin);
+  T* first = begin;
+  T* last  = end;
+
+  // The median of 3 guarantees that these scans stop inside the range
+  while (less(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while ((first < last) && !less(*--last, pivot)) {
+    }
+  } else {
+    while (!less(*--last, pivot)) {
+    }
+  }
+
+  *already_partitioned = first >= last;
+  while (first < last) {
+    std::swap(*first, *last);
+    while (less(*++first, pivot)) {
+    }
+    while (!less(*--last, pivot)) {
+    }
+  }
+
+  T* pivot_pos = first - 1;
+  *begin       = std::move(*pivot_pos);
+  *pivot_pos   = std::move(pivot);
+  return pivot_pos;
+}
+
+/// Partitions `[begin, end)` around `*begin`, placing elements equal to the
+/// pivot on the left.
+///
+/// Used when the pivot equals the element before the range, so that runs of
+/// equal elements are handled in linear time.
+template <class T, class Less>
+auto partitionLeft(T* begin, T* end, Less& less) noexcept -> T* {
+  T  pivot = std::move(*begin);
+  T* first = begin;
+  T* last  = end;
+
+  while (less(pivot, *--last)) {
+  }
+  if (last + 1 == end) {
+    while ((first < last) && !less(pivot, *++first)) {
+    }
+  } else {
+    while (!less(pivot, *++first)) {
+    }
+  }
+
+  while (first < last) {
+    std::swap(*first, *last);
+    while (less(pivot, *--last)) {
+    }
+    while (!less(pivot, *++first)) {
+    }
+  }
+
+  T* pivot_pos = last;
+  *begin       = std::move(*pivot_pos);
+  *pivot_pos   = std::move(pivot);
+  return pivot_pos;
+}
+
+template <class T, class Less>
+auto pdqLoop(T* begin, T* end, Less& less, usize bad_allowed,
+             bool leftmost) noexcept -> void {
+  while (true) {
+    const usize size = static_cast<usize>(end - begin);
+    if (size < INSERTION_SORT_THRESHOLD) {
+      if (leftmost) {
+        insertionSort<true>(begin, end, less);
+      } else {
+        insertionSort<false>(begin, end, less);
+      }
+      return;
+    }
+
+    // Choose the pivot as the median of 3, or the pseudomedian of 9 for
+    // larger ranges, and move it to the start
+    const usize half = size / 2;
+    if (size > NINTHER_THRESHOLD) {
+      sort3(begin, begin + half, end - 1, less);
+      sort3(begin + 1, begin + (half - 1), end - 2, less);
+      sort3(begin + 2, begin + (half + 1), end - 3, less);
+      sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+      std::swap(*begin, *(begin + half));
+    } else {
+      sort3(begin + half, begin, end - 1, less);
+    }
+
+    // If the pivot equals the element before the range, every element in the
+    // range is at least the pivot, so the ones equal to it are already in
+    // their final position
+    if (!leftmost && !less(*(begin - 1), *begin)) {
+      begin = partitionLeft(begin, end, less) + 1;
+      continue;
+    }
+
+    bool already_partitioned;
+    T*   pivot_pos = partitionRight(begin, end, less, &already_partitioned);
+    const usize l_size = static_cast<usize>(pivot_pos - begin);
+    const usize r_size = static_cast<usize>(end - (pivot_pos + 1));
+
+    if ((l_size < size / 8) || (r_size < size / 8)) {
+      // Fall back to heap sort if there have been too many bad partitions
+      bad_allowed -= 1;
+      if (bad_allowed == 0) {
+        heapSort(begin, end, less);
+        return;
+      }
+
+      // Break up patterns that may be causing the bad partitions
+      if (l_size >= INSERTION_SORT_THRESHOLD) {
+        std::swap(*begin, *(begin + l_size / 4));
+        std::swap(*(pivot_pos - 1), *(pivot_pos - l_size / 4));
+        if (l_size > NINTHER_THRESHOLD) {
+          std::swap(*(begin + 1), *(begin + (l_size / 4 + 1)));
+          std::swap(*(begin + 2), *(begin + (l_size / 4 + 2)));
+          std::swap(*(pivot_pos - 2), *(pivot_pos - (l_size / 4 + 1)));
+          std::swap(*(pivot_pos - 3), *(pivot_pos - (l_size / 4 + 2)));
+        }
+      }
+      if (r_size >= INSERTION_SORT_THRESHOLD) {
+        std::swap(*(pivot_pos + 1), *(pivot_pos + (1 + r_size / 4)));
+        std::swap(*(end - 1), *(end - r_size / 4));
+        if (r_size > NINTHER_THRESHOLD) {
+          std::swap(*(pivot_pos + 2), *(pivot_pos + (2 + r_size / 4)));
+          std::swap(*(pivot_pos + 3), *(pivot_pos + (3 + r_size / 4)));
+          std::swap(*(end - 2), *(end - (1 + r_size / 4)));
+          std::swap(*(end - 3), *(end - (2 + r_size / 4)));
+        }
+      }
+    } else if (already_partitioned &&
+               partialInsertionSort(begin, pivot_pos, less) &&
+               partialInsertionSort(pivot_pos + 1, end, less)) {
+      // The input was likely sorted already
+      return;
+    }
+
+    // Recurse into the left side and loop on the right side
+    pdqLoop(begin, pivot_pos, less, bad_allowed, leftmost);
+    begin    = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+/// Maps a key to an unsigned integer with the same ordering.
+template <class K> auto radixBits(K key) noexcept {
+  if constexpr (std::is_same_v<K, f32> || std::is_same_v<K, f64>) {
+    using U              = std::conditional_t<std::is_same_v<K, f32>,
+                                              std::uint32_t, std::uint64_t>;
+    const U bits         = std::bit_cast<U>(key);
+    const U sign         = U{1} << (sizeof(U) * 8 - 1);
+
+    // Negative numbers sort in reverse order of their magnitude
+    return ((bits & sign) != 0) ? static_cast<U>(~bits) : (bits | sign);
+  } else {
+    using U = typename slice::detail::IntLane<sizeof(K), false>::Type;
+    U bits  = std::bit_cast<U>(key);
+    if constexpr (isSigned<K>()) {
+      bits ^= U{1} << (sizeof(U) * 8 - 1);
+    }
+    return bits;
+  }
+}
+
+/// Returns the number of elements in the stable merge of `a` and `b` that
+/// come from `a`, among the first `k`.
+template <class T, class Less>
+auto coRank(const T* a, usize a_len, const T* b, usize b_len, usize k,
+            Less& less) noexcept -> usize {
+  usize lo = (k > b_len) ? k - b_len : 0;
+  usize hi = (k < a_len) ? k : a_len;
+  while (lo < hi) {
+    const usize i = lo + (hi - lo) / 2;
+    const usize j = k - i;
+    if ((j > 0) && !less(b[j - 1], a[i])) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+/// Merges `a` and `b` into `out`, taking from `a` on ties.
+template <class T, class Less>
+auto merge(const T* a, const T* a_end, const T* b, const T* b_end, T* out,
+           Less& less) noexcept -> void {
+  while ((a != a_end) && (b != b_end)) {
+    if (less(*b, *a)) {
+      *out++ = *b++;
+    } else {
+      *out++ = *a++;
+    }
+  }
+  while (a != a_end) {
+    *out++ = *a++;
+  }
+  while (b != b_end) {
+    *out++ = *b++;
+  }
+}
+
+} // namespace detail
+
+/// Keys that `radix` can sort directly.
+template <class K>
+concept RadixKey = slice::detail::IntElement<K> || std::is_same_v<K, f32> ||
+                   std::is_same_v<K, f64>;
+
+/// Returns `true` if `slice` is sorted with respect to `less`.
+template <class T, class Less = std::less<>>
+auto isSorted(Slice<T> slice, Less less = {}) noexcept -> bool {
+  for (usize i = 1; i < slice.len(); i++) {
+    if (less(slice.getUnchecked(i), slice.getUnchecked(i - 1))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Sorts `slice` in place using pattern-defeating quicksort.
+///
+/// This runs in O(n log n) in the worst case and in linear time on sorted,
+/// reverse sorted and many-duplicate inputs.
+///
+/// # Note
+///
+/// The sort is not stable.
+template <class T, class Less = std::less<>>
+auto pdq(Slice<T> slice, Less less = {}) noexcept -> void {
+  if (slice.len() < 2) {
+    return;
+  }
+  detail::pdqLoop(slice.begin(), slice.end(), less,
+                  static_cast<usize>(std::bit_width(slice.len())), true);
+}
+
+/// Sorts `slice` by `key(element)` using a least-significant-digit radix
+/// sort, which is stable and runs in O(n) passes over the data.
+///
+/// Keys may be integers of up to 64 bits, `f32` or `f64`. Passes over digits
+/// that are the same in every key are skipped.
+///
+/// # Note
+///
+/// Floating point keys are ordered by their bits, so `-0.0` sorts before
+/// `0.0` and NaNs sort to the ends.
+///
+/// # Errors
+///
+/// Returns `false`, leaving `slice` unchanged, if the scratch buffer cannot
+/// be allocated.
+template <class T, class KeyFn>
+  requires std::is_trivially_copyable_v<T> &&
+           RadixKey<std::invoke_result_t<KeyFn&, const T&>>
+auto radix(mem::Allocator& allocator, Slice<T> slice,
+           KeyFn key) noexcept -> bool {
+  constexpr usize DIGITS = sizeof(std::invoke_result_t<KeyFn&, const T&>);
+  if (slice.len() < 2) {
+    return true;
+  }
+
+  Slice<T> scratch = allocator.createArray<T>(slice.len());
+  if (scratch.isEmpty()) {
+    return false;
+  }
+
+  // Count every digit in a single pass
+  usize counts[DIGITS][256] = {};
+  for (const T& elem : slice) {
+    const auto bits = detail::radixBits(key(elem));
+    for (usize d = 0; d < DIGITS; d++) {
+      counts[d][static_cast<std::uint8_t>(bits >> (d * 8))] += 1;
+    }
+  }
+
+  T* src = slice.ptr();
+  T* dst = scratch.ptr();
+  for (usize d = 0; d < DIGITS; d++) {
+    usize* count = counts[d];
+    usize  first = 0;
+    while (count[first] == 0) {
+      first += 1;
+    }
+    if (count[first] == slice.len()) {
+      continue;
+    }
+
+    // Turn the counts into starting offsets
+    usize offset = 0;
+    for (usize b = 0; b < 256; b++) {
+      const usize n  = count[b];
+      count[b]       = offset;
+      offset        += n;
+    }
+    for (usize i = 0; i < slice.len(); i++) {
+      const auto bits = detail::radixBits(key(src[i]));
+      dst[count[static_cast<std::uint8_t>(bits >> (d * 8))]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+
+  if (src != slice.ptr()) {
+    slice::copy(slice, Slice<T>{src, slice.len()});
+  }
+  allocator.destroyArray(scratch);
+  return true;
+}
+
+/// Sorts integer or floating point keys using a radix sort.
+///
+/// # Errors
+///
+/// Returns `false`, leaving `slice` unchanged, if the scratch buffer cannot
+/// be allocated.
+template <RadixKey K>
+auto radix(mem::Allocator& allocator, Slice<K> slice) noexcept -> bool {
+  return radix(allocator, slice, [](const K& key) { return key; });
+}
+
+/// The most threads that `parallel` uses.
+inline constexpr usize MAX_THREADS = 64;
+
+/// Sorts `slice` on `threads` threads (or one per hardware thread if
+/// `threads` is 0).
+///
+/// Each thread sorts a chunk with `pdq`, and the sorted chunks are then
+/// merged in rounds. Each merge is split across threads by output position,
+/// so all threads stay busy until the end.
+///
+/// # Note
+///
+/// * The sort is not stable.
+/// * Small slices are sorted on the calling thread.
+///
+/// # Errors
+///
+/// Returns `false`, leaving `slice` unchanged, if the scratch buffer cannot
+/// be allocated.
+template <class T, class Less = std::less<>>
+  requires std::is_trivially_copyable_v<T>
+auto parallel(mem::Allocator& allocator, Slice<T> slice, Less less = {},
+              usize threads = 0) noexcept -> bool {
+  constexpr usize MIN_CHUNK_LEN = 1 << 14;
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+  if (threads > slice.len() / MIN_CHUNK_LEN) {
+    threads = slice.len() / MIN_CHUNK_LEN;
+  }
+  if (threads <= 1) {
+    pdq(slice, less);
+    return true;
+  }
+
+  Slice<T> scratch = allocator.createArray<T>(slice.len());
+  if (scratch.isEmpty()) {
+    return false;
+  }
+
+  std::thread workers[MAX_THREADS];
+  usize       runs[MAX_THREADS + 1];
+  usize       num_runs = threads;
+  for (usize t = 0; t <= threads; t++) {
+    runs[t] = slice.len() * t / threads;
+  }
+  for (usize t = 0; t < threads; t++) {
+    workers[t] = std::thread{[&, t]() {
+      pdq(slice.subslice(runs[t], runs[t + 1]), less);
+    }};
+  }
+  for (usize t = 0; t < threads; t++) {
+    workers[t].join();
+  }
+
+  T* src = slice.ptr();
+  T* dst = scratch.ptr();
+  while (num_runs > 1) {
+    const usize pairs   = num_runs / 2;
+    const usize parts   = (threads / pairs == 0) ? 1 : threads / pairs;
+    usize       spawned = 0;
+    for (usize p = 0; p < pairs; p++) {
+      const usize start = runs[2 * p];
+      const usize mid   = runs[2 * p + 1];
+      const usize end   = runs[2 * p + 2];
+      for (usize part = 0; part < parts; part++) {
+        workers[spawned++] = std::thread{[=, &less]() {
+          const usize a_len = mid - start;
+          const usize b_len = end - mid;
+          const usize k0    = (a_len + b_len) * part / parts;
+          const usize k1    = (a_len + b_len) * (part + 1) / parts;
+          const T*    a     = src + start;
+          const T*    b     = src + mid;
+          const usize i0    = detail::coRank(a, a_len, b, b_len, k0, less);
+          const usize i1    = detail::coRank(a, a_len, b, b_len, k1, less);
+          detail::merge(a + i0, a + i1, b + (k0 - i0), b + (k1 - i1),
+                        dst + start + k0, less);
+        }};
+      }
+    }
+
+    // An odd run out is carried over to the next round
+    if ((num_runs % 2) != 0) {
+      const usize start = runs[num_runs - 1];
+      slice::copy(Slice<T>{dst + start, slice.len() - start},
+                  Slice<T>{src + start, slice.len() - start});
+    }
+    for (usize t = 0; t < spawned; t++) {
+      workers[t].join();
+    }
+
+    for (usize r = 0; r < pairs; r++) {
+      runs[r + 1] = runs[2 * r + 2];
+    }
+    if ((num_runs % 2) != 0) {
+      runs[pairs + 1] = slice.len();
+    }
+    num_runs = (num_runs + 1) / 2;
+    std::swap(src, dst);
+  }
+
+  if (src != slice.ptr()) {
+    slice::copy(slice, Slice<T>{src, slice.len()});
+  }
+  allocator.destroyArray(scratch);
+  return true;
+}
+
+} // namespace cbl::sort
+
+#endif // !CBL_SORT_H
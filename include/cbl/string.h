@@ -0,0 +1,159 @@
+#ifndef CBL_STRING_H
+#define CBL_STRING_H
+
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/io/writer.h"     // Writer
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, usize, const_cstr
+#include "cbl/slice.h"         // Slice
+
+namespace cbl {
+
+/// A growable byte string.
+///
+/// `StringBuilder` implements `io::Writer`, so `format` can be used to build
+/// strings in memory.
+struct StringBuilder : public io::Writer {
+  explicit StringBuilder() noexcept                       = delete;
+  StringBuilder(StringBuilder&&) noexcept                 = default;
+  StringBuilder(const StringBuilder&) noexcept            = delete;
+  StringBuilder& operator=(StringBuilder&&) noexcept      = default;
+  StringBuilder& operator=(const StringBuilder&) noexcept = delete;
+  ~StringBuilder() noexcept                               = default;
+
+public:
+  /// Creates an empty string that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the string.
+  explicit StringBuilder(mem::Allocator& allocator) noexcept;
+
+  /// Creates an empty string with memory reserved for `capacity` bytes.
+  static auto initWithCapacity(mem::Allocator& allocator,
+                               usize capacity) noexcept -> StringBuilder;
+
+  /// Frees all memory allocated by the string.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void;
+
+  /// Appends `buf`, returning the number of bytes written.
+  [[nodiscard]] auto write(Slice<u8> buf) noexcept -> usize override;
+
+  /// Appends `str`.
+  auto append(Slice<u8> str) noexcept -> void;
+
+  /// Appends a null-terminated string.
+  auto append(const_cstr str) noexcept -> void;
+
+  /// Appends a single byte.
+  auto appendByte(u8 byte) noexcept -> void;
+
+  /// Returns the bytes of the string.
+  ///
+  /// # Safety
+  ///
+  /// The returned slice will be invalid after the string grows.
+  auto str() const noexcept -> Slice<u8>;
+
+  /// Returns the length of the string in bytes.
+  auto len() const noexcept -> usize;
+
+  /// Removes all bytes from the string, keeping its capacity.
+  auto clear() noexcept -> void;
+
+  /// Returns the string as a slice that the caller owns.
+  ///
+  /// # Note
+  ///
+  /// This will empty the string and clear its capacity.
+  auto toOwnedSlice() noexcept -> Slice<u8>;
+
+private:
+  mem::Allocator*           _allocator;
+  UnmanagedDynamicArray<u8> _buf;
+};
+
+/// Utilities for byte strings represented as `Slice<u8>`.
+///
+/// Searches use SSE2 or AVX2 when the CPU supports them.
+namespace str {
+
+/// Returned by searches when nothing was found.
+inline constexpr usize NOT_FOUND = static_cast<usize>(-1);
+
+/// Creates a slice over a null-terminated string (excluding the terminator).
+auto fromCstr(const_cstr str) noexcept -> Slice<u8>;
+
+/// Returns `true` if `a` and `b` contain the same bytes.
+auto eql(Slice<u8> a, Slice<u8> b) noexcept -> bool;
+
+/// Returns `true` if `str` begins with `prefix`.
+auto startsWith(Slice<u8> str, Slice<u8> prefix) noexcept -> bool;
+
+/// Returns `true` if `str` ends with `suffix`.
+auto endsWith(Slice<u8> str, Slice<u8> suffix) noexcept -> bool;
+
+/// Returns the index of the first `byte` in `str`, or `NOT_FOUND`.
+auto indexOfByte(Slice<u8> str, u8 byte) noexcept -> usize;
+
+/// Returns the index of the first occurrence of `needle` in `haystack`, or
+/// `NOT_FOUND`.
+///
+/// An empty `needle` is found at index 0.
+auto indexOf(Slice<u8> haystack, Slice<u8> needle) noexcept -> usize;
+
+/// Returns `str` without leading ASCII whitespace.
+auto trimLeft(Slice<u8> str) noexcept -> Slice<u8>;
+
+/// Returns `str` without trailing ASCII whitespace.
+auto trimRight(Slice<u8> str) noexcept -> Slice<u8>;
+
+/// Returns `str` without leading and trailing ASCII whitespace.
+auto trim(Slice<u8> str) noexcept -> Slice<u8>;
+
+/// Iterates over the parts of a string separated by a delimiter.
+///
+/// Consecutive delimiters produce empty parts, and an empty string produces
+/// a single empty part.
+struct SplitIterator {
+  explicit SplitIterator() noexcept                       = delete;
+  SplitIterator(SplitIterator&&) noexcept                 = default;
+  SplitIterator(const SplitIterator&) noexcept            = default;
+  SplitIterator& operator=(SplitIterator&&) noexcept      = default;
+  SplitIterator& operator=(const SplitIterator&) noexcept = default;
+  ~SplitIterator() noexcept                               = default;
+
+public:
+  /// Creates an iterator over the parts of `str` separated by `delim`.
+  ///
+  /// # Note
+  ///
+  /// `delim` must not be empty.
+  explicit SplitIterator(Slice<u8> str, Slice<u8> delim) noexcept;
+
+  /// Stores the next part in `out`, returning `false` if there are no parts
+  /// left.
+  auto next(Slice<u8>* out) noexcept -> bool;
+
+  /// Returns the part of the string that has not been iterated over yet.
+  auto rest() const noexcept -> Slice<u8>;
+
+private:
+  Slice<u8> _rest;
+  Slice<u8> _delim;
+  bool      _done = false;
+};
+
+/// Splits `str` on every occurrence of `delim`.
+auto split(Slice<u8> str, Slice<u8> delim) noexcept -> SplitIterator;
+
+} // namespace str
+
+} // namespace cbl
+
+#endif // !CBL_STRING_H
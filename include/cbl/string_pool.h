@@ -0,0 +1,113 @@
+#ifndef CBL_STRING_POOL_H
+#define CBL_STRING_POOL_H
+
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u32, u64, usize
+#include "cbl/slice.h"         // Slice
+#include <atomic>              // atomic
+#include <shared_mutex>        // shared_mutex
+
+namespace cbl {
+
+/// Interns byte strings, mapping each unique string to a compact `u32` ID.
+///
+/// Two strings are equal exactly when their IDs are, so interned strings can
+/// be compared and hashed as integers.
+///
+/// # Note
+///
+/// * String bytes are stored contiguously in chunks obtained from the
+///   allocator and never move, so resolved slices stay valid for the lifetime
+///   of the pool.
+/// * IDs are assigned sequentially starting at 0.
+/// * All methods are thread-safe. `resolve` never blocks, and lookups of
+///   strings that are already interned only take a shared lock.
+struct StringPool {
+  explicit StringPool() noexcept                    = delete;
+  StringPool(StringPool&&) noexcept                 = delete;
+  StringPool(const StringPool&) noexcept            = delete;
+  StringPool& operator=(StringPool&&) noexcept      = delete;
+  StringPool& operator=(const StringPool&) noexcept = delete;
+
+public:
+  /// Creates an empty pool that allocates with `allocator`.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the pool.
+  explicit StringPool(mem::Allocator& allocator) noexcept;
+
+  /// Frees all memory allocated by the pool.
+  ~StringPool() noexcept;
+
+  /// Returns the ID of `str`, copying it into the pool if it has not been
+  /// interned yet.
+  auto intern(Slice<u8> str) noexcept -> u32;
+
+  /// Looks up the ID of `str` without interning it.
+  ///
+  /// Returns `false` if `str` has not been interned.
+  auto find(Slice<u8> str, u32* out) const noexcept -> bool;
+
+  /// Returns the string with the given ID.
+  ///
+  /// # Safety
+  ///
+  /// `id` must have been returned by this pool.
+  auto resolve(u32 id) const noexcept -> Slice<u8>;
+
+  /// Returns the number of unique strings in the pool.
+  auto len() const noexcept -> usize;
+
+private:
+  /// The number of entries in the first segment; each following segment is
+  /// twice as large as the previous one.
+  static constexpr usize FIRST_SEGMENT_LEN = 64;
+  static constexpr usize MAX_SEGMENTS      = 26;
+
+  /// The size of the chunks that string bytes are copied into.
+  static constexpr usize CHUNK_SIZE        = 64 * 1024;
+
+  struct Entry {
+    u8*   ptr;
+    usize len;
+  };
+
+  mem::Allocator*                  _allocator;
+  mutable std::shared_mutex        _mutex;
+
+  /// Entries are stored in segments that are never reallocated, so `resolve`
+  /// can read them without locking.
+  Entry*                           _segments[MAX_SEGMENTS] = {};
+  std::atomic<usize>               _len{0};
+
+  /// An open-addressing table of `hash << 32 | (id + 1)`, where 0 marks an
+  /// empty slot.
+  Slice<u64>                       _table;
+
+  /// Every chunk allocated so far, and the one being filled.
+  UnmanagedDynamicArray<Slice<u8>> _chunks;
+  Slice<u8>                        _chunk;
+  usize                            _chunk_pos = 0;
+
+  /// Returns the entry with the given ID.
+  auto entry(usize id) const noexcept -> Entry&;
+
+  /// Returns the table slot that holds `str`, or the empty slot where it
+  /// would be inserted.
+  auto probe(Slice<u8> str, u32 hash) const noexcept -> usize;
+
+  /// Copies `str` into the current chunk, starting a new one if necessary.
+  auto store(Slice<u8> str) noexcept -> u8*;
+
+  /// Allocates a chunk of `size` bytes and records it for `~StringPool`.
+  auto allocateChunk(usize size) noexcept -> Slice<u8>;
+
+  /// Doubles the size of the table.
+  auto grow() noexcept -> void;
+};
+
+} // namespace cbl
+
+#endif // !CBL_STRING_POOL_H
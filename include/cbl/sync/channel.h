@@ -0,0 +1,322 @@
+#ifndef CBL_SYNC_CHANNEL_H
+#define CBL_SYNC_CHANNEL_H
+
+#include "cbl/assert.h"        // CBL_ASSERT, CBL_VERIFY
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u64, usize, isize
+#include "cbl/slice.h"         // Slice
+#include "cbl/sync/futex.h"    // FutexWord, NO_TIMEOUT, spinHint
+#include <atomic>              // atomic, atomic_thread_fence, memory_order
+#include <memory>              // construct_at
+#include <type_traits>         // is_trivially_copyable_v
+
+namespace cbl::sync {
+
+struct ChannelBase;
+
+/// Blocks until one of `channels` is ready (see `ChannelBase::isReady`) for
+/// at most `timeout_ns` nanoseconds, returning the index of a ready channel,
+/// or `channels.len()` if the timeout expired.
+///
+/// # Note
+///
+/// * The calling thread must be the receiver of every channel, and the
+///   channels must be distinct.
+/// * The returned channel stays ready until its messages are received, so
+///   `recv` on it does not sleep.
+auto select(Slice<ChannelBase* const> channels,
+            u64 timeout_ns = NO_TIMEOUT) noexcept -> usize;
+
+namespace detail {
+
+/// A receiver blocked in `select`, which the first channel to become ready
+/// wakes up.
+struct Waiter {
+  FutexWord state{0};
+};
+
+} // namespace detail
+
+/// The state of a channel that does not depend on the type of its messages,
+/// which `select` waits on.
+struct ChannelBase {
+  explicit ChannelBase() noexcept                     = delete;
+  ChannelBase(ChannelBase&&) noexcept                 = delete;
+  ChannelBase(const ChannelBase&) noexcept            = delete;
+  ChannelBase& operator=(ChannelBase&&) noexcept      = delete;
+  ChannelBase& operator=(const ChannelBase&) noexcept = delete;
+  ~ChannelBase() noexcept                             = default;
+
+public:
+  /// Returns `true` if a message is queued or the channel is closed, i.e. if
+  /// `recv` would not sleep.
+  auto isReady() const noexcept -> bool {
+    // The closed flag is part of the tail, so a closed channel is never
+    // equal to its head
+    return this->_tail.load(std::memory_order_seq_cst) !=
+           this->_head.load(std::memory_order_relaxed);
+  }
+
+  /// Returns `true` if the channel was closed.
+  auto isClosed() const noexcept -> bool {
+    return (this->_tail.load(std::memory_order_acquire) & CLOSED) != 0;
+  }
+
+  /// Returns the number of queued messages, which may be out of date by the
+  /// time it returns.
+  auto len() const noexcept -> usize {
+    return (this->_tail.load(std::memory_order_relaxed) & ~CLOSED) -
+           this->_head.load(std::memory_order_relaxed);
+  }
+
+  /// Returns the number of messages the channel can hold.
+  auto capacity() const noexcept -> usize { return this->_mask + 1; }
+
+  /// Closes the channel, waking up every blocked thread.
+  ///
+  /// Sends fail from now on, and receives fail once the queued messages have
+  /// been received. Closing a closed channel does nothing.
+  auto close() noexcept -> void;
+
+protected:
+  /// Set in the tail once the channel is closed.
+  static constexpr usize CLOSED = ~(~static_cast<usize>(0) >> 1);
+
+  /// Spins before sleeping, since the other side is usually about to act.
+  static constexpr usize SPIN_LIMIT = 128;
+
+  explicit ChannelBase(usize capacity) noexcept : _mask{capacity - 1} {
+    CBL_ASSERT((capacity != 0) && ((capacity & (capacity - 1)) == 0),
+               "The capacity must be a power of 2");
+  }
+
+  /// Returns `true` if the channel was closed and every message received.
+  auto isDrained() const noexcept -> bool {
+    const usize tail = this->_tail.load(std::memory_order_acquire);
+    return tail == (this->_head.load(std::memory_order_relaxed) | CLOSED);
+  }
+
+  /// Wakes the receiver if it is blocked on the channel.
+  ///
+  /// # Note
+  ///
+  /// Must follow the `seq_cst` update of the tail that made the channel
+  /// ready, which orders it against the receiver registering in `select`.
+  auto wakeReceiver() noexcept -> void {
+    if (this->_waiter.load(std::memory_order_seq_cst) != nullptr)
+        [[unlikely]] {
+      this->wakeReceiverSlow();
+    }
+  }
+
+  /// Wakes the senders blocked on a full channel, after the receiver freed
+  /// slots.
+  auto wakeSenders() noexcept -> void {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->_senders_asleep.load(std::memory_order_relaxed)) [[unlikely]] {
+      this->wakeSendersSlow();
+    }
+  }
+
+  /// Blocks a sender until the channel has a free slot or is closed.
+  auto waitForSlot() noexcept -> void;
+
+  /// Blocks the receiver until the channel is ready, or, if a sender claimed
+  /// a slot but has not filled it yet, for a moment.
+  auto waitReady() noexcept -> void;
+
+  usize _mask;
+
+  /// Written by senders.
+  alignas(64) std::atomic<usize> _tail{0};
+  /// Written by the receiver when it blocks.
+  std::atomic<detail::Waiter*> _waiter{nullptr};
+
+  /// Written by the receiver.
+  alignas(64) std::atomic<usize> _head{0};
+  /// Set by senders when they block, and cleared by the first receive that
+  /// wakes them, so that a receiver makes one syscall however many slots it
+  /// frees before they run.
+  std::atomic<bool> _senders_asleep{false};
+  FutexWord         _send_seq{0};
+
+private:
+  auto wakeReceiverSlow() noexcept -> void;
+  auto wakeSendersSlow() noexcept -> void;
+
+  friend auto select(Slice<ChannelBase* const> channels,
+                     u64 timeout_ns) noexcept -> usize;
+};
+
+/// A bounded channel for passing messages of type `T` from any number of
+/// sending threads to a single receiving thread.
+///
+/// Messages are copied into a ring of slots allocated up front, so sending
+/// and receiving never allocate. A full channel applies backpressure:
+/// `send` blocks until the receiver frees a slot. Blocked threads spin for a
+/// moment and then sleep on a futex, and the other side only makes a
+/// syscall when someone is asleep.
+///
+/// # Note
+///
+/// * Only one thread may receive from a channel at a time.
+/// * Messages from a single sender are received in order.
+/// * `T` must be trivially copyable.
+template <class T>
+  requires(std::is_trivially_copyable_v<T>)
+struct Channel final : public ChannelBase {
+  explicit Channel() noexcept                 = delete;
+  Channel(Channel&&) noexcept                 = delete;
+  Channel(const Channel&) noexcept            = delete;
+  Channel& operator=(Channel&&) noexcept      = delete;
+  Channel& operator=(const Channel&) noexcept = delete;
+  ~Channel() noexcept                         = default;
+
+public:
+  /// Creates an empty channel that holds up to `capacity` messages, which
+  /// must be a power of 2.
+  ///
+  /// # Note
+  ///
+  /// `allocator` must outlive the channel.
+  explicit Channel(mem::Allocator& allocator, usize capacity) noexcept
+      : ChannelBase{capacity}, _allocator{&allocator} {
+    this->_slots = allocator.createArray<Slot>(capacity);
+    CBL_VERIFY(!this->_slots.isEmpty(), "Allocation failed");
+    for (usize i = 0; i < capacity; i++) {
+      std::construct_at(&this->_slots[i].seq, i);
+    }
+  }
+
+  /// Frees the slots, dropping any message still queued.
+  ///
+  /// # Note
+  ///
+  /// Calling just the destructor will result in a memory leak; `deinit` must be
+  /// called to free allocated memory.
+  auto deinit() noexcept -> void {
+    this->_allocator->destroyArray(this->_slots);
+    this->_slots = Slice<Slot>{};
+  }
+
+  /// Sends `value` if the channel has a free slot, returning `false` if it
+  /// is full or closed.
+  auto trySend(const T& value) noexcept -> bool {
+    return this->push(value) == Push::Sent;
+  }
+
+  /// Sends `value`, blocking while the channel is full, returning `false` if
+  /// the channel is closed.
+  auto send(const T& value) noexcept -> bool {
+    usize spins = 0;
+    while (true) {
+      const Push result = this->push(value);
+      if (result != Push::Full) [[likely]] {
+        return result == Push::Sent;
+      }
+      if (spins < SPIN_LIMIT) {
+        spinHint();
+        spins += 1;
+      } else {
+        this->waitForSlot();
+      }
+    }
+  }
+
+  /// Receives the next message into `out` if one is queued, returning
+  /// `false` otherwise.
+  auto tryRecv(T* out) noexcept -> bool {
+    return this->tryRecvMany(Slice<T>{out, 1}) == 1;
+  }
+
+  /// Receives the next message into `out`, blocking while the channel is
+  /// empty, returning `false` if the channel is closed and drained.
+  auto recv(T* out) noexcept -> bool {
+    return this->recvMany(Slice<T>{out, 1}) == 1;
+  }
+
+  /// Receives up to `out.len()` queued messages into `out`, returning their
+  /// number.
+  auto tryRecvMany(Slice<T> out) noexcept -> usize {
+    usize pos = this->_head.load(std::memory_order_relaxed);
+    usize n   = 0;
+    for (; n < out.len(); n++, pos++) {
+      Slot& slot = this->_slots.getUnchecked(pos & this->_mask);
+      if (slot.seq.load(std::memory_order_acquire) != pos + 1) {
+        break;
+      }
+      out.getUnchecked(n) = slot.value;
+      slot.seq.store(pos + this->_mask + 1, std::memory_order_release);
+    }
+    if (n != 0) {
+      this->_head.store(pos, std::memory_order_release);
+      this->wakeSenders();
+    }
+    return n;
+  }
+
+  /// Receives between 1 and `out.len()` messages into `out`, blocking while
+  /// the channel is empty, returning their number, or 0 if the channel is
+  /// closed and drained.
+  ///
+  /// Receiving in batches amortizes the synchronization with the senders.
+  auto recvMany(Slice<T> out) noexcept -> usize {
+    CBL_ASSERT(!out.isEmpty(), "`out` must not be empty");
+    while (true) {
+      const usize n = this->tryRecvMany(out);
+      if ((n != 0) || this->isDrained()) {
+        return n;
+      }
+      this->waitReady();
+    }
+  }
+
+private:
+  struct Slot {
+    /// `pos` when the slot is free for the message at `pos`, and `pos + 1`
+    /// once that message is in it.
+    std::atomic<usize> seq;
+    T                  value;
+  };
+
+  enum class Push {
+    Sent,
+    Full,
+    Closed,
+  };
+
+  auto push(const T& value) noexcept -> Push {
+    // Bounded MPMC queue (Vyukov), with the closed flag in the tail so that
+    // no message is sent after `close`
+    usize pos = this->_tail.load(std::memory_order_relaxed);
+    while (true) {
+      if ((pos & CLOSED) != 0) [[unlikely]] {
+        return Push::Closed;
+      }
+      Slot&       slot = this->_slots.getUnchecked(pos & this->_mask);
+      const usize seq  = slot.seq.load(std::memory_order_acquire);
+      const isize diff = static_cast<isize>(seq) - static_cast<isize>(pos);
+      if (diff == 0) {
+        if (this->_tail.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.seq.store(pos + 1, std::memory_order_release);
+          this->wakeReceiver();
+          return Push::Sent;
+        }
+      } else if (diff < 0) {
+        return Push::Full;
+      } else {
+        pos = this->_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  alignas(64) mem::Allocator* _allocator;
+  Slice<Slot> _slots;
+};
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_CHANNEL_H
@@ -0,0 +1,70 @@
+#ifndef CBL_SYNC_CONDITION_H
+#define CBL_SYNC_CONDITION_H
+
+#include "cbl/primitives.h" // u64
+#include "cbl/sync/futex.h" // FutexWord, NO_TIMEOUT, Padded
+#include "cbl/sync/mutex.h" // Mutex
+
+namespace cbl::sync {
+
+/// A condition variable, one 32-bit word in size.
+///
+/// Threads wait on the condition with a mutex locked, and are woken up by
+/// `notifyOne` or `notifyAll`. The word is a sequence number that every
+/// notification bumps, so a notification sent between unlocking the mutex
+/// and going to sleep is not missed.
+///
+/// # Note
+///
+/// Waits may end spuriously, so the waited for state must be checked again
+/// in a loop.
+struct Condition {
+  explicit Condition() noexcept                   = default;
+  Condition(Condition&&) noexcept                 = delete;
+  Condition(const Condition&) noexcept            = delete;
+  Condition& operator=(Condition&&) noexcept      = delete;
+  Condition& operator=(const Condition&) noexcept = delete;
+  ~Condition() noexcept                           = default;
+
+public:
+  /// Unlocks `mutex`, waits for a notification, and locks `mutex` again.
+  ///
+  /// # Note
+  ///
+  /// `mutex` must be locked by the calling thread.
+  auto wait(Mutex& mutex) noexcept -> void {
+    (void)this->waitFor(mutex, NO_TIMEOUT);
+  }
+
+  /// Unlocks `mutex`, waits for a notification for at most `timeout_ns`
+  /// nanoseconds, and locks `mutex` again, returning `false` if the timeout
+  /// expired.
+  ///
+  /// # Note
+  ///
+  /// `mutex` must be locked by the calling thread.
+  auto waitFor(Mutex& mutex, u64 timeout_ns) noexcept -> bool;
+
+  /// Waits with `mutex` locked until `ready()` returns `true`.
+  template <class F> auto wait(Mutex& mutex, F&& ready) noexcept -> void {
+    while (!ready()) {
+      this->wait(mutex);
+    }
+  }
+
+  /// Wakes up one waiting thread.
+  auto notifyOne() noexcept -> void;
+
+  /// Wakes up every waiting thread.
+  auto notifyAll() noexcept -> void;
+
+private:
+  FutexWord _seq{0};
+};
+
+/// A condition variable on a cache line of its own.
+using PaddedCondition = Padded<Condition>;
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_CONDITION_H
@@ -0,0 +1,56 @@
+#ifndef CBL_SYNC_FUTEX_H
+#define CBL_SYNC_FUTEX_H
+
+#include "cbl/primitives.h" // u32, u64
+#include <atomic>           // atomic
+#include <cstdint>          // uint32_t
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // _mm_pause
+#endif
+
+namespace cbl::sync {
+
+/// The word that threads block on, which the kernel requires to be a 32-bit
+/// integer.
+using FutexWord = std::atomic<uint32_t>;
+
+/// A timeout that never expires.
+inline constexpr u64 NO_TIMEOUT = ~static_cast<u64>(0);
+
+/// Blocks the calling thread while `word` holds `expected`, for at most
+/// `timeout_ns` nanoseconds, returning `false` if the timeout expired.
+///
+/// # Note
+///
+/// The thread may wake up spuriously, so callers must check their condition
+/// again in a loop.
+auto futexWait(const FutexWord& word, uint32_t expected,
+               u64 timeout_ns = NO_TIMEOUT) noexcept -> bool;
+
+/// Wakes up to `count` threads blocked on `word`, returning the number of
+/// threads woken up.
+auto futexWake(const FutexWord& word, u32 count) noexcept -> u32;
+
+/// Wakes every thread blocked on `word`.
+auto futexWakeAll(const FutexWord& word) noexcept -> void;
+
+/// Tells the CPU that the calling thread is spinning, which lets the other
+/// hyperthread of the core run and saves power.
+inline auto spinHint() noexcept -> void {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/// Wraps `T` so that it has a cache line of its own, which keeps a hot lock
+/// from sharing a line with the data around it (false sharing).
+template <class T> struct alignas(64) Padded : public T {
+  using T::T;
+};
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_FUTEX_H
@@ -0,0 +1,98 @@
+#ifndef CBL_SYNC_MUTEX_H
+#define CBL_SYNC_MUTEX_H
+
+#include "cbl/sync/futex.h" // FutexWord, futexWake, Padded
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+/// A mutual exclusion lock, one 32-bit word in size.
+///
+/// Locking and unlocking an uncontended mutex is a single atomic
+/// instruction each. A thread that finds the mutex locked spins for a while,
+/// since critical sections are usually short, and then sleeps on a futex.
+/// Spinning is adaptive: it stops as soon as other threads are asleep on the
+/// mutex, since unlocking will then wake one of them, and it backs off
+/// exponentially to keep the cache line quiet.
+///
+/// The mutex is not fair and not recursive.
+struct Mutex {
+  explicit Mutex() noexcept               = default;
+  Mutex(Mutex&&) noexcept                 = delete;
+  Mutex(const Mutex&) noexcept            = delete;
+  Mutex& operator=(Mutex&&) noexcept      = delete;
+  Mutex& operator=(const Mutex&) noexcept = delete;
+  ~Mutex() noexcept                       = default;
+
+public:
+  /// Locks the mutex, blocking until it is available.
+  auto lock() noexcept -> void {
+    uint32_t unlocked = UNLOCKED;
+    if (!this->_state.compare_exchange_weak(unlocked, LOCKED,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed))
+        [[unlikely]] {
+      this->lockSlow();
+    }
+  }
+
+  /// Locks the mutex if it is available, returning `false` otherwise.
+  auto tryLock() noexcept -> bool {
+    uint32_t unlocked = UNLOCKED;
+    return this->_state.compare_exchange_strong(unlocked, LOCKED,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed);
+  }
+
+  /// Unlocks the mutex, waking up a waiting thread if there is one.
+  ///
+  /// # Note
+  ///
+  /// The mutex must be locked by the calling thread.
+  auto unlock() noexcept -> void {
+    if (this->_state.exchange(UNLOCKED, std::memory_order_release) ==
+        CONTENDED) [[unlikely]] {
+      futexWake(this->_state, 1);
+    }
+  }
+
+private:
+  static constexpr uint32_t UNLOCKED  = 0;
+  static constexpr uint32_t LOCKED    = 1;
+  /// Locked, and other threads may be asleep waiting for it.
+  static constexpr uint32_t CONTENDED = 2;
+
+  auto lockSlow() noexcept -> void;
+
+  FutexWord _state{UNLOCKED};
+};
+
+/// A mutex on a cache line of its own.
+using PaddedMutex = Padded<Mutex>;
+
+/// Holds a lock until the end of the enclosing scope.
+///
+/// `L` is any type with `lock` and `unlock` methods, such as `Mutex`,
+/// `SpinLock`, or `RwLock` for exclusive access.
+template <class L> struct Guard {
+  explicit Guard() noexcept               = delete;
+  Guard(Guard&&) noexcept                 = delete;
+  Guard(const Guard&) noexcept            = delete;
+  Guard& operator=(Guard&&) noexcept      = delete;
+  Guard& operator=(const Guard&) noexcept = delete;
+
+public:
+  /// Locks `lock`.
+  explicit Guard(L& lock) noexcept : _lock{lock} { this->_lock.lock(); }
+
+  /// Unlocks the lock.
+  ~Guard() noexcept { this->_lock.unlock(); }
+
+private:
+  L& _lock;
+};
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_MUTEX_H
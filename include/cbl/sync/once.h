@@ -0,0 +1,67 @@
+#ifndef CBL_SYNC_ONCE_H
+#define CBL_SYNC_ONCE_H
+
+#include "cbl/sync/futex.h" // FutexWord, Padded
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+/// Runs a function exactly once, one 32-bit word in size.
+///
+/// The first thread to call `call` runs the function, and any other thread
+/// calling it meanwhile blocks until the function has returned. Once it has,
+/// `call` is a single load.
+struct Once {
+  explicit Once() noexcept              = default;
+  Once(Once&&) noexcept                 = delete;
+  Once(const Once&) noexcept            = delete;
+  Once& operator=(Once&&) noexcept      = delete;
+  Once& operator=(const Once&) noexcept = delete;
+  ~Once() noexcept                      = default;
+
+public:
+  /// Runs `f` if no call has run yet, and otherwise waits for the call that
+  /// runs it to finish.
+  ///
+  /// # Note
+  ///
+  /// `f` must not call `call` on the same `Once`.
+  template <class F> auto call(F&& f) noexcept -> void {
+    if (this->isDone()) [[likely]] {
+      return;
+    }
+    if (this->begin()) {
+      f();
+      this->finish();
+    }
+  }
+
+  /// Returns `true` if a call has finished running its function.
+  auto isDone() const noexcept -> bool {
+    return this->_state.load(std::memory_order_acquire) == DONE;
+  }
+
+private:
+  static constexpr uint32_t INCOMPLETE = 0;
+  static constexpr uint32_t RUNNING    = 1;
+  /// Running, and threads may be asleep waiting for it.
+  static constexpr uint32_t WAITING    = 2;
+  static constexpr uint32_t DONE       = 3;
+
+  /// Returns `true` if the calling thread must run the function, or waits
+  /// for the thread that runs it and returns `false`.
+  auto begin() noexcept -> bool;
+
+  /// Marks the function as run, waking up the waiting threads.
+  auto finish() noexcept -> void;
+
+  FutexWord _state{INCOMPLETE};
+};
+
+/// A once flag on a cache line of its own.
+using PaddedOnce = Padded<Once>;
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_ONCE_H
@@ -0,0 +1,70 @@
+#ifndef CBL_SYNC_RESET_EVENT_H
+#define CBL_SYNC_RESET_EVENT_H
+
+#include "cbl/primitives.h" // u64
+#include "cbl/sync/futex.h" // FutexWord, NO_TIMEOUT, Padded
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+/// A flag that threads can wait on until it is set, one 32-bit word in size.
+///
+/// Setting the event wakes every waiting thread, and later waits return
+/// immediately until the event is reset.
+struct ResetEvent {
+  explicit ResetEvent() noexcept                    = default;
+  ResetEvent(ResetEvent&&) noexcept                 = delete;
+  ResetEvent(const ResetEvent&) noexcept            = delete;
+  ResetEvent& operator=(ResetEvent&&) noexcept      = delete;
+  ResetEvent& operator=(const ResetEvent&) noexcept = delete;
+  ~ResetEvent() noexcept                            = default;
+
+public:
+  /// Returns `true` if the event is set.
+  auto isSet() const noexcept -> bool {
+    return this->_state.load(std::memory_order_acquire) == IS_SET;
+  }
+
+  /// Blocks until the event is set.
+  auto wait() noexcept -> void {
+    if (!this->isSet()) {
+      (void)this->waitSlow(NO_TIMEOUT);
+    }
+  }
+
+  /// Blocks until the event is set for at most `timeout_ns` nanoseconds,
+  /// returning `false` if the timeout expired.
+  auto waitFor(u64 timeout_ns) noexcept -> bool {
+    return this->isSet() || this->waitSlow(timeout_ns);
+  }
+
+  /// Sets the event, waking up every waiting thread.
+  auto set() noexcept -> void;
+
+  /// Unsets the event.
+  ///
+  /// # Note
+  ///
+  /// No thread may be waiting on the event.
+  auto reset() noexcept -> void {
+    this->_state.store(UNSET, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr uint32_t UNSET   = 0;
+  /// Unset, and threads may be asleep waiting for it.
+  static constexpr uint32_t WAITING = 1;
+  static constexpr uint32_t IS_SET  = 2;
+
+  auto waitSlow(u64 timeout_ns) noexcept -> bool;
+
+  FutexWord _state{UNSET};
+};
+
+/// A reset event on a cache line of its own.
+using PaddedResetEvent = Padded<ResetEvent>;
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_RESET_EVENT_H
@@ -0,0 +1,170 @@
+#ifndef CBL_SYNC_RW_LOCK_H
+#define CBL_SYNC_RW_LOCK_H
+
+#include "cbl/sync/futex.h" // FutexWord, Padded
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+/// A reader-writer lock, two 32-bit words in size.
+///
+/// Any number of readers or a single writer can hold the lock. The lock
+/// prefers writers: once a writer waits, new readers wait as well, so a
+/// steady stream of readers cannot starve writers.
+///
+/// The first word holds the number of readers (or a marker for the writer)
+/// and whether readers and writers are waiting; readers sleep on it. Writers
+/// sleep on the second word, which is bumped to wake one of them.
+struct RwLock {
+  explicit RwLock() noexcept                = default;
+  RwLock(RwLock&&) noexcept                 = delete;
+  RwLock(const RwLock&) noexcept            = delete;
+  RwLock& operator=(RwLock&&) noexcept      = delete;
+  RwLock& operator=(const RwLock&) noexcept = delete;
+  ~RwLock() noexcept                        = default;
+
+public:
+  /// Locks for shared access, blocking while a writer holds or waits for the
+  /// lock.
+  auto lockShared() noexcept -> void {
+    uint32_t state = this->_state.load(std::memory_order_relaxed);
+    if (!isReadLockable(state) ||
+        !this->_state.compare_exchange_weak(state, state + READ_LOCKED,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed))
+        [[unlikely]] {
+      this->lockSharedSlow();
+    }
+  }
+
+  /// Locks for shared access if no writer holds or waits for the lock,
+  /// returning `false` otherwise.
+  auto tryLockShared() noexcept -> bool {
+    uint32_t state = this->_state.load(std::memory_order_relaxed);
+    while (isReadLockable(state)) {
+      if (this->_state.compare_exchange_weak(state, state + READ_LOCKED,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Unlocks shared access.
+  ///
+  /// # Note
+  ///
+  /// The calling thread must hold shared access.
+  auto unlockShared() noexcept -> void {
+    const uint32_t state =
+        this->_state.fetch_sub(READ_LOCKED, std::memory_order_release) -
+        READ_LOCKED;
+    // Readers only wait while a writer holds or waits for the lock, so only
+    // a waiting writer has to be woken up
+    if (isUnlocked(state) && ((state & WRITERS_WAITING) != 0)) [[unlikely]] {
+      this->wake(state);
+    }
+  }
+
+  /// Locks for exclusive access, blocking while any thread holds the lock.
+  auto lock() noexcept -> void {
+    uint32_t unlocked = 0;
+    if (!this->_state.compare_exchange_weak(unlocked, WRITE_LOCKED,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed))
+        [[unlikely]] {
+      this->lockSlow();
+    }
+  }
+
+  /// Locks for exclusive access if no thread holds the lock, returning
+  /// `false` otherwise.
+  auto tryLock() noexcept -> bool {
+    uint32_t state = this->_state.load(std::memory_order_relaxed);
+    while (isUnlocked(state)) {
+      if (this->_state.compare_exchange_weak(state, state + WRITE_LOCKED,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Unlocks exclusive access.
+  ///
+  /// # Note
+  ///
+  /// The calling thread must hold exclusive access.
+  auto unlock() noexcept -> void {
+    const uint32_t state =
+        this->_state.fetch_sub(WRITE_LOCKED, std::memory_order_release) -
+        WRITE_LOCKED;
+    if ((state & (READERS_WAITING | WRITERS_WAITING)) != 0) [[unlikely]] {
+      this->wake(state);
+    }
+  }
+
+  /// Holds shared access until the end of the enclosing scope.
+  struct SharedGuard {
+    explicit SharedGuard() noexcept                     = delete;
+    SharedGuard(SharedGuard&&) noexcept                 = delete;
+    SharedGuard(const SharedGuard&) noexcept            = delete;
+    SharedGuard& operator=(SharedGuard&&) noexcept      = delete;
+    SharedGuard& operator=(const SharedGuard&) noexcept = delete;
+
+  public:
+    /// Locks `lock` for shared access.
+    explicit SharedGuard(RwLock& lock) noexcept : _lock{lock} {
+      this->_lock.lockShared();
+    }
+
+    /// Unlocks shared access.
+    ~SharedGuard() noexcept { this->_lock.unlockShared(); }
+
+  private:
+    RwLock& _lock;
+  };
+
+private:
+  /// Every reader adds `READ_LOCKED`, and a writer sets every bit of `MASK`.
+  static constexpr uint32_t READ_LOCKED     = 1;
+  static constexpr uint32_t MASK            = (1U << 30) - 1;
+  static constexpr uint32_t WRITE_LOCKED    = MASK;
+  static constexpr uint32_t MAX_READERS     = MASK - 1;
+  static constexpr uint32_t READERS_WAITING = 1U << 30;
+  static constexpr uint32_t WRITERS_WAITING = 1U << 31;
+
+  static constexpr auto isUnlocked(uint32_t state) noexcept -> bool {
+    return (state & MASK) == 0;
+  }
+
+  static constexpr auto isReadLockable(uint32_t state) noexcept -> bool {
+    // Readers also wait while other readers wait, so that woken readers are
+    // not overtaken
+    return ((state & MASK) < MAX_READERS) &&
+           ((state & (READERS_WAITING | WRITERS_WAITING)) == 0);
+  }
+
+  auto lockSharedSlow() noexcept -> void;
+  auto lockSlow() noexcept -> void;
+
+  /// Wakes a writer or the readers after the lock was released, leaving
+  /// `state`.
+  auto wake(uint32_t state) noexcept -> void;
+
+  /// Wakes a writer, returning `false` if none was asleep.
+  auto wakeWriter() noexcept -> bool;
+
+  FutexWord _state{0};
+  FutexWord _writer_notify{0};
+};
+
+/// A reader-writer lock on a cache line of its own.
+using PaddedRwLock = Padded<RwLock>;
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_RW_LOCK_H
@@ -0,0 +1,70 @@
+#ifndef CBL_SYNC_SPIN_LOCK_H
+#define CBL_SYNC_SPIN_LOCK_H
+
+#include "cbl/primitives.h" // u32
+#include "cbl/sync/futex.h" // Padded, spinHint
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+/// A lock that never sleeps, one 32-bit word in size.
+///
+/// Waiting threads spin on a plain load, so the lock's cache line stays
+/// shared until it is released, and back off exponentially between loads.
+///
+/// # Note
+///
+/// A spin lock only pays off for critical sections of a few instructions
+/// that never block: a preempted owner keeps the waiters spinning for a
+/// whole time slice. Use `Mutex` otherwise.
+struct SpinLock {
+  explicit SpinLock() noexcept                  = default;
+  SpinLock(SpinLock&&) noexcept                 = delete;
+  SpinLock(const SpinLock&) noexcept            = delete;
+  SpinLock& operator=(SpinLock&&) noexcept      = delete;
+  SpinLock& operator=(const SpinLock&) noexcept = delete;
+  ~SpinLock() noexcept                          = default;
+
+public:
+  /// Locks the lock, spinning until it is available.
+  auto lock() noexcept -> void {
+    u32 backoff = 1;
+    while (this->_locked.exchange(1, std::memory_order_acquire) != 0) {
+      do {
+        for (u32 i = 0; i < backoff; i++) {
+          spinHint();
+        }
+        backoff = (backoff < MAX_BACKOFF) ? 2 * backoff : backoff;
+      } while (this->_locked.load(std::memory_order_relaxed) != 0);
+    }
+  }
+
+  /// Locks the lock if it is available, returning `false` otherwise.
+  auto tryLock() noexcept -> bool {
+    return (this->_locked.load(std::memory_order_relaxed) == 0) &&
+           (this->_locked.exchange(1, std::memory_order_acquire) == 0);
+  }
+
+  /// Unlocks the lock.
+  ///
+  /// # Note
+  ///
+  /// The lock must be held by the calling thread.
+  auto unlock() noexcept -> void {
+    this->_locked.store(0, std::memory_order_release);
+  }
+
+private:
+  /// The most `spinHint`s between two loads.
+  static constexpr u32 MAX_BACKOFF = 64;
+
+  std::atomic<uint32_t> _locked{0};
+};
+
+/// A spin lock on a cache line of its own.
+using PaddedSpinLock = Padded<SpinLock>;
+
+} // namespace cbl::sync
+
+#endif // !CBL_SYNC_SPIN_LOCK_H
@@ -0,0 +1,234 @@
+#ifndef CBL_TRACE_H
+#define CBL_TRACE_H
+
+#include "cbl/io/writer.h"     // Writer
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u32, u64, i64, usize, const_cstr
+#include "cbl/slice.h"         // Slice
+#include <atomic>              // atomic
+#include <source_location>     // source_location
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#else
+#include <time.h> // clock_gettime
+#endif
+
+/// Instrumentation zones and counters.
+///
+/// `CBL_TRACE_ZONE` and `CBL_TRACE_COUNTER` are only compiled in when
+/// `CBL_TRACE_ON` is defined (`zig build -Dtrace=true`); otherwise they
+/// expand to nothing, so instrumented code pays nothing for them.
+// clang-format off
+#ifdef CBL_TRACE_ON
+  #define CBL_TRACE_CONCAT_(a, b) a##b
+  #define CBL_TRACE_CONCAT(a, b)  CBL_TRACE_CONCAT_(a, b)
+
+  /// Records the time spent until the end of the enclosing scope as a zone
+  /// named `name`, which must be a string literal.
+  #define CBL_TRACE_ZONE(name)                                                 \
+    static constexpr ::cbl::trace::Site CBL_TRACE_CONCAT(                      \
+        cbl_trace_site_, __LINE__){name};                                      \
+    ::cbl::trace::Zone CBL_TRACE_CONCAT(cbl_trace_zone_, __LINE__) {           \
+      CBL_TRACE_CONCAT(cbl_trace_site_, __LINE__)                              \
+    }
+
+  /// Records `value` for the counter named `name`, which must be a string
+  /// literal.
+  #define CBL_TRACE_COUNTER(name, value)                                       \
+    do {                                                                       \
+      static constexpr ::cbl::trace::Site cbl_trace_site{name};                \
+      ::cbl::trace::counter(cbl_trace_site, static_cast<::cbl::i64>(value));   \
+    } while (false)
+#else
+  #define CBL_TRACE_ZONE(name)           ((void)0)
+  #define CBL_TRACE_COUNTER(name, value) ((void)0)
+#endif // CBL_TRACE_ON
+// clang-format on
+
+namespace cbl::trace {
+
+/// A place in the code that records events.
+///
+/// Sites are `static constexpr`, so the address of a site identifies it.
+struct Site {
+  const_cstr name;
+  const_cstr file;
+  const_cstr function;
+  u32        line;
+
+  /// Creates a site named `name` at the location of the caller.
+  constexpr explicit Site(const_cstr           name,
+                          std::source_location loc =
+                              std::source_location::current()) noexcept
+      : name{name}, file{loc.file_name()}, function{loc.function_name()},
+        line{static_cast<u32>(loc.line())} {}
+};
+
+enum class Kind {
+  Begin   = 0,
+  End     = 1,
+  Counter = 2,
+};
+
+/// A fixed-size event, as stored in the per-thread buffers.
+struct Event {
+  /// Ticks of `now()`.
+  u64         time;
+  const Site* site;
+  /// The value of a counter, or 0.
+  i64         value;
+  Kind        kind;
+};
+
+/// The number of events each thread can buffer; events recorded while the
+/// buffer is full are dropped (see `dropped`).
+inline constexpr usize BUFFER_EVENTS = 1 << 16;
+
+/// Returns the current time in ticks.
+///
+/// Ticks are TSC cycles on x86 and nanoseconds elsewhere; the exporters
+/// convert them to nanoseconds.
+inline auto now() noexcept -> u64 {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<u64>(ts.tv_sec) * 1000000000ULL +
+         static_cast<u64>(ts.tv_nsec);
+#endif
+}
+
+namespace detail {
+
+/// A single-producer, single-consumer ring of events, written by its thread
+/// and drained by the exporters.
+struct ThreadBuffer {
+  Slice<Event>       events;
+  u32                thread;
+  std::atomic<bool>  retired{false};
+  std::atomic<usize> dropped{0};
+  ThreadBuffer*      next = nullptr;
+
+  /// Written by the owning thread.
+  alignas(64) std::atomic<usize> tail{0};
+  usize cached_head = 0;
+  /// The number of zones that are open, each of which has a slot reserved
+  /// for its end event.
+  usize open        = 0;
+
+  /// Written by the exporters.
+  alignas(64) std::atomic<usize> head{0};
+};
+
+inline thread_local ThreadBuffer* t_buffer = nullptr;
+
+/// Returns a buffer for the calling thread, registering one on first use.
+auto registerThread() noexcept -> ThreadBuffer*;
+
+/// Pushes `event`, keeping `reserve` slots free, returning `false` if the
+/// buffer is full.
+inline auto push(ThreadBuffer& buf, const Event& event,
+                 usize reserve) noexcept -> bool {
+  const usize tail = buf.tail.load(std::memory_order_relaxed);
+  if (tail - buf.cached_head + reserve >= BUFFER_EVENTS) {
+    buf.cached_head = buf.head.load(std::memory_order_acquire);
+    if (tail - buf.cached_head + reserve >= BUFFER_EVENTS) {
+      buf.dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  buf.events.getUnchecked(tail & (BUFFER_EVENTS - 1)) = event;
+  buf.tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+inline auto buffer() noexcept -> ThreadBuffer& {
+  ThreadBuffer* buf = t_buffer;
+  if (buf == nullptr) [[unlikely]] {
+    buf = registerThread();
+  }
+  return *buf;
+}
+
+} // namespace detail
+
+/// Records a begin event when created and an end event when destroyed.
+///
+/// A zone whose begin event is dropped also drops its end event, and a
+/// recorded begin event always has room for its end event, so the zones of
+/// a thread are always balanced.
+struct Zone {
+  explicit Zone() noexcept              = delete;
+  Zone(Zone&&) noexcept                 = delete;
+  Zone(const Zone&) noexcept            = delete;
+  Zone& operator=(Zone&&) noexcept      = delete;
+  Zone& operator=(const Zone&) noexcept = delete;
+
+public:
+  /// Opens a zone for `site`.
+  explicit Zone(const Site& site) noexcept : _site{&site} {
+    detail::ThreadBuffer& buf = detail::buffer();
+    this->_recorded           = detail::push(
+        buf, Event{now(), &site, 0, Kind::Begin}, buf.open + 1);
+    buf.open                 += this->_recorded ? 1 : 0;
+  }
+
+  /// Closes the zone.
+  ~Zone() noexcept {
+    if (this->_recorded) {
+      detail::ThreadBuffer& buf = detail::buffer();
+      buf.open                 -= 1;
+      detail::push(buf, Event{now(), this->_site, 0, Kind::End}, buf.open);
+    }
+  }
+
+private:
+  const Site* _site;
+  bool        _recorded;
+};
+
+/// Records `value` for the counter of `site`.
+inline auto counter(const Site& site, i64 value) noexcept -> void {
+  detail::ThreadBuffer& buf = detail::buffer();
+  detail::push(buf, Event{now(), &site, value, Kind::Counter}, buf.open);
+}
+
+/// Returns the number of events dropped because a buffer was full.
+auto dropped() noexcept -> usize;
+
+/// Drains the events of every thread into `writer` as Chrome trace JSON,
+/// which can be opened with `chrome://tracing` or Perfetto, returning the
+/// number of events written.
+auto exportChromeJson(io::Writer& writer) noexcept -> usize;
+
+/// Drains the events of every thread into `writer` in a compact binary
+/// format, returning the number of events written.
+///
+/// The stream is encoded with `io::BinaryWriter`:
+///
+/// * A header: `BINARY_MAGIC` (`u32`), the version (`u8`), and the
+///   nanoseconds per tick (`f64`).
+/// * The sites: their number (varint), and for every site its name, file
+///   and function (`Slice<u8>`) and line (`u32`). Events refer to sites by
+///   their index in this table.
+/// * For every thread with events: the tag 1 (`u8`), the thread index and
+///   the number of events (varints), and for every event its kind (`u8`),
+///   its site (varint), the ticks since the previous event of the thread
+///   (zigzag varint), and for counters the value (zigzag varint).
+/// * The tag 0 (`u8`).
+///
+/// `allocator` is used for the table of sites while exporting.
+auto exportBinary(mem::Allocator& allocator, io::Writer& writer) noexcept
+    -> usize;
+
+/// The first field of the binary format, "CBLT" in little-endian order.
+inline constexpr u32 BINARY_MAGIC = 0x544C4243;
+
+/// The version of the binary format.
+inline constexpr u8 BINARY_VERSION = 1;
+
+} // namespace cbl::trace
+
+#endif // !CBL_TRACE_H
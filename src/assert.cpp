@@ -1,18 +1,18 @@
-#include "assert.h"
+#include "cbl/assert.h"
 
-#include "cbl/primitives.h" // const_cstr, usize
-#include <cstdio>           // stderr, fprintf
+#include "cbl/primitives.h" // const_cstr
+#include <cstdio>           // stderr, fprintf, fflush
+#include <cstdlib>          // abort
 #include <source_location>  // source_location
 
-namespace cbl {
+namespace cbl::detail {
 
-auto cbl_assert(bool expr, const_cstr msg,
-                std::source_location loc = std::source_location::current())
-    -> void {
-  if (!expr) {
-    std::fprintf(stderr, "[%s:%d:%d] %s\n", loc.file_name(), // NOLINT
-                 loc.line(), loc.column(), msg);
-  }
+auto assertFail(const_cstr msg, std::source_location loc) noexcept -> void {
+  std::fprintf(stderr, "[%s:%d:%d] %s\n", loc.file_name(), // NOLINT
+               static_cast<int>(loc.line()), static_cast<int>(loc.column()),
+               msg);
+  std::fflush(stderr);
+  std::abort();
 }
 
-} // namespace cbl
+} // namespace cbl::detail
@@ -0,0 +1,279 @@
+#include "cbl/bit_set.h"
+
+#include "cbl/assert.h"        // CBL_ASSERT, CBL_VERIFY
+#include "cbl/cpu.h"           // features
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u64, usize
+#include "cbl/slice.h"         // Slice
+#include "cbl/slice_ops.h"     // copy, fill
+
+#if defined(__x86_64__)
+  #include <immintrin.h> // _pdep_u64
+  #define CBL_BIT_SET_X86
+#endif
+
+namespace cbl {
+
+namespace {
+
+[[gnu::always_inline]] inline auto popcount(u64 word) noexcept -> usize {
+  return static_cast<usize>(
+      __builtin_popcountll(static_cast<unsigned long long>(word)));
+}
+
+[[gnu::always_inline]] inline auto popcountBody(const u64* words,
+                                                usize      len) noexcept
+    -> usize {
+  usize n = 0;
+  for (usize i = 0; i < len; i++) {
+    n += popcount(words[i]);
+  }
+  return n;
+}
+
+/// Returns the index of the set bit with rank `k` in `word`.
+auto selectInWordScalar(u64 word, usize k) noexcept -> usize {
+  for (usize i = 0; i < k; i++) {
+    word &= word - 1;
+  }
+  return static_cast<usize>(
+      __builtin_ctzll(static_cast<unsigned long long>(word)));
+}
+
+#if defined(CBL_BIT_SET_X86)
+__attribute__((target("popcnt"))) auto
+popcountHardware(const u64* words, usize len) noexcept -> usize {
+  return popcountBody(words, len);
+}
+
+/// `pdep` deposits the `k`th bit of `1 << k` at the position of the `k`th set
+/// bit of `word`.
+__attribute__((target("bmi,bmi2"))) auto selectInWordBmi2(u64   word,
+                                                          usize k) noexcept
+    -> usize {
+  const unsigned long long bit =
+      _pdep_u64(1ULL << k, static_cast<unsigned long long>(word));
+  return static_cast<usize>(_tzcnt_u64(bit));
+}
+#endif
+
+auto selectInWord(u64 word, usize k) noexcept -> usize {
+#if defined(CBL_BIT_SET_X86)
+  if (cpu::features().bmi2) {
+    return selectInWordBmi2(word, k);
+  }
+#endif
+  return selectInWordScalar(word, k);
+}
+
+} // namespace
+
+namespace detail {
+
+auto popcountWords(const u64* words, usize len) noexcept -> usize {
+#if defined(CBL_BIT_SET_X86)
+  if (cpu::features().popcnt) {
+    return popcountHardware(words, len);
+  }
+#endif
+  return popcountBody(words, len);
+}
+
+} // namespace detail
+
+DynamicBitSet::DynamicBitSet(mem::Allocator& allocator) noexcept
+    : _allocator{&allocator} {}
+
+auto DynamicBitSet::initEmpty(mem::Allocator& allocator,
+                              usize           len) noexcept -> DynamicBitSet {
+  DynamicBitSet self{allocator};
+  self.resize(len);
+  return self;
+}
+
+auto DynamicBitSet::initFromOwnedWords(mem::Allocator& allocator,
+                                       Slice<u64>      words,
+                                       usize len) noexcept -> DynamicBitSet {
+  CBL_ASSERT(detail::bitSetWords(len) <= words.len(),
+             "The words are too short for the set");
+  DynamicBitSet self{allocator};
+  self._words = words;
+  self._len   = len;
+  return self;
+}
+
+auto DynamicBitSet::deinit() noexcept -> void {
+  this->_allocator->destroyArray(this->_words);
+  this->_words = Slice<u64>{};
+  this->_len   = 0;
+}
+
+auto DynamicBitSet::resize(usize len) noexcept -> void {
+  const usize new_words = detail::bitSetWords(len);
+  if (new_words != this->_words.len()) {
+    Slice<u64> words = this->_allocator->createArray<u64>(new_words);
+    CBL_VERIFY((new_words == 0) || !words.isEmpty(), "Allocation failed");
+
+    const usize kept = (new_words < this->_words.len()) ? new_words
+                                                        : this->_words.len();
+    slice::copy(words, this->_words.first(kept));
+    this->_allocator->destroyArray(this->_words);
+    this->_words = words;
+  }
+
+  // Growing within the last word exposes bits that are already unset;
+  // shrinking must clear the bits that are cut off
+  this->_len = len;
+  this->maskLast();
+}
+
+auto DynamicBitSet::setAll() noexcept -> void {
+  slice::fill(this->_words, ~u64(0));
+  this->maskLast();
+}
+
+auto DynamicBitSet::unsetAll() noexcept -> void {
+  slice::fill(this->_words, u64(0));
+}
+
+auto DynamicBitSet::toggleAll() noexcept -> void {
+  for (u64& word : this->_words) {
+    word = ~word;
+  }
+  this->maskLast();
+}
+
+auto DynamicBitSet::setUnion(const DynamicBitSet& other) noexcept -> void {
+  CBL_ASSERT(this->_len == other._len, "The sets must have the same length");
+  u64*       dst = this->_words.ptr();
+  const u64* src = other._words.ptr();
+  for (usize i = 0; i < this->_words.len(); i++) {
+    dst[i] |= src[i];
+  }
+}
+
+auto DynamicBitSet::setIntersection(const DynamicBitSet& other) noexcept
+    -> void {
+  CBL_ASSERT(this->_len == other._len, "The sets must have the same length");
+  u64*       dst = this->_words.ptr();
+  const u64* src = other._words.ptr();
+  for (usize i = 0; i < this->_words.len(); i++) {
+    dst[i] &= src[i];
+  }
+}
+
+auto DynamicBitSet::setDifference(const DynamicBitSet& other) noexcept
+    -> void {
+  CBL_ASSERT(this->_len == other._len, "The sets must have the same length");
+  u64*       dst = this->_words.ptr();
+  const u64* src = other._words.ptr();
+  for (usize i = 0; i < this->_words.len(); i++) {
+    dst[i] &= ~src[i];
+  }
+}
+
+auto DynamicBitSet::toggleSet(const DynamicBitSet& other) noexcept -> void {
+  CBL_ASSERT(this->_len == other._len, "The sets must have the same length");
+  u64*       dst = this->_words.ptr();
+  const u64* src = other._words.ptr();
+  for (usize i = 0; i < this->_words.len(); i++) {
+    dst[i] ^= src[i];
+  }
+}
+
+auto DynamicBitSet::count() const noexcept -> usize {
+  return detail::popcountWords(this->_words.ptr(), this->_words.len());
+}
+
+auto DynamicBitSet::eql(const DynamicBitSet& other) const noexcept -> bool {
+  return (this->_len == other._len) && slice::equal(this->_words, other._words);
+}
+
+auto DynamicBitSet::iterator() const noexcept -> SetBitIterator {
+  return SetBitIterator{this->_words};
+}
+
+auto DynamicBitSet::maskLast() noexcept -> void {
+  if (!this->_words.isEmpty()) {
+    this->_words.getUnchecked(this->_words.len() - 1) &=
+        detail::bitSetLastMask(this->_len);
+  }
+}
+
+RankSelect::RankSelect(mem::Allocator& allocator, Slice<const u64> words,
+                       usize len) noexcept
+    : _allocator{&allocator}, _words{words}, _len{len} {
+  CBL_ASSERT(detail::bitSetWords(len) <= words.len(),
+             "The words are too short for the index");
+  const usize num_words  = detail::bitSetWords(len);
+  const usize num_blocks = (num_words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+  this->_ranks           = allocator.createArray<u64>(num_blocks + 1);
+  CBL_VERIFY(!this->_ranks.isEmpty(), "Allocation failed");
+
+  usize total = 0;
+  for (usize b = 0; b < num_blocks; b++) {
+    this->_ranks.getUnchecked(b) = static_cast<u64>(total);
+    const usize start            = b * BLOCK_WORDS;
+    const usize end = (start + BLOCK_WORDS < num_words) ? start + BLOCK_WORDS
+                                                        : num_words;
+    total += detail::popcountWords(words.ptr() + start, end - start);
+  }
+  this->_ranks.getUnchecked(num_blocks) = static_cast<u64>(total);
+}
+
+auto RankSelect::deinit() noexcept -> void {
+  this->_allocator->destroyArray(this->_ranks);
+  this->_ranks = Slice<u64>{};
+}
+
+auto RankSelect::isSet(usize idx) const noexcept -> bool {
+  CBL_ASSERT(idx < this->_len, "The index is outside the index's bounds");
+  return ((this->_words.getUnchecked(idx / 64) >> (idx % 64)) & 1) != 0;
+}
+
+auto RankSelect::rank(usize idx) const noexcept -> usize {
+  CBL_ASSERT(idx <= this->_len, "The index is outside the index's bounds");
+  const usize word  = idx / 64;
+  const usize block = word / BLOCK_WORDS;
+  usize       n     = static_cast<usize>(this->_ranks.getUnchecked(block));
+  for (usize i = block * BLOCK_WORDS; i < word; i++) {
+    n += popcount(this->_words.getUnchecked(i));
+  }
+  if ((idx % 64) != 0) {
+    const u64 mask  = (u64(1) << (idx % 64)) - 1;
+    n              += popcount(this->_words.getUnchecked(word) & mask);
+  }
+  return n;
+}
+
+auto RankSelect::select(usize k) const noexcept -> usize {
+  CBL_ASSERT(k < this->count(), "The rank is greater than the bit count");
+
+  // Find the last block that starts with at most `k` set bits before it
+  usize lo = 0;
+  usize hi = this->_ranks.len() - 1;
+  while (hi - lo > 1) {
+    const usize mid = lo + (hi - lo) / 2;
+    if (static_cast<usize>(this->_ranks.getUnchecked(mid)) <= k) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  usize remaining = k - static_cast<usize>(this->_ranks.getUnchecked(lo));
+  for (usize i = lo * BLOCK_WORDS;; i++) {
+    const u64   word = this->_words.getUnchecked(i);
+    const usize n    = popcount(word);
+    if (remaining < n) {
+      return i * 64 + selectInWord(word, remaining);
+    }
+    remaining -= n;
+  }
+}
+
+auto RankSelect::count() const noexcept -> usize {
+  return static_cast<usize>(this->_ranks.getUnchecked(this->_ranks.len() - 1));
+}
+
+} // namespace cbl
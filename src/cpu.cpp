@@ -0,0 +1,53 @@
+#include "cbl/cpu.h"
+
+#if defined(__x86_64__)
+  #include <cpuid.h> // __get_cpuid, __get_cpuid_count
+#endif
+
+namespace cbl::cpu {
+
+namespace {
+
+auto detect() noexcept -> Features {
+  Features features;
+#if defined(__x86_64__)
+  unsigned eax = 0;
+  unsigned ebx = 0;
+  unsigned ecx = 0;
+  unsigned edx = 0;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return features;
+  }
+  features.sse42        = (ecx & (1U << 20)) != 0;
+  features.popcnt       = (ecx & (1U << 23)) != 0;
+  const bool osxsave    = (ecx & (1U << 27)) != 0;
+  const bool avx        = (ecx & (1U << 28)) != 0;
+
+  // Check which register state the OS saves on context switches
+  unsigned xcr0_lo = 0;
+  unsigned xcr0_hi = 0;
+  if (osxsave) {
+    __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  }
+  const bool ymm_state = (xcr0_lo & 0x6) == 0x6;
+  const bool zmm_state = (xcr0_lo & 0xE6) == 0xE6;
+
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+    return features;
+  }
+  features.avx2     = avx && ymm_state && ((ebx & (1U << 5)) != 0);
+  features.bmi2     = (ebx & (1U << 8)) != 0;
+  features.avx512f  = zmm_state && ((ebx & (1U << 16)) != 0);
+  features.avx512bw = features.avx512f && ((ebx & (1U << 30)) != 0);
+#endif
+  return features;
+}
+
+} // namespace
+
+auto features() noexcept -> const Features& {
+  static const Features detected = detect();
+  return detected;
+}
+
+} // namespace cbl::cpu
@@ -0,0 +1,87 @@
+#include "cbl/io/binary.h"
+
+#include "cbl/io/writer.h"  // Writer
+#include "cbl/primitives.h" // u8, u64, usize
+#include "cbl/slice.h"      // Slice
+
+namespace cbl::io {
+
+BinaryWriter::BinaryWriter(Writer& writer) noexcept : _writer{&writer} {}
+
+auto BinaryWriter::writeVarint(u64 value) noexcept -> bool {
+  // At most 10 bytes for 64 bits
+  u8    bytes[10];
+  usize len = 0;
+  do {
+    u8 byte   = static_cast<u8>(value & 0x7F);
+    value   >>= 7;
+    if (value != 0) {
+      byte |= 0x80;
+    }
+    bytes[len]  = byte;
+    len        += 1;
+  } while (value != 0);
+  return this->writeBytes(bytes, len);
+}
+
+auto BinaryWriter::written() const noexcept -> usize { return this->_pos; }
+
+auto BinaryWriter::writeBytes(const void* bytes, usize len) noexcept -> bool {
+  if (len == 0) {
+    return true;
+  }
+  const usize written = this->_writer->writeAll(
+      Slice<u8>{static_cast<u8*>(const_cast<void*>(bytes)), len});
+  this->_pos += written;
+  return written == len;
+}
+
+auto BinaryWriter::pad(usize alignment) noexcept -> bool {
+  static constexpr u8 ZEROES[64] = {};
+  usize padding = (alignment - (this->_pos % alignment)) % alignment;
+  while (padding != 0) {
+    usize len  = (padding < sizeof(ZEROES)) ? padding : sizeof(ZEROES);
+    if (!this->writeBytes(ZEROES, len)) {
+      return false;
+    }
+    padding -= len;
+  }
+  return true;
+}
+
+BinaryReader::BinaryReader(Slice<u8> buf) noexcept : _buf{buf} {}
+
+auto BinaryReader::readVarint(u64* out) noexcept -> bool {
+  u64   value = 0;
+  usize pos   = this->_pos;
+  for (usize shift = 0; shift < 64; shift += 7) {
+    if (pos >= this->_buf.len()) {
+      return false;
+    }
+    const u8 byte  = this->_buf[pos];
+    pos           += 1;
+    value         |= static_cast<u64>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *out       = value;
+      this->_pos = pos;
+      return true;
+    }
+  }
+  // More than 10 bytes
+  return false;
+}
+
+auto BinaryReader::remaining() const noexcept -> usize {
+  return this->_buf.len() - this->_pos;
+}
+
+auto BinaryReader::skipPadding(usize alignment) noexcept -> bool {
+  const usize padding = (alignment - (this->_pos % alignment)) % alignment;
+  if (padding > this->remaining()) {
+    return false;
+  }
+  this->_pos += padding;
+  return true;
+}
+
+} // namespace cbl::io
@@ -0,0 +1,33 @@
+#include "cbl/io/buffer_writer.h"
+
+#include "cbl/primitives.h" // u8, usize
+#include "cbl/slice.h"      // Slice
+#include <cstring>          // memcpy
+
+namespace cbl::io {
+
+BufferWriter::BufferWriter(Slice<u8> buf) noexcept : _buf{buf} {}
+
+[[nodiscard]] auto BufferWriter::write(Slice<u8> buf) noexcept -> usize {
+  usize len = buf.len();
+  if (len > this->remaining()) {
+    len = this->remaining();
+  }
+  if (len != 0) {
+    std::memcpy(this->_buf.ptr() + this->_pos, buf.ptr(), len);
+    this->_pos += len;
+  }
+  return len;
+}
+
+auto BufferWriter::written() const noexcept -> Slice<u8> {
+  return Slice<u8>{this->_buf.ptr(), this->_pos};
+}
+
+auto BufferWriter::remaining() const noexcept -> usize {
+  return this->_buf.len() - this->_pos;
+}
+
+auto BufferWriter::reset() noexcept -> void { this->_pos = 0; }
+
+} // namespace cbl::io
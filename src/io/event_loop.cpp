@@ -0,0 +1,307 @@
+#include "cbl/io/event_loop.h"
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/io/task.h"       // Task
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u64, usize, isize
+#include "cbl/slice.h"         // Slice
+#include "cbl/trace.h"         // CBL_TRACE_ZONE
+#include <atomic>              // memory_order
+#include <cerrno>              // errno, EAGAIN, EEXIST, EINTR, ENOMEM
+#include <coroutine>           // coroutine_handle
+#include <fcntl.h>             // fcntl, O_NONBLOCK
+#include <sys/epoll.h>         // epoll_create1, epoll_ctl, epoll_wait
+#include <sys/eventfd.h>       // eventfd
+#include <sys/timerfd.h>       // timerfd_create, timerfd_settime
+#include <time.h>              // clock_gettime
+#include <unistd.h>            // read, write, close
+#include <utility>             // swap
+
+namespace cbl::io {
+
+namespace {
+
+/// The most events handled per `epoll_wait`.
+constexpr int MAX_EVENTS = 64;
+
+auto monotonicNs() noexcept -> u64 {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<u64>(ts.tv_sec) * 1000000000ULL +
+         static_cast<u64>(ts.tv_nsec);
+}
+
+/// Reads or writes once, returning the number of bytes transferred or a
+/// negated `errno` value.
+auto attempt(int fd, Slice<u8> buf, bool is_write) noexcept -> isize {
+  while (true) {
+    const isize n = is_write ? ::write(fd, buf.ptr(), buf.len())
+                             : ::read(fd, buf.ptr(), buf.len());
+    if (n >= 0) {
+      return n;
+    }
+    if (errno != EINTR) {
+      // `EWOULDBLOCK` is `EAGAIN` on Linux
+      return -errno;
+    }
+  }
+}
+
+} // namespace
+
+auto EventLoop::IoAwaiter::await_ready() noexcept -> bool {
+  this->result = attempt(this->fd, this->buf, this->is_write);
+  return this->result != -EAGAIN;
+}
+
+auto EventLoop::IoAwaiter::await_suspend(
+    std::coroutine_handle<> handle) noexcept -> bool {
+  this->handle = handle;
+  if (!this->loop->watch(this)) {
+    this->result = -errno;
+    return false;
+  }
+  return true;
+}
+
+auto EventLoop::SleepAwaiter::await_ready() const noexcept -> bool {
+  return monotonicNs() >= this->deadline;
+}
+
+auto EventLoop::SleepAwaiter::await_suspend(
+    std::coroutine_handle<> handle) noexcept -> void {
+  EventLoop& loop = *this->loop;
+  loop._timers.push(Timer{this->deadline, loop._timer_seq, handle});
+  loop._timer_seq += 1;
+  loop.armTimer();
+}
+
+auto EventLoop::YieldAwaiter::await_suspend(
+    std::coroutine_handle<> handle) noexcept -> void {
+  this->loop->schedule(handle);
+}
+
+EventLoop::EventLoop(mem::Allocator& allocator) noexcept
+    : _allocator{&allocator}, _timers{allocator} {
+  this->_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  this->_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  this->_timer_fd =
+      timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if ((this->_epoll_fd < 0) || (this->_event_fd < 0) ||
+      (this->_timer_fd < 0)) {
+    return;
+  }
+
+  // Both stay readable until they are read, so they are level-triggered
+  for (int fd : {this->_event_fd, this->_timer_fd}) {
+    epoll_event event{};
+    event.events  = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(this->_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+      return;
+    }
+  }
+  this->_valid = true;
+}
+
+EventLoop::~EventLoop() noexcept {
+  for (int fd : {this->_epoll_fd, this->_event_fd, this->_timer_fd}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  this->_ready.deinit(*this->_allocator);
+  this->_running.deinit(*this->_allocator);
+  this->_timers.deinit();
+  this->_allocator->destroyArray(this->_watches);
+}
+
+auto EventLoop::isValid() const noexcept -> bool { return this->_valid; }
+
+auto EventLoop::allocator() noexcept -> mem::Allocator& {
+  return *this->_allocator;
+}
+
+auto EventLoop::spawn(Task<void>&& task) noexcept -> void {
+  auto handle               = task.release();
+  handle.promise().detached = &this->_live;
+  this->_live += 1;
+  this->schedule(handle);
+}
+
+auto EventLoop::run() noexcept -> void {
+  CBL_ASSERT(this->_valid, "The loop is not initialized");
+  CBL_TRACE_ZONE("EventLoop::run");
+
+  epoll_event events[MAX_EVENTS];
+  while (!this->_stopped.exchange(false, std::memory_order_acquire)) {
+    // Tasks scheduled while these run wait for the next iteration, so a
+    // task that keeps yielding does not starve I/O
+    std::swap(this->_ready, this->_running);
+    for (std::coroutine_handle<> handle : this->_running.elems()) {
+      handle.resume();
+    }
+    this->_running.clear();
+
+    if (this->_live == 0) {
+      return;
+    }
+
+    const int timeout = (this->_ready.len() == 0) ? -1 : 0;
+    const int count =
+        epoll_wait(this->_epoll_fd, events, MAX_EVENTS, timeout);
+    if (count < 0) {
+      CBL_ASSERT(errno == EINTR, "epoll_wait failed");
+      continue;
+    }
+    for (int i = 0; i < count; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == this->_event_fd) {
+        u64 value;
+        (void)::read(fd, &value, sizeof(value));
+      } else if (fd == this->_timer_fd) {
+        this->fireTimers();
+      } else {
+        this->dispatch(fd, events[i].events);
+      }
+    }
+  }
+}
+
+auto EventLoop::stop() noexcept -> void {
+  this->_stopped.store(true, std::memory_order_release);
+  const u64 value = 1;
+  (void)::write(this->_event_fd, &value, sizeof(value));
+}
+
+auto EventLoop::sleep(u64 ns) noexcept -> SleepAwaiter {
+  return SleepAwaiter{this, monotonicNs() + ns};
+}
+
+auto EventLoop::readAll(int fd, Slice<u8> buf) noexcept -> Task<isize> {
+  usize done = 0;
+  while (done < buf.len()) {
+    const isize n = co_await this->read(fd, buf.subslice(done, buf.len()));
+    if (n < 0) {
+      co_return n;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += static_cast<usize>(n);
+  }
+  co_return static_cast<isize>(done);
+}
+
+auto EventLoop::writeAll(int fd, Slice<u8> buf) noexcept -> Task<isize> {
+  usize done = 0;
+  while (done < buf.len()) {
+    const isize n = co_await this->write(fd, buf.subslice(done, buf.len()));
+    if (n < 0) {
+      co_return n;
+    }
+    done += static_cast<usize>(n);
+  }
+  co_return static_cast<isize>(done);
+}
+
+auto EventLoop::setNonBlocking(int fd) noexcept -> bool {
+  const int flags = fcntl(fd, F_GETFL);
+  return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0);
+}
+
+auto EventLoop::schedule(std::coroutine_handle<> handle) noexcept -> void {
+  this->_ready.append(*this->_allocator, handle);
+}
+
+auto EventLoop::watch(IoAwaiter* awaiter) noexcept -> bool {
+  const usize fd = static_cast<usize>(awaiter->fd);
+  if (fd >= this->_watches.len()) {
+    usize len = (this->_watches.len() == 0) ? 64 : this->_watches.len() * 2;
+    while (len <= fd) {
+      len *= 2;
+    }
+    Slice<Watch> watches = this->_allocator->createArray<Watch>(len);
+    if (watches.isEmpty()) {
+      errno = ENOMEM;
+      return false;
+    }
+    for (usize i = 0; i < this->_watches.len(); i++) {
+      watches[i] = this->_watches[i];
+    }
+    this->_allocator->destroyArray(this->_watches);
+    this->_watches = watches;
+  }
+
+  // Descriptors stay registered for both directions, and edge-triggered
+  // events that arrive while nobody waits are dropped. Registering again on
+  // every wait costs a syscall, but keeps a closed and reused descriptor
+  // from being missed
+  epoll_event event{};
+  event.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.fd = awaiter->fd;
+  if ((epoll_ctl(this->_epoll_fd, EPOLL_CTL_ADD, awaiter->fd, &event) != 0) &&
+      (errno != EEXIST)) {
+    return false;
+  }
+
+  Watch&      watch = this->_watches[fd];
+  IoAwaiter*& slot  = awaiter->is_write ? watch.writer : watch.reader;
+  CBL_ASSERT(slot == nullptr,
+             "Only one task may wait on each side of a descriptor");
+  slot = awaiter;
+  return true;
+}
+
+auto EventLoop::dispatch(int fd, unsigned events) noexcept -> void {
+  if (static_cast<usize>(fd) >= this->_watches.len()) {
+    return;
+  }
+  Watch& watch = this->_watches[static_cast<usize>(fd)];
+
+  // Events may be stale, so the I/O is retried before resuming a task
+  const unsigned done = EPOLLERR | EPOLLHUP;
+  if ((watch.reader != nullptr) && ((events & (EPOLLIN | done)) != 0)) {
+    if (watch.reader->await_ready()) {
+      this->schedule(watch.reader->handle);
+      watch.reader = nullptr;
+    }
+  }
+  if ((watch.writer != nullptr) && ((events & (EPOLLOUT | done)) != 0)) {
+    if (watch.writer->await_ready()) {
+      this->schedule(watch.writer->handle);
+      watch.writer = nullptr;
+    }
+  }
+}
+
+auto EventLoop::fireTimers() noexcept -> void {
+  u64 expirations;
+  (void)::read(this->_timer_fd, &expirations, sizeof(expirations));
+  this->_timer_armed = 0;
+
+  const u64 now = monotonicNs();
+  Timer     timer;
+  while (!this->_timers.isEmpty() && (this->_timers.peek()->deadline <= now)) {
+    this->_timers.pop(&timer);
+    this->schedule(timer.handle);
+  }
+  this->armTimer();
+}
+
+auto EventLoop::armTimer() noexcept -> void {
+  const u64 deadline =
+      this->_timers.isEmpty() ? 0 : this->_timers.peek()->deadline;
+  if (deadline == this->_timer_armed) {
+    return;
+  }
+
+  // A zero deadline disarms the timer
+  itimerspec spec{};
+  spec.it_value.tv_sec  = static_cast<time_t>(deadline / 1000000000ULL);
+  spec.it_value.tv_nsec = static_cast<long>(deadline % 1000000000ULL);
+  timerfd_settime(this->_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+  this->_timer_armed = deadline;
+}
+
+} // namespace cbl::io
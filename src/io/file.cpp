@@ -1,12 +1,71 @@
 #include "cbl/io/file.h"
 
 #include "cbl/assert.h"     // CBL_ASSERT
-#include "cbl/primitives.h" // usize, const_cstr
-#include <cstdio>           // FILE, stdout, stderr, stdin, fwrite, vfprintf
-#include <unistd.h>         // dup
+#include "cbl/primitives.h" // u8, u64, usize, isize, const_cstr
+#include "cbl/slice.h"      // Slice
+#include "cbl/trace.h"      // CBL_TRACE_ZONE, CBL_TRACE_COUNTER
+#include <cerrno>           // errno, EINTR, EINVAL, EXDEV, ...
+#include <cstdio>           // FILE, stdout, stderr, stdin, fwrite, fflush
+#include <fcntl.h>          // splice, SPLICE_F_MOVE
+#include <sys/sendfile.h>   // sendfile
+#include <sys/stat.h>       // fstat, S_ISREG, S_ISFIFO
+#include <unistd.h>         // dup, copy_file_range, read, pread, write
 
 namespace cbl::io {
 
+namespace {
+
+/// The most bytes asked of a single syscall, below the kernel's limit of
+/// `0x7ffff000`.
+constexpr usize MAX_CHUNK = usize{1} << 30;
+
+/// Returns `true` if `error` means that a method does not work for these
+/// files, so the next one should be tried.
+auto isUnsupported(int error) noexcept -> bool {
+  return (error == EINVAL) || (error == ENOSYS) || (error == EXDEV) ||
+         (error == EOPNOTSUPP) || (error == EBADF);
+}
+
+/// Calls `step(max)` until `len` bytes are copied or it returns 0,
+/// accumulating the bytes into `copied`, returning 0 or the `errno` value
+/// that stopped it.
+template <class Step>
+auto pump(usize len, usize* copied, Step step) noexcept -> int {
+  while (*copied < len) {
+    const usize   max = (len - *copied < MAX_CHUNK) ? len - *copied : MAX_CHUNK;
+    const ssize_t n   = step(max);
+    if (n == 0) {
+      return 0;
+    }
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    *copied += static_cast<usize>(n);
+  }
+  return 0;
+}
+
+/// Writes all of `buf` into `fd`, returning 0 or an `errno` value.
+auto writeAll(int fd, Slice<u8> buf) noexcept -> int {
+  usize done = 0;
+  while (done < buf.len()) {
+    const ssize_t n = ::write(fd, buf.ptr() + done, buf.len() - done);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    done += static_cast<usize>(n);
+  }
+  return 0;
+}
+
+} // namespace
+
 File::File(std::FILE* file) noexcept : _file{file} {}
 
 File::File(const_cstr filename, Mode mode) noexcept {
@@ -25,26 +84,105 @@ File::~File() noexcept {
 }
 
 [[nodiscard]] auto File::write(Slice<u8> buf) noexcept -> usize {
+  CBL_TRACE_ZONE("File::write");
   if (!buf.isEmpty()) {
     return std::fwrite(buf.ptr(), sizeof(u8), buf.len(), this->_file);
   }
   return 0;
 }
 
-auto File::formatV(const_cstr fmt, std::va_list args) noexcept -> void {
-  CBL_ASSERT(fmt != nullptr, "The format string must not be null");
-  usize written = std::vfprintf(this->_file, fmt, args);
-  CBL_ASSERT(written != 0, "Failed to write to file");
-}
-
 auto File::file() const noexcept -> std::FILE* { return this->_file; }
 
+auto File::fd() const noexcept -> int { return fileno(this->_file); }
+
 auto File::clone() const noexcept -> File {
   FILE* copied_file =
       fdopen(dup(fileno(this->_file)), getFileMode(this->_mode));
   return File{copied_file};
 }
 
+auto copyRange(File& src, File& dst, u64 offset, usize len, Slice<u8> buf,
+               CopyMethod* method) noexcept -> isize {
+  CBL_TRACE_ZONE("io::copyRange");
+  std::fflush(src.file());
+  std::fflush(dst.file());
+
+  const int   in  = src.fd();
+  const int   out = dst.fd();
+  struct stat in_stat;
+  struct stat out_stat;
+  if ((fstat(in, &in_stat) != 0) || (fstat(out, &out_stat) != 0)) {
+    return -errno;
+  }
+  const bool in_file  = S_ISREG(in_stat.st_mode);
+  const bool in_pipe  = S_ISFIFO(in_stat.st_mode);
+  const bool out_file = S_ISREG(out_stat.st_mode);
+  const bool out_pipe = S_ISFIFO(out_stat.st_mode);
+
+  // Each method is tried in turn, from the one with the fewest copies, and
+  // a method that turns out not to work for these files hands over the rest
+  // of the range to the next
+  off_t      pos    = static_cast<off_t>(offset);
+  usize      copied = 0;
+  int        error  = EINVAL;
+  CopyMethod used   = CopyMethod::Buffered;
+
+  if (in_file && out_file) {
+    used  = CopyMethod::CopyFileRange;
+    error = pump(len, &copied, [&](usize max) -> ssize_t {
+      const ssize_t n = copy_file_range(in, &pos, out, nullptr, max, 0);
+      // Some file systems report 0 for files whose size they do not know
+      // (e.g. procfs), so an empty first copy is retried by the next method
+      if ((n == 0) && (copied == 0)) {
+        errno = EINVAL;
+        return -1;
+      }
+      return n;
+    });
+  }
+  if (in_file && isUnsupported(error)) {
+    used  = CopyMethod::SendFile;
+    error = pump(len, &copied, [&](usize max) -> ssize_t {
+      return sendfile(out, in, &pos, max);
+    });
+  }
+  if ((in_pipe || out_pipe) && isUnsupported(error)) {
+    // Pipes have no position, and neither do the other unseekable files
+    used  = CopyMethod::Splice;
+    error = pump(len, &copied, [&](usize max) -> ssize_t {
+      return splice(in, in_file ? &pos : nullptr, out, nullptr, max,
+                    SPLICE_F_MOVE);
+    });
+  }
+  if (isUnsupported(error) && !buf.isEmpty()) {
+    used  = CopyMethod::Buffered;
+    error = pump(len, &copied, [&](usize max) -> ssize_t {
+      const usize   want = (max < buf.len()) ? max : buf.len();
+      const ssize_t n    = in_file ? pread(in, buf.ptr(), want, pos)
+                                   : ::read(in, buf.ptr(), want);
+      if (n <= 0) {
+        return n;
+      }
+      const int write_error = writeAll(out, buf.first(static_cast<usize>(n)));
+      if (write_error != 0) {
+        errno = write_error;
+        return -1;
+      }
+      pos += n;
+      return n;
+    });
+  }
+
+  CBL_TRACE_COUNTER("io::copyRange bytes", copied);
+  if (method != nullptr) {
+    *method = used;
+  }
+  if ((copied == 0) && (error != 0)) {
+    return -error;
+  }
+  return static_cast<isize>(copied);
+}
+
 auto File::getFileMode(Mode mode) -> const_cstr {
   switch (mode) {
   case Mode::Write:
@@ -70,12 +208,6 @@ auto File::getFileMode(Mode mode) -> const_cstr {
   return 0;
 }
 
-auto Stdout::formatV(const_cstr fmt, std::va_list args) noexcept -> void {
-  CBL_ASSERT(fmt != nullptr, "The format string must not be null");
-  usize written = std::vfprintf(stdout, fmt, args);
-  CBL_ASSERT(written != 0, "Failed to write to stdout");
-}
-
 [[nodiscard]] auto Stderr::write(Slice<u8> buf) noexcept -> usize {
   if (!buf.isEmpty()) {
     return std::fwrite(buf.ptr(), sizeof(u8), buf.len(), stderr);
@@ -83,10 +215,4 @@ auto Stdout::formatV(const_cstr fmt, std::va_list args) noexcept -> void {
   return 0;
 }
 
-auto Stderr::formatV(const_cstr fmt, std::va_list args) noexcept -> void {
-  CBL_ASSERT(fmt != nullptr, "The format string must not be null");
-  usize written = std::vfprintf(stderr, fmt, args);
-  CBL_ASSERT(written != 0, "Failed to write to stdout");
-}
-
 } // namespace cbl::io
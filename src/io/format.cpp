@@ -0,0 +1,151 @@
+#include "cbl/io/format.h"
+
+#include "cbl/assert.h"     // CBL_ASSERT
+#include "cbl/io/writer.h"  // Writer
+#include "cbl/primitives.h" // u8, usize, f32, f64, const_cstr
+#include "cbl/slice.h"      // Slice
+#include <charconv>         // to_chars, chars_format
+#include <cstring>          // strlen
+
+namespace cbl::io {
+
+namespace {
+
+/// Two-digit decimal strings for every value in `[0, 100)`.
+constexpr char DIGIT_PAIRS[] = "00010203040506070809"
+                               "10111213141516171819"
+                               "20212223242526272829"
+                               "30313233343536373839"
+                               "40414243444546474849"
+                               "50515253545556575859"
+                               "60616263646566676869"
+                               "70717273747576777879"
+                               "80818283848586878889"
+                               "90919293949596979899";
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+auto writeChars(Writer& writer, const char* ptr, usize len) noexcept -> void {
+  writer.writeAll(Slice<u8>{reinterpret_cast<u8*>(const_cast<char*>(ptr)),
+                            len});
+}
+
+/// Converts `value` at its own width, so an `f32` gets the shortest digits
+/// that round-trip as an `f32` rather than as an `f64`.
+template <class F>
+auto writeFloat(Writer& writer, F value, char spec) noexcept -> void {
+  // Large enough for the shortest representation of any `f64`
+  char                 buf[32];
+  std::to_chars_result res =
+      (spec == 'e')
+          ? std::to_chars(buf, buf + sizeof(buf), value,
+                          std::chars_format::scientific)
+          : std::to_chars(buf, buf + sizeof(buf), value);
+  CBL_ASSERT(res.ec == std::errc{}, "Float conversion failed");
+  writeChars(writer, buf, static_cast<usize>(res.ptr - buf));
+}
+
+} // namespace
+
+namespace detail {
+
+auto formatInteger(Writer& writer, unsigned long long value, bool negative,
+                   char spec) noexcept -> void {
+  // Enough for a 64-bit value in binary and a sign
+  char  buf[66];
+  char* end = buf + sizeof(buf);
+  char* pos = end;
+
+  if (spec == 'x') {
+    do {
+      *--pos   = HEX_DIGITS[value & 0xF];
+      value  >>= 4;
+    } while (value != 0);
+  } else if (spec == 'b') {
+    do {
+      *--pos   = static_cast<char>('0' + (value & 1));
+      value  >>= 1;
+    } while (value != 0);
+  } else {
+    // Emit two digits per division
+    while (value >= 100) {
+      const usize idx    = static_cast<usize>(value % 100) * 2;
+      value             /= 100;
+      pos               -= 2;
+      pos[0]             = DIGIT_PAIRS[idx];
+      pos[1]             = DIGIT_PAIRS[idx + 1];
+    }
+    if (value >= 10) {
+      const usize idx  = static_cast<usize>(value) * 2;
+      pos             -= 2;
+      pos[0]           = DIGIT_PAIRS[idx];
+      pos[1]           = DIGIT_PAIRS[idx + 1];
+    } else {
+      *--pos = static_cast<char>('0' + value);
+    }
+  }
+
+  if (negative) {
+    *--pos = '-';
+  }
+  writeChars(writer, pos, static_cast<usize>(end - pos));
+}
+
+auto formatFloat(Writer& writer, f32 value, char spec) noexcept -> void {
+  writeFloat(writer, value, spec);
+}
+
+auto formatFloat(Writer& writer, f64 value, char spec) noexcept -> void {
+  writeFloat(writer, value, spec);
+}
+
+auto formatLiteral(Writer& writer, const_cstr str, usize len,
+                   bool escaped) noexcept -> void {
+  if (!escaped) {
+    writeChars(writer, str, len);
+    return;
+  }
+
+  // Write up to and including each doubled brace, then skip its twin
+  usize start = 0;
+  for (usize i = 0; i < len; i++) {
+    if ((str[i] == '{') || (str[i] == '}')) {
+      writeChars(writer, str + start, i + 1 - start);
+      i     += 1;
+      start  = i + 1;
+    }
+  }
+  if (start < len) {
+    writeChars(writer, str + start, len - start);
+  }
+}
+
+} // namespace detail
+
+auto Formatter<bool>::format(Writer& writer, const bool& value,
+                             char spec) noexcept -> void {
+  (void)spec;
+  if (value) {
+    writeChars(writer, "true", 4);
+  } else {
+    writeChars(writer, "false", 5);
+  }
+}
+
+auto Formatter<char>::format(Writer& writer, const char& value,
+                             char spec) noexcept -> void {
+  (void)spec;
+  writeChars(writer, &value, 1);
+}
+
+auto Formatter<const_cstr>::format(Writer& writer, const const_cstr& value,
+                                   char spec) noexcept -> void {
+  (void)spec;
+  if (value == nullptr) {
+    writeChars(writer, "(null)", 6);
+    return;
+  }
+  writeChars(writer, value, std::strlen(value));
+}
+
+} // namespace cbl::io
@@ -0,0 +1,370 @@
+#include "cbl/io/ring.h"
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/io/file.h"       // File
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u32, u64, usize, isize, any
+#include "cbl/slice.h"         // Slice
+#include "cbl/trace.h"         // CBL_TRACE_ZONE, CBL_TRACE_COUNTER
+#include <atomic>              // atomic_ref, memory_order
+#include <cerrno>              // errno
+#include <cstring>             // memset
+#include <linux/io_uring.h>    // io_uring_params, io_uring_sqe, io_uring_cqe
+#include <sys/mman.h>          // mmap, munmap
+#include <sys/syscall.h>       // __NR_io_uring_*
+#include <sys/uio.h>           // iovec, preadv, pwritev
+#include <unistd.h>            // syscall, close
+
+namespace cbl::io {
+
+namespace {
+
+auto uringSetup(unsigned entries, io_uring_params* params) noexcept -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto uringEnter(int fd, unsigned to_submit, unsigned min_complete,
+                unsigned flags) noexcept -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+auto uringRegister(int fd, unsigned opcode, const void* arg,
+                   unsigned nr_args) noexcept -> int {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+auto loadAcquire(unsigned* ptr) noexcept -> unsigned {
+  return std::atomic_ref<unsigned>{*ptr}.load(std::memory_order_acquire);
+}
+
+auto storeRelease(unsigned* ptr, unsigned value) noexcept -> void {
+  std::atomic_ref<unsigned>{*ptr}.store(value, std::memory_order_release);
+}
+
+} // namespace
+
+Ring::Ring(mem::Allocator& allocator, u32 entries, Backend backend) noexcept
+    : _allocator{&allocator}, _entries{entries} {
+  CBL_ASSERT(entries != 0, "A ring must have at least one entry");
+
+  if ((backend == Backend::Auto) || (backend == Backend::Uring)) {
+    if (this->initUring()) {
+      this->_backend = Backend::Uring;
+      this->_valid   = true;
+      return;
+    }
+    if (backend == Backend::Uring) {
+      return;
+    }
+  }
+
+  this->_backend = Backend::Blocking;
+  this->_valid   = this->initBlocking();
+}
+
+Ring::~Ring() noexcept {
+  if (this->_ring_fd >= 0) {
+    if (this->_sqes != nullptr) {
+      munmap(this->_sqes, this->_sqes_size);
+    }
+    if ((this->_cq_ptr != nullptr) && (this->_cq_ptr != this->_sq_ptr)) {
+      munmap(this->_cq_ptr, this->_cq_size);
+    }
+    if (this->_sq_ptr != nullptr) {
+      munmap(this->_sq_ptr, this->_sq_size);
+    }
+    close(this->_ring_fd);
+  }
+  this->_allocator->destroyArray(this->_pending);
+  this->_allocator->destroyArray(this->_completed);
+  this->_allocator->destroyArray(this->_files);
+}
+
+auto Ring::isValid() const noexcept -> bool { return this->_valid; }
+
+auto Ring::backend() const noexcept -> Backend { return this->_backend; }
+
+auto Ring::registerBuffers(Slice<Slice<u8>> bufs) noexcept -> bool {
+  CBL_ASSERT(this->_valid, "The ring is not initialized");
+  if (this->_backend == Backend::Blocking) {
+    // Nothing to pin; requests carry their own buffers
+    return true;
+  }
+
+  Slice<iovec> iovecs = this->_allocator->createArray<iovec>(bufs.len());
+  if (iovecs.isEmpty()) {
+    return false;
+  }
+  for (usize i = 0; i < bufs.len(); i++) {
+    iovecs[i].iov_base = bufs[i].ptr();
+    iovecs[i].iov_len  = bufs[i].len();
+  }
+  int res = uringRegister(this->_ring_fd, IORING_REGISTER_BUFFERS,
+                          iovecs.ptr(), static_cast<unsigned>(bufs.len()));
+  this->_allocator->destroyArray(iovecs);
+  return res == 0;
+}
+
+auto Ring::registerFiles(Slice<int> fds) noexcept -> bool {
+  CBL_ASSERT(this->_valid, "The ring is not initialized");
+  if (this->_backend == Backend::Uring) {
+    int res = uringRegister(this->_ring_fd, IORING_REGISTER_FILES, fds.ptr(),
+                            static_cast<unsigned>(fds.len()));
+    return res == 0;
+  }
+
+  // The blocking backend resolves indices itself
+  Slice<int> files = this->_allocator->createArray<int>(fds.len());
+  if (files.isEmpty()) {
+    return false;
+  }
+  for (usize i = 0; i < fds.len(); i++) {
+    files[i] = fds[i];
+  }
+  this->_allocator->destroyArray(this->_files);
+  this->_files = files;
+  return true;
+}
+
+auto Ring::unregisterAll() noexcept -> void {
+  CBL_ASSERT(this->_valid, "The ring is not initialized");
+  if (this->_backend == Backend::Uring) {
+    uringRegister(this->_ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    uringRegister(this->_ring_fd, IORING_UNREGISTER_FILES, nullptr, 0);
+    return;
+  }
+  this->_allocator->destroyArray(this->_files);
+  this->_files = Slice<int>{};
+}
+
+auto Ring::queue(Request request) noexcept -> bool {
+  CBL_ASSERT(this->_valid, "The ring is not initialized");
+  if (this->_in_flight == static_cast<usize>(this->_entries)) {
+    return false;
+  }
+
+  if (this->_backend == Backend::Blocking) {
+    this->_pending[this->_pending_len]  = request;
+    this->_pending_len                 += 1;
+    this->_in_flight                   += 1;
+    return true;
+  }
+
+  unsigned tail = *this->_sq_tail;
+  unsigned head = loadAcquire(this->_sq_head);
+  if (tail - head > *this->_sq_mask) {
+    return false;
+  }
+
+  unsigned      idx = tail & *this->_sq_mask;
+  io_uring_sqe* sqe = &this->_sqes[idx];
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  if (request.buf_index >= 0) {
+    sqe->opcode    = (request.op == Op::Read) ? IORING_OP_READ_FIXED
+                                              : IORING_OP_WRITE_FIXED;
+    sqe->buf_index = static_cast<__u16>(request.buf_index);
+  } else {
+    sqe->opcode =
+        (request.op == Op::Read) ? IORING_OP_READ : IORING_OP_WRITE;
+  }
+  if (request.fixed_file) {
+    sqe->flags |= IOSQE_FIXED_FILE;
+  }
+  sqe->fd                = request.fd;
+  sqe->addr              = reinterpret_cast<__u64>(request.buf.ptr());
+  sqe->len               = static_cast<__u32>(request.buf.len());
+  sqe->off               = static_cast<__u64>(request.offset);
+  sqe->user_data         = static_cast<__u64>(request.user_data);
+  this->_sq_array[idx]   = idx;
+  storeRelease(this->_sq_tail, tail + 1);
+
+  this->_to_submit += 1;
+  this->_in_flight += 1;
+  return true;
+}
+
+auto Ring::read(const File& file, Slice<u8> buf, u64 offset,
+                u64 user_data) noexcept -> bool {
+  return this->queue(Request{
+      .op = Op::Read, .fd = file.fd(), .buf = buf, .offset = offset,
+      .user_data = user_data});
+}
+
+auto Ring::write(const File& file, Slice<u8> buf, u64 offset,
+                 u64 user_data) noexcept -> bool {
+  return this->queue(Request{
+      .op = Op::Write, .fd = file.fd(), .buf = buf, .offset = offset,
+      .user_data = user_data});
+}
+
+auto Ring::submit() noexcept -> usize { return this->submitAndWait(0); }
+
+auto Ring::submitAndWait(u32 min_complete) noexcept -> usize {
+  CBL_ASSERT(this->_valid, "The ring is not initialized");
+  CBL_TRACE_ZONE("Ring::submitAndWait");
+  CBL_TRACE_COUNTER("Ring::inFlight", this->inFlight());
+
+  if (this->_backend == Backend::Blocking) {
+    usize submitted = this->_pending_len;
+    for (usize i = 0; i < submitted; i++) {
+      const Request& request = this->_pending[i];
+      usize tail = (this->_completed_head + this->_completed_len) %
+                   this->_completed.len();
+      this->_completed[tail] = Completion{
+          .user_data = request.user_data, .result = this->execute(request)};
+      this->_completed_len += 1;
+    }
+    this->_pending_len = 0;
+    return submitted;
+  }
+
+  unsigned flags     = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+  unsigned to_submit = this->_to_submit;
+  int      submitted;
+  do {
+    submitted = uringEnter(this->_ring_fd, to_submit,
+                           static_cast<unsigned>(min_complete), flags);
+  } while ((submitted < 0) && (errno == EINTR));
+  if (submitted < 0) {
+    return 0;
+  }
+  this->_to_submit -= static_cast<u32>(submitted);
+  return static_cast<usize>(submitted);
+}
+
+auto Ring::poll(Slice<Completion> out) noexcept -> usize {
+  usize count = 0;
+  while ((count < out.len()) && this->nextCompletion(&out[count])) {
+    count += 1;
+  }
+  return count;
+}
+
+auto Ring::poll(Callback callback, any ctx) noexcept -> usize {
+  CBL_ASSERT(callback != nullptr, "`callback` must not be null");
+  usize      count = 0;
+  Completion completion;
+  while (this->nextCompletion(&completion)) {
+    callback(completion, ctx);
+    count += 1;
+  }
+  return count;
+}
+
+auto Ring::inFlight() const noexcept -> usize { return this->_in_flight; }
+
+auto Ring::initUring() noexcept -> bool {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  int fd = uringSetup(this->_entries, &params);
+  if (fd < 0) {
+    return false;
+  }
+  this->_ring_fd = fd;
+
+  this->_sq_size =
+      params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+  this->_cq_size =
+      params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    this->_sq_size = (this->_cq_size > this->_sq_size) ? this->_cq_size
+                                                       : this->_sq_size;
+  }
+
+  void* sq_ptr = mmap(nullptr, this->_sq_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ptr == MAP_FAILED) {
+    return false;
+  }
+  this->_sq_ptr = static_cast<u8*>(sq_ptr);
+
+  if (single_mmap) {
+    this->_cq_ptr = this->_sq_ptr;
+  } else {
+    void* cq_ptr = mmap(nullptr, this->_cq_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ptr == MAP_FAILED) {
+      return false;
+    }
+    this->_cq_ptr = static_cast<u8*>(cq_ptr);
+  }
+
+  this->_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, this->_sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  this->_sqes = static_cast<io_uring_sqe*>(sqes);
+
+  u8* sq          = this->_sq_ptr;
+  u8* cq          = this->_cq_ptr;
+  this->_sq_head  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  this->_sq_tail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  this->_sq_mask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  this->_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  this->_cq_head  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  this->_cq_tail  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  this->_cq_mask  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  this->_cqes     = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  return true;
+}
+
+auto Ring::initBlocking() noexcept -> bool {
+  this->_pending   = this->_allocator->createArray<Request>(this->_entries);
+  this->_completed = this->_allocator->createArray<Completion>(this->_entries);
+  return !this->_pending.isEmpty() && !this->_completed.isEmpty();
+}
+
+auto Ring::execute(const Request& request) const noexcept -> isize {
+  int fd = request.fd;
+  if (request.fixed_file) {
+    if ((request.fd < 0) ||
+        (static_cast<usize>(request.fd) >= this->_files.len())) {
+      return -EBADF;
+    }
+    fd = this->_files[static_cast<usize>(request.fd)];
+  }
+
+  iovec iov{.iov_base = request.buf.ptr(), .iov_len = request.buf.len()};
+  off_t offset = static_cast<off_t>(request.offset);
+  isize res;
+  do {
+    res = (request.op == Op::Read) ? preadv(fd, &iov, 1, offset)
+                                   : pwritev(fd, &iov, 1, offset);
+  } while ((res < 0) && (errno == EINTR));
+  return (res < 0) ? -static_cast<isize>(errno) : res;
+}
+
+auto Ring::nextCompletion(Completion* out) noexcept -> bool {
+  CBL_ASSERT(this->_valid, "The ring is not initialized");
+
+  if (this->_backend == Backend::Blocking) {
+    if (this->_completed_len == 0) {
+      return false;
+    }
+    *out                  = this->_completed[this->_completed_head];
+    this->_completed_head =
+        (this->_completed_head + 1) % this->_completed.len();
+    this->_completed_len -= 1;
+    this->_in_flight     -= 1;
+    return true;
+  }
+
+  unsigned head = *this->_cq_head;
+  unsigned tail = loadAcquire(this->_cq_tail);
+  if (head == tail) {
+    return false;
+  }
+  const io_uring_cqe& cqe = this->_cqes[head & *this->_cq_mask];
+  *out = Completion{.user_data = static_cast<u64>(cqe.user_data),
+                    .result    = static_cast<isize>(cqe.res)};
+  storeRelease(this->_cq_head, head + 1);
+  this->_in_flight -= 1;
+  return true;
+}
+
+} // namespace cbl::io
@@ -0,0 +1,36 @@
+#include "cbl/io/task.h"
+
+#include "cbl/assert.h"        // CBL_VERIFY
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/mem/layout.h"    // Layout
+#include "cbl/primitives.h"    // u8, u16, usize
+
+namespace cbl::io::detail {
+
+namespace {
+
+/// The room for the allocator in front of a frame, which keeps the frame
+/// aligned like memory from `new`.
+constexpr usize FRAME_HEADER = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+auto frameLayout(usize size) noexcept -> mem::Layout {
+  return mem::Layout{FRAME_HEADER + size, static_cast<u16>(FRAME_HEADER)};
+}
+
+} // namespace
+
+auto PromiseBase::allocateFrame(mem::Allocator& allocator, usize size) noexcept
+    -> void* {
+  u8* ptr = allocator.allocate(frameLayout(size)).ptr();
+  CBL_VERIFY(ptr != nullptr, "Allocation failed");
+  *reinterpret_cast<mem::Allocator**>(ptr) = &allocator;
+  return ptr + FRAME_HEADER;
+}
+
+auto PromiseBase::deallocateFrame(void* frame, usize size) noexcept -> void {
+  u8*             ptr       = static_cast<u8*>(frame) - FRAME_HEADER;
+  mem::Allocator* allocator = *reinterpret_cast<mem::Allocator**>(ptr);
+  allocator->deallocate(ptr, frameLayout(size));
+}
+
+} // namespace cbl::io::detail
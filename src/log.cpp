@@ -0,0 +1,171 @@
+#include "cbl/log.h"
+
+#include "cbl/assert.h"           // CBL_ASSERT, CBL_VERIFY
+#include "cbl/io/buffer_writer.h" // BufferWriter
+#include "cbl/io/writer.h"        // Writer
+#include "cbl/mem/allocator.h"    // Allocator
+#include "cbl/primitives.h"       // u8, u32, usize, isize
+#include "cbl/slice.h"            // Slice
+#include <atomic>                 // atomic, atomic_thread_fence
+#include <cstring>                // memcpy
+#include <memory>                 // construct_at
+#include <thread>                 // thread, this_thread::yield
+
+namespace cbl::log {
+
+auto levelName(Level level) noexcept -> const_cstr {
+  switch (level) {
+  case Level::Trace:
+    return "TRACE";
+  case Level::Debug:
+    return "DEBUG";
+  case Level::Info:
+    return "INFO";
+  case Level::Warn:
+    return "WARN";
+  case Level::Error:
+  default:
+    return "ERROR";
+  }
+}
+
+namespace detail {
+
+auto threadBuffer() noexcept -> io::BufferWriter& {
+  thread_local u8               buf[MAX_MESSAGE_LEN];
+  thread_local io::BufferWriter writer{Slice<u8>{buf, MAX_MESSAGE_LEN}};
+  return writer;
+}
+
+} // namespace detail
+
+Logger::Logger(mem::Allocator& allocator, io::Writer& sink,
+               Options options) noexcept
+    : _allocator{&allocator}, _sink{&sink}, _mask{options.capacity - 1},
+      _policy{options.policy}, _level{options.level} {
+  CBL_ASSERT((options.capacity != 0) &&
+                 ((options.capacity & (options.capacity - 1)) == 0),
+             "The capacity must be a power of 2");
+
+  this->_slots = allocator.createArray<Slot>(options.capacity);
+  CBL_VERIFY(!this->_slots.isEmpty(), "Allocation failed");
+  for (usize i = 0; i < this->_slots.len(); i++) {
+    std::construct_at(&this->_slots[i].seq, i);
+  }
+
+  this->_thread = std::thread{[this]() { this->run(); }};
+}
+
+Logger::~Logger() noexcept {
+  this->_running.store(false, std::memory_order_release);
+  this->_sleeping.store(false, std::memory_order_seq_cst);
+  this->_sleeping.notify_one();
+  this->_thread.join();
+  this->_allocator->destroyArray(this->_slots);
+}
+
+auto Logger::push(Level level, Slice<u8> msg) noexcept -> bool {
+  while (!this->tryPush(level, msg)) {
+    if (this->_policy == Policy::Drop) {
+      this->_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    std::this_thread::yield();
+  }
+
+  // Only pay for a wakeup if the background thread is asleep
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->_sleeping.load(std::memory_order_relaxed)) {
+    this->_sleeping.store(false, std::memory_order_relaxed);
+    this->_sleeping.notify_one();
+  }
+  return true;
+}
+
+auto Logger::flush() noexcept -> void {
+  const usize target = this->_tail.load(std::memory_order_acquire);
+  while (this->_head.load(std::memory_order_acquire) < target) {
+    this->_sleeping.store(false, std::memory_order_seq_cst);
+    this->_sleeping.notify_one();
+    std::this_thread::yield();
+  }
+}
+
+auto Logger::setLevel(Level level) noexcept -> void {
+  this->_level.store(level, std::memory_order_relaxed);
+}
+
+auto Logger::dropped() const noexcept -> usize {
+  return this->_dropped.load(std::memory_order_relaxed);
+}
+
+auto Logger::tryPush(Level level, Slice<u8> msg) noexcept -> bool {
+  // Bounded MPMC queue (Vyukov): a slot is free for position `pos` when its
+  // sequence number equals `pos`
+  usize pos  = this->_tail.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  while (true) {
+    slot            = &this->_slots[pos & this->_mask];
+    const usize seq = slot->seq.load(std::memory_order_acquire);
+    const isize diff = static_cast<isize>(seq) - static_cast<isize>(pos);
+    if (diff == 0) {
+      if (this->_tail.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = this->_tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  const usize len =
+      (msg.len() < MAX_MESSAGE_LEN) ? msg.len() : MAX_MESSAGE_LEN;
+  std::memcpy(slot->msg, msg.ptr(), len);
+  slot->len   = static_cast<u32>(len);
+  slot->level = level;
+  slot->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+auto Logger::drainOne() noexcept -> bool {
+  const usize pos  = this->_head.load(std::memory_order_relaxed);
+  Slot&       slot = this->_slots[pos & this->_mask];
+  if (slot.seq.load(std::memory_order_acquire) != pos + 1) {
+    return false;
+  }
+
+  this->_sink->format("[{}] ", levelName(slot.level));
+  this->_sink->writeAll(Slice<u8>{slot.msg, static_cast<usize>(slot.len)});
+  this->_sink->format("\n");
+
+  slot.seq.store(pos + this->_mask + 1, std::memory_order_release);
+  this->_head.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+auto Logger::run() noexcept -> void {
+  while (true) {
+    if (this->drainOne()) {
+      continue;
+    }
+    if (!this->_running.load(std::memory_order_acquire)) {
+      while (this->drainOne()) {
+      }
+      return;
+    }
+
+    // Announce that we are going to sleep, then re-check the queue so that a
+    // push racing with us is not missed
+    this->_sleeping.store(true, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->drainOne() || !this->_running.load(std::memory_order_acquire)) {
+      this->_sleeping.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    this->_sleeping.wait(true, std::memory_order_seq_cst);
+  }
+}
+
+} // namespace cbl::log
@@ -1,7 +1,7 @@
 #include "cbl/mem/allocator.h"
 
 #include "cbl/assert.h"     // CBL_ASSERT
-#include "cbl/primitives.h" // u8
+#include "cbl/primitives.h" // u8, usize
 #include "cbl/slice.h"      // Slice
 #include <cstring>          // memset
 
@@ -89,4 +89,24 @@ auto Allocator::shrink(u8* ptr, Layout old_layout,
   return new_mem;
 }
 
+auto Allocator::allocateBatch(Layout layout, Slice<u8*> out) noexcept -> bool {
+  for (usize i = 0; i < out.len(); i++) {
+    Slice<u8> mem = this->allocate(layout);
+    if (mem.isEmpty()) {
+      this->deallocateBatch(out.first(i), layout);
+      return false;
+    }
+    out[i] = mem.ptr();
+  }
+  return true;
+}
+
+auto Allocator::deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+    -> void {
+  // Freeing in reverse lets stack-like allocators give back every block
+  for (usize i = ptrs.len(); i > 0; i--) {
+    this->deallocate(ptrs[i - 1], layout);
+  }
+}
+
 } // namespace cbl::mem
@@ -1,41 +1,166 @@
 #include "cbl/mem/c_allocator.h"
 
-#include "cbl/primitives.h" // u8, u16
+#include "cbl/primitives.h" // u8, u16, usize
+#include "cbl/trace.h"      // CBL_TRACE_ZONE
+#include <atomic>           // atomic
+#include <cstddef>          // offsetof
 #include <cstdint>          // uintptr_t
 #include <cstdlib>          // malloc, free
-#include <stdckdint.h>      // ckd_add
+#include <new>              // operator new
+#include <stdckdint.h>      // ckd_add, ckd_mul
 
 namespace cbl::mem {
 
+namespace {
+
+/// Stored at the start of a batch, counting the blocks that are still
+/// allocated.
+struct BatchHeader {
+  std::atomic<usize> live;
+};
+
+/// Stored in front of every block of a batch.
+///
+/// The offset is at the same place as the offset in front of a single
+/// allocation, and is always 0, which a single allocation never has.
+struct BatchPrefix {
+  BatchHeader* header;
+  u16          padding[3];
+  u16          offset;
+};
+static_assert(sizeof(BatchPrefix) == offsetof(BatchPrefix, offset) + 2);
+
+auto alignUp(usize value, usize alignment) noexcept -> usize {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+auto prefixOf(u8* ptr) noexcept -> BatchPrefix* {
+  return reinterpret_cast<BatchPrefix*>(ptr - sizeof(BatchPrefix));
+}
+
+auto releaseBlocks(BatchHeader* header, usize count) noexcept -> void {
+  if (header->live.fetch_sub(count, std::memory_order_acq_rel) == count) {
+    header->~BatchHeader();
+    std::free(header);
+  }
+}
+
+} // namespace
+
 Slice<u8> CAllocator::allocate(Layout layout) noexcept {
-  void* mem = std::malloc(layout.size() + layout.alignment());
+  CBL_TRACE_ZONE("CAllocator::allocate");
+  // Over-allocate so that there is always room for the offset in front of the
+  // aligned pointer
+  const usize alignment = (layout.alignment() < sizeof(u16))
+                              ? sizeof(u16)
+                              : static_cast<usize>(layout.alignment());
+  usize       alloc_size;
+  bool        invalid = ckd_add(&alloc_size, layout.size(), alignment);
+  CBL_ASSERT(invalid == false, "Addition overflowed");
+  void* mem = std::malloc(alloc_size);
   if (mem == nullptr) {
     return Slice<u8>{};
   }
 
   // Align allocation
   uintptr_t addr         = reinterpret_cast<uintptr_t>(mem);
-  uintptr_t aligned_addr = addr & ~(layout.alignment() - 1);
+  uintptr_t aligned_addr = addr & ~(alignment - 1);
   uintptr_t final_addr;
-  bool      invalid = ckd_add(&final_addr, aligned_addr,
-                              static_cast<usize>(layout.alignment()));
+  invalid = ckd_add(&final_addr, aligned_addr, alignment);
   CBL_ASSERT(invalid == false, "Addition overflowed");
   u8*  aligned_ptr = reinterpret_cast<u8*>(final_addr);
 
   // Set offset
   u16  offset      = final_addr - addr;
-  u16* offset_ptr  = reinterpret_cast<u16*>(aligned_ptr - layout.alignment());
+  u16* offset_ptr  = reinterpret_cast<u16*>(aligned_ptr - sizeof(u16));
   *offset_ptr      = offset;
 
   return Slice<u8>{aligned_ptr, layout.size()};
 }
 
 void CAllocator::deallocate(u8* ptr, Layout layout) noexcept {
+  CBL_TRACE_ZONE("CAllocator::deallocate");
+  (void)layout;
   if (ptr != nullptr) {
-    u16* offset  = reinterpret_cast<u16*>(ptr - layout.alignment());
-    u8*  alloced = ptr - *offset;
+    u16* offset = reinterpret_cast<u16*>(ptr - sizeof(u16));
+    if (*offset == 0) {
+      releaseBlocks(prefixOf(ptr)->header, 1);
+      return;
+    }
+    u8* alloced = ptr - *offset;
     std::free(alloced);
   }
 }
 
+auto CAllocator::allocateBatch(Layout layout, Slice<u8*> out) noexcept
+    -> bool {
+  CBL_TRACE_ZONE("CAllocator::allocateBatch");
+  if (out.isEmpty()) {
+    return true;
+  }
+
+  // Every block is preceded by its prefix, so blocks are at least as aligned
+  // as the prefix
+  const usize alignment = (layout.alignment() < alignof(BatchPrefix))
+                              ? alignof(BatchPrefix)
+                              : static_cast<usize>(layout.alignment());
+  const usize prefix    = alignUp(sizeof(BatchPrefix), alignment);
+  usize       stride;
+  usize       alloc_size;
+  if (ckd_add(&stride, layout.size(), alignment - 1) ||
+      ckd_add(&stride, stride & ~(alignment - 1), prefix) ||
+      ckd_mul(&alloc_size, stride, out.len()) ||
+      ckd_add(&alloc_size, alloc_size, sizeof(BatchHeader) + alignment)) {
+    return false;
+  }
+  void* mem = std::malloc(alloc_size);
+  if (mem == nullptr) {
+    return false;
+  }
+
+  BatchHeader* header = new (mem) BatchHeader{};
+  header->live.store(out.len(), std::memory_order_relaxed);
+
+  const uintptr_t base = alignUp(
+      reinterpret_cast<uintptr_t>(mem) + sizeof(BatchHeader), alignment);
+  u8* block = reinterpret_cast<u8*>(base) + prefix;
+  for (u8*& ptr : out) {
+    new (prefixOf(block)) BatchPrefix{header, {}, 0};
+    ptr    = block;
+    block += stride;
+  }
+  return true;
+}
+
+auto CAllocator::deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+    -> void {
+  CBL_TRACE_ZONE("CAllocator::deallocateBatch");
+
+  // Neighbouring blocks usually come from the same batch, so they are
+  // released together with a single atomic operation
+  BatchHeader* header = nullptr;
+  usize        count  = 0;
+  for (u8* ptr : ptrs) {
+    if (ptr == nullptr) {
+      continue;
+    }
+    if (*reinterpret_cast<u16*>(ptr - sizeof(u16)) != 0) {
+      this->deallocate(ptr, layout);
+      continue;
+    }
+    BatchHeader* owner = prefixOf(ptr)->header;
+    if (owner != header) {
+      if (header != nullptr) {
+        releaseBlocks(header, count);
+      }
+      header = owner;
+      count  = 0;
+    }
+    count++;
+  }
+  if (header != nullptr) {
+    releaseBlocks(header, count);
+  }
+}
+
 } // namespace cbl::mem
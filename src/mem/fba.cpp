@@ -1,68 +1,61 @@
 #include "cbl/mem/fba.h"
 
 #include "cbl/assert.h"     // CBL_ASSERT
-#include "cbl/primitives.h" // u8
+#include "cbl/primitives.h" // u8, usize
 #include "cbl/slice.h"      // Slice
 #include <cstdint>          // uintptr_t
-#include <stdckdint.h>      // ckd_sub, ckd_add
+#include <stdckdint.h>      // ckd_add, ckd_mul
 
 namespace cbl::mem {
 
 FixedBufferAllocator::FixedBufferAllocator(Slice<u8> buf) noexcept
     : _pos{0}, _buf{buf} {}
 
-auto FixedBufferAllocator::allocate(Layout layout) noexcept -> Slice<u8> {
-  usize alloc_size;
-  {
-    bool invalid = ckd_add(&alloc_size, layout.size(),
-                           static_cast<usize>(layout.alignment()));
-    CBL_ASSERT(invalid == false, "Addition overflowed");
-
-    usize remaining_mem;
-    invalid = ckd_sub(&remaining_mem, this->_buf.len(), this->_pos);
-    CBL_ASSERT(invalid == false, "Subtraction overflowed");
-
-    CBL_ASSERT(
-        alloc_size <= remaining_mem,
-        "Not enough memory in the `FixedBufferAllocator` for the allocation");
+auto FixedBufferAllocator::allocateBatch(Layout layout, Slice<u8*> out) noexcept
+    -> bool {
+  if (out.isEmpty()) {
+    return true;
   }
-  u8*       mem          = this->_buf.ptr() + this->_pos + alloc_size;
 
-  // Align allocation
-  uintptr_t addr         = reinterpret_cast<uintptr_t>(mem);
-  uintptr_t aligned_addr = addr & ~(layout.alignment() - 1);
-  uintptr_t final_addr;
-  {
-    bool invalid = ckd_add(&final_addr, aligned_addr,
-                           static_cast<usize>(layout.alignment()));
-    CBL_ASSERT(invalid == false, "Addition overflowed");
+  // Blocks are laid out back to back, each starting at the alignment
+  const uintptr_t start   = reinterpret_cast<uintptr_t>(this->_buf.ptr());
+  const uintptr_t align   = layout.alignment();
+  const usize     padding = static_cast<usize>((~(start + this->_pos) + 1) &
+                                               (align - 1));
+  const usize     stride  = (layout.size() + align - 1) & ~(align - 1);
+  usize           total;
+  if (ckd_mul(&total, stride, out.len() - 1) ||
+      ckd_add(&total, total, padding) ||
+      ckd_add(&total, total, layout.size()) ||
+      (total > this->_buf.len() - this->_pos)) {
+    return false;
   }
-  u8*   aligned_ptr = reinterpret_cast<u8*>(final_addr);
 
-  // Increment allocation position
-  usize final_pos;
-  {
-    bool invalid = ckd_add(&final_pos, this->_pos, alloc_size);
-    CBL_ASSERT(invalid == false, "Addition overflowed");
+  u8* ptr = this->_buf.ptr() + this->_pos + padding;
+  for (u8*& block : out) {
+    block  = ptr;
+    ptr   += stride;
   }
-  this->_pos = final_pos;
-  return Slice<u8>{aligned_ptr, layout.size()};
+  this->_pos += total;
+  return true;
 }
 
-auto FixedBufferAllocator::deallocate(u8* ptr, Layout layout) noexcept -> void {
-  CBL_ASSERT(ownsPtr(ptr), "`ptr` was not allocated by this allocator");
-  usize alloc_size;
-  {
-    bool invalid = ckd_add(&alloc_size, layout.size(),
-                           static_cast<usize>(layout.alignment()));
-    CBL_ASSERT(invalid == false, "Addition overflowed");
-  }
-  usize final_pos;
-  {
-    bool invalid = ckd_add(&final_pos, this->_pos, alloc_size);
-    CBL_ASSERT(invalid == false, "Subtraction overflowed");
+auto FixedBufferAllocator::deallocateBatch(Slice<u8*> ptrs,
+                                           Layout     layout) noexcept -> void {
+  const usize align  = layout.alignment();
+  const usize stride = (layout.size() + align - 1) & ~(align - 1);
+  for (usize i = ptrs.len(); i > 0; i--) {
+    u8* ptr = ptrs[i - 1];
+    CBL_ASSERT(this->ownsPtr(ptr), "`ptr` was not allocated by this allocator");
+
+    // Blocks of a batch are `stride` apart, so a block followed by the last
+    // freed block also counts as the most recent allocation
+    u8* end = this->_buf.ptr() + this->_pos;
+    if ((ptr + layout.size() != end) && (ptr + stride != end)) {
+      return;
+    }
+    this->_pos = static_cast<usize>(ptr - this->_buf.ptr());
   }
-  this->_pos = final_pos;
 }
 
 auto FixedBufferAllocator::reset() noexcept -> void { this->_pos = 0; }
@@ -0,0 +1,143 @@
+#include "cbl/mem/pool.h"
+
+#include "cbl/assert.h"         // CBL_ASSERT
+#include "cbl/intrusive_list.h" // SList
+#include "cbl/mem/allocator.h"  // Allocator
+#include "cbl/mem/layout.h"     // Layout
+#include "cbl/primitives.h"     // u8, u16, usize
+#include "cbl/slice.h"          // Slice
+#include "cbl/trace.h"          // CBL_TRACE_ZONE
+#include <new>                  // operator new
+
+namespace cbl::mem {
+
+PoolAllocator::PoolAllocator(Allocator& backing, Layout block,
+                             usize slab_size) noexcept
+    : _backing{&backing} {
+  // Free blocks hold the free list's links, so they must fit a pointer
+  const Layout free_block = Layout::init<FreeBlock>();
+  const Layout padded     =
+      Layout{(block.size() < free_block.size()) ? free_block.size()
+                                                : block.size(),
+             block.alignment()}
+          .alignTo(free_block.alignment())
+          .padToAlign();
+  this->_block_size  = padded.size();
+  this->_block_align = padded.alignment();
+
+  // Every slab must fit its header and at least one block
+  const Layout min_slab =
+      Layout::init<SlabHeader>().extend(padded).layout.padToAlign();
+  this->_slab_size  = (slab_size < min_slab.size()) ? min_slab.size()
+                                                    : slab_size;
+  this->_slab_align = min_slab.alignment();
+}
+
+auto PoolAllocator::deinit() noexcept -> void {
+  while (SlabHeader* slab = this->_slabs.popFront()) {
+    this->_backing->deallocate(reinterpret_cast<u8*>(slab),
+                               Layout{this->_slab_size, this->_slab_align});
+  }
+  this->_free.clear();
+  this->_bump     = nullptr;
+  this->_bump_end = nullptr;
+}
+
+auto PoolAllocator::allocate(Layout layout) noexcept -> Slice<u8> {
+  if ((layout.size() > this->_block_size) ||
+      (static_cast<usize>(layout.alignment()) > this->_block_align)) {
+    return Slice<u8>{};
+  }
+
+  // Reuse freed blocks first, since they are likely still in cache
+  if (FreeBlock* block = this->_free.popFront()) {
+    return Slice<u8>{reinterpret_cast<u8*>(block), layout.size()};
+  }
+
+  if ((this->_bump == nullptr) ||
+      (static_cast<usize>(this->_bump_end - this->_bump) <
+       this->_block_size)) {
+    if (!this->allocateSlab()) {
+      return Slice<u8>{};
+    }
+  }
+  u8* ptr      = this->_bump;
+  this->_bump += this->_block_size;
+  return Slice<u8>{ptr, layout.size()};
+}
+
+auto PoolAllocator::deallocate(u8* ptr, Layout layout) noexcept -> void {
+  (void)layout;
+  if (ptr == nullptr) {
+    return;
+  }
+  this->_free.pushFront(new (ptr) FreeBlock{});
+}
+
+auto PoolAllocator::allocateBatch(Layout layout, Slice<u8*> out) noexcept
+    -> bool {
+  if ((layout.size() > this->_block_size) ||
+      (static_cast<usize>(layout.alignment()) > this->_block_align)) {
+    return false;
+  }
+
+  usize i = 0;
+  while (i < out.len()) {
+    if (FreeBlock* block = this->_free.popFront()) {
+      out[i++] = reinterpret_cast<u8*>(block);
+      continue;
+    }
+
+    // Carve as many blocks as fit out of the slab before taking a new one
+    if ((this->_bump == nullptr) ||
+        (static_cast<usize>(this->_bump_end - this->_bump) <
+         this->_block_size)) {
+      if (!this->allocateSlab()) {
+        this->deallocateBatch(out.first(i), layout);
+        return false;
+      }
+    }
+    const usize fit  = static_cast<usize>(this->_bump_end - this->_bump) /
+                      this->_block_size;
+    const usize rest = out.len() - i;
+    const usize n    = (fit < rest) ? fit : rest;
+    for (usize j = 0; j < n; j++) {
+      out[i++]     = this->_bump;
+      this->_bump += this->_block_size;
+    }
+  }
+  return true;
+}
+
+auto PoolAllocator::deallocateBatch(Slice<u8*> ptrs, Layout layout) noexcept
+    -> void {
+  (void)layout;
+  for (u8* ptr : ptrs) {
+    if (ptr != nullptr) {
+      this->_free.pushFront(new (ptr) FreeBlock{});
+    }
+  }
+}
+
+auto PoolAllocator::allocateSlab() noexcept -> bool {
+  CBL_TRACE_ZONE("PoolAllocator::allocateSlab");
+  Slice<u8> mem = this->_backing->allocate(
+      Layout{this->_slab_size, this->_slab_align});
+  if (mem.isEmpty()) {
+    return false;
+  }
+
+  this->_slabs.pushFront(new (mem.ptr()) SlabHeader{});
+
+  // Blocks start after the header, at the block alignment
+  const usize offset =
+      Layout::init<SlabHeader>()
+          .extend(Layout{this->_block_size,
+                         static_cast<u16>(this->_block_align)})
+          .offset;
+  this->_bump        = mem.ptr() + offset;
+  this->_bump_end    = mem.ptr() + this->_slab_size;
+  return true;
+}
+
+} // namespace cbl::mem
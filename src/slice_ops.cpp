@@ -0,0 +1,431 @@
+#include "cbl/slice_ops.h"
+
+#include "cbl/cpu.h"        // features
+#include "cbl/primitives.h" // usize
+#include <cstdint>          // int8_t, uint8_t, ..., int64_t, uint64_t
+
+// The kernels are written once with GCC vector extensions and instantiated
+// for each vector width. On x86_64 the wider instantiations are compiled for
+// AVX2 and AVX-512 and selected at runtime; 16-byte vectors map to SSE2 (or
+// NEON on ARM) and are always available.
+
+// clang-format off
+#if defined(__x86_64__)
+  #define CBL_SLICE_X86
+  #define CBL_TARGET_AVX2   __attribute__((target("avx2")))
+  #define CBL_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+// clang-format on
+
+namespace cbl::slice::detail {
+
+namespace {
+
+/// A vector of `BYTES / sizeof(K)` lanes that can be loaded from and stored
+/// to unaligned memory.
+template <class K, usize BYTES> struct Vec {
+  typedef K Type
+      __attribute__((vector_size(BYTES), aligned(alignof(K)), may_alias));
+};
+
+template <usize BYTES, class K>
+[[gnu::always_inline]] inline auto
+indexOfBody(const K* ptr, usize len, K value) noexcept -> usize {
+  using V               = typename Vec<K, BYTES>::Type;
+  using Bits            = typename Vec<std::uint64_t, BYTES>::Type;
+  constexpr usize LANES = BYTES / sizeof(K);
+
+  const V         target = V{} + value;
+  usize           i      = 0;
+  for (; i + LANES <= len; i += LANES) {
+    const Bits    eq  = (Bits)(*reinterpret_cast<const V*>(ptr + i) == target);
+    std::uint64_t any = 0;
+    for (usize j = 0; j < BYTES / 8; j++) {
+      any |= eq[j];
+    }
+    if (any != 0) {
+      break;
+    }
+  }
+  for (; i < len; i++) {
+    if (ptr[i] == value) {
+      return i;
+    }
+  }
+  return NOT_FOUND;
+}
+
+template <usize BYTES, class K>
+[[gnu::always_inline]] inline auto
+countBody(const K* ptr, usize len, K value) noexcept -> usize {
+  using V                    = typename Vec<K, BYTES>::Type;
+  constexpr usize LANES      = BYTES / sizeof(K);
+
+  // Lane counters must be flushed before they overflow
+  constexpr usize MAX_BLOCKS = (sizeof(K) == 1) ? 255 : 65535;
+
+  const V         target     = V{} + value;
+  usize           total      = 0;
+  usize           i          = 0;
+  while (i + LANES <= len) {
+    V counts = V{};
+    for (usize b = 0; (b < MAX_BLOCKS) && (i + LANES <= len); b++) {
+      // Matching lanes are all ones, i.e. -1
+      counts -= (V)(*reinterpret_cast<const V*>(ptr + i) == target);
+      i      += LANES;
+    }
+    for (usize j = 0; j < LANES; j++) {
+      total += static_cast<usize>(counts[j]);
+    }
+  }
+  for (; i < len; i++) {
+    total += (ptr[i] == value) ? 1 : 0;
+  }
+  return total;
+}
+
+template <usize BYTES, class K>
+[[gnu::always_inline]] inline auto
+countLessBody(const K* ptr, usize len, K value) noexcept -> usize {
+  using V                    = typename Vec<K, BYTES>::Type;
+  using U                    = typename IntLane<sizeof(K), false>::Type;
+  using Counts               = typename Vec<U, BYTES>::Type;
+  constexpr usize LANES      = BYTES / sizeof(K);
+
+  // Lane counters must be flushed before they overflow
+  constexpr usize MAX_BLOCKS = (sizeof(K) == 1) ? 255 : 65535;
+
+  const V         target     = V{} + value;
+  usize           total      = 0;
+  usize           i          = 0;
+  while (i + LANES <= len) {
+    Counts counts = Counts{};
+    for (usize b = 0; (b < MAX_BLOCKS) && (i + LANES <= len); b++) {
+      counts -= (Counts)(*reinterpret_cast<const V*>(ptr + i) < target);
+      i      += LANES;
+    }
+    for (usize j = 0; j < LANES; j++) {
+      total += static_cast<usize>(counts[j]);
+    }
+  }
+  for (; i < len; i++) {
+    total += (ptr[i] < value) ? 1 : 0;
+  }
+  return total;
+}
+
+template <usize BYTES, class K>
+[[gnu::always_inline]] inline auto fillBody(K* ptr, usize len,
+                                            K value) noexcept -> void {
+  using V               = typename Vec<K, BYTES>::Type;
+  constexpr usize LANES = BYTES / sizeof(K);
+
+  const V         splat = V{} + value;
+  usize           i     = 0;
+  for (; i + LANES <= len; i += LANES) {
+    *reinterpret_cast<V*>(ptr + i) = splat;
+  }
+  for (; i < len; i++) {
+    ptr[i] = value;
+  }
+}
+
+template <usize BYTES, bool IS_MAX, class K>
+[[gnu::always_inline]] inline auto extremumBody(const K* ptr,
+                                                usize    len) noexcept -> K {
+  using V               = typename Vec<K, BYTES>::Type;
+  constexpr usize LANES = BYTES / sizeof(K);
+
+  if (len < LANES) {
+    K result = ptr[0];
+    for (usize i = 1; i < len; i++) {
+      if (IS_MAX ? (result < ptr[i]) : (ptr[i] < result)) {
+        result = ptr[i];
+      }
+    }
+    return result;
+  }
+
+  // The last block overlaps the previous ones instead of needing a scalar
+  // tail, which is fine since the result does not depend on duplicates
+  V acc = *reinterpret_cast<const V*>(ptr);
+  for (usize i = LANES;; i += LANES) {
+    const usize start = (i + LANES <= len) ? i : len - LANES;
+    const V     block = *reinterpret_cast<const V*>(ptr + start);
+    if constexpr (IS_MAX) {
+      acc = (acc < block) ? block : acc;
+    } else {
+      acc = (block < acc) ? block : acc;
+    }
+    if (start + LANES >= len) {
+      break;
+    }
+  }
+
+  K result = acc[0];
+  for (usize j = 1; j < LANES; j++) {
+    if (IS_MAX ? (result < acc[j]) : (acc[j] < result)) {
+      result = acc[j];
+    }
+  }
+  return result;
+}
+
+template <usize BYTES, class K>
+[[gnu::always_inline]] inline auto sumBody(const K* ptr,
+                                           usize    len) noexcept -> K {
+  using V               = typename Vec<K, BYTES>::Type;
+  constexpr usize LANES = BYTES / sizeof(K);
+
+  V               acc   = V{};
+  usize           i     = 0;
+  for (; i + LANES <= len; i += LANES) {
+    acc += *reinterpret_cast<const V*>(ptr + i);
+  }
+  K result = K{};
+  for (usize j = 0; j < LANES; j++) {
+    result = static_cast<K>(result + acc[j]);
+  }
+  for (; i < len; i++) {
+    result = static_cast<K>(result + ptr[i]);
+  }
+  return result;
+}
+
+#ifdef CBL_SLICE_X86
+
+auto hasAvx512() noexcept -> bool {
+  const cpu::Features& features = cpu::features();
+  return features.avx512f && features.avx512bw;
+}
+
+template <class K>
+CBL_TARGET_AVX2 auto indexOfAvx2(const K* ptr, usize len,
+                                 K value) noexcept -> usize {
+  return indexOfBody<32>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX512 auto indexOfAvx512(const K* ptr, usize len,
+                                     K value) noexcept -> usize {
+  return indexOfBody<64>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX2 auto countAvx2(const K* ptr, usize len,
+                               K value) noexcept -> usize {
+  return countBody<32>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX512 auto countAvx512(const K* ptr, usize len,
+                                   K value) noexcept -> usize {
+  return countBody<64>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX2 auto countLessAvx2(const K* ptr, usize len,
+                                   K value) noexcept -> usize {
+  return countLessBody<32>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX512 auto countLessAvx512(const K* ptr, usize len,
+                                       K value) noexcept -> usize {
+  return countLessBody<64>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX2 auto fillAvx2(K* ptr, usize len, K value) noexcept -> void {
+  fillBody<32>(ptr, len, value);
+}
+
+template <class K>
+CBL_TARGET_AVX512 auto fillAvx512(K* ptr, usize len, K value) noexcept -> void {
+  fillBody<64>(ptr, len, value);
+}
+
+template <bool IS_MAX, class K>
+CBL_TARGET_AVX2 auto extremumAvx2(const K* ptr, usize len) noexcept -> K {
+  return extremumBody<32, IS_MAX>(ptr, len);
+}
+
+template <bool IS_MAX, class K>
+CBL_TARGET_AVX512 auto extremumAvx512(const K* ptr, usize len) noexcept -> K {
+  return extremumBody<64, IS_MAX>(ptr, len);
+}
+
+template <class K>
+CBL_TARGET_AVX2 auto sumAvx2(const K* ptr, usize len) noexcept -> K {
+  return sumBody<32>(ptr, len);
+}
+
+template <class K>
+CBL_TARGET_AVX512 auto sumAvx512(const K* ptr, usize len) noexcept -> K {
+  return sumBody<64>(ptr, len);
+}
+
+#endif // CBL_SLICE_X86
+
+template <bool IS_MAX, class K>
+auto extremumKernel(const K* ptr, usize len) noexcept -> K {
+#ifdef CBL_SLICE_X86
+  if (hasAvx512()) {
+    return extremumAvx512<IS_MAX>(ptr, len);
+  }
+  if (cpu::features().avx2) {
+    return extremumAvx2<IS_MAX>(ptr, len);
+  }
+#endif // CBL_SLICE_X86
+  return extremumBody<16, IS_MAX>(ptr, len);
+}
+
+} // namespace
+
+template <class K>
+auto indexOfKernel(const K* ptr, usize len, K value) noexcept -> usize {
+#ifdef CBL_SLICE_X86
+  if (hasAvx512()) {
+    return indexOfAvx512(ptr, len, value);
+  }
+  if (cpu::features().avx2) {
+    return indexOfAvx2(ptr, len, value);
+  }
+#endif // CBL_SLICE_X86
+  return indexOfBody<16>(ptr, len, value);
+}
+
+template <class K>
+auto countKernel(const K* ptr, usize len, K value) noexcept -> usize {
+#ifdef CBL_SLICE_X86
+  if (hasAvx512()) {
+    return countAvx512(ptr, len, value);
+  }
+  if (cpu::features().avx2) {
+    return countAvx2(ptr, len, value);
+  }
+#endif // CBL_SLICE_X86
+  return countBody<16>(ptr, len, value);
+}
+
+template <class K>
+auto countLessKernel(const K* ptr, usize len, K value) noexcept -> usize {
+#ifdef CBL_SLICE_X86
+  if (hasAvx512()) {
+    return countLessAvx512(ptr, len, value);
+  }
+  if (cpu::features().avx2) {
+    return countLessAvx2(ptr, len, value);
+  }
+#endif // CBL_SLICE_X86
+  return countLessBody<16>(ptr, len, value);
+}
+
+template <class K>
+auto fillKernel(K* ptr, usize len, K value) noexcept -> void {
+#ifdef CBL_SLICE_X86
+  if (hasAvx512()) {
+    fillAvx512(ptr, len, value);
+    return;
+  }
+  if (cpu::features().avx2) {
+    fillAvx2(ptr, len, value);
+    return;
+  }
+#endif // CBL_SLICE_X86
+  fillBody<16>(ptr, len, value);
+}
+
+template <class K> auto minKernel(const K* ptr, usize len) noexcept -> K {
+  return extremumKernel<false>(ptr, len);
+}
+
+template <class K> auto maxKernel(const K* ptr, usize len) noexcept -> K {
+  return extremumKernel<true>(ptr, len);
+}
+
+template <class K> auto sumKernel(const K* ptr, usize len) noexcept -> K {
+#ifdef CBL_SLICE_X86
+  if (hasAvx512()) {
+    return sumAvx512(ptr, len);
+  }
+  if (cpu::features().avx2) {
+    return sumAvx2(ptr, len);
+  }
+#endif // CBL_SLICE_X86
+  return sumBody<16>(ptr, len);
+}
+
+// Equality and wrapping sums only need unsigned lanes
+template auto indexOfKernel(const std::uint8_t*, usize, std::uint8_t) noexcept
+    -> usize;
+template auto indexOfKernel(const std::uint16_t*, usize, std::uint16_t) noexcept
+    -> usize;
+template auto indexOfKernel(const std::uint32_t*, usize, std::uint32_t) noexcept
+    -> usize;
+template auto indexOfKernel(const std::uint64_t*, usize, std::uint64_t) noexcept
+    -> usize;
+
+template auto countKernel(const std::uint8_t*, usize, std::uint8_t) noexcept
+    -> usize;
+template auto countKernel(const std::uint16_t*, usize, std::uint16_t) noexcept
+    -> usize;
+template auto countKernel(const std::uint32_t*, usize, std::uint32_t) noexcept
+    -> usize;
+template auto countKernel(const std::uint64_t*, usize, std::uint64_t) noexcept
+    -> usize;
+
+// Ordering needs signed lanes for signed integers
+template auto countLessKernel(const std::int8_t*, usize, std::int8_t) noexcept
+    -> usize;
+template auto countLessKernel(const std::uint8_t*, usize, std::uint8_t) noexcept
+    -> usize;
+template auto countLessKernel(const std::int16_t*, usize, std::int16_t) noexcept
+    -> usize;
+template auto countLessKernel(const std::uint16_t*, usize,
+                              std::uint16_t) noexcept -> usize;
+template auto countLessKernel(const std::int32_t*, usize, std::int32_t) noexcept
+    -> usize;
+template auto countLessKernel(const std::uint32_t*, usize,
+                              std::uint32_t) noexcept -> usize;
+template auto countLessKernel(const std::int64_t*, usize, std::int64_t) noexcept
+    -> usize;
+template auto countLessKernel(const std::uint64_t*, usize,
+                              std::uint64_t) noexcept -> usize;
+template auto countLessKernel(const float*, usize, float) noexcept -> usize;
+template auto countLessKernel(const double*, usize, double) noexcept -> usize;
+
+template auto fillKernel(std::uint16_t*, usize, std::uint16_t) noexcept -> void;
+template auto fillKernel(std::uint32_t*, usize, std::uint32_t) noexcept -> void;
+template auto fillKernel(std::uint64_t*, usize, std::uint64_t) noexcept -> void;
+
+template auto sumKernel(const std::uint8_t*, usize) noexcept -> std::uint8_t;
+template auto sumKernel(const std::uint16_t*, usize) noexcept -> std::uint16_t;
+template auto sumKernel(const std::uint32_t*, usize) noexcept -> std::uint32_t;
+template auto sumKernel(const std::uint64_t*, usize) noexcept -> std::uint64_t;
+template auto sumKernel(const float*, usize) noexcept -> float;
+template auto sumKernel(const double*, usize) noexcept -> double;
+
+template auto minKernel(const std::int8_t*, usize) noexcept -> std::int8_t;
+template auto minKernel(const std::uint8_t*, usize) noexcept -> std::uint8_t;
+template auto minKernel(const std::int16_t*, usize) noexcept -> std::int16_t;
+template auto minKernel(const std::uint16_t*, usize) noexcept -> std::uint16_t;
+template auto minKernel(const std::int32_t*, usize) noexcept -> std::int32_t;
+template auto minKernel(const std::uint32_t*, usize) noexcept -> std::uint32_t;
+template auto minKernel(const std::int64_t*, usize) noexcept -> std::int64_t;
+template auto minKernel(const std::uint64_t*, usize) noexcept -> std::uint64_t;
+template auto minKernel(const float*, usize) noexcept -> float;
+template auto minKernel(const double*, usize) noexcept -> double;
+
+template auto maxKernel(const std::int8_t*, usize) noexcept -> std::int8_t;
+template auto maxKernel(const std::uint8_t*, usize) noexcept -> std::uint8_t;
+template auto maxKernel(const std::int16_t*, usize) noexcept -> std::int16_t;
+template auto maxKernel(const std::uint16_t*, usize) noexcept -> std::uint16_t;
+template auto maxKernel(const std::int32_t*, usize) noexcept -> std::int32_t;
+template auto maxKernel(const std::uint32_t*, usize) noexcept -> std::uint32_t;
+template auto maxKernel(const std::int64_t*, usize) noexcept -> std::int64_t;
+template auto maxKernel(const std::uint64_t*, usize) noexcept -> std::uint64_t;
+template auto maxKernel(const float*, usize) noexcept -> float;
+template auto maxKernel(const double*, usize) noexcept -> double;
+
+} // namespace cbl::slice::detail
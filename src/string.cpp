@@ -0,0 +1,300 @@
+#include "cbl/string.h"
+
+#include "cbl/assert.h"        // CBL_ASSERT
+#include "cbl/cpu.h"           // features
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, usize, const_cstr
+#include "cbl/slice.h"         // Slice
+#include <cstring>             // memchr, memcmp, strlen
+
+#if defined(__x86_64__)
+  #include <immintrin.h> // _mm*_cmpeq_epi8, _mm*_movemask_epi8
+  #define CBL_STRING_SIMD
+#endif
+
+namespace cbl {
+
+StringBuilder::StringBuilder(mem::Allocator& allocator) noexcept
+    : _allocator{&allocator} {}
+
+auto StringBuilder::initWithCapacity(mem::Allocator& allocator,
+                                     usize capacity) noexcept -> StringBuilder {
+  StringBuilder self{allocator};
+  self._buf = UnmanagedDynamicArray<u8>::initWithCapacity(allocator, capacity);
+  return self;
+}
+
+auto StringBuilder::deinit() noexcept -> void {
+  this->_buf.deinit(*this->_allocator);
+}
+
+[[nodiscard]] auto StringBuilder::write(Slice<u8> buf) noexcept -> usize {
+  this->append(buf);
+  return buf.len();
+}
+
+auto StringBuilder::append(Slice<u8> str) noexcept -> void {
+  this->_buf.appendSlice(*this->_allocator, str);
+}
+
+auto StringBuilder::append(const_cstr str) noexcept -> void {
+  this->append(str::fromCstr(str));
+}
+
+auto StringBuilder::appendByte(u8 byte) noexcept -> void {
+  this->_buf.append(*this->_allocator, byte);
+}
+
+auto StringBuilder::str() const noexcept -> Slice<u8> {
+  return this->_buf.elems();
+}
+
+auto StringBuilder::len() const noexcept -> usize { return this->_buf.len(); }
+
+auto StringBuilder::clear() noexcept -> void { this->_buf.clear(); }
+
+auto StringBuilder::toOwnedSlice() noexcept -> Slice<u8> {
+  return this->_buf.toOwnedSlice(*this->_allocator);
+}
+
+namespace str {
+
+namespace {
+
+#ifdef CBL_STRING_SIMD
+
+auto indexOfByteSse2(const u8* ptr, usize len, u8 byte) noexcept -> usize {
+  const __m128i target = _mm_set1_epi8(static_cast<char>(byte));
+  usize         i      = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+    const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, target));
+    if (mask != 0) {
+      return i + static_cast<usize>(__builtin_ctz(mask));
+    }
+  }
+  for (; i < len; i++) {
+    if (ptr[i] == byte) {
+      return i;
+    }
+  }
+  return NOT_FOUND;
+}
+
+__attribute__((target("avx2"))) auto
+indexOfByteAvx2(const u8* ptr, usize len, u8 byte) noexcept -> usize {
+  const __m256i target = _mm256_set1_epi8(static_cast<char>(byte));
+  usize         i      = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+    const unsigned mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, target)));
+    if (mask != 0) {
+      return i + static_cast<usize>(__builtin_ctz(mask));
+    }
+  }
+  const usize rest = indexOfByteSse2(ptr + i, len - i, byte);
+  return (rest == NOT_FOUND) ? NOT_FOUND : i + rest;
+}
+
+// Substring search compares the first and last bytes of the needle against
+// a whole block of candidate positions at once, and only verifies positions
+// where both match.
+
+auto indexOfSse2(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len) noexcept -> usize {
+  const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+  const __m128i last =
+      _mm_set1_epi8(static_cast<char>(needle[needle_len - 1]));
+  const usize end = hay_len - needle_len + 1;
+  usize       i   = 0;
+  for (; i + 16 <= end; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+    const __m128i block_last = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(hay + i + needle_len - 1));
+    unsigned mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                        _mm_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      const usize pos = i + static_cast<usize>(__builtin_ctz(mask));
+      if (std::memcmp(hay + pos + 1, needle + 1, needle_len - 1) == 0) {
+        return pos;
+      }
+      mask &= mask - 1;
+    }
+  }
+  for (; i < end; i++) {
+    if ((hay[i] == needle[0]) &&
+        (std::memcmp(hay + i, needle, needle_len) == 0)) {
+      return i;
+    }
+  }
+  return NOT_FOUND;
+}
+
+__attribute__((target("avx2"))) auto
+indexOfAvx2(const u8* hay, usize hay_len, const u8* needle,
+            usize needle_len) noexcept -> usize {
+  const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+  const __m256i last =
+      _mm256_set1_epi8(static_cast<char>(needle[needle_len - 1]));
+  const usize end = hay_len - needle_len + 1;
+  usize       i   = 0;
+  for (; i + 32 <= end; i += 32) {
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+    const __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(hay + i + needle_len - 1));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                         _mm256_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      const usize pos = i + static_cast<usize>(__builtin_ctz(mask));
+      if (std::memcmp(hay + pos + 1, needle + 1, needle_len - 1) == 0) {
+        return pos;
+      }
+      mask &= mask - 1;
+    }
+  }
+  const usize rest = indexOfSse2(hay + i, hay_len - i, needle, needle_len);
+  return (rest == NOT_FOUND) ? NOT_FOUND : i + rest;
+}
+
+#endif // CBL_STRING_SIMD
+
+auto isSpace(u8 byte) noexcept -> bool {
+  return (byte == ' ') || (byte == '\t') || (byte == '\n') || (byte == '\r') ||
+         (byte == '\v') || (byte == '\f');
+}
+
+} // namespace
+
+auto fromCstr(const_cstr str) noexcept -> Slice<u8> {
+  CBL_ASSERT(str != nullptr, "`str` must not be null");
+  return Slice<u8>{reinterpret_cast<u8*>(const_cast<char*>(str)),
+                   std::strlen(str)};
+}
+
+auto eql(Slice<u8> a, Slice<u8> b) noexcept -> bool {
+  if (a.len() != b.len()) {
+    return false;
+  }
+  // `memcmp` is already vectorized by the C library
+  return (a.len() == 0) || (a.ptr() == b.ptr()) ||
+         (std::memcmp(a.ptr(), b.ptr(), a.len()) == 0);
+}
+
+auto startsWith(Slice<u8> str, Slice<u8> prefix) noexcept -> bool {
+  return (prefix.len() <= str.len()) &&
+         eql(Slice<u8>{str.ptr(), prefix.len()}, prefix);
+}
+
+auto endsWith(Slice<u8> str, Slice<u8> suffix) noexcept -> bool {
+  return (suffix.len() <= str.len()) &&
+         eql(Slice<u8>{str.ptr() + (str.len() - suffix.len()), suffix.len()},
+             suffix);
+}
+
+auto indexOfByte(Slice<u8> str, u8 byte) noexcept -> usize {
+  if (str.len() == 0) {
+    return NOT_FOUND;
+  }
+#ifdef CBL_STRING_SIMD
+  if (cpu::features().avx2) {
+    return indexOfByteAvx2(str.ptr(), str.len(), byte);
+  }
+  return indexOfByteSse2(str.ptr(), str.len(), byte);
+#else
+  const void* found = std::memchr(str.ptr(), static_cast<int>(byte), str.len());
+  return (found == nullptr)
+             ? NOT_FOUND
+             : static_cast<usize>(static_cast<const u8*>(found) - str.ptr());
+#endif // CBL_STRING_SIMD
+}
+
+auto indexOf(Slice<u8> haystack, Slice<u8> needle) noexcept -> usize {
+  if (needle.len() == 0) {
+    return 0;
+  }
+  if (needle.len() > haystack.len()) {
+    return NOT_FOUND;
+  }
+  if (needle.len() == 1) {
+    return indexOfByte(haystack, needle[0]);
+  }
+#ifdef CBL_STRING_SIMD
+  if (cpu::features().avx2) {
+    return indexOfAvx2(haystack.ptr(), haystack.len(), needle.ptr(),
+                       needle.len());
+  }
+  return indexOfSse2(haystack.ptr(), haystack.len(), needle.ptr(),
+                     needle.len());
+#else
+  for (usize i = 0; i + needle.len() <= haystack.len(); i++) {
+    if (std::memcmp(haystack.ptr() + i, needle.ptr(), needle.len()) == 0) {
+      return i;
+    }
+  }
+  return NOT_FOUND;
+#endif // CBL_STRING_SIMD
+}
+
+auto trimLeft(Slice<u8> str) noexcept -> Slice<u8> {
+  usize start = 0;
+  while ((start < str.len()) && isSpace(str[start])) {
+    start += 1;
+  }
+  return Slice<u8>{str.ptr() + start, str.len() - start};
+}
+
+auto trimRight(Slice<u8> str) noexcept -> Slice<u8> {
+  usize end = str.len();
+  while ((end > 0) && isSpace(str[end - 1])) {
+    end -= 1;
+  }
+  return Slice<u8>{str.ptr(), end};
+}
+
+auto trim(Slice<u8> str) noexcept -> Slice<u8> {
+  return trimRight(trimLeft(str));
+}
+
+SplitIterator::SplitIterator(Slice<u8> str, Slice<u8> delim) noexcept
+    : _rest{str}, _delim{delim} {
+  CBL_ASSERT(delim.len() != 0, "The delimiter must not be empty");
+}
+
+auto SplitIterator::next(Slice<u8>* out) noexcept -> bool {
+  if (this->_done) {
+    return false;
+  }
+
+  const usize idx = (this->_delim.len() == 1)
+                        ? indexOfByte(this->_rest, this->_delim[0])
+                        : indexOf(this->_rest, this->_delim);
+  if (idx == NOT_FOUND) {
+    *out        = this->_rest;
+    this->_rest = Slice<u8>{};
+    this->_done = true;
+    return true;
+  }
+
+  const usize skip = idx + this->_delim.len();
+  *out             = Slice<u8>{this->_rest.ptr(), idx};
+  this->_rest = Slice<u8>{this->_rest.ptr() + skip, this->_rest.len() - skip};
+  return true;
+}
+
+auto SplitIterator::rest() const noexcept -> Slice<u8> { return this->_rest; }
+
+auto split(Slice<u8> str, Slice<u8> delim) noexcept -> SplitIterator {
+  return SplitIterator{str, delim};
+}
+
+} // namespace str
+
+} // namespace cbl
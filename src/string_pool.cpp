@@ -0,0 +1,215 @@
+#include "cbl/string_pool.h"
+
+#include "cbl/assert.h"        // CBL_ASSERT, CBL_VERIFY
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/mem/layout.h"    // Layout
+#include "cbl/primitives.h"    // u8, u32, u64, usize
+#include "cbl/slice.h"         // Slice
+#include "cbl/string.h"        // str::eql
+#include <atomic>              // memory_order
+#include <bit>                 // bit_width
+#include <cstring>             // memcpy
+#include <mutex>               // unique_lock
+#include <shared_mutex>        // shared_lock
+
+namespace cbl {
+
+namespace {
+
+/// Hashes a byte string, consuming 8 bytes at a time.
+auto hashBytes(Slice<u8> str) noexcept -> u32 {
+  u64         hash = 0x9E3779B97F4A7C15ULL ^ static_cast<u64>(str.len());
+  const u8*   ptr  = str.ptr();
+  const usize len  = str.len();
+  usize       i    = 0;
+  for (; i + 8 <= len; i += 8) {
+    u64 word;
+    std::memcpy(&word, ptr + i, 8);
+    hash  = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 31;
+  }
+  if (i < len) {
+    u64 word = 0;
+    std::memcpy(&word, ptr + i, len - i);
+    hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+  }
+  hash  = (hash ^ (hash >> 29)) * 0x94D049BB133111EBULL;
+  hash ^= hash >> 32;
+  return static_cast<u32>(hash);
+}
+
+} // namespace
+
+StringPool::StringPool(mem::Allocator& allocator) noexcept
+    : _allocator{&allocator} {}
+
+StringPool::~StringPool() noexcept {
+  for (Slice<u8> chunk : this->_chunks.elems()) {
+    this->_allocator->deallocate(chunk.ptr(),
+                                 mem::Layout::array<u8>(chunk.len()));
+  }
+  this->_chunks.deinit(*this->_allocator);
+
+  for (usize k = 0; k < MAX_SEGMENTS; k++) {
+    if (this->_segments[k] != nullptr) {
+      this->_allocator->destroyArray(
+          Slice<Entry>{this->_segments[k], FIRST_SEGMENT_LEN << k});
+    }
+  }
+  this->_allocator->destroyArray(this->_table);
+}
+
+auto StringPool::intern(Slice<u8> str) noexcept -> u32 {
+  const u32 hash = hashBytes(str);
+
+  // Fast path: the string is usually already interned
+  {
+    std::shared_lock lock{this->_mutex};
+    if (!this->_table.isEmpty()) {
+      const u64 slot = this->_table.ptr()[this->probe(str, hash)];
+      if (slot != 0) {
+        return static_cast<u32>(slot) - 1;
+      }
+    }
+  }
+
+  std::unique_lock lock{this->_mutex};
+  const usize      id = this->_len.load(std::memory_order_relaxed);
+  if ((id + 1) * 2 > this->_table.len()) {
+    this->grow();
+  }
+
+  // Another thread may have interned the string after the shared lock was
+  // released
+  const usize idx = this->probe(str, hash);
+  if (this->_table.ptr()[idx] != 0) {
+    return static_cast<u32>(this->_table.ptr()[idx]) - 1;
+  }
+
+  const usize adjusted = id + FIRST_SEGMENT_LEN;
+  const usize segment  = static_cast<usize>(std::bit_width(adjusted) -
+                                           std::bit_width(FIRST_SEGMENT_LEN));
+  CBL_VERIFY(segment < MAX_SEGMENTS, "StringPool is full");
+  if (this->_segments[segment] == nullptr) {
+    Slice<Entry> entries =
+        this->_allocator->createArray<Entry>(FIRST_SEGMENT_LEN << segment);
+    CBL_VERIFY(!entries.isEmpty(), "Allocation failed");
+    this->_segments[segment] = entries.ptr();
+  }
+
+  this->entry(id)         = Entry{this->store(str), str.len()};
+  this->_table.ptr()[idx] = (static_cast<u64>(hash) << 32) |
+                            static_cast<u64>(id + 1);
+
+  // Publish the entry to `resolve`
+  this->_len.store(id + 1, std::memory_order_release);
+  return static_cast<u32>(id);
+}
+
+auto StringPool::find(Slice<u8> str, u32* out) const noexcept -> bool {
+  const u32        hash = hashBytes(str);
+  std::shared_lock lock{this->_mutex};
+  if (this->_table.isEmpty()) {
+    return false;
+  }
+  const u64 slot = this->_table.ptr()[this->probe(str, hash)];
+  if (slot == 0) {
+    return false;
+  }
+  *out = static_cast<u32>(slot) - 1;
+  return true;
+}
+
+auto StringPool::resolve(u32 id) const noexcept -> Slice<u8> {
+  [[maybe_unused]] const usize len =
+      this->_len.load(std::memory_order_acquire);
+  CBL_ASSERT(static_cast<usize>(id) < len, "Invalid string ID");
+  const Entry& e = this->entry(static_cast<usize>(id));
+  return Slice<u8>{e.ptr, e.len};
+}
+
+auto StringPool::len() const noexcept -> usize {
+  return this->_len.load(std::memory_order_acquire);
+}
+
+auto StringPool::entry(usize id) const noexcept -> Entry& {
+  const usize adjusted = id + FIRST_SEGMENT_LEN;
+  const usize segment  = static_cast<usize>(std::bit_width(adjusted) -
+                                           std::bit_width(FIRST_SEGMENT_LEN));
+  return this->_segments[segment][adjusted - (FIRST_SEGMENT_LEN << segment)];
+}
+
+auto StringPool::probe(Slice<u8> str, u32 hash) const noexcept -> usize {
+  const u64*  table = this->_table.ptr();
+  const usize mask  = this->_table.len() - 1;
+  usize       idx   = static_cast<usize>(hash) & mask;
+  while (true) {
+    const u64 slot = table[idx];
+    if (slot == 0) {
+      return idx;
+    }
+    if (static_cast<u32>(slot >> 32) == hash) {
+      const Entry& e = this->entry(static_cast<usize>(static_cast<u32>(slot)) -
+                                   1);
+      if (str::eql(Slice<u8>{e.ptr, e.len}, str)) {
+        return idx;
+      }
+    }
+    idx = (idx + 1) & mask;
+  }
+}
+
+auto StringPool::store(Slice<u8> str) noexcept -> u8* {
+  if (str.len() == 0) {
+    return nullptr;
+  }
+
+  // Large strings get their own chunk so they don't waste the current one
+  if (str.len() > CHUNK_SIZE / 4) {
+    Slice<u8> chunk = this->allocateChunk(str.len());
+    std::memcpy(chunk.ptr(), str.ptr(), str.len());
+    return chunk.ptr();
+  }
+
+  if (this->_chunk_pos + str.len() > this->_chunk.len()) {
+    this->_chunk     = this->allocateChunk(CHUNK_SIZE);
+    this->_chunk_pos = 0;
+  }
+  u8* dst = this->_chunk.ptr() + this->_chunk_pos;
+  std::memcpy(dst, str.ptr(), str.len());
+  this->_chunk_pos += str.len();
+  return dst;
+}
+
+auto StringPool::allocateChunk(usize size) noexcept -> Slice<u8> {
+  Slice<u8> chunk = this->_allocator->allocate(mem::Layout::array<u8>(size));
+  CBL_VERIFY(!chunk.isEmpty(), "Allocation failed");
+  chunk = Slice<u8>{chunk.ptr(), size};
+  this->_chunks.append(*this->_allocator, chunk);
+  return chunk;
+}
+
+auto StringPool::grow() noexcept -> void {
+  const usize new_len = this->_table.isEmpty() ? 2 * FIRST_SEGMENT_LEN
+                                               : 2 * this->_table.len();
+  Slice<u64>  table   = this->_allocator->createArray<u64>(new_len);
+  CBL_VERIFY(!table.isEmpty(), "Allocation failed");
+
+  // Slots hold their hash, so entries can be moved without rehashing strings
+  const usize mask = new_len - 1;
+  for (const u64 slot : this->_table) {
+    if (slot == 0) {
+      continue;
+    }
+    usize idx = static_cast<usize>(slot >> 32) & mask;
+    while (table.ptr()[idx] != 0) {
+      idx = (idx + 1) & mask;
+    }
+    table.ptr()[idx] = slot;
+  }
+
+  this->_allocator->destroyArray(this->_table);
+  this->_table = table;
+}
+
+} // namespace cbl
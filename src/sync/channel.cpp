@@ -0,0 +1,150 @@
+#include "cbl/sync/channel.h"
+
+#include "cbl/assert.h"     // CBL_ASSERT
+#include "cbl/primitives.h" // u64, usize
+#include "cbl/slice.h"      // Slice
+#include "cbl/sync/futex.h" // futexWait, futexWake, futexWakeAll, spinHint
+#include <atomic>           // atomic_thread_fence, memory_order
+#include <cstdint>          // uint32_t
+#include <thread>           // this_thread
+#include <time.h>           // clock_gettime
+
+namespace cbl::sync {
+
+namespace {
+
+auto monotonicNs() noexcept -> u64 {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<u64>(ts.tv_sec) * 1000000000ULL +
+         static_cast<u64>(ts.tv_nsec);
+}
+
+/// Returns the index of the first ready channel, or `channels.len()`.
+auto findReady(Slice<ChannelBase* const> channels) noexcept -> usize {
+  for (usize i = 0; i < channels.len(); i++) {
+    if (channels[i]->isReady()) {
+      return i;
+    }
+  }
+  return channels.len();
+}
+
+} // namespace
+
+auto select(Slice<ChannelBase* const> channels, u64 timeout_ns) noexcept
+    -> usize {
+  usize ready = findReady(channels);
+  if (ready != channels.len()) {
+    return ready;
+  }
+
+  const u64 deadline =
+      (timeout_ns == NO_TIMEOUT) ? NO_TIMEOUT : monotonicNs() + timeout_ns;
+  while (true) {
+    // Register with every channel, then check them again: a sender that
+    // made one ready before it saw the waiter is seen here
+    detail::Waiter waiter;
+    for (ChannelBase* channel : channels) {
+      CBL_ASSERT(channel->_waiter.load(std::memory_order_relaxed) == nullptr,
+                 "Only one thread may receive from a channel");
+      channel->_waiter.store(&waiter, std::memory_order_seq_cst);
+    }
+
+    bool timed_out = false;
+    ready          = findReady(channels);
+    if (ready == channels.len()) {
+      u64 remaining = NO_TIMEOUT;
+      if (deadline != NO_TIMEOUT) {
+        const u64 now = monotonicNs();
+        remaining     = (now < deadline) ? deadline - now : 0;
+      }
+      timed_out = (remaining == 0) || !futexWait(waiter.state, 0, remaining);
+    }
+
+    // A sender that took the waiter is about to set its state; wait for it,
+    // since the waiter goes out of scope
+    for (ChannelBase* channel : channels) {
+      if (channel->_waiter.exchange(nullptr, std::memory_order_acq_rel) ==
+          nullptr) {
+        while (waiter.state.load(std::memory_order_acquire) == 0) {
+          spinHint();
+        }
+      }
+    }
+
+    ready = findReady(channels);
+    if ((ready != channels.len()) || timed_out) {
+      return ready;
+    }
+  }
+}
+
+auto ChannelBase::close() noexcept -> void {
+  if ((this->_tail.fetch_or(CLOSED, std::memory_order_seq_cst) & CLOSED) !=
+      0) {
+    return;
+  }
+  this->wakeReceiver();
+  this->_send_seq.fetch_add(1, std::memory_order_release);
+  futexWakeAll(this->_send_seq);
+}
+
+auto ChannelBase::waitForSlot() noexcept -> void {
+  // Announce the sender, then check the channel again: a receiver that
+  // freed a slot before it saw the announcement is seen here
+  const uint32_t seq = this->_send_seq.load(std::memory_order_acquire);
+  this->_senders_asleep.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const usize tail = this->_tail.load(std::memory_order_relaxed);
+  const usize head = this->_head.load(std::memory_order_acquire);
+  if (((tail & CLOSED) == 0) && (tail - head > this->_mask)) {
+    futexWait(this->_send_seq, seq);
+  }
+}
+
+auto ChannelBase::waitReady() noexcept -> void {
+  // A sender between claiming a slot and filling it is only a few
+  // instructions away from being done, unless it was preempted
+  if (this->isReady()) {
+    for (usize i = 0; i < SPIN_LIMIT; i++) {
+      spinHint();
+    }
+    std::this_thread::yield();
+    return;
+  }
+
+  for (usize i = 0; i < SPIN_LIMIT; i++) {
+    spinHint();
+    if (this->isReady()) {
+      return;
+    }
+  }
+  ChannelBase* self = this;
+  (void)select(Slice<ChannelBase* const>{&self, 1});
+}
+
+auto ChannelBase::wakeReceiverSlow() noexcept -> void {
+  detail::Waiter* waiter =
+      this->_waiter.exchange(nullptr, std::memory_order_acq_rel);
+  if (waiter == nullptr) {
+    return;
+  }
+  // The waiter may go out of scope as soon as its state is set, but waking
+  // an address nobody waits on is harmless, and waiters handle spurious
+  // wake ups
+  FutexWord& state = waiter->state;
+  state.store(1, std::memory_order_release);
+  futexWake(state, 1);
+}
+
+auto ChannelBase::wakeSendersSlow() noexcept -> void {
+  // Every sleeping sender is woken up, since the flag no longer tells
+  // whether some still sleep; the ones that find no free slot sleep again
+  if (this->_senders_asleep.exchange(false, std::memory_order_relaxed)) {
+    this->_send_seq.fetch_add(1, std::memory_order_release);
+    futexWakeAll(this->_send_seq);
+  }
+}
+
+} // namespace cbl::sync
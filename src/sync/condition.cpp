@@ -0,0 +1,31 @@
+#include "cbl/sync/condition.h"
+
+#include "cbl/primitives.h" // u64
+#include "cbl/sync/futex.h" // futexWait, futexWake, futexWakeAll
+#include "cbl/sync/mutex.h" // Mutex
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+auto Condition::waitFor(Mutex& mutex, u64 timeout_ns) noexcept -> bool {
+  // Read the sequence before unlocking: a notification sent after that
+  // changes it, so the futex does not sleep
+  const uint32_t seq = this->_seq.load(std::memory_order_relaxed);
+  mutex.unlock();
+  const bool notified = futexWait(this->_seq, seq, timeout_ns);
+  mutex.lock();
+  return notified;
+}
+
+auto Condition::notifyOne() noexcept -> void {
+  this->_seq.fetch_add(1, std::memory_order_relaxed);
+  futexWake(this->_seq, 1);
+}
+
+auto Condition::notifyAll() noexcept -> void {
+  this->_seq.fetch_add(1, std::memory_order_relaxed);
+  futexWakeAll(this->_seq);
+}
+
+} // namespace cbl::sync
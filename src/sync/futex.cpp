@@ -0,0 +1,52 @@
+#include "cbl/sync/futex.h"
+
+#include "cbl/primitives.h" // u32, u64
+#include <cerrno>           // errno, ETIMEDOUT
+#include <climits>          // INT_MAX
+#include <cstdint>          // uint32_t
+#include <ctime>            // timespec
+#include <linux/futex.h>    // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h>    // SYS_futex
+#include <unistd.h>         // syscall
+
+namespace cbl::sync {
+
+namespace {
+
+auto futexAddr(const FutexWord& word) noexcept -> uint32_t* {
+  // The kernel only reads the word, but the syscall takes a mutable pointer
+  static_assert(sizeof(FutexWord) == sizeof(uint32_t));
+  return const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(&word));
+}
+
+} // namespace
+
+auto futexWait(const FutexWord& word, uint32_t expected,
+               u64 timeout_ns) noexcept -> bool {
+  timespec  ts;
+  timespec* timeout = nullptr;
+  if (timeout_ns != NO_TIMEOUT) {
+    ts.tv_sec  = static_cast<time_t>(timeout_ns / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout_ns % 1000000000);
+    timeout    = &ts;
+  }
+
+  // `EAGAIN` (the word changed) and `EINTR` are spurious wake ups
+  const long ret = syscall(SYS_futex, futexAddr(word), FUTEX_WAIT_PRIVATE,
+                           expected, timeout, nullptr, 0);
+  return (ret == 0) || (errno != ETIMEDOUT);
+}
+
+auto futexWake(const FutexWord& word, u32 count) noexcept -> u32 {
+  const int  n   = (count > INT_MAX) ? INT_MAX : static_cast<int>(count);
+  const long ret = syscall(SYS_futex, futexAddr(word), FUTEX_WAKE_PRIVATE, n,
+                           nullptr, nullptr, 0);
+  return (ret > 0) ? static_cast<u32>(ret) : 0;
+}
+
+auto futexWakeAll(const FutexWord& word) noexcept -> void {
+  syscall(SYS_futex, futexAddr(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+          nullptr, 0);
+}
+
+} // namespace cbl::sync
@@ -0,0 +1,52 @@
+#include "cbl/sync/mutex.h"
+
+#include "cbl/primitives.h" // u32
+#include "cbl/sync/futex.h" // futexWait, spinHint
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+namespace {
+
+/// The most `spinHint`s between two reads of a contended word.
+constexpr u32 MAX_BACKOFF = 64;
+
+/// The most `spinHint`s before going to sleep, which is on the order of a
+/// microsecond: roughly the cost of sleeping and being woken up.
+constexpr u32 SPIN_LIMIT = 1024;
+
+} // namespace
+
+auto Mutex::lockSlow() noexcept -> void {
+  // Spin while the owner is running its critical section, but not once
+  // others sleep on the mutex: unlocking then wakes one of them, so a
+  // spinner would only race with it
+  uint32_t state = this->_state.load(std::memory_order_relaxed);
+  u32      spins = 0;
+  for (u32 backoff = 1; (state == LOCKED) && (spins < SPIN_LIMIT);
+       backoff = (backoff < MAX_BACKOFF) ? 2 * backoff : backoff) {
+    for (u32 i = 0; i < backoff; i++) {
+      spinHint();
+    }
+    spins += backoff;
+    state  = this->_state.load(std::memory_order_relaxed);
+  }
+
+  if (state == UNLOCKED) {
+    if (this->_state.compare_exchange_strong(state, LOCKED,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      return;
+    }
+  }
+
+  // Taking the mutex as `CONTENDED` is pessimistic: the next unlock makes a
+  // syscall even if no one else is waiting, but a waiter is never missed
+  while (this->_state.exchange(CONTENDED, std::memory_order_acquire) !=
+         UNLOCKED) {
+    futexWait(this->_state, CONTENDED);
+  }
+}
+
+} // namespace cbl::sync
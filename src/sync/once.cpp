@@ -0,0 +1,43 @@
+#include "cbl/sync/once.h"
+
+#include "cbl/sync/futex.h" // futexWait, futexWakeAll
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+auto Once::begin() noexcept -> bool {
+  uint32_t state = this->_state.load(std::memory_order_acquire);
+  while (true) {
+    switch (state) {
+    case INCOMPLETE:
+      if (this->_state.compare_exchange_weak(state, RUNNING,
+                                             std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+        return true;
+      }
+      break;
+    case RUNNING:
+      if (!this->_state.compare_exchange_weak(state, WAITING,
+                                              std::memory_order_acquire,
+                                              std::memory_order_acquire)) {
+        break;
+      }
+      [[fallthrough]];
+    case WAITING:
+      futexWait(this->_state, WAITING);
+      state = this->_state.load(std::memory_order_acquire);
+      break;
+    default:
+      return false;
+    }
+  }
+}
+
+auto Once::finish() noexcept -> void {
+  if (this->_state.exchange(DONE, std::memory_order_release) == WAITING) {
+    futexWakeAll(this->_state);
+  }
+}
+
+} // namespace cbl::sync
@@ -0,0 +1,62 @@
+#include "cbl/sync/reset_event.h"
+
+#include "cbl/primitives.h" // u64
+#include "cbl/sync/futex.h" // futexWait, futexWakeAll
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+#include <time.h>           // clock_gettime
+
+namespace cbl::sync {
+
+namespace {
+
+auto monotonicNs() noexcept -> u64 {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<u64>(ts.tv_sec) * 1000000000ULL +
+         static_cast<u64>(ts.tv_nsec);
+}
+
+} // namespace
+
+auto ResetEvent::set() noexcept -> void {
+  // Avoid the read-modify-write if the event is already set
+  if (this->_state.load(std::memory_order_relaxed) == IS_SET) {
+    return;
+  }
+  if (this->_state.exchange(IS_SET, std::memory_order_release) == WAITING) {
+    futexWakeAll(this->_state);
+  }
+}
+
+auto ResetEvent::waitSlow(u64 timeout_ns) noexcept -> bool {
+  // Tell `set` that there are threads to wake up
+  uint32_t state = UNSET;
+  if (!this->_state.compare_exchange_strong(state, WAITING,
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+    if (state == IS_SET) {
+      return true;
+    }
+  }
+
+  // Spurious wake ups must not extend the timeout
+  const u64 deadline =
+      (timeout_ns == NO_TIMEOUT) ? NO_TIMEOUT : monotonicNs() + timeout_ns;
+  while (true) {
+    u64 remaining = NO_TIMEOUT;
+    if (deadline != NO_TIMEOUT) {
+      const u64 now = monotonicNs();
+      if (now >= deadline) {
+        return this->isSet();
+      }
+      remaining = deadline - now;
+    }
+    futexWait(this->_state, WAITING, remaining);
+    if (this->_state.load(std::memory_order_acquire) == IS_SET) {
+      return true;
+    }
+  }
+}
+
+} // namespace cbl::sync
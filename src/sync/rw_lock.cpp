@@ -0,0 +1,145 @@
+#include "cbl/sync/rw_lock.h"
+
+#include "cbl/assert.h"     // CBL_ASSERT, CBL_VERIFY
+#include "cbl/primitives.h" // u32
+#include "cbl/sync/futex.h" // futexWait, futexWake, futexWakeAll, spinHint
+#include <atomic>           // memory_order
+#include <cstdint>          // uint32_t
+
+namespace cbl::sync {
+
+namespace {
+
+/// The most reads of the state before going to sleep.
+constexpr u32 SPIN_LIMIT = 100;
+
+/// Spins until `done(state)` or for `SPIN_LIMIT` reads, returning the last
+/// state read.
+template <class F>
+auto spinUntil(const FutexWord& word, F&& done) noexcept -> uint32_t {
+  uint32_t state = word.load(std::memory_order_relaxed);
+  for (u32 i = 0; (i < SPIN_LIMIT) && !done(state); i++) {
+    spinHint();
+    state = word.load(std::memory_order_relaxed);
+  }
+  return state;
+}
+
+} // namespace
+
+auto RwLock::lockSharedSlow() noexcept -> void {
+  // Spin while a writer holds the lock, unless others already sleep
+  auto     done  = [](uint32_t s) {
+    return ((s & MASK) != WRITE_LOCKED) ||
+           ((s & (READERS_WAITING | WRITERS_WAITING)) != 0);
+  };
+  uint32_t state = spinUntil(this->_state, done);
+  while (true) {
+    if (isReadLockable(state)) {
+      if (this->_state.compare_exchange_weak(state, state + READ_LOCKED,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    CBL_VERIFY((state & MASK) != MAX_READERS, "Too many readers");
+
+    // Readers are woken up by the writer that unlocks, once it sees the flag
+    if ((state & READERS_WAITING) == 0) {
+      if (!this->_state.compare_exchange_weak(state, state | READERS_WAITING,
+                                              std::memory_order_relaxed,
+                                              std::memory_order_relaxed)) {
+        continue;
+      }
+    }
+    futexWait(this->_state, state | READERS_WAITING);
+    state = spinUntil(this->_state, done);
+  }
+}
+
+auto RwLock::lockSlow() noexcept -> void {
+  auto     done  = [](uint32_t s) {
+    return isUnlocked(s) || ((s & WRITERS_WAITING) != 0);
+  };
+  uint32_t state = spinUntil(this->_state, done);
+
+  // Once this thread has slept, it can't know whether other writers still
+  // sleep, so it keeps the flag set when it takes the lock
+  uint32_t other_writers_waiting = 0;
+  while (true) {
+    if (isUnlocked(state)) {
+      if (this->_state.compare_exchange_weak(
+              state, state | WRITE_LOCKED | other_writers_waiting,
+              std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+
+    if ((state & WRITERS_WAITING) == 0) {
+      if (!this->_state.compare_exchange_weak(state, state | WRITERS_WAITING,
+                                              std::memory_order_relaxed,
+                                              std::memory_order_relaxed)) {
+        continue;
+      }
+    }
+    other_writers_waiting = WRITERS_WAITING;
+
+    // Read the notification counter before checking the state again, so a
+    // wake up between the two is not missed
+    const uint32_t seq = this->_writer_notify.load(std::memory_order_acquire);
+    state              = this->_state.load(std::memory_order_relaxed);
+    if (isUnlocked(state) || ((state & WRITERS_WAITING) == 0)) {
+      continue;
+    }
+    futexWait(this->_writer_notify, seq);
+    state = spinUntil(this->_state, done);
+  }
+}
+
+auto RwLock::wake(uint32_t state) noexcept -> void {
+  CBL_ASSERT(isUnlocked(state), "The lock must be unlocked");
+
+  // Writers go first
+  if (state == WRITERS_WAITING) {
+    if (this->_state.compare_exchange_strong(state, 0,
+                                             std::memory_order_relaxed,
+                                             std::memory_order_relaxed)) {
+      this->wakeWriter();
+      return;
+    }
+    // Readers may have started to wait as well
+  }
+
+  // Clear the writers flag and wake one up, leaving the readers asleep
+  // unless no writer was asleep
+  if (state == (READERS_WAITING | WRITERS_WAITING)) {
+    if (!this->_state.compare_exchange_strong(state, READERS_WAITING,
+                                              std::memory_order_relaxed,
+                                              std::memory_order_relaxed)) {
+      // Another thread locked the lock, and will wake the waiters when it
+      // unlocks
+      return;
+    }
+    if (this->wakeWriter()) {
+      return;
+    }
+    state = READERS_WAITING;
+  }
+
+  if (state == READERS_WAITING) {
+    if (this->_state.compare_exchange_strong(state, 0,
+                                             std::memory_order_relaxed,
+                                             std::memory_order_relaxed)) {
+      futexWakeAll(this->_state);
+    }
+  }
+}
+
+auto RwLock::wakeWriter() noexcept -> bool {
+  this->_writer_notify.fetch_add(1, std::memory_order_release);
+  return futexWake(this->_writer_notify, 1) > 0;
+}
+
+} // namespace cbl::sync
@@ -0,0 +1,293 @@
+#include "cbl/trace.h"
+
+#include "cbl/dynamic_array.h" // UnmanagedDynamicArray
+#include "cbl/io/binary.h"     // BinaryWriter
+#include "cbl/io/writer.h"     // Writer
+#include "cbl/mem/allocator.h" // Allocator
+#include "cbl/primitives.h"    // u8, u32, u64, i64, usize, f64, const_cstr
+#include "cbl/slice.h"         // Slice
+#include "cbl/sort.h"          // pdq
+#include <algorithm>           // lower_bound
+#include <atomic>              // atomic
+#include <chrono>              // steady_clock
+#include <cstdlib>             // calloc
+#include <cstring>             // strlen
+#include <mutex>               // mutex, lock_guard
+#include <new>                 // operator new
+
+namespace cbl::trace {
+
+namespace {
+
+using detail::ThreadBuffer;
+
+/// A tick count and the time it was taken at, used to convert ticks to
+/// nanoseconds.
+struct Anchor {
+  u64 ticks;
+  u64 ns;
+};
+
+auto anchorNow() noexcept -> Anchor {
+  const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+  return Anchor{
+      now(),
+      static_cast<u64>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch)
+              .count()),
+  };
+}
+
+/// The threads that have recorded events.
+///
+/// Buffers are never freed, since the exporters may read them at any time;
+/// the buffer of an exited thread is reused by a new thread once it has been
+/// drained.
+struct Registry {
+  std::mutex    mutex;
+  ThreadBuffer* buffers = nullptr;
+  u32           threads = 0;
+  Anchor        origin  = anchorNow();
+};
+
+auto registry() noexcept -> Registry& {
+  static Registry registry;
+  return registry;
+}
+
+/// Retires the buffer of a thread when the thread exits.
+struct Retirer {
+  ~Retirer() noexcept {
+    if (detail::t_buffer != nullptr) {
+      detail::t_buffer->retired.store(true, std::memory_order_release);
+      detail::t_buffer = nullptr;
+    }
+  }
+};
+
+/// Returns the nanoseconds per tick since the origin.
+auto nsPerTick(const Anchor& origin) noexcept -> f64 {
+  const Anchor current = anchorNow();
+  if ((current.ticks <= origin.ticks) || (current.ns <= origin.ns)) {
+    return 1.0;
+  }
+  return static_cast<f64>(current.ns - origin.ns) /
+         static_cast<f64>(current.ticks - origin.ticks);
+}
+
+/// Returns the nanoseconds between the origin and `ticks`.
+auto sinceOrigin(u64 ticks, const Anchor& origin, f64 ns_per_tick) noexcept
+    -> f64 {
+  const f64 delta = (ticks >= origin.ticks)
+                        ? static_cast<f64>(ticks - origin.ticks)
+                        : -static_cast<f64>(origin.ticks - ticks);
+  return delta * ns_per_tick;
+}
+
+auto writeJsonString(io::Writer& writer, const_cstr str) noexcept -> void {
+  writer.format("\"");
+  for (const char* c = str; *c != '\0'; c++) {
+    if ((*c == '"') || (*c == '\\')) {
+      writer.format("\\{}", *c);
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      const u32 code = static_cast<unsigned char>(*c);
+      writer.format("\\u00{x}{x}", code >> 4, code & 0xF);
+    } else {
+      writer.format("{}", *c);
+    }
+  }
+  writer.format("\"");
+}
+
+auto zigzag(i64 value) noexcept -> u64 {
+  return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+}
+
+auto writeString(io::BinaryWriter& writer, const_cstr str) noexcept -> void {
+  writer.writeSlice(Slice<u8>{
+      reinterpret_cast<u8*>(const_cast<char*>(str)), std::strlen(str)});
+}
+
+} // namespace
+
+namespace detail {
+
+auto registerThread() noexcept -> ThreadBuffer* {
+  Registry&                   reg = registry();
+  std::lock_guard<std::mutex> lock{reg.mutex};
+
+  // Reuse the buffer of an exited thread if all of its events were exported
+  ThreadBuffer* buf = nullptr;
+  for (ThreadBuffer* b = reg.buffers; b != nullptr; b = b->next) {
+    if (b->retired.load(std::memory_order_acquire) &&
+        (b->head.load(std::memory_order_relaxed) ==
+         b->tail.load(std::memory_order_relaxed))) {
+      buf = b;
+      buf->retired.store(false, std::memory_order_relaxed);
+      buf->open = 0;
+      break;
+    }
+  }
+
+  // Tracing must not depend on the allocators, which are traced themselves
+  if (buf == nullptr) {
+    void*  mem    = std::calloc(1, sizeof(ThreadBuffer));
+    Event* events = static_cast<Event*>(std::calloc(BUFFER_EVENTS,
+                                                    sizeof(Event)));
+    CBL_VERIFY((mem != nullptr) && (events != nullptr), "Allocation failed");
+    buf          = new (mem) ThreadBuffer();
+    buf->events  = Slice<Event>{events, BUFFER_EVENTS};
+    buf->thread  = reg.threads++;
+    buf->next    = reg.buffers;
+    reg.buffers  = buf;
+  }
+
+  thread_local Retirer retirer;
+  (void)retirer;
+  t_buffer = buf;
+  return buf;
+}
+
+} // namespace detail
+
+auto dropped() noexcept -> usize {
+  Registry&                   reg = registry();
+  std::lock_guard<std::mutex> lock{reg.mutex};
+  usize                       total = 0;
+  for (ThreadBuffer* b = reg.buffers; b != nullptr; b = b->next) {
+    total += b->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+auto exportChromeJson(io::Writer& writer) noexcept -> usize {
+  Registry&                   reg = registry();
+  std::lock_guard<std::mutex> lock{reg.mutex};
+  const f64                   ns_per_tick = nsPerTick(reg.origin);
+
+  usize count   = 0;
+  usize dropped = 0;
+  writer.format("{{\"traceEvents\":[");
+  for (ThreadBuffer* b = reg.buffers; b != nullptr; b = b->next) {
+    const usize tail  = b->tail.load(std::memory_order_acquire);
+    dropped          += b->dropped.load(std::memory_order_relaxed);
+    for (usize i = b->head.load(std::memory_order_relaxed); i < tail; i++) {
+      const Event& event =
+          b->events.getUnchecked(i & (BUFFER_EVENTS - 1));
+      const f64 us = sinceOrigin(event.time, reg.origin, ns_per_tick) / 1000.0;
+
+      if (count == 0) {
+        writer.format("\n{{\"name\":");
+      } else {
+        writer.format(",\n{{\"name\":");
+      }
+      writeJsonString(writer, event.site->name);
+      switch (event.kind) {
+      case Kind::Begin:
+        writer.format(",\"ph\":\"B\",\"ts\":{},\"pid\":1,\"tid\":{}", us,
+                      b->thread);
+        writer.format(",\"args\":{{\"file\":");
+        writeJsonString(writer, event.site->file);
+        writer.format(",\"line\":{}}}}}", event.site->line);
+        break;
+      case Kind::End:
+        writer.format(",\"ph\":\"E\",\"ts\":{},\"pid\":1,\"tid\":{}}}", us,
+                      b->thread);
+        break;
+      case Kind::Counter:
+      default:
+        writer.format(",\"ph\":\"C\",\"ts\":{},\"pid\":1,\"tid\":{}", us,
+                      b->thread);
+        writer.format(",\"args\":{{\"value\":{}}}}}", event.value);
+        break;
+      }
+      count++;
+    }
+    b->head.store(tail, std::memory_order_release);
+  }
+  writer.format("\n],\"displayTimeUnit\":\"ns\",");
+  writer.format("\"otherData\":{{\"dropped\":{}}}}}\n", dropped);
+  return count;
+}
+
+auto exportBinary(mem::Allocator& allocator, io::Writer& writer) noexcept
+    -> usize {
+  Registry&                   reg = registry();
+  std::lock_guard<std::mutex> lock{reg.mutex};
+  const f64                   ns_per_tick = nsPerTick(reg.origin);
+
+  // Snapshot the events of every thread and collect their sites, so that
+  // events can refer to sites by index
+  UnmanagedDynamicArray<usize>       tails;
+  UnmanagedDynamicArray<const Site*> sites;
+  for (ThreadBuffer* b = reg.buffers; b != nullptr; b = b->next) {
+    const usize tail = b->tail.load(std::memory_order_acquire);
+    tails.append(allocator, tail);
+    const Site* last = nullptr;
+    for (usize i = b->head.load(std::memory_order_relaxed); i < tail; i++) {
+      const Site* site = b->events.getUnchecked(i & (BUFFER_EVENTS - 1)).site;
+      if (site != last) {
+        sites.append(allocator, site);
+        last = site;
+      }
+    }
+  }
+  sort::pdq(sites.elems());
+  usize unique = 0;
+  for (const Site* site : sites.elems()) {
+    if ((unique == 0) || (sites.elems()[unique - 1] != site)) {
+      sites.elems()[unique++] = site;
+    }
+  }
+  const Slice<const Site*> table = sites.elems().first(unique);
+
+  io::BinaryWriter out{writer};
+  out.write(BINARY_MAGIC);
+  out.write(BINARY_VERSION);
+  out.write(ns_per_tick);
+  out.writeVarint(static_cast<u64>(table.len()));
+  for (const Site* site : table) {
+    writeString(out, site->name);
+    writeString(out, site->file);
+    writeString(out, site->function);
+    out.write(site->line);
+  }
+
+  usize count = 0;
+  usize index = 0;
+  for (ThreadBuffer* b = reg.buffers; b != nullptr; b = b->next, index++) {
+    const usize head = b->head.load(std::memory_order_relaxed);
+    const usize tail = tails.elems()[index];
+    if (head == tail) {
+      continue;
+    }
+    out.write(static_cast<u8>(1));
+    out.writeVarint(static_cast<u64>(b->thread));
+    out.writeVarint(static_cast<u64>(tail - head));
+
+    u64 prev = reg.origin.ticks;
+    for (usize i = head; i < tail; i++) {
+      const Event& event =
+          b->events.getUnchecked(i & (BUFFER_EVENTS - 1));
+      const usize site = static_cast<usize>(
+          std::lower_bound(table.begin(), table.end(), event.site) -
+          table.begin());
+      out.write(static_cast<u8>(event.kind));
+      out.writeVarint(static_cast<u64>(site));
+      out.writeVarint(zigzag(static_cast<i64>(event.time - prev)));
+      if (event.kind == Kind::Counter) {
+        out.writeVarint(zigzag(event.value));
+      }
+      prev = event.time;
+    }
+    b->head.store(tail, std::memory_order_release);
+    count += tail - head;
+  }
+  out.write(static_cast<u8>(0));
+
+  tails.deinit(allocator);
+  sites.deinit(allocator);
+  return count;
+}
+
+} // namespace cbl::trace
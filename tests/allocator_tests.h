@@ -1,13 +1,16 @@
 #ifndef CBL_ALLOCATOR_TESTS_H
 #define CBL_ALLOCATOR_TESTS_H
 
+#include "cbl/dynamic_array.h"
 #include "cbl/mem/c_allocator.h"
 #include "cbl/mem/fba.h"
+#include "cbl/mem/pool.h"
 #include "cbl/primitives.h"
 #include "cbl/slice.h"
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 namespace cbl_tests {
 using namespace cbl;
@@ -18,6 +21,38 @@ inline bool is_aligned(const void* ptr, uintptr_t alignment) noexcept {
   return (iptr % alignment) == 0;
 }
 
+inline static void layoutTests() {
+  struct Header {
+    u32 len;
+    u8  tag;
+  };
+
+  // Layouts of types and arrays are computed at compile time
+  static_assert(Layout::init<u64>() == Layout{8, 8});
+  static_assert(Layout::array<u32>(5) == Layout{20, 4});
+  static_assert(Layout{5, 4}.padToAlign() == Layout{8, 4});
+  static_assert(Layout{8, 4}.padToAlign() == Layout{8, 4});
+  static_assert(Layout{5, 4}.alignTo(16) == Layout{5, 16});
+  static_assert(Layout{5, 16}.alignTo(4) == Layout{5, 16});
+  static_assert(Layout{5, 4}.repeat(3) == Layout{24, 4});
+
+  // A header followed by two arrays
+  constexpr Layout::Extended keys =
+      Layout::init<Header>().extend(Layout::array<u64>(3));
+  static_assert(keys.offset == 8);
+  constexpr Layout::Extended values = keys.layout.extend(Layout::array<u8>(5));
+  static_assert(values.offset == 32);
+  static_assert(values.layout == Layout{37, 8});
+  static_assert(values.layout.padToAlign() == Layout{40, 8});
+
+  // The layout can also be computed at run time
+  usize        len    = 3;
+  const Layout layout = Layout::init<Header>()
+                            .extend(Layout::array<u64>(len))
+                            .layout.padToAlign();
+  assert((layout == Layout{32, 8}));
+}
+
 inline static void allocatorTests() {
   CAllocator allocator = CAllocator{};
 
@@ -77,9 +112,164 @@ inline static void fbaTests() {
     assert(mem != nullptr);
     *mem = 2;
     assert(*mem == 2);
+    fba.reset();
+  }
+
+  // Allocations that don't fit fail instead of overrunning the buffer
+  {
+    Slice<u8> first   = fba.allocate(Layout{10, 1});
+    Slice<u8> too_big = fba.allocate(Layout{7, 1});
+    assert((first.len() == 10) && too_big.isEmpty());
+    Slice<u8> second = fba.allocate(Layout{6, 1});
+    Slice<u8> full   = fba.allocate(Layout{1, 1});
+    assert((second.ptr() == first.ptr() + 10) && full.isEmpty());
+
+    // Only the most recent allocation is given back
+    fba.deallocate(first.ptr(), Layout{10, 1});
+    full = fba.allocate(Layout{1, 1});
+    assert(full.isEmpty());
+    fba.deallocate(second.ptr(), Layout{6, 1});
+    Slice<u8> again = fba.allocate(Layout{6, 1});
+    assert(again.ptr() == second.ptr());
+    fba.reset();
+  }
+
+  // Containers can use the allocator without virtual calls
+  {
+    static_assert(AllocatorLike<FixedBufferAllocator>);
+    static_assert(AllocatorLike<Allocator>);
+
+    alignas(8) u8              array_buf[1024];
+    FixedBufferAllocator       array_fba{Slice<u8>{array_buf, 1024}};
+    UnmanagedDynamicArray<u32> array;
+    for (u32 i = 0; i < 32; i++) {
+      array.append(array_fba, i);
+    }
+    array.insert(array_fba, 100, 0);
+    assert((array.len() == 33) && (array.elems()[0] == 100));
+    assert(array.elems()[32] == 31);
+
+    // Nothing can be allocated past the buffer
+    Slice<u32> owned = mem::allocateArray<u32>(array_fba, 200);
+    assert(owned.isEmpty());
+    array.deinit(array_fba);
+  }
+}
+
+inline static void batchTests() {
+  // Blocks of a batch can be freed one by one or all at once
+  {
+    CAllocator allocator{};
+    u8*        ptrs[100];
+    Slice<u8*> batch{ptrs, 100};
+    bool       ok = allocator.allocateBatch(Layout{24, 32}, batch);
+    assert(ok);
+    for (usize i = 0; i < 100; i++) {
+      assert(is_aligned(ptrs[i], 32));
+      std::memset(ptrs[i], static_cast<int>(i), 24);
+    }
+    for (usize i = 0; i < 100; i++) {
+      assert(ptrs[i][23] == static_cast<u8>(i));
+    }
+    allocator.deallocate(ptrs[50], Layout{24, 32});
+    allocator.deallocateBatch(batch.first(50), Layout{24, 32});
+    allocator.deallocateBatch(batch.subslice(51, 100), Layout{24, 32});
+
+    // Batches and single allocations can be mixed in one call
+    ok = allocator.allocateBatch(Layout{8, 1}, batch.first(3));
+    assert(ok);
+    ptrs[3] = allocator.allocate(Layout{8, 1}).ptr();
+    allocator.deallocateBatch(batch.first(4), Layout{8, 1});
+  }
+
+  // Objects are zeroed and can be destroyed together
+  {
+    struct Node {
+      u64   value;
+      Node* next;
+    };
+    CAllocator allocator{};
+    Node*      nodes[200];
+    const bool ok = allocator.createMany(Slice<Node*>{nodes, 200});
+    assert(ok);
+    for (usize i = 0; i < 200; i++) {
+      assert((nodes[i]->value == 0) && (nodes[i]->next == nullptr));
+      nodes[i]->value = i;
+    }
+    allocator.destroy(nodes[0]);
+    allocator.destroyMany(Slice<Node*>{nodes + 1, 199});
+  }
+
+  // The fixed buffer allocator bumps once, and gives back the last batch
+  {
+    alignas(16) u8       buf[256];
+    FixedBufferAllocator fba{Slice<u8>{buf, 256}};
+    u8*                  ptrs[8];
+    Slice<u8*>           batch{ptrs, 8};
+    Slice<u8>            single = fba.allocate(Layout{1, 1});
+    bool                 ok     = fba.allocateBatch(Layout{12, 16}, batch);
+    assert((single.ptr() == buf) && ok);
+    for (usize i = 0; i < 8; i++) {
+      assert(ptrs[i] == buf + 16 * (i + 1));
+    }
+    ok = fba.allocateBatch(Layout{12, 16}, batch);
+    assert(!ok);
+    fba.deallocateBatch(batch, Layout{12, 16});
+    single = fba.allocate(Layout{4, 4});
+    assert(single.ptr() == buf + 16);
+  }
+
+  // Pools take freed blocks first, then carve new ones across slabs
+  {
+    CAllocator    backing{};
+    PoolAllocator pool{backing, Layout{32, 8}, 256};
+    u8*           ptrs[40];
+    Slice<u8*>    batch{ptrs, 40};
+    u8*           freed = pool.allocate(Layout{32, 8}).ptr();
+    pool.deallocate(freed, Layout{32, 8});
+    bool ok = pool.allocateBatch(Layout{32, 8}, batch);
+    assert(ok && (ptrs[0] == freed));
+    for (usize i = 0; i < 40; i++) {
+      for (usize j = 0; j < i; j++) {
+        assert(ptrs[j] != ptrs[i]);
+      }
+    }
+    pool.deallocateBatch(batch, Layout{32, 8});
+    ok = pool.allocateBatch(Layout{64, 8}, batch);
+    assert(!ok);
+    pool.deinit();
   }
 }
 
+inline static void poolTests() {
+  CAllocator    backing{};
+  PoolAllocator pool{backing, Layout{24, 16}, 256};
+  assert(pool.blockSize() == 32);
+
+  // Blocks are aligned and distinct across slabs
+  u8* blocks[40];
+  for (usize i = 0; i < 40; i++) {
+    Slice<u8> mem = pool.allocate(Layout{24, 16});
+    assert(!mem.isEmpty() && is_aligned(mem.ptr(), 16));
+    blocks[i] = mem.ptr();
+    for (usize j = 0; j < i; j++) {
+      assert(blocks[j] != blocks[i]);
+    }
+  }
+
+  // Freed blocks are reused
+  pool.deallocate(blocks[7], Layout{24, 16});
+  Slice<u8> reused = pool.allocate(Layout{24, 16});
+  assert(reused.ptr() == blocks[7]);
+
+  // Layouts that don't fit in a block are rejected
+  Slice<u8> too_big     = pool.allocate(Layout{33, 8});
+  Slice<u8> too_aligned = pool.allocate(Layout{8, 64});
+  assert(too_big.isEmpty() && too_aligned.isEmpty());
+
+  pool.deinit();
+}
+
 } // namespace cbl_tests
 
 #endif // !CBL_ALLOCATOR_TESTS_H
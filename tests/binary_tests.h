@@ -0,0 +1,116 @@
+#ifndef CBL_BINARY_TESTS_H
+#define CBL_BINARY_TESTS_H
+
+#include "cbl/dynamic_array.h"
+#include "cbl/io/binary.h"
+#include "cbl/io/buffer_writer.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::io;
+
+inline static void binaryTests() {
+  mem::CAllocator allocator{};
+  alignas(16) u8  buf[256];
+  BufferWriter    out{Slice<u8>{buf, sizeof(buf)}};
+  BinaryWriter    encoder{out};
+
+  u32 ints[4]    = {1, 2, 300, 4000000000U};
+  f64 floats[2]  = {0.5, -2.25};
+  UnmanagedDynamicArray<f64> array =
+      UnmanagedDynamicArray<f64>::initWithCapacity(allocator, 2);
+  array.appendSlice(allocator, Slice<f64>{floats, 2});
+
+  // Encode
+  encoder.write(static_cast<u8>(7));
+  encoder.write(static_cast<i64>(-5));
+  encoder.write(true);
+  encoder.writeVarint(300);
+  encoder.writeSlice(Slice<u32>{ints, 4});
+  encoder.writeArray(array);
+  assert(encoder.written() == out.written().len());
+
+  // Varints are compact
+  {
+    BinaryReader reader{Slice<u8>{buf + 10, 2}};
+    u64          value = 0;
+    const bool   ok    = reader.readVarint(&value);
+    assert(ok && (value == 300));
+  }
+
+  // Decode
+  {
+    BinaryReader reader{out.written()};
+    u8           a  = 0;
+    i64          b  = 0;
+    bool         c  = false;
+    u64          d  = 0;
+    bool         ok = reader.read(&a);
+    assert(ok && (a == 7));
+    ok = reader.read(&b);
+    assert(ok && (b == -5));
+    ok = reader.read(&c);
+    assert(ok && c);
+    ok = reader.readVarint(&d);
+    assert(ok && (d == 300));
+
+    // Slices are views into the buffer
+    Slice<u32> view;
+    ok = reader.readSlice(&view);
+    assert(ok && (view.len() == 4));
+    assert((view.ptr() >= reinterpret_cast<u32*>(buf)) &&
+           (view.ptr() < reinterpret_cast<u32*>(buf + sizeof(buf))));
+    for (usize i = 0; i < 4; i++) {
+      assert(view[i] == ints[i]);
+    }
+
+    UnmanagedDynamicArray<f64> decoded;
+    ok = reader.readArray(allocator, &decoded);
+    assert(ok && (decoded.len() == 2));
+    assert((decoded.elems()[0] == 0.5) && (decoded.elems()[1] == -2.25));
+    decoded.deinit(allocator);
+
+    // Nothing left
+    u8 extra;
+    assert(reader.remaining() == 0);
+    ok = reader.read(&extra);
+    assert(!ok);
+  }
+
+  // Truncated input is rejected
+  {
+    BinaryReader reader{Slice<u8>{buf, 14}};
+    u8           a;
+    i64          b;
+    bool         c;
+    u64          d;
+    Slice<u32>   view;
+    const bool   fixed  = reader.read(&a) && reader.read(&b) && reader.read(&c);
+    const bool   varint = reader.readVarint(&d);
+    const bool   slice  = reader.readSlice(&view);
+    assert(fixed && varint && !slice);
+  }
+
+  // Short writes are reported, and only accepted bytes are counted
+  {
+    u8           small[12];
+    BufferWriter sink{Slice<u8>{small, sizeof(small)}};
+    BinaryWriter truncated{sink};
+    const bool   first  = truncated.write(static_cast<u64>(1));
+    const bool   second = truncated.write(static_cast<u64>(2));
+    assert(first && !second);
+    assert(truncated.written() == sizeof(small));
+    const bool slice = truncated.writeSlice(Slice<u32>{ints, 4});
+    assert(!slice && (truncated.written() == sizeof(small)));
+  }
+
+  array.deinit(allocator);
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_BINARY_TESTS_H
@@ -0,0 +1,182 @@
+#ifndef CBL_BIT_SET_TESTS_H
+#define CBL_BIT_SET_TESTS_H
+
+#include "cbl/bit_set.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slice_ops.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+inline static void bitSetTests() {
+  BitSet<130> a{};
+  assert((a.len() == 130) && (a.count() == 0));
+
+  // Single bits
+  {
+    a.set(0);
+    a.set(64);
+    a.set(129);
+    assert(a.isSet(0) && a.isSet(64) && a.isSet(129) && !a.isSet(1));
+    a.toggle(1);
+    a.unset(0);
+    assert(!a.isSet(0) && a.isSet(1) && (a.count() == 3));
+  }
+
+  // Set operations
+  {
+    BitSet<130> b{};
+    b.set(1);
+    b.set(100);
+
+    BitSet<130> u = a;
+    u.setUnion(b);
+    assert((u.count() == 4) && u.isSet(100));
+
+    BitSet<130> i = a;
+    i.setIntersection(b);
+    assert((i.count() == 1) && i.isSet(1));
+
+    BitSet<130> d = a;
+    d.setDifference(b);
+    assert((d.count() == 2) && !d.isSet(1));
+
+    BitSet<130> x = a;
+    x.toggleSet(b);
+    assert((x.count() == 3) && !x.isSet(1) && x.isSet(100));
+    assert(!x.eql(a));
+  }
+
+  // Whole-set operations keep the bits past the end unset
+  {
+    BitSet<130> all{};
+    all.setAll();
+    assert(all.count() == 130);
+    assert(all.words()[2] == 0b11);
+    all.toggleAll();
+    assert(all.count() == 0);
+  }
+
+  // Iteration
+  {
+    SetBitIterator it         = a.iterator();
+    usize          idx        = 0;
+    usize          expected[] = {1, 64, 129};
+    usize          n          = 0;
+    while (it.next(&idx)) {
+      assert(idx == expected[n]);
+      n += 1;
+    }
+    assert(n == 3);
+  }
+}
+
+inline static void dynamicBitSetTests() {
+  mem::CAllocator allocator{};
+
+  DynamicBitSet set = DynamicBitSet::initEmpty(allocator, 100);
+  assert((set.len() == 100) && (set.count() == 0));
+
+  // Resizing keeps existing bits and clears truncated ones
+  {
+    set.set(3);
+    set.set(99);
+    set.resize(1000);
+    assert((set.len() == 1000) && set.isSet(3) && set.isSet(99));
+    assert(!set.isSet(100) && !set.isSet(999));
+    set.set(999);
+    set.resize(64);
+    assert(set.count() == 1);
+    set.resize(1000);
+    assert((set.count() == 1) && !set.isSet(99) && !set.isSet(999));
+  }
+
+  // Set operations
+  {
+    DynamicBitSet other = DynamicBitSet::initEmpty(allocator, 1000);
+    other.set(3);
+    other.set(500);
+
+    set.setUnion(other);
+    assert((set.count() == 2) && set.isSet(500));
+    set.setDifference(other);
+    assert(set.count() == 0);
+    set.setAll();
+    set.setIntersection(other);
+    assert(set.eql(other));
+    set.toggleSet(other);
+    assert(set.count() == 0);
+
+    other.deinit();
+  }
+
+  // Iteration visits set bits in order
+  {
+    for (usize i = 0; i < 1000; i += 7) {
+      set.set(i);
+    }
+    SetBitIterator it   = set.iterator();
+    usize          idx  = 0;
+    usize          next = 0;
+    while (it.next(&idx)) {
+      assert(idx == next);
+      next += 7;
+    }
+    assert(next == 1001);
+  }
+
+  // Words can be written out and adopted as they are
+  {
+    Slice<u64> words = allocator.createArray<u64>(set.words().len());
+    slice::copy(words, set.words());
+
+    DynamicBitSet loaded =
+        DynamicBitSet::initFromOwnedWords(allocator, words, set.len());
+    assert(loaded.eql(set) && (loaded.count() == 143));
+    loaded.deinit();
+  }
+
+  set.deinit();
+}
+
+inline static void rankSelectTests() {
+  mem::CAllocator allocator{};
+
+  DynamicBitSet set = DynamicBitSet::initEmpty(allocator, 5000);
+  for (usize i = 0; i < 5000; i++) {
+    if ((i % 3 == 0) || (i % 1024 == 1)) {
+      set.set(i);
+    }
+  }
+
+  RankSelect index{allocator, set.words(), set.len()};
+  assert(index.count() == set.count());
+  assert((index.rank(0) == 0) && (index.rank(5000) == set.count()));
+
+  usize rank = 0;
+  for (usize i = 0; i < 5000; i++) {
+    assert(index.rank(i) == rank);
+    assert(index.isSet(i) == set.isSet(i));
+    if (set.isSet(i)) {
+      assert(index.select(rank) == i);
+      rank += 1;
+    }
+  }
+
+  index.deinit();
+  set.deinit();
+
+  // An empty index
+  {
+    RankSelect empty{allocator, Slice<const u64>{}, 0};
+    assert((empty.count() == 0) && (empty.rank(0) == 0));
+    empty.deinit();
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_BIT_SET_TESTS_H
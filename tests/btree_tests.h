@@ -0,0 +1,156 @@
+#ifndef CBL_BTREE_TESTS_H
+#define CBL_BTREE_TESTS_H
+
+#include "cbl/btree.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <functional>
+
+namespace cbl_tests {
+using namespace cbl;
+
+/// Checks that iterating over `map` yields exactly the keys marked in
+/// `present`, in order, with their values.
+template <class Map>
+inline static void btreeCheck(Map& map, Slice<bool> present,
+                              Slice<u64> values) {
+  typename Map::Range it    = map.iterator();
+  typename Map::Entry entry = {};
+  usize               key   = 0;
+  usize               count = 0;
+  while (it.next(&entry)) {
+    while (!present[key]) {
+      key += 1;
+    }
+    assert(*entry.key == static_cast<u64>(key));
+    assert(*entry.value == values[key]);
+    key   += 1;
+    count += 1;
+  }
+  assert(count == map.len());
+}
+
+inline static void btreeTests() {
+  mem::CAllocator allocator{};
+  const usize     domain  = 5000;
+  Slice<bool>     present = allocator.createArray<bool>(domain);
+  Slice<u64>      values  = allocator.createArray<u64>(domain);
+
+  // Random inserts and removals against a reference
+  {
+    BTreeMap<u64, u64> map{allocator};
+    u64                state = 12345;
+    usize              len   = 0;
+    for (usize op = 0; op < 200000; op++) {
+      state           = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      const usize key = static_cast<usize>(state >> 33) % domain;
+      if ((state >> 20) % 3 != 0) {
+        const bool inserted = map.insert(key, op);
+        assert(inserted == !present[key]);
+        len          += present[key] ? 0 : 1;
+        present[key]  = true;
+        values[key]   = op;
+      } else {
+        const bool removed = map.remove(key);
+        assert(removed == present[key]);
+        len          -= present[key] ? 1 : 0;
+        present[key]  = false;
+      }
+      assert(map.len() == len);
+    }
+    for (usize key = 0; key < domain; key++) {
+      u64* value = map.getPtr(key);
+      assert((value != nullptr) == present[key]);
+      assert((value == nullptr) || (*value == values[key]));
+    }
+    btreeCheck(map, present, values);
+
+    // Ranges stop before their end
+    BTreeMap<u64, u64>::Range range = map.range(1000, 2000);
+    BTreeMap<u64, u64>::Entry entry = {};
+    u64                       prev  = 999;
+    while (range.next(&entry)) {
+      assert((*entry.key > prev) && (*entry.key < 2000));
+      assert(present[*entry.key]);
+      prev = *entry.key;
+    }
+
+    // Removing everything leaves an empty tree
+    for (usize key = 0; key < domain; key++) {
+      map.remove(key);
+      present[key] = false;
+    }
+    BTreeMap<u64, u64>::Range all      = map.iterator();
+    const bool                has_next = all.next(&entry);
+    assert(map.isEmpty() && !has_next);
+    const bool inserted = map.insert(7, 7);
+    assert(inserted && map.contains(7));
+    map.deinit();
+  }
+
+  // Bulk loading
+  {
+    const usize len  = 100000;
+    Slice<u64>  keys = allocator.createArray<u64>(len);
+    Slice<u64>  vals = allocator.createArray<u64>(len);
+    for (usize i = 0; i < len; i++) {
+      keys[i] = 3 * i;
+      vals[i] = i;
+    }
+    BTreeMap<u64, u64> map =
+        BTreeMap<u64, u64>::initFromSorted(allocator, keys, vals);
+    assert(map.len() == len);
+    for (usize i = 0; i < len; i++) {
+      assert(*map.getPtr(3 * i) == i);
+      assert(!map.contains(3 * i + 1));
+    }
+
+    BTreeMap<u64, u64>::Range range = map.range(10, 20);
+    BTreeMap<u64, u64>::Entry entry = {};
+    for (u64 key : {12, 15, 18}) {
+      const bool has_next = range.next(&entry);
+      assert(has_next && (*entry.key == key));
+    }
+    const bool has_next = range.next(&entry);
+    assert(!has_next);
+
+    // The loaded tree can still be modified
+    for (usize i = 0; i < len; i += 2) {
+      const bool removed  = map.remove(3 * i);
+      const bool inserted = map.insert(3 * i + 1, i);
+      assert(removed && inserted);
+    }
+    assert(map.len() == len);
+    assert(!map.contains(0) && (*map.getPtr(1) == 0) && map.contains(3));
+
+    map.deinit();
+    allocator.destroyArray(vals);
+    allocator.destroyArray(keys);
+  }
+
+  // Custom orderings are searched without SIMD
+  {
+    BTreeMap<i32, i32, std::greater<i32>> map{allocator};
+    for (i32 i = 0; i < 1000; i++) {
+      map.insert(i, -i);
+    }
+    BTreeMap<i32, i32, std::greater<i32>>::Entry entry = {};
+    BTreeMap<i32, i32, std::greater<i32>>::Range range = map.iterator();
+    for (i32 i = 999; i >= 0; i--) {
+      const bool has_next = range.next(&entry);
+      assert(has_next && (*entry.key == i) && (*entry.value == -i));
+    }
+    const bool has_next = range.next(&entry);
+    assert(!has_next);
+    map.deinit();
+  }
+
+  allocator.destroyArray(values);
+  allocator.destroyArray(present);
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_BTREE_TESTS_H
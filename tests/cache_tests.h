@@ -0,0 +1,190 @@
+#ifndef CBL_CACHE_TESTS_H
+#define CBL_CACHE_TESTS_H
+
+#include "cbl/cache.h"
+#include "cbl/hash.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include <cassert>
+#include <thread>
+
+namespace cbl_tests {
+using namespace cbl;
+
+/// Counts evicted entries and sums their values.
+struct CountEvict {
+  usize* count;
+  u64*   sum;
+
+  auto operator()(const u64&, const u64& value) const noexcept -> void {
+    *this->count += 1;
+    *this->sum   += value;
+  }
+};
+
+inline static void cacheTests() {
+  mem::CAllocator allocator{};
+  using TestCache    = Cache<u64, u64, Hasher<u64>, std::equal_to<u64>,
+                             CountEvict>;
+  const usize charge = TestCache::charge(0);
+
+  // The least recently used entry is evicted first
+  {
+    usize     evicted = 0;
+    u64       sum     = 0;
+    TestCache cache{allocator, 3 * charge, CachePolicy::Lru,
+                    CountEvict{&evicted, &sum}};
+    for (u64 key = 1; key <= 3; key++) {
+      const bool stored = cache.put(key, key * 10);
+      assert(stored);
+    }
+    assert((cache.len() == 3) && (cache.bytes() == 3 * charge));
+
+    u64        value = 0;
+    const bool hit   = cache.get(1, &value);
+    assert(hit && (value == 10));
+    bool stored = cache.put(4, 40);
+    assert(stored && !cache.contains(2) && cache.contains(1));
+    assert((evicted == 1) && (sum == 20));
+
+    // Replacing a value passes the old one to `OnEvict`
+    stored = cache.put(3, 31);
+    assert(stored && (evicted == 2) && (sum == 50));
+    assert(*cache.getPtr(3) == 31);
+    stored = cache.put(5, 50);
+    assert(stored && !cache.contains(1) && (cache.len() == 3));
+
+    // Removed values are returned instead of evicted
+    const bool removed = cache.remove(4, &value);
+    const bool again   = cache.remove(4);
+    assert(removed && (value == 40) && !again);
+    assert((evicted == 3) && (cache.bytes() == 2 * charge));
+
+    // A rejected put keeps the previous value of its key
+    const bool rejected = cache.put(5, 51, 3 * charge);
+    assert(!rejected && (*cache.getPtr(5) == 50) && (evicted == 3));
+
+    // Extra bytes count against the budget
+    const bool too_big = cache.put(6, 60, 3 * charge);
+    stored             = cache.put(6, 60, charge);
+    assert(!too_big && stored);
+    assert((cache.len() == 2) && cache.contains(5) && !cache.contains(3));
+    cache.deinit();
+    assert(evicted == 6);
+  }
+
+  // Clock gives referenced entries a second chance
+  {
+    usize     evicted = 0;
+    u64       sum     = 0;
+    TestCache cache{allocator, 3 * charge, CachePolicy::Clock,
+                    CountEvict{&evicted, &sum}};
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    assert(cache.getPtr(1) != nullptr);
+    bool stored = cache.put(4, 40);
+    assert(stored && cache.contains(1) && !cache.contains(2));
+    stored = cache.put(5, 50);
+    assert(stored && cache.contains(1) && !cache.contains(3));
+    assert(cache.contains(4));
+    assert((evicted == 2) && (sum == 50));
+    cache.deinit();
+  }
+
+  // Many entries against a reference, growing the table and wrapping probes
+  for (const CachePolicy policy : {CachePolicy::Lru, CachePolicy::Clock}) {
+    const usize     capacity = 500;
+    Cache<u64, u64> cache{allocator, capacity * Cache<u64, u64>::charge(0),
+                          policy};
+    u64             state    = 99;
+    for (usize op = 0; op < 100000; op++) {
+      state         = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      const u64 key = (state >> 33) % 2000;
+      if ((state >> 20) % 4 == 0) {
+        cache.remove(key);
+      } else if ((state >> 20) % 4 == 1) {
+        cache.put(key, key * 3);
+      } else {
+        const u64* value = cache.getPtr(key);
+        assert((value == nullptr) || (*value == key * 3));
+      }
+      assert(cache.len() <= capacity);
+    }
+    usize found = 0;
+    for (u64 key = 0; key < 2000; key++) {
+      found += cache.contains(key) ? 1 : 0;
+    }
+    assert(found == cache.len());
+    cache.clear();
+    assert(cache.isEmpty() && (cache.bytes() == 0) && !cache.contains(0));
+    cache.deinit();
+  }
+
+  // The default hash takes the `_BitInt` aliases and spreads their bits
+  {
+    const Hasher<u64> hash{};
+    assert((hash(1) != hash(2)) && ((hash(1) >> 32) != 0));
+    assert(Hasher<i32>{}(-1) == hash(~u64(0)));
+  }
+}
+
+inline static void shardedCacheTests() {
+  mem::CAllocator        allocator{};
+  const usize            capacity = 4096;
+  ShardedCache<u64, u64> cache{allocator,
+                               capacity * Cache<u64, u64>::charge(0), 8};
+
+  // Threads share keys, so shards see concurrent puts, gets and removes
+  std::thread threads[4];
+  for (usize t = 0; t < 4; t++) {
+    threads[t] = std::thread{[&cache, t]() {
+      for (u64 i = 0; i < 20000; i++) {
+        const u64 key   = (i * 7 + t) % 3000;
+        u64       value = 0;
+        if (cache.get(key, &value)) {
+          assert(value == key + 1);
+        } else {
+          cache.put(key, key + 1);
+        }
+        if (i % 16 == t) {
+          cache.remove(key);
+        }
+      }
+    }};
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  assert((cache.len() > 0) && (cache.len() <= capacity));
+
+  u64        value  = 0;
+  const bool stored = cache.put(5000, 1);
+  assert(stored && cache.contains(5000));
+  const bool hit = cache.get(5000, &value);
+  assert(hit && (value == 1));
+  const bool removed = cache.remove(5000);
+  assert(removed && !cache.contains(5000));
+  cache.clear();
+  assert((cache.len() == 0) && (cache.bytes() == 0));
+  cache.deinit();
+
+  // Small budgets get fewer shards, so each one still holds large entries
+  {
+    const usize            charge = Cache<u64, u64>::charge(0);
+    const usize            budget = ShardedCache<u64, u64>::MIN_SHARD_ENTRIES *
+                                    charge;
+    ShardedCache<u64, u64> fewer{allocator, budget};
+    ShardedCache<u64, u64> eight{allocator, budget, 8};
+    const bool             large = fewer.put(1, 10, budget / 2);
+    const bool             split = eight.put(1, 10, budget / 2);
+    assert(large && fewer.contains(1));
+    assert(!split && !eight.contains(1));
+    fewer.deinit();
+    eight.deinit();
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_CACHE_TESTS_H
@@ -0,0 +1,309 @@
+#ifndef CBL_EVENT_LOOP_TESTS_H
+#define CBL_EVENT_LOOP_TESTS_H
+
+#include "cbl/io/event_loop.h"
+#include "cbl/io/task.h"
+#include "cbl/mem/allocator.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/mem/layout.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::io;
+
+/// Counts the live allocations of an inner allocator.
+struct CountingAllocator final : public mem::Allocator {
+  auto allocate(mem::Layout layout) noexcept -> Slice<u8> override {
+    this->allocations += 1;
+    this->live        += 1;
+    return this->inner.allocate(layout);
+  }
+
+  auto deallocate(u8* ptr, mem::Layout layout) noexcept -> void override {
+    this->live -= 1;
+    this->inner.deallocate(ptr, layout);
+  }
+
+  mem::CAllocator inner{};
+  usize           allocations = 0;
+  usize           live        = 0;
+};
+
+inline static auto square(mem::Allocator&, i32 x) noexcept -> Task<i32> {
+  co_return x * x;
+}
+
+inline static auto sumOfSquares(mem::Allocator& allocator, i32 n) noexcept
+    -> Task<i32> {
+  i32 sum = 0;
+  for (i32 i = 1; i <= n; i++) {
+    sum += co_await square(allocator, i);
+  }
+  co_return sum;
+}
+
+inline static auto storeSum(mem::Allocator& allocator, i32 n,
+                            i32* out) noexcept -> Task<void> {
+  *out = co_await sumOfSquares(allocator, n);
+}
+
+inline static void taskTests() {
+  // Frames come from the allocator of the arguments, and are all freed
+  {
+    CountingAllocator allocator{};
+    i32               result = 0;
+    {
+      Task<void> task = storeSum(allocator, 4, &result);
+      assert(allocator.live == 1);
+      assert(!task.isDone());
+
+      // A task is lazy, so it only runs once something resumes it
+      auto handle = task.release();
+      handle.resume();
+      assert(handle.done());
+      handle.destroy();
+    }
+    assert(result == 1 + 4 + 9 + 16);
+    assert(allocator.allocations == 1 + 1 + 4);
+    assert(allocator.live == 0);
+  }
+
+  // Destroying a task that never started frees its frame
+  {
+    CountingAllocator allocator{};
+    {
+      Task<i32> task = square(allocator, 3);
+      Task<i32> moved{static_cast<Task<i32>&&>(task)};
+      assert(allocator.live == 1);
+    }
+    assert(allocator.live == 0);
+  }
+}
+
+inline static auto pipeReader(EventLoop& loop, int fd, u8* out,
+                              usize* order) noexcept -> Task<void> {
+  u8          buf[4];
+  const isize n = co_await loop.read(fd, Slice<u8>{buf, sizeof(buf)});
+  assert(n == 4);
+  for (usize i = 0; i < 4; i++) {
+    out[i] = buf[i];
+  }
+  *order = *order * 10 + 1;
+}
+
+inline static auto pipeWriter(EventLoop& loop, int fd, usize* order) noexcept
+    -> Task<void> {
+  // Let the reader find the pipe empty first
+  co_await loop.yield();
+  *order = *order * 10 + 2;
+  u8          buf[4] = {1, 2, 3, 4};
+  const isize n      = co_await loop.write(fd, Slice<u8>{buf, sizeof(buf)});
+  assert(n == 4);
+}
+
+inline static auto echo(EventLoop& loop, int fd) noexcept -> Task<void> {
+  u8 buf[16];
+  while (true) {
+    const isize n = co_await loop.read(fd, Slice<u8>{buf, sizeof(buf)});
+    if (n <= 0) {
+      ::shutdown(fd, SHUT_WR);
+      co_return;
+    }
+    const isize written =
+        co_await loop.writeAll(fd, Slice<u8>{buf, static_cast<usize>(n)});
+    assert(written == n);
+  }
+}
+
+inline static auto ping(EventLoop& loop, int fd, usize rounds) noexcept
+    -> Task<void> {
+  for (usize i = 0; i < rounds; i++) {
+    u8          out[3]  = {static_cast<u8>(i), 'a', 'b'};
+    const isize written = co_await loop.writeAll(fd, Slice<u8>{out, 3});
+    assert(written == 3);
+    u8          in[3] = {};
+    const isize read  = co_await loop.readAll(fd, Slice<u8>{in, 3});
+    assert(read == 3);
+    assert((in[0] == static_cast<u8>(i)) && (in[1] == 'a') && (in[2] == 'b'));
+  }
+  ::shutdown(fd, SHUT_WR);
+
+  // The echo closes its end once it sees the end of the stream
+  u8          last;
+  const isize n = co_await loop.read(fd, Slice<u8>{&last, 1});
+  assert(n == 0);
+}
+
+inline static auto bulkWriter(EventLoop& loop, int fd, Slice<u8> buf) noexcept
+    -> Task<void> {
+  const isize written = co_await loop.writeAll(fd, buf);
+  assert(written == static_cast<isize>(buf.len()));
+  close(fd);
+}
+
+inline static auto bulkReader(EventLoop& loop, int fd, Slice<u8> buf,
+                              isize* read) noexcept -> Task<void> {
+  *read = co_await loop.readAll(fd, buf);
+
+  // The writer closed its end, so nothing follows
+  u8          extra;
+  const isize n = co_await loop.read(fd, Slice<u8>{&extra, 1});
+  assert(n == 0);
+}
+
+inline static auto sleeper(EventLoop& loop, u64 ns, usize id,
+                           usize* order) noexcept -> Task<void> {
+  co_await loop.sleep(ns);
+  *order = *order * 10 + id;
+}
+
+inline static auto yielder(EventLoop& loop, usize id, usize* order) noexcept
+    -> Task<void> {
+  for (usize i = 0; i < 2; i++) {
+    *order = *order * 10 + id;
+    co_await loop.yield();
+  }
+}
+
+inline static auto blockForever(EventLoop& loop, int fd) noexcept
+    -> Task<void> {
+  u8 byte;
+  (void)co_await loop.read(fd, Slice<u8>{&byte, 1});
+}
+
+inline static void eventLoopTests() {
+  CountingAllocator allocator{};
+
+  // The reader suspends on an empty pipe until the writer fills it
+  {
+    EventLoop loop{allocator};
+    assert(loop.isValid());
+    int       fds[2];
+    const int rc = pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+    assert(rc == 0);
+
+    u8    out[4] = {};
+    usize order  = 0;
+    loop.spawn(pipeReader(loop, fds[0], out, &order));
+    loop.spawn(pipeWriter(loop, fds[1], &order));
+    loop.run();
+    assert(order == 21);
+    assert((out[0] == 1) && (out[3] == 4));
+    close(fds[0]);
+    close(fds[1]);
+  }
+  assert(allocator.live == 0);
+
+  // Messages bounce through an echo over a socket pair
+  {
+    EventLoop loop{allocator};
+    int       fds[2];
+    const int rc = socketpair(
+        AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds);
+    assert(rc == 0);
+    loop.spawn(echo(loop, fds[1]));
+    loop.spawn(ping(loop, fds[0], 100));
+    loop.run();
+    close(fds[0]);
+    close(fds[1]);
+  }
+  assert(allocator.live == 0);
+
+  // More data than the pipe holds makes the writer wait for the reader
+  {
+    EventLoop   loop{allocator};
+    const usize len = 1 << 20;
+    Slice<u8>   src = allocator.createArray<u8>(len);
+    Slice<u8>   dst = allocator.createArray<u8>(len);
+    for (usize i = 0; i < len; i++) {
+      src[i] = static_cast<u8>(i * 7);
+    }
+    int        fds[2];
+    const int  rc       = pipe2(fds, O_CLOEXEC);
+    const bool read_nb  = EventLoop::setNonBlocking(fds[0]);
+    const bool write_nb = EventLoop::setNonBlocking(fds[1]);
+    assert((rc == 0) && read_nb && write_nb);
+
+    isize read = 0;
+    loop.spawn(bulkReader(loop, fds[0], dst, &read));
+    loop.spawn(bulkWriter(loop, fds[1], src));
+    loop.run();
+    assert(read == static_cast<isize>(len));
+    for (usize i = 0; i < len; i++) {
+      assert(dst[i] == src[i]);
+    }
+    close(fds[0]);
+    allocator.destroyArray(src);
+    allocator.destroyArray(dst);
+  }
+  assert(allocator.live == 0);
+
+  // Timers fire in deadline order, whatever the spawn order
+  {
+    EventLoop loop{allocator};
+    usize     order = 0;
+    loop.spawn(sleeper(loop, 3000000, 3, &order));
+    loop.spawn(sleeper(loop, 1000000, 1, &order));
+    loop.spawn(sleeper(loop, 2000000, 2, &order));
+    loop.spawn(sleeper(loop, 0, 4, &order));
+    loop.run();
+    assert(order == 4123);
+  }
+  assert(allocator.live == 0);
+
+  // Yielding lets the other ready tasks run
+  {
+    EventLoop loop{allocator};
+    usize     order = 0;
+    loop.spawn(yielder(loop, 1, &order));
+    loop.spawn(yielder(loop, 2, &order));
+    loop.run();
+    assert(order == 1212);
+  }
+
+  // Another thread can stop a loop that waits on I/O
+  {
+    EventLoop loop{allocator};
+    int       fds[2];
+    const int rc = pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+    assert(rc == 0);
+    loop.spawn(blockForever(loop, fds[0]));
+    std::thread stopper{[&loop]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      loop.stop();
+    }};
+    loop.run();
+    stopper.join();
+
+    // The blocked task finishes once the pipe has data
+    u8            byte    = 1;
+    const ssize_t written = write(fds[1], &byte, 1);
+    assert(written == 1);
+    loop.run();
+    close(fds[0]);
+    close(fds[1]);
+  }
+  assert(allocator.live == 0);
+
+  // Errors come back as negated `errno` values
+  {
+    EventLoop  loop{allocator};
+    u8         byte;
+    auto       awaiter = loop.read(-1, Slice<u8>{&byte, 1});
+    const bool ready   = awaiter.await_ready();
+    assert(ready && (awaiter.await_resume() == -EBADF));
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_EVENT_LOOP_TESTS_H
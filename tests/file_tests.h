@@ -0,0 +1,156 @@
+#ifndef CBL_FILE_TESTS_H
+#define CBL_FILE_TESTS_H
+
+#include "cbl/io/file.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::io;
+
+/// Writes `len` bytes of a known pattern into `file`.
+inline static void writePattern(File& file, usize len) {
+  u8 chunk[256];
+  for (usize done = 0; done < len; done += sizeof(chunk)) {
+    const usize n = (len - done < sizeof(chunk)) ? len - done : sizeof(chunk);
+    for (usize i = 0; i < n; i++) {
+      chunk[i] = static_cast<u8>((done + i) * 31);
+    }
+    const usize written = file.write(Slice<u8>{chunk, n});
+    assert(written == n);
+  }
+}
+
+/// Checks that `fd` holds the pattern of `writePattern` from `offset` on,
+/// for `len` bytes.
+inline static void checkPattern(int fd, usize offset, usize len) {
+  u8    chunk[256];
+  usize done = 0;
+  while (done < len) {
+    const usize   want = (len - done < sizeof(chunk)) ? len - done
+                                                      : sizeof(chunk);
+    const ssize_t n    = read(fd, chunk, want);
+    assert(n > 0);
+    for (ssize_t i = 0; i < n; i++) {
+      assert(chunk[i] == static_cast<u8>((offset + done + i) * 31));
+    }
+    done += static_cast<usize>(n);
+  }
+}
+
+inline static void copyRangeTests() {
+  const usize len    = 100000;
+  u8          buf[4096];
+  CopyMethod  method = CopyMethod::Buffered;
+
+  // Between regular files the copy stays in the kernel
+  {
+    File src{std::tmpfile()};
+    File dst{std::tmpfile()};
+    writePattern(src, len);
+    const isize copied = copyRange(src, dst, 1000, 50000,
+                                   Slice<u8>{buf, sizeof(buf)}, &method);
+    assert(copied == 50000);
+    assert(method != CopyMethod::Buffered);
+    const off_t pos = lseek(dst.fd(), 0, SEEK_SET);
+    assert(pos == 0);
+    checkPattern(dst.fd(), 1000, 50000);
+
+    // A range past the end of the file stops at the end
+    const isize tail = copyRange(src, dst, len - 10, 100, Slice<u8>{});
+    const isize none = copyRange(src, dst, len, 100, Slice<u8>{});
+    assert((tail == 10) && (none == 0));
+  }
+
+  // From a file into a pipe
+  {
+    File src{std::tmpfile()};
+    writePattern(src, len);
+    int       fds[2];
+    const int rc = pipe(fds);
+    assert(rc == 0);
+    File        dst{fdopen(fds[1], "w")};
+    const isize copied = copyRange(src, dst, 0, 4096,
+                                   Slice<u8>{buf, sizeof(buf)}, &method);
+    assert(copied == 4096);
+    assert(method != CopyMethod::Buffered);
+    checkPattern(fds[0], 0, 4096);
+    close(fds[0]);
+  }
+
+  // From a pipe into a file, where the offset is ignored
+  {
+    int       fds[2];
+    const int rc = pipe(fds);
+    assert(rc == 0);
+    u8 data[4096];
+    for (usize i = 0; i < sizeof(data); i++) {
+      data[i] = static_cast<u8>(i * 31);
+    }
+    const ssize_t written = write(fds[1], data, sizeof(data));
+    assert(written == 4096);
+    close(fds[1]);
+
+    File        src{fdopen(fds[0], "r")};
+    File        dst{std::tmpfile()};
+    const isize copied = copyRange(src, dst, 123, len,
+                                   Slice<u8>{buf, sizeof(buf)}, &method);
+    assert(copied == 4096);
+    assert(method == CopyMethod::Splice);
+    const off_t pos = lseek(dst.fd(), 0, SEEK_SET);
+    assert(pos == 0);
+    checkPattern(dst.fd(), 0, 4096);
+  }
+
+  // Neither end is a regular file or a pipe, so the bytes go through `buf`
+  {
+    int       fds[2];
+    const int rc = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(rc == 0);
+    u8 data[100];
+    for (usize i = 0; i < sizeof(data); i++) {
+      data[i] = static_cast<u8>(i * 31);
+    }
+    const ssize_t written = write(fds[1], data, sizeof(data));
+    assert(written == 100);
+    shutdown(fds[1], SHUT_WR);
+
+    File        src{fdopen(fds[0], "r")};
+    File        dst{std::tmpfile()};
+    const isize no_buf = copyRange(src, dst, 0, 100, Slice<u8>{});
+    assert(no_buf == -EINVAL);
+    const isize copied =
+        copyRange(src, dst, 0, 1000, Slice<u8>{buf, 16}, &method);
+    assert(copied == 100);
+    assert(method == CopyMethod::Buffered);
+    const off_t pos = lseek(dst.fd(), 0, SEEK_SET);
+    assert(pos == 0);
+    checkPattern(dst.fd(), 0, 100);
+    close(fds[1]);
+  }
+
+  // Pending writes through the `FILE*` buffer are copied too
+  {
+    File        src{std::tmpfile()};
+    u8          data[3] = {'a', 'b', 'c'};
+    const usize written = src.write(Slice<u8>{data, 3});
+    assert(written == 3);
+    File        dst{std::tmpfile()};
+    const isize copied =
+        copyRange(src, dst, 1, 2, Slice<u8>{buf, sizeof(buf)});
+    assert(copied == 2);
+    u8            out[2] = {};
+    const ssize_t n      = pread(dst.fd(), out, 2, 0);
+    assert((n == 2) && (out[0] == 'b') && (out[1] == 'c'));
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_FILE_TESTS_H
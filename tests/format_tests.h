@@ -0,0 +1,86 @@
+#ifndef CBL_FORMAT_TESTS_H
+#define CBL_FORMAT_TESTS_H
+
+#include "cbl/io/format.h"
+#include "cbl/io/writer.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <cstring>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::io;
+
+/// Collects formatted output in a fixed buffer.
+struct ArrayWriter : public Writer {
+  char  buf[128] = {};
+  usize len      = 0;
+
+  [[nodiscard]] auto write(Slice<u8> data) noexcept -> usize override {
+    std::memcpy(buf + len, data.ptr(), data.len());
+    len += data.len();
+    return data.len();
+  }
+
+  /// Returns `true` if the output so far is `expected`, and clears it.
+  auto equals(const_cstr expected) noexcept -> bool {
+    bool eq = (std::strlen(expected) == len) &&
+              (std::memcmp(buf, expected, len) == 0);
+    len     = 0;
+    return eq;
+  }
+};
+
+inline static void formatTests() {
+  ArrayWriter writer{};
+
+  // Literals and escapes
+  {
+    writer.format("plain");
+    bool eq = writer.equals("plain");
+    assert(eq);
+    writer.format("{{}} {}", 1);
+    eq = writer.equals("{} 1");
+    assert(eq);
+  }
+
+  // Integers
+  {
+    writer.format("{} {} {}", 0, -42, 1234567890123ULL);
+    bool eq = writer.equals("0 -42 1234567890123");
+    assert(eq);
+    writer.format("{} {}", static_cast<u64>(18446744073709551615ULL),
+                  static_cast<i8>(-128));
+    eq = writer.equals("18446744073709551615 -128");
+    assert(eq);
+    writer.format("{x} {b}", 255, static_cast<u8>(5));
+    eq = writer.equals("ff 101");
+    assert(eq);
+  }
+
+  // Floats, bools, chars, strings
+  {
+    writer.format("{} {} {} {e}", 0.1, 0.1F, 1.5F, 1000.0);
+    bool eq = writer.equals("0.1 0.1 1.5 1e+03");
+    assert(eq);
+    writer.format("{}|{}|{}|{}", true, 'c', "str",
+                  static_cast<const_cstr>(nullptr));
+    eq = writer.equals("true|c|str|(null)");
+    assert(eq);
+  }
+
+  // Slices
+  {
+    int ints[3] = {1, 2, 3};
+    u8  str[2]  = {'h', 'i'};
+    writer.format("{} {x} {s} {s}", Slice<int>{ints, 3}, Slice<int>{ints, 0},
+                  Slice<u8>{str, 2}, Slice<const u8>{str, 2});
+    const bool eq = writer.equals("[1, 2, 3] [] hi hi");
+    assert(eq);
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_FORMAT_TESTS_H
@@ -0,0 +1,152 @@
+#ifndef CBL_INTRUSIVE_LIST_TESTS_H
+#define CBL_INTRUSIVE_LIST_TESTS_H
+
+#include "cbl/intrusive_list.h"
+#include "cbl/primitives.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+/// An element that can be in a singly and a doubly linked list at once.
+struct ListItem {
+  i32       value;
+  SListLink slink;
+  DListLink dlink;
+};
+
+inline static void sListTests() {
+  ListItem items[4] = {{0, {}, {}}, {1, {}, {}}, {2, {}, {}}, {3, {}, {}}};
+  SList<ListItem, &ListItem::slink> list{};
+  ListItem*                         popped = list.popFront();
+  assert(list.isEmpty() && (list.front() == nullptr) && (popped == nullptr));
+
+  // Pushing to the front reverses the order
+  for (ListItem& item : items) {
+    list.pushFront(&item);
+  }
+  assert((list.len() == 4) && (list.front() == &items[3]));
+  SList<ListItem, &ListItem::slink>::Iterator it   = list.iterator();
+  ListItem*                                   item = nullptr;
+  for (i32 i = 3; i >= 0; i--) {
+    const bool has_next = it.next(&item);
+    assert(has_next && (item->value == i));
+  }
+  const bool has_next = it.next(&item);
+  assert(!has_next);
+
+  // Removing from the middle and inserting after an element
+  const bool removed = list.remove(&items[1]);
+  const bool again   = list.remove(&items[1]);
+  assert(removed && !again);
+  list.insertAfter(&items[0], &items[1]);
+  assert(list.len() == 4);
+  const i32 order[4] = {3, 2, 0, 1};
+  for (const i32 value : order) {
+    popped = list.popFront();
+    assert(popped->value == value);
+  }
+  assert(list.isEmpty() && (list.len() == 0));
+}
+
+inline static void dListTests() {
+  ListItem items[6] = {{0, {}, {}}, {1, {}, {}}, {2, {}, {}},
+                       {3, {}, {}}, {4, {}, {}}, {5, {}, {}}};
+  DList<ListItem, &ListItem::dlink> list{};
+  ListItem*                         popped = list.popBack();
+  assert(list.isEmpty() && (popped == nullptr));
+
+  // 1 0 2
+  list.pushBack(&items[0]);
+  list.pushFront(&items[1]);
+  list.pushBack(&items[2]);
+  assert((list.front() == &items[1]) && (list.back() == &items[2]));
+  assert(list.next(&items[1]) == &items[0]);
+  assert(list.prev(&items[1]) == nullptr);
+
+  // 1 3 0 4 2
+  list.insertBefore(&items[0], &items[3]);
+  list.insertAfter(&items[0], &items[4]);
+  assert(list.len() == 5);
+  {
+    const i32 order[5] = {1, 3, 0, 4, 2};
+    DList<ListItem, &ListItem::dlink>::Iterator it   = list.iterator();
+    ListItem*                                   item = nullptr;
+    for (const i32 value : order) {
+      const bool has_next = it.next(&item);
+      assert(has_next && (item->value == value));
+    }
+    const bool has_next = it.next(&item);
+    assert(!has_next);
+  }
+
+  // Removing the ends and the middle in O(1)
+  list.remove(&items[1]);
+  list.remove(&items[2]);
+  list.remove(&items[0]);
+  assert((list.len() == 2) && (list.front() == &items[3]) &&
+         (list.back() == &items[4]));
+  assert((list.prev(&items[4]) == &items[3]) &&
+         (list.next(&items[4]) == nullptr));
+
+  // Splicing moves every element of the other list
+  DList<ListItem, &ListItem::dlink> other{};
+  other.pushBack(&items[5]);
+  other.pushBack(&items[0]);
+  list.splice(other);
+  assert(other.isEmpty() && (other.len() == 0) && (list.len() == 4));
+  {
+    const i32 order[4] = {3, 4, 5, 0};
+    for (const i32 value : order) {
+      popped = list.popFront();
+      assert(popped->value == value);
+    }
+  }
+  assert(list.isEmpty() && (list.front() == nullptr));
+
+  // Splicing into an empty list
+  other.pushBack(&items[1]);
+  list.splice(other);
+  list.splice(other);
+  assert(list.len() == 1);
+  popped = list.popBack();
+  assert(popped == &items[1]);
+
+  // Elements can be in several lists through different links
+  SList<ListItem, &ListItem::slink> stack{};
+  for (ListItem& item : items) {
+    stack.pushFront(&item);
+    list.pushBack(&item);
+  }
+  list.remove(&items[2]);
+  assert((stack.len() == 6) && (list.len() == 5));
+}
+
+inline static void lruListTests() {
+  ListItem items[4] = {{0, {}, {}}, {1, {}, {}}, {2, {}, {}}, {3, {}, {}}};
+  LruList<ListItem, &ListItem::dlink> lru{};
+  ListItem*                           evicted = lru.evict();
+  assert(evicted == nullptr);
+  for (ListItem& item : items) {
+    lru.insert(&item);
+  }
+  assert(lru.leastRecent() == &items[0]);
+
+  // Touched elements are evicted last
+  lru.touch(&items[0]);
+  lru.touch(&items[2]);
+  lru.touch(&items[2]);
+  evicted = lru.evict();
+  assert(evicted == &items[1]);
+  evicted = lru.evict();
+  assert(evicted == &items[3]);
+  lru.remove(&items[0]);
+  assert(lru.len() == 1);
+  evicted = lru.evict();
+  assert(evicted == &items[2]);
+  assert(lru.isEmpty() && (lru.leastRecent() == nullptr));
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_INTRUSIVE_LIST_TESTS_H
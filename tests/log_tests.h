@@ -0,0 +1,70 @@
+#ifndef CBL_LOG_TESTS_H
+#define CBL_LOG_TESTS_H
+
+#include "cbl/io/buffer_writer.h"
+#include "cbl/log.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::log;
+
+inline static void logTests() {
+  mem::CAllocator  allocator{};
+  static u8        out[16384];
+  io::BufferWriter sink{Slice<u8>{out, sizeof(out)}};
+
+  // Single producer, runtime filtering
+  {
+    Logger     logger{allocator, sink,
+                      Logger::Options{.capacity = 4, .level = Level::Info}};
+    const bool debug = logger.debug("filtered {}", 1);
+    const bool info  = logger.info("answer={}", 42);
+    const bool error = logger.error("{} failed", "thing");
+    assert(!debug && info && error);
+    logger.flush();
+
+    const char* expected = "[INFO] answer=42\n[ERROR] thing failed\n";
+    assert(sink.written().len() == std::strlen(expected));
+    assert(std::memcmp(out, expected, std::strlen(expected)) == 0);
+  }
+
+  // Many producers on a small queue with backpressure
+  {
+    sink.reset();
+    const usize THREADS = 4;
+    const usize MSGS    = 100;
+    {
+      Logger      logger{allocator, sink,
+                    Logger::Options{.capacity = 8,
+                                         .policy   = Logger::Policy::Block}};
+      std::thread threads[THREADS];
+      for (usize t = 0; t < THREADS; t++) {
+        threads[t] = std::thread{[&logger, t]() {
+          for (usize i = 0; i < MSGS; i++) {
+            logger.info("t{} m{}", t, i);
+          }
+        }};
+      }
+      for (std::thread& thread : threads) {
+        thread.join();
+      }
+      assert(logger.dropped() == 0);
+    }
+
+    usize lines = 0;
+    for (usize i = 0; i < sink.written().len(); i++) {
+      lines += (out[i] == '\n') ? 1 : 0;
+    }
+    assert(lines == THREADS * MSGS);
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_LOG_TESTS_H
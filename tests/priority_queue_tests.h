@@ -0,0 +1,94 @@
+#ifndef CBL_PRIORITY_QUEUE_TESTS_H
+#define CBL_PRIORITY_QUEUE_TESTS_H
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/priority_queue.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <functional>
+
+namespace cbl_tests {
+using namespace cbl;
+
+inline static void priorityQueueTests() {
+  mem::CAllocator allocator{};
+
+  // Elements come out in order
+  {
+    PriorityQueue<i32> queue{allocator};
+    i32                value  = 0;
+    bool               popped = queue.pop(&value);
+    assert(!popped && (queue.peek() == nullptr));
+    for (i32 i = 0; i < 1000; i++) {
+      queue.push((i * 7919) % 1000);
+    }
+    assert((queue.len() == 1000) && (*queue.peek() == 0));
+    for (i32 i = 0; i < 1000; i++) {
+      popped = queue.pop(&value);
+      assert(popped && (value == i));
+    }
+    assert(queue.isEmpty());
+    queue.deinit();
+  }
+
+  // Heapify, with a max-queue
+  {
+    i32 values[500];
+    for (i32 i = 0; i < 500; i++) {
+      values[i] = (i * 31) % 500;
+    }
+    PriorityQueue<i32, std::greater<i32>> queue =
+        PriorityQueue<i32, std::greater<i32>>::fromSlice(
+            allocator, Slice<const i32>{values, 500});
+    i32 value = 0;
+    for (i32 i = 499; i >= 0; i--) {
+      const bool popped = queue.pop(&value);
+      assert(popped && (value == i));
+    }
+    queue.deinit();
+  }
+}
+
+inline static void indexedPriorityQueueTests() {
+  mem::CAllocator                   allocator{};
+  IndexedPriorityQueue<u64>         queue{allocator};
+  IndexedPriorityQueue<u64>::Handle handles[200];
+  u64                               value = 0;
+
+  for (u64 i = 0; i < 200; i++) {
+    handles[i] = queue.push(1000 + i);
+  }
+  assert(*queue.get(handles[42]) == 1042);
+
+  // Decreasing a key moves it to the top
+  bool ok = queue.decreaseKey(handles[150], 5);
+  assert(ok && (*queue.peek() == 5));
+
+  // Updates may move elements either way
+  const bool raised  = queue.update(handles[150], 2000);
+  const bool lowered = queue.update(handles[199], 1);
+  assert(raised && lowered && (*queue.peek() == 1));
+
+  // Removal by handle
+  ok = queue.remove(handles[10], &value);
+  assert(ok && (value == 1010));
+  const bool again     = queue.remove(handles[10], &value);
+  const bool decreased = queue.decreaseKey(handles[10], 0);
+  assert(!again && !decreased && !queue.contains(handles[10]));
+
+  ok = queue.pop(&value);
+  assert(ok && (value == 1));
+  assert(!queue.contains(handles[199]));
+  u64 prev = 0;
+  while (queue.pop(&value)) {
+    assert(value >= prev);
+    prev = value;
+  }
+  assert(prev == 2000);
+  queue.deinit();
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_PRIORITY_QUEUE_TESTS_H
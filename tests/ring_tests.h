@@ -0,0 +1,84 @@
+#ifndef CBL_RING_TESTS_H
+#define CBL_RING_TESTS_H
+
+#include "cbl/io/file.h"
+#include "cbl/io/ring.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include <cassert>
+#include <cstdio>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::io;
+
+inline static void ringRoundTrip(Ring::Backend backend) {
+  mem::CAllocator allocator{};
+  Ring            ring{allocator, 8, backend};
+  if (!ring.isValid()) {
+    // `io_uring` may be disabled (e.g. by seccomp)
+    assert(backend == Ring::Backend::Uring);
+    return;
+  }
+
+  File file{std::tmpfile()};
+  u8   out[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+  // Write both halves in one batch
+  const bool first  = ring.write(file, Slice<u8>{out, 4}, 0, 1);
+  const bool second = ring.write(file, Slice<u8>{out + 4, 4}, 4, 2);
+  assert(first && second && (ring.inFlight() == 2));
+  ring.submitAndWait(2);
+
+  Ring::Completion completions[2];
+  usize            reaped = 0;
+  while (reaped < 2) {
+    reaped += ring.poll(
+        Slice<Ring::Completion>{completions + reaped, 2 - reaped});
+  }
+  for (usize i = 0; i < 2; i++) {
+    assert(completions[i].result == 4);
+  }
+  assert(ring.inFlight() == 0);
+
+  // Read it back through a registered buffer and file
+  u8         in[8]   = {};
+  int        fds[1]  = {file.fd()};
+  Slice<u8>  bufs[1] = {Slice<u8>{in, 8}};
+  const bool files   = ring.registerFiles(Slice<int>{fds, 1});
+  const bool buffers = ring.registerBuffers(Slice<Slice<u8>>{bufs, 1});
+  const bool queued  = ring.queue(Ring::Request{.op         = Ring::Op::Read,
+                                                .fd         = 0,
+                                                .buf        = Slice<u8>{in, 8},
+                                                .offset     = 0,
+                                                .user_data  = 3,
+                                                .buf_index  = 0,
+                                                .fixed_file = true});
+  assert(files && buffers && queued);
+  ring.submitAndWait(1);
+
+  bool read = false;
+  while (!read) {
+    ring.poll(
+        [](Ring::Completion completion, any ctx) {
+          assert(completion.user_data == 3);
+          assert(completion.result == 8);
+          *static_cast<bool*>(ctx) = true;
+        },
+        &read);
+  }
+  for (usize i = 0; i < 8; i++) {
+    assert(in[i] == out[i]);
+  }
+  ring.unregisterAll();
+}
+
+inline static void ringTests() {
+  ringRoundTrip(Ring::Backend::Uring);
+  ringRoundTrip(Ring::Backend::Blocking);
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_RING_TESTS_H
@@ -1,12 +1,102 @@
 #include "allocator_tests.h"
+#include "binary_tests.h"
+#include "bit_set_tests.h"
+#include "btree_tests.h"
+#include "cache_tests.h"
+#include "event_loop_tests.h"
+#include "file_tests.h"
+#include "format_tests.h"
+#include "intrusive_list_tests.h"
+#include "log_tests.h"
+#include "priority_queue_tests.h"
+#include "ring_tests.h"
+#include "slice_ops_tests.h"
+#include "slice_tests.h"
+#include "slot_map_tests.h"
+#include "sort_tests.h"
+#include "string_pool_tests.h"
+#include "string_tests.h"
+#include "sync_tests.h"
+#include "trace_tests.h"
 
 int main() {
   using namespace cbl_tests;
 
   // Allocator tests
   {
+    layoutTests();
     allocatorTests();
     fbaTests();
+    batchTests();
+    poolTests();
+  }
+
+  // Slice tests
+  {
+    sliceTests();
+    sliceOpsTests();
+  }
+
+  // Bit set tests
+  {
+    bitSetTests();
+    dynamicBitSetTests();
+    rankSelectTests();
+  }
+
+  // Container tests
+  {
+    sListTests();
+    dListTests();
+    lruListTests();
+    btreeTests();
+    slotMapTests();
+    priorityQueueTests();
+    indexedPriorityQueueTests();
+    cacheTests();
+    shardedCacheTests();
+  }
+
+  // Sorting tests
+  {
+    pdqSortTests();
+    radixSortTests();
+    parallelSortTests();
+  }
+
+  // String tests
+  {
+    stringBuilderTests();
+    stringSearchTests();
+    stringPoolTests();
+  }
+
+  // I/O tests
+  {
+    binaryTests();
+    copyRangeTests();
+    formatTests();
+    ringTests();
+    taskTests();
+    eventLoopTests();
+  }
+
+  // Synchronization tests
+  {
+    mutexTests();
+    spinLockTests();
+    rwLockTests();
+    conditionTests();
+    resetEventTests();
+    onceTests();
+    channelTests();
+    selectTests();
+  }
+
+  // Logging tests
+  {
+    logTests();
+    traceTests();
   }
 
   return 0;
@@ -0,0 +1,120 @@
+#ifndef CBL_SLICE_OPS_TESTS_H
+#define CBL_SLICE_OPS_TESTS_H
+
+#include "cbl/dynamic_array.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slice_ops.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+/// Checks the kernels against scalar loops for lengths around the vector
+/// widths.
+template <class T> inline static void sliceOpsCheck(T lo, T hi) {
+  mem::CAllocator allocator{};
+  const usize     lens[] = {1, 3, 15, 16, 17, 31, 32, 33, 63, 64, 65, 300};
+  for (usize len : lens) {
+    Slice<T> s = allocator.createArray<T>(len);
+    slice::fill(s, lo);
+    for (usize i = 0; i < len; i++) {
+      assert(s[i] == lo);
+    }
+    assert(slice::count(s, lo) == len);
+    assert(slice::indexOf(s, hi) == slice::NOT_FOUND);
+    assert(slice::countLess(s, hi) == len);
+    assert(slice::countLess(s, lo) == 0);
+
+    // Place the extremes at the end, where the tails are handled
+    s[len - 1] = hi;
+    assert(slice::indexOf(s, hi) == len - 1);
+    assert(slice::count(s, hi) == 1);
+    assert(slice::max(s) == hi);
+    assert((len == 1) || (slice::min(s) == lo));
+    s[len - 1] = lo;
+    s[len / 2] = hi;
+    assert(slice::indexOf(s, hi) == len / 2);
+    assert(slice::max(s) == hi);
+    assert(slice::countLess(s, hi) == len - 1);
+
+    Slice<T> t = allocator.createArray<T>(len);
+    slice::copy(t, s);
+    assert(slice::equal(s, t));
+    t[0] = hi;
+    assert((len == 1) || !slice::equal(s, t));
+
+    allocator.destroyArray(t);
+    allocator.destroyArray(s);
+  }
+}
+
+inline static void sliceOpsTests() {
+  // Signedness must be respected by `min` and `max`
+  sliceOpsCheck<u8>(3, 200);
+  sliceOpsCheck<i8>(-100, 7);
+  sliceOpsCheck<i16>(-3000, -2);
+  sliceOpsCheck<u32>(1, 4000000000U);
+  sliceOpsCheck<i64>(-5, 1LL << 40);
+  sliceOpsCheck<f32>(-1.5F, 2.25F);
+  sliceOpsCheck<f64>(0.5, 1e300);
+
+  // Sums
+  {
+    u32 values[100];
+    f64 floats[100];
+    for (usize i = 0; i < 100; i++) {
+      values[i] = static_cast<u32>(i + 1);
+      floats[i] = static_cast<f64>(i) * 0.5;
+    }
+    assert(slice::sum(Slice<u32>{values, 100}) == 5050);
+    assert(slice::sum(Slice<f64>{floats, 100}) == 2475.0);
+    assert(slice::sum(Slice<u32>{values, 0}) == 0);
+
+    // Wraps around
+    u8 bytes[40];
+    slice::fill(Slice<u8>{bytes, 40}, u8(10));
+    assert(slice::sum(Slice<u8>{bytes, 40}) == u8(400 % 256));
+  }
+
+  // Byte counts must not overflow the lane counters
+  {
+    mem::CAllocator allocator{};
+    Slice<u8>       bytes = allocator.createArray<u8>(100000);
+    slice::fill(bytes, u8(7));
+    assert(slice::count(bytes, u8(7)) == 100000);
+    allocator.destroyArray(bytes);
+  }
+
+  // Overlapping moves
+  {
+    i32 values[] = {1, 2, 3, 4, 5};
+    slice::move(Slice<i32>{values + 1, 4}, Slice<i32>{values, 4});
+    assert((values[0] == 1) && (values[1] == 1) && (values[4] == 4));
+    slice::move(Slice<i32>{values, 4}, Slice<i32>{values + 1, 4});
+    assert((values[0] == 1) && (values[1] == 2) && (values[3] == 4));
+  }
+
+  // Containers
+  {
+    mem::CAllocator            allocator{};
+    UnmanagedDynamicArray<i32> array;
+    i32                        values[] = {1, 2, 5, 6};
+    i32                        middle[] = {3, 4};
+    array.appendSlice(allocator, Slice<i32>{values, 4});
+    array.insertSlice(allocator, Slice<i32>{middle, 2}, 2);
+    array.insert(allocator, 0, 0);
+    assert(array.len() == 7);
+    for (usize i = 0; i < array.len(); i++) {
+      assert(array.elems()[i] == static_cast<i32>(i));
+    }
+    const i32 removed = array.remove(3);
+    assert((removed == 3) && (array.elems()[3] == 4) && (array.len() == 6));
+    array.deinit(allocator);
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_SLICE_OPS_TESTS_H
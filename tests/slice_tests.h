@@ -0,0 +1,83 @@
+#ifndef CBL_SLICE_TESTS_H
+#define CBL_SLICE_TESTS_H
+
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slice_ops.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+inline static void sliceTests() {
+  i32        values[] = {0, 1, 2, 3, 4, 5, 6};
+  Slice<i32> s{values, 7};
+
+  // Iteration
+  {
+    i32 expected = 0;
+    for (i32& v : s) {
+      assert(v == expected);
+      expected += 1;
+    }
+    assert(expected == 7);
+    assert(s.getUnchecked(3) == 3);
+  }
+
+  // Sub-slices
+  {
+    Slice<i32> mid = s.subslice(2, 5);
+    assert((mid.len() == 3) && (mid[0] == 2) && (mid[2] == 4));
+    assert(s.subslice(7, 7).len() == 0);
+    assert((s.first(2).len() == 2) && (s.first(2)[1] == 1));
+    assert((s.last(2).len() == 2) && (s.last(2)[0] == 5));
+    assert(s.last(0).len() == 0);
+  }
+
+  // Read-only conversion
+  {
+    Slice<const i32> read_only = s;
+    assert((read_only.len() == 7) && (read_only[6] == 6));
+    assert(slice::equal(read_only, s));
+    assert(slice::indexOf(read_only, 4) == 4);
+    assert(slice::max(read_only) == 6);
+
+    i32 copied[7];
+    slice::copy(Slice<i32>{copied, 7}, read_only);
+    assert(slice::equal(Slice<i32>{copied, 7}, read_only));
+  }
+
+  // Chunks
+  {
+    Slice<i32>         chunk;
+    Slice<i32>::Chunks chunks   = s.chunks(3);
+    bool               has_next = chunks.next(&chunk);
+    assert(has_next && (chunk.len() == 3) && (chunk[0] == 0));
+    has_next = chunks.next(&chunk);
+    assert(has_next && (chunk.len() == 3) && (chunk[0] == 3));
+    has_next = chunks.next(&chunk);
+    assert(has_next && (chunk.len() == 1) && (chunk[0] == 6));
+    has_next = chunks.next(&chunk);
+    assert(!has_next);
+    has_next = Slice<i32>{}.chunks(2).next(&chunk);
+    assert(!has_next);
+  }
+
+  // Windows
+  {
+    Slice<i32>          window;
+    Slice<i32>::Windows windows = s.windows(5);
+    usize               count   = 0;
+    while (windows.next(&window)) {
+      assert((window.len() == 5) && (window[0] == static_cast<i32>(count)));
+      count += 1;
+    }
+    assert(count == 3);
+    const bool has_next = s.windows(8).next(&window);
+    assert(!has_next);
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_SLICE_TESTS_H
@@ -0,0 +1,70 @@
+#ifndef CBL_SLOT_MAP_TESTS_H
+#define CBL_SLOT_MAP_TESTS_H
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slot_map.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+inline static void slotMapTests() {
+  mem::CAllocator allocator{};
+  SlotMap<i32>    map{allocator};
+
+  // Handles stay valid as the map grows
+  SlotMap<i32>::Handle handles[1000];
+  for (i32 i = 0; i < 1000; i++) {
+    handles[i] = map.insert(i * 10);
+  }
+  assert(map.len() == 1000);
+  for (i32 i = 0; i < 1000; i++) {
+    assert(*map.getPtr(handles[i]) == i * 10);
+  }
+
+  // Removed handles are stale, even after their slot is reused
+  {
+    const bool removed = map.remove(handles[3]);
+    const bool again   = map.remove(handles[3]);
+    assert(removed && !again);
+    assert(!map.contains(handles[3]) && (map.getPtr(handles[3]) == nullptr));
+
+    SlotMap<i32>::Handle reused = map.insert(-1);
+    assert(reused.index == handles[3].index);
+    assert(!(reused == handles[3]) && !map.contains(handles[3]));
+    assert(*map.getPtr(reused) == -1);
+    assert(!map.contains(SlotMap<i32>::Handle{0, 0}));
+    handles[3] = reused;
+  }
+
+  // Removing moves the last value, which must stay reachable
+  {
+    const bool removed = map.remove(handles[0]);
+    assert(removed && (*map.getPtr(handles[999]) == 9990));
+    assert(*map.getPtr(handles[3]) == -1);
+    assert(map.len() == 999);
+  }
+
+  // Dense iteration
+  {
+    Slice<i32> values = map.values();
+    i64        sum    = 0;
+    for (usize i = 0; i < values.len(); i++) {
+      sum += values[i];
+      assert(map.getPtr(map.handleAt(i)) == &values[i]);
+    }
+    assert(sum == 4995000 - 30 - 1);
+  }
+
+  map.clear();
+  assert(map.isEmpty() && !map.contains(handles[500]));
+  SlotMap<i32>::Handle handle = map.insert(5);
+  assert(*map.getPtr(handle) == 5);
+  map.deinit();
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_SLOT_MAP_TESTS_H
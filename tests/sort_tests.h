@@ -0,0 +1,146 @@
+#ifndef CBL_SORT_TESTS_H
+#define CBL_SORT_TESTS_H
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/slice_ops.h"
+#include "cbl/sort.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+/// A small deterministic generator for test data.
+struct SortTestRng {
+  u64 state;
+
+  auto next() noexcept -> u64 {
+    this->state ^= this->state << 13;
+    this->state ^= this->state >> 7;
+    this->state ^= this->state << 17;
+    return this->state;
+  }
+};
+
+struct SortTestRecord {
+  u32 key;
+  u32 order;
+};
+
+inline static void pdqSortTests() {
+  mem::CAllocator allocator{};
+  SortTestRng     rng{0x9E3779B97F4A7C15ULL};
+  const usize     len  = 10000;
+  Slice<i64>      keys = allocator.createArray<i64>(len);
+
+  // Random, sorted, reverse sorted and few unique keys
+  for (i64& key : keys) {
+    key = static_cast<i64>(rng.next());
+  }
+  sort::pdq(keys);
+  assert(sort::isSorted(keys));
+  sort::pdq(keys);
+  assert(sort::isSorted(keys));
+  sort::pdq(keys, [](i64 a, i64 b) { return b < a; });
+  assert(sort::isSorted(keys, [](i64 a, i64 b) { return b < a; }));
+  sort::pdq(keys);
+  assert(sort::isSorted(keys));
+  for (i64& key : keys) {
+    key = static_cast<i64>(rng.next() % 4);
+  }
+  sort::pdq(keys);
+  assert(sort::isSorted(keys));
+  assert(slice::count(keys, 0) + slice::count(keys, 1) +
+             slice::count(keys, 2) + slice::count(keys, 3) ==
+         len);
+
+  // Organ pipe, which defeats naive pivot selection
+  for (usize i = 0; i < len; i++) {
+    keys[i] = static_cast<i64>((i < len / 2) ? i : len - i);
+  }
+  sort::pdq(keys);
+  assert(sort::isSorted(keys));
+
+  allocator.destroyArray(keys);
+}
+
+inline static void radixSortTests() {
+  mem::CAllocator allocator{};
+  SortTestRng     rng{12345};
+  const usize     len = 5000;
+
+  {
+    Slice<i32> keys = allocator.createArray<i32>(len);
+    for (i32& key : keys) {
+      key = static_cast<i32>(rng.next());
+    }
+    const bool sorted = sort::radix(allocator, keys);
+    assert(sorted && sort::isSorted(keys));
+    allocator.destroyArray(keys);
+  }
+  {
+    Slice<u8> keys = allocator.createArray<u8>(len);
+    for (u8& key : keys) {
+      key = static_cast<u8>(rng.next());
+    }
+    const bool sorted = sort::radix(allocator, keys);
+    assert(sorted && sort::isSorted(keys));
+    allocator.destroyArray(keys);
+  }
+  {
+    Slice<f64> keys = allocator.createArray<f64>(len);
+    for (f64& key : keys) {
+      key = static_cast<f64>(static_cast<i64>(rng.next() % 2000) - 1000) /
+            7.0;
+    }
+    const bool sorted = sort::radix(allocator, keys);
+    assert(sorted && sort::isSorted(keys));
+    allocator.destroyArray(keys);
+  }
+
+  // Records sort stably by key
+  {
+    Slice<SortTestRecord> records =
+        allocator.createArray<SortTestRecord>(len);
+    for (usize i = 0; i < len; i++) {
+      records[i] = SortTestRecord{static_cast<u32>(rng.next() % 100),
+                                  static_cast<u32>(i)};
+    }
+    const bool sorted = sort::radix(
+        allocator, records, [](const SortTestRecord& r) { return r.key; });
+    assert(sorted);
+    for (usize i = 1; i < len; i++) {
+      assert((records[i - 1].key < records[i].key) ||
+             ((records[i - 1].key == records[i].key) &&
+              (records[i - 1].order < records[i].order)));
+    }
+    allocator.destroyArray(records);
+  }
+}
+
+inline static void parallelSortTests() {
+  mem::CAllocator allocator{};
+  SortTestRng     rng{777};
+  const usize     len      = 200000;
+  Slice<u64>      keys     = allocator.createArray<u64>(len);
+  Slice<u64>      expected = allocator.createArray<u64>(len);
+
+  const usize     threads[] = {1, 2, 3, 4, 0};
+  for (usize n : threads) {
+    for (u64& key : keys) {
+      key = rng.next() % 100000;
+    }
+    slice::copy(expected, keys);
+    sort::pdq(expected);
+    const bool sorted = sort::parallel(allocator, keys, std::less<>{}, n);
+    assert(sorted && slice::equal(keys, expected));
+  }
+
+  allocator.destroyArray(expected);
+  allocator.destroyArray(keys);
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_SORT_TESTS_H
@@ -0,0 +1,86 @@
+#ifndef CBL_STRING_POOL_TESTS_H
+#define CBL_STRING_POOL_TESTS_H
+
+#include "cbl/io/buffer_writer.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/string.h"
+#include "cbl/string_pool.h"
+#include <cassert>
+#include <thread>
+
+namespace cbl_tests {
+using namespace cbl;
+
+inline static void stringPoolTests() {
+  mem::CAllocator allocator{};
+  StringPool      pool{allocator};
+
+  const u32       foo   = pool.intern(str::fromCstr("foo"));
+  const u32       bar   = pool.intern(str::fromCstr("bar"));
+  const u32       nil   = pool.intern(str::fromCstr(""));
+  const u32       again = pool.intern(str::fromCstr("foo"));
+  assert((foo != bar) && (again == foo));
+  assert(pool.len() == 3);
+  assert(str::eql(pool.resolve(bar), str::fromCstr("bar")));
+  assert(pool.resolve(nil).len() == 0);
+
+  u32        found   = 0;
+  const bool has_bar = pool.find(str::fromCstr("bar"), &found);
+  assert(has_bar && (found == bar));
+  const bool has_baz = pool.find(str::fromCstr("baz"), &found);
+  assert(!has_baz);
+
+  // Enough strings to grow the table, fill several segments and chunks
+  u8 buf[32];
+  for (usize i = 0; i < 5000; i++) {
+    io::BufferWriter name{Slice<u8>{buf, sizeof(buf)}};
+    name.format("identifier_{}", i);
+    const u32 id = pool.intern(name.written());
+    assert(id == i + 3);
+  }
+  for (usize i = 0; i < 5000; i++) {
+    io::BufferWriter name{Slice<u8>{buf, sizeof(buf)}};
+    name.format("identifier_{}", i);
+    assert(str::eql(pool.resolve(static_cast<u32>(i + 3)), name.written()));
+  }
+  assert(str::eql(pool.resolve(foo), str::fromCstr("foo")));
+
+  // Strings larger than a chunk
+  Slice<u8> big = allocator.createArray<u8>(100 * 1024);
+  big[big.len() - 1]  = 'x';
+  const u32 big_id    = pool.intern(big);
+  const u32 big_again = pool.intern(big);
+  assert(pool.resolve(big_id).len() == big.len());
+  assert(big_again == big_id);
+  allocator.destroyArray(big);
+
+  // Concurrent interning of the same strings agrees on their IDs
+  {
+    StringPool shared{allocator};
+    u32        ids[4][200];
+    auto       worker = [&](usize t) {
+      u8 name_buf[32];
+      for (usize i = 0; i < 200; i++) {
+        io::BufferWriter name{Slice<u8>{name_buf, sizeof(name_buf)}};
+        name.format("key{}", (i * 7 + t) % 200);
+        ids[t][(i * 7 + t) % 200] = shared.intern(name.written());
+      }
+    };
+    std::thread threads[4] = {std::thread{worker, 0}, std::thread{worker, 1},
+                              std::thread{worker, 2}, std::thread{worker, 3}};
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    assert(shared.len() == 200);
+    for (usize i = 0; i < 200; i++) {
+      assert((ids[0][i] == ids[1][i]) && (ids[1][i] == ids[2][i]) &&
+             (ids[2][i] == ids[3][i]));
+    }
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_STRING_POOL_TESTS_H
@@ -0,0 +1,87 @@
+#ifndef CBL_STRING_TESTS_H
+#define CBL_STRING_TESTS_H
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/string.h"
+#include <cassert>
+
+namespace cbl_tests {
+using namespace cbl;
+
+inline static void stringBuilderTests() {
+  mem::CAllocator allocator{};
+  StringBuilder   builder{allocator};
+
+  builder.append("id=");
+  builder.format("{}:{}", 42, "x");
+  builder.appendByte('!');
+  assert(str::eql(builder.str(), str::fromCstr("id=42:x!")));
+
+  builder.clear();
+  assert(builder.len() == 0);
+  builder.append("abc");
+
+  Slice<u8> owned = builder.toOwnedSlice();
+  assert(str::eql(owned, str::fromCstr("abc")));
+  assert(builder.len() == 0);
+  allocator.destroyArray(owned);
+  builder.deinit();
+}
+
+inline static void stringSearchTests() {
+  // Long enough to exercise the vector loops and the scalar tails
+  Slice<u8> text = str::fromCstr(
+      "GET /api/v1/users/1234/profile HTTP/1.1 -- the quick brown fox jumps "
+      "over the lazy dog; the quick brown fox jumps over the lazy cat");
+
+  assert(str::startsWith(text, str::fromCstr("GET /api/")));
+  assert(!str::startsWith(text, str::fromCstr("POST")));
+  assert(str::endsWith(text, str::fromCstr("lazy cat")));
+  assert(!str::endsWith(str::fromCstr("at"), str::fromCstr("cat")));
+
+  assert(str::indexOfByte(text, 'G') == 0);
+  assert(str::indexOfByte(text, ';') == 86);
+  assert(str::indexOfByte(text, 'Z') == str::NOT_FOUND);
+  assert(str::indexOf(text, str::fromCstr("HTTP")) == 31);
+  assert(str::indexOf(text, str::fromCstr("lazy cat")) == text.len() - 8);
+  assert(str::indexOf(text, str::fromCstr("lazy cow")) == str::NOT_FOUND);
+  assert(str::indexOf(text, str::fromCstr("")) == 0);
+
+  assert(str::eql(str::trim(str::fromCstr(" \t x y \n")),
+                  str::fromCstr("x y")));
+  assert(str::trim(str::fromCstr("   ")).len() == 0);
+
+  // Splitting
+  {
+    const_cstr         expected[] = {"", "api", "v1", "", "users"};
+    str::SplitIterator it         = str::split(str::fromCstr("/api/v1//users"),
+                                               str::fromCstr("/"));
+    Slice<u8>          part;
+    usize              count = 0;
+    while (it.next(&part)) {
+      assert(str::eql(part, str::fromCstr(expected[count])));
+      count += 1;
+    }
+    assert(count == 5);
+  }
+  {
+    str::SplitIterator it =
+        str::split(str::fromCstr("a, b, c"), str::fromCstr(", "));
+    Slice<u8>          part;
+    bool               has_next = it.next(&part);
+    assert(has_next && str::eql(part, str::fromCstr("a")));
+    assert(str::eql(it.rest(), str::fromCstr("b, c")));
+    has_next = it.next(&part);
+    assert(has_next && str::eql(part, str::fromCstr("b")));
+    has_next = it.next(&part);
+    assert(has_next && str::eql(part, str::fromCstr("c")));
+    has_next = it.next(&part);
+    assert(!has_next);
+  }
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_STRING_TESTS_H
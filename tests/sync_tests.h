@@ -0,0 +1,335 @@
+#ifndef CBL_SYNC_TESTS_H
+#define CBL_SYNC_TESTS_H
+
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/sync/channel.h"
+#include "cbl/sync/condition.h"
+#include "cbl/sync/mutex.h"
+#include "cbl/sync/once.h"
+#include "cbl/sync/reset_event.h"
+#include "cbl/sync/rw_lock.h"
+#include "cbl/sync/spin_lock.h"
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::sync;
+
+/// Increments a counter guarded by `lock` from several threads, checking
+/// that no increment is lost.
+template <class L> inline void checkExclusion(L& lock) {
+  static constexpr usize THREADS = 4;
+  static constexpr usize ITERS   = 20000;
+  usize                  counter = 0;
+  std::thread            threads[THREADS];
+  for (std::thread& thread : threads) {
+    thread = std::thread{[&lock, &counter]() {
+      for (usize i = 0; i < ITERS; i++) {
+        Guard<L> guard{lock};
+        counter += 1;
+      }
+    }};
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  assert(counter == THREADS * ITERS);
+}
+
+inline static void mutexTests() {
+  static_assert(sizeof(Mutex) == 4);
+  static_assert((sizeof(PaddedMutex) == 64) && (alignof(PaddedMutex) == 64));
+
+  Mutex mutex;
+  bool  locked = mutex.tryLock();
+  bool  again  = mutex.tryLock();
+  assert(locked && !again);
+  mutex.unlock();
+  locked = mutex.tryLock();
+  assert(locked);
+  mutex.unlock();
+
+  checkExclusion(mutex);
+  PaddedMutex padded;
+  checkExclusion<Mutex>(padded);
+}
+
+inline static void spinLockTests() {
+  static_assert(sizeof(SpinLock) == 4);
+
+  SpinLock   lock;
+  const bool locked = lock.tryLock();
+  const bool again  = lock.tryLock();
+  assert(locked && !again);
+  lock.unlock();
+
+  checkExclusion(lock);
+}
+
+inline static void rwLockTests() {
+  static_assert(sizeof(RwLock) == 8);
+
+  // Readers share the lock, and a writer excludes everyone
+  RwLock lock;
+  bool   first  = lock.tryLockShared();
+  bool   second = lock.tryLockShared();
+  bool   writer = lock.tryLock();
+  assert(first && second && !writer);
+  lock.unlockShared();
+  lock.unlockShared();
+  writer = lock.tryLock();
+  first  = lock.tryLockShared();
+  second = lock.tryLock();
+  assert(writer && !first && !second);
+  lock.unlock();
+
+  checkExclusion(lock);
+
+  // Readers never see a half-done write
+  {
+    usize             a = 0;
+    usize             b = 0;
+    std::atomic<bool> stop{false};
+    std::thread       readers[3];
+    for (std::thread& reader : readers) {
+      reader = std::thread{[&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+          RwLock::SharedGuard guard{lock};
+          assert(a == b);
+        }
+      }};
+    }
+    for (usize i = 0; i < 5000; i++) {
+      Guard<RwLock> guard{lock};
+      a += 1;
+      b += 1;
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& reader : readers) {
+      reader.join();
+    }
+    assert((a == 5000) && (b == 5000));
+  }
+}
+
+inline static void conditionTests() {
+  static_assert(sizeof(Condition) == 4);
+
+  // A producer hands items to a consumer one at a time
+  Mutex       mutex;
+  Condition   cond;
+  usize       item = 0;
+  bool        full = false;
+  usize       sum  = 0;
+  std::thread consumer{[&]() {
+    for (usize i = 0; i < 1000; i++) {
+      Guard<Mutex> guard{mutex};
+      cond.wait(mutex, [&]() { return full; });
+      sum  += item;
+      full  = false;
+      cond.notifyAll();
+    }
+  }};
+  for (usize i = 1; i <= 1000; i++) {
+    Guard<Mutex> guard{mutex};
+    cond.wait(mutex, [&]() { return !full; });
+    item = i;
+    full = true;
+    cond.notifyOne();
+  }
+  consumer.join();
+  assert(sum == 1000 * 1001 / 2);
+
+  // Waits time out without a notification
+  {
+    Guard<Mutex> guard{mutex};
+    const bool   woken = cond.waitFor(mutex, 1000000);
+    assert(!woken);
+  }
+}
+
+inline static void resetEventTests() {
+  static_assert(sizeof(ResetEvent) == 4);
+
+  ResetEvent event;
+  bool       set = event.waitFor(1000000);
+  assert(!set && !event.isSet());
+
+  // Setting the event wakes every waiter
+  std::atomic<usize> woken{0};
+  std::thread        waiters[3];
+  for (std::thread& waiter : waiters) {
+    waiter = std::thread{[&]() {
+      event.wait();
+      woken.fetch_add(1);
+    }};
+  }
+  event.set();
+  for (std::thread& waiter : waiters) {
+    waiter.join();
+  }
+  set = event.waitFor(0);
+  assert((woken.load() == 3) && event.isSet() && set);
+
+  event.reset();
+  assert(!event.isSet());
+}
+
+inline static void onceTests() {
+  static_assert(sizeof(Once) == 4);
+
+  Once               once;
+  std::atomic<usize> calls{0};
+  std::atomic<usize> seen{0};
+  std::thread        threads[4];
+  for (std::thread& thread : threads) {
+    thread = std::thread{[&]() {
+      once.call([&]() {
+        std::this_thread::yield();
+        calls.fetch_add(1);
+      });
+      // Every caller returns after the function has run
+      seen.fetch_add(calls.load());
+    }};
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  assert((calls.load() == 1) && (seen.load() == 4) && once.isDone());
+
+  once.call([&]() { calls.fetch_add(1); });
+  assert(calls.load() == 1);
+}
+
+inline static void channelTests() {
+  mem::CAllocator allocator{};
+
+  // A full channel refuses messages until one is received
+  {
+    Channel<u64> channel{allocator, 4};
+    assert(channel.capacity() == 4);
+    for (u64 i = 0; i < 4; i++) {
+      const bool sent = channel.trySend(i);
+      assert(sent);
+    }
+    bool sent = channel.trySend(4);
+    assert(!sent && (channel.len() == 4) && channel.isReady());
+
+    u64  value    = 0;
+    bool received = channel.tryRecv(&value);
+    assert(received && (value == 0));
+    sent = channel.trySend(4);
+    assert(sent);
+    u64         values[8];
+    const usize n = channel.tryRecvMany(Slice<u64>{values, 8});
+    assert((n == 4) && (values[0] == 1) && (values[3] == 4));
+    received = channel.tryRecv(&value);
+    assert(!received && !channel.isReady());
+
+    // Closing drains the queued messages before receives fail
+    sent = channel.trySend(5);
+    assert(sent);
+    channel.close();
+    channel.close();
+    sent                   = channel.trySend(6);
+    const bool sent_closed = channel.send(6);
+    assert(channel.isClosed() && !sent && !sent_closed);
+    received = channel.recv(&value);
+    assert(received && (value == 5));
+    received = channel.recv(&value);
+    assert(!received && channel.isReady());
+    channel.deinit();
+  }
+
+  // Senders block while the channel is full, and every message arrives in
+  // the order of its sender
+  {
+    static constexpr u64 SENDERS = 4;
+    static constexpr u64 COUNT   = 20000;
+    Channel<u64>         channel{allocator, 64};
+    std::thread          senders[SENDERS];
+    for (u64 t = 0; t < SENDERS; t++) {
+      senders[t] = std::thread{[&channel, t]() {
+        for (u64 i = 0; i < COUNT; i++) {
+          const bool sent = channel.send((t << 32) | i);
+          assert(sent);
+        }
+      }};
+    }
+
+    u64   next[SENDERS] = {};
+    u64   batch[16];
+    usize received      = 0;
+    while (received < SENDERS * COUNT) {
+      const usize n = channel.recvMany(Slice<u64>{batch, 16});
+      assert(n > 0);
+      for (usize i = 0; i < n; i++) {
+        const u64 t = batch[i] >> 32;
+        assert((t < SENDERS) && ((batch[i] & 0xFFFFFFFF) == next[t]));
+        next[t] += 1;
+      }
+      received += n;
+    }
+    for (std::thread& sender : senders) {
+      sender.join();
+    }
+    assert(!channel.isReady());
+
+    // Closing wakes a blocked receiver
+    std::thread closer{[&channel]() { channel.close(); }};
+    u64         value     = 0;
+    const bool  has_value = channel.recv(&value);
+    assert(!has_value);
+    closer.join();
+    channel.deinit();
+  }
+}
+
+inline static void selectTests() {
+  mem::CAllocator           allocator{};
+  Channel<u64>              numbers{allocator, 8};
+  Channel<i32>              signals{allocator, 8};
+  ChannelBase*              channels[] = {&numbers, &signals};
+  Slice<ChannelBase* const> both{channels, 2};
+
+  // Times out while nothing is sent
+  usize ready = select(both, 1000000);
+  assert(ready == 2);
+
+  // Wakes up for whichever channel gets a message
+  std::thread sender{[&signals]() {
+    const bool sent = signals.send(-1);
+    assert(sent);
+  }};
+  ready = select(both);
+  assert(ready == 1);
+  i32  signal   = 0;
+  bool received = signals.recv(&signal);
+  assert(received && (signal == -1));
+  sender.join();
+
+  const bool sent = numbers.trySend(7);
+  ready           = select(both, 0);
+  assert(sent && (ready == 0));
+  u64 number = 0;
+  received   = numbers.tryRecv(&number);
+  assert(received && (number == 7));
+
+  // A closed channel is ready
+  std::thread closer{[&numbers]() { numbers.close(); }};
+  ready    = select(both);
+  received = numbers.recv(&number);
+  assert((ready == 0) && !received);
+  closer.join();
+
+  numbers.deinit();
+  signals.deinit();
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_SYNC_TESTS_H
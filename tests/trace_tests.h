@@ -0,0 +1,174 @@
+#ifndef CBL_TRACE_TESTS_H
+#define CBL_TRACE_TESTS_H
+
+#include "cbl/io/binary.h"
+#include "cbl/io/buffer_writer.h"
+#include "cbl/mem/c_allocator.h"
+#include "cbl/primitives.h"
+#include "cbl/slice.h"
+#include "cbl/trace.h"
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+namespace cbl_tests {
+using namespace cbl;
+using namespace cbl::trace;
+
+/// Counts the occurrences of `needle` in `haystack`.
+inline usize countOccurrences(Slice<u8> haystack, const char* needle) {
+  const usize len   = std::strlen(needle);
+  usize       count = 0;
+  for (usize i = 0; i + len <= haystack.len(); i++) {
+    if (std::memcmp(haystack.ptr() + i, needle, len) == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/// The events of a binary trace recorded at a site named `name`.
+struct TraceCounts {
+  usize begins   = 0;
+  usize ends     = 0;
+  usize counters = 0;
+  i64   last     = 0;
+};
+
+/// Decodes a binary trace, counting the events of the sites named `name`.
+inline TraceCounts decodeBinaryTrace(Slice<u8> buf, const char* name) {
+  io::BinaryReader reader{buf};
+  u32              magic   = 0;
+  u8               version = 0;
+  f64              ns_per_tick;
+  bool             ok      = reader.read(&magic) && reader.read(&version) &&
+                             reader.read(&ns_per_tick);
+  assert(ok && (magic == BINARY_MAGIC) && (version == BINARY_VERSION));
+  assert(ns_per_tick > 0.0);
+
+  // Only the sites named `name` are counted
+  u64  num_sites = 0;
+  bool matches[64];
+  ok = reader.readVarint(&num_sites);
+  assert(ok && (num_sites <= 64));
+  for (u64 i = 0; i < num_sites; i++) {
+    Slice<u8> site_name;
+    Slice<u8> file;
+    Slice<u8> function;
+    u32       line;
+    ok = reader.readSlice(&site_name) && reader.readSlice(&file) &&
+         reader.readSlice(&function) && reader.read(&line);
+    assert(ok);
+    matches[i] = (site_name.len() == std::strlen(name)) &&
+                 (std::memcmp(site_name.ptr(), name, site_name.len()) == 0);
+  }
+
+  TraceCounts counts;
+  u8          tag = 0;
+  while (reader.read(&tag) && (tag == 1)) {
+    u64 thread = 0;
+    u64 events = 0;
+    ok = reader.readVarint(&thread) && reader.readVarint(&events);
+    assert(ok);
+    for (u64 i = 0; i < events; i++) {
+      u8  kind  = 0;
+      u64 site  = 0;
+      u64 delta = 0;
+      ok = reader.read(&kind) && reader.readVarint(&site) &&
+           reader.readVarint(&delta);
+      assert(ok && (site < num_sites));
+      u64 value = 0;
+      if (kind == static_cast<u8>(Kind::Counter)) {
+        ok = reader.readVarint(&value);
+        assert(ok);
+      }
+      if (!matches[site]) {
+        continue;
+      }
+      if (kind == static_cast<u8>(Kind::Begin)) {
+        counts.begins++;
+      } else if (kind == static_cast<u8>(Kind::End)) {
+        counts.ends++;
+      } else {
+        counts.counters++;
+        counts.last = static_cast<i64>((value >> 1) ^ (0 - (value & 1)));
+      }
+    }
+  }
+  assert((tag == 0) && (reader.remaining() == 0));
+  return counts;
+}
+
+inline static void traceTests() {
+  mem::CAllocator allocator{};
+  Slice<u8>       buf = allocator.createArray<u8>(1 << 20);
+  assert(!buf.isEmpty());
+  io::BufferWriter out{buf};
+
+  // Start from empty buffers
+  (void)exportBinary(allocator, out);
+  out.reset();
+
+  static constexpr Site outer{"outer"};
+  static constexpr Site inner{"inner"};
+  static constexpr Site value{"value"};
+
+  // Zones nest, and threads record into their own buffers
+  {
+    Zone zone{outer};
+    for (i64 i = 0; i < 3; i++) {
+      Zone nested{inner};
+      counter(value, -i);
+    }
+  }
+  std::thread{[]() { Zone zone{outer}; }}.join();
+  {
+    CBL_TRACE_ZONE("macro");
+    CBL_TRACE_COUNTER("macro", 1);
+  }
+
+  const usize exported = exportChromeJson(out);
+  Slice<u8>   json     = out.written();
+  assert(exported >= 12);
+  assert(countOccurrences(json, "{\"traceEvents\":[") == 1);
+  assert(countOccurrences(json, "\"name\":\"outer\",\"ph\":\"B\"") == 2);
+  assert(countOccurrences(json, "\"name\":\"outer\",\"ph\":\"E\"") == 2);
+  assert(countOccurrences(json, "\"name\":\"inner\",\"ph\":\"B\"") == 3);
+  assert(countOccurrences(json, "\"name\":\"value\",\"ph\":\"C\"") == 3);
+  assert(countOccurrences(json, "\"args\":{\"value\":-2}") == 1);
+  assert(countOccurrences(json, "\"ph\":\"B\"") ==
+         countOccurrences(json, "\"ph\":\"E\""));
+
+  // Exporting drains the buffers
+  out.reset();
+  (void)exportChromeJson(out);
+  assert(countOccurrences(out.written(), "\"name\":\"outer\"") == 0);
+
+  // A full buffer drops events, but keeps zones balanced
+  {
+    out.reset();
+    const usize before = dropped();
+    {
+      Zone zone{outer};
+      for (usize i = 0; i < BUFFER_EVENTS; i++) {
+        counter(value, static_cast<i64>(i));
+      }
+      Zone nested{inner};
+    }
+    assert(dropped() > before);
+    (void)exportBinary(allocator, out);
+    const TraceCounts outers = decodeBinaryTrace(out.written(), "outer");
+    const TraceCounts inners = decodeBinaryTrace(out.written(), "inner");
+    const TraceCounts values = decodeBinaryTrace(out.written(), "value");
+    assert((outers.begins == 1) && (outers.ends == 1));
+    assert(inners.begins == inners.ends);
+    assert((values.counters > 0) && (values.counters < BUFFER_EVENTS));
+    assert(values.last == static_cast<i64>(values.counters - 1));
+  }
+
+  allocator.destroyArray(buf);
+}
+
+} // namespace cbl_tests
+
+#endif // !CBL_TRACE_TESTS_H